@@ -0,0 +1,49 @@
+#ifndef GAME_ENGINE_BENCHMARK_UTILS_H
+#define GAME_ENGINE_BENCHMARK_UTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Keeps the optimizer from throwing away a computed value
+    template<typename T>
+    inline void DoNotOptimize(const T &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline auto MillisecondsSince(Clock::time_point start) -> double {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// Runs the body several times and returns the median wall time in milliseconds
+    inline auto MedianMs(const std::function<void()> &body, int repetitions = 5) -> double {
+        std::vector<double> samples;
+        samples.reserve(repetitions);
+        for (int i = 0; i < repetitions; ++i) {
+            auto start = Clock::now();
+            body();
+            samples.push_back(MillisecondsSince(start));
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    /// Busy work of roughly fixed cost which can't be folded away
+    inline auto Spin(unsigned iterations) -> unsigned {
+        unsigned value = iterations;
+        for (unsigned i = 0; i < iterations; ++i)
+            value = value * 1664525u + 1013904223u;
+        DoNotOptimize(value);
+        return value;
+    }
+}
+
+
+#endif //GAME_ENGINE_BENCHMARK_UTILS_H
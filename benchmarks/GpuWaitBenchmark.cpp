@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Engine/Core/TaskSystem.h>
+#include "BenchmarkUtils.h"
+
+
+/// Stands in for a VkFence, signalled by a thread playing the GPU
+class MockFence {
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    bool m_Signalled = false;
+
+public:
+    void Signal() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Signalled = true;
+        }
+        m_Signal.notify_all();
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Signalled = false;
+    }
+
+    /// Same contract as vkWaitForFences, true when signalled within the timeout
+    auto Wait(uint64_t timeoutNs) -> bool {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        return m_Signal.wait_for(lock, std::chrono::nanoseconds(timeoutNs), [this] { return m_Signalled; });
+    }
+};
+
+
+struct Result {
+    double frameMs;
+    double tasksPerFrame;
+    TaskSystem::ExternalWaitStats waits;
+};
+
+
+/**
+ * Every frame the render thread "submits" and waits for the GPU, which takes GPU_MS, while a
+ * streaming thread keeps the task system busy with normal priority jobs. Without cooperation the
+ * render thread's core idles during the wait, with it the jobs get done on that core.
+ */
+static auto MeasureFrames(unsigned workerCount, bool cooperative, unsigned frameCount) -> Result {
+    constexpr auto GPU_TIME = std::chrono::milliseconds(4);
+    constexpr unsigned JOB_COST = 20'000;
+
+    TaskSystem taskSystem(workerCount);
+    std::atomic<uint64_t> jobsDone{0};
+    std::atomic<bool> streaming{true};
+    std::thread streamer([&] {
+        TaskCounter pending;
+        while (streaming.load(std::memory_order_relaxed)) {
+            if (pending.Pending() < 4 * (workerCount + 1)) {
+                taskSystem.Spawn(TaskPriority::NORMAL, pending, [&jobsDone] {
+                    Bench::Spin(JOB_COST);
+                    jobsDone.fetch_add(1, std::memory_order_relaxed);
+                });
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        taskSystem.Wait(pending);
+    });
+
+    MockFence fence;
+    auto start = Bench::Clock::now();
+    uint64_t jobsBefore = jobsDone.load();
+    for (unsigned frame = 0; frame < frameCount; frame++) {
+        fence.Reset();
+        std::thread gpu([&fence, GPU_TIME] {
+            std::this_thread::sleep_for(GPU_TIME);
+            fence.Signal();
+        });
+
+        if (cooperative)
+            taskSystem.WaitExternal([&fence](uint64_t timeoutNs) { return fence.Wait(timeoutNs); }, TaskPriority::NORMAL);
+        else
+            fence.Wait(UINT64_MAX);
+        gpu.join();
+    }
+
+    Result result{};
+    result.frameMs = Bench::MillisecondsSince(start) / frameCount;
+    result.tasksPerFrame = double(jobsDone.load() - jobsBefore) / frameCount;
+    result.waits = taskSystem.GetExternalWaitStats();
+
+    streaming = false;
+    streamer.join();
+    return result;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned frameCount = argc > 1 ? std::stoul(argv[1]) : 200;
+    unsigned workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    std::printf("GPU wait benchmark, %u workers, %u frames\n", workerCount, frameCount);
+    std::printf("%-12s | %10s | %10s | %14s | %14s\n", "wait", "frame [ms]", "jobs/frame", "recovered [ms]",
+                "tasks in waits");
+    for (bool cooperative : {false, true}) {
+        Result result = MeasureFrames(workerCount, cooperative, frameCount);
+        std::printf("%-12s | %10.3f | %10.1f | %14.2f | %14llu\n", cooperative ? "cooperative" : "blocking",
+                    result.frameMs, result.tasksPerFrame, result.waits.recoveredNs / 1e6,
+                    (unsigned long long) result.waits.tasks);
+    }
+    return 0;
+}
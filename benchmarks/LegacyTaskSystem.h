@@ -1,5 +1,5 @@
-#ifndef GAME_ENGINE_NOTIFICATION_QUEUE_H
-#define GAME_ENGINE_NOTIFICATION_QUEUE_H
+#ifndef GAME_ENGINE_LEGACY_TASK_SYSTEM_H
+#define GAME_ENGINE_LEGACY_TASK_SYSTEM_H
 
 #include <deque>
 #include <mutex>
@@ -12,6 +12,12 @@
 #include <vector>
 
 
+/**
+ * The NotificationQueue based TaskSystem the engine used before the work-stealing scheduler,
+ * kept only as a baseline for the benchmarks. Queue selection uses % instead of the original & m_ThreadCount.
+ */
+namespace Legacy {
+
 class NotificationQueue {
     std::deque<std::pair<std::promise<void>, std::function<void()>>> m_Tasks;
     std::mutex m_Mutex;
@@ -80,7 +86,7 @@ public:
 
 
 class TaskSystem {
-    const unsigned m_ThreadCount{std::thread::hardware_concurrency()};
+    const unsigned m_ThreadCount;
     std::vector<std::thread> m_Threads;
     std::vector<NotificationQueue> m_Queues{m_ThreadCount};
     std::atomic<unsigned> m_Index{0};
@@ -91,7 +97,7 @@ class TaskSystem {
             std::promise<void> p;
 
             for (unsigned threadIdx = 0; threadIdx != m_ThreadCount; ++threadIdx) {
-                if (m_Queues[(i + threadIdx) & m_ThreadCount].TryPop(f, p)) break;
+                if (m_Queues[(i + threadIdx) % m_ThreadCount].TryPop(f, p)) break;
             }
             if (!f && !m_Queues[i].Pop(f, p)) break;
             f();
@@ -100,7 +106,7 @@ class TaskSystem {
     }
 
 public:
-    TaskSystem() {
+    explicit TaskSystem(unsigned threadCount = std::thread::hardware_concurrency()) : m_ThreadCount(threadCount) {
         for (size_t i = 0; i < m_ThreadCount; ++i) {
             m_Threads.emplace_back([&, i] {
                 Run(i);
@@ -128,9 +134,11 @@ public:
                 return future;
             }
         }
-        return std::move(m_Queues[taskIdx & m_ThreadCount].Push(std::forward<F>(f)));
+        return std::move(m_Queues[taskIdx % m_ThreadCount].Push(std::forward<F>(f)));
     }
 };
 
+}
+
 
-#endif //GAME_ENGINE_NOTIFICATION_QUEUE_H
+#endif //GAME_ENGINE_LEGACY_TASK_SYSTEM_H
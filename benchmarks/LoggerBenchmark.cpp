@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/Logger.h>
+#include "BenchmarkUtils.h"
+
+
+/// The std::cout logging the engine used before, kept for comparison
+namespace Legacy {
+    inline auto currentTime() -> const char * {
+        static char buf[11] = {0};
+        std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        tm tstruct = *localtime(&time);
+        strftime(buf, sizeof(buf) / sizeof(char), "[%X]", &tstruct);
+        return buf;
+    }
+
+    inline auto Log() -> std::ostream & { return std::cout << currentTime(); }
+}
+
+
+/**
+ * Every thread writes a burst of messages shaped like the shader loading logs, the result is the
+ * caller-side cost per message of the slowest thread. Bursts fit into a thread's ring, the
+ * asynchronous logger is flushed between repetitions and its formatting cost is left out on
+ * purpose, it runs on another thread.
+ */
+template<typename Write>
+static auto NsPerMessage(unsigned threadCount, unsigned messageCount, const Write &write) -> double {
+    constexpr int REPETITIONS = 5;
+    std::vector<double> samples;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        std::vector<std::thread> threads;
+        std::vector<double> threadMs(threadCount);
+        for (unsigned t = 0; t < threadCount; t++) {
+            threads.emplace_back([&write, &threadMs, t, messageCount] {
+                auto start = Bench::Clock::now();
+                for (unsigned i = 0; i < messageCount; i++)
+                    write(t, i);
+                threadMs[t] = Bench::MillisecondsSince(start);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        samples.push_back(*std::max_element(threadMs.begin(), threadMs.end()));
+        Logger::Get().Flush();
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2] * 1e6 / messageCount;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned messageCount = argc > 1 ? std::stoul(argv[1]) : 1000;
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::string shaderName = "pbr.frag";
+
+    // Log output goes to stdout, redirect it to keep the terminal usable, results are on stderr
+    std::fprintf(stderr, "Logger benchmark, %u messages per thread\n", messageCount);
+    std::fprintf(stderr, "%-8s | %16s | %16s\n", "threads", "std::cout [ns]", "async [ns]");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double legacy = NsPerMessage(threads, messageCount, [&shaderName](unsigned t, unsigned i) {
+            Legacy::Log() << "[ShaderModule (" << shaderName << ")] UBO: " << t << ", Set: " << i
+                          << ", Binding: " << 0 << std::endl;
+        });
+        double async = NsPerMessage(threads, messageCount, [&shaderName](unsigned t, unsigned i) {
+            LOG_INFO("[ShaderModule ({})] UBO: {}, Set: {}, Binding: {}", shaderName, t, i, 0);
+        });
+        std::fprintf(stderr, "%-8u | %16.1f | %16.1f\n", threads, legacy, async);
+    }
+    return 0;
+}
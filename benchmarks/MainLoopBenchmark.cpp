@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/CpuTopology.h>
+#include <Engine/Core/MainThreadQueue.h>
+#include <Engine/Core/TaskSystem.h>
+#include "BenchmarkUtils.h"
+
+
+/// Stands in for the GLFW event queue: input events carry their creation time, empty events only wake
+class MockEventQueue {
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    std::deque<Bench::Clock::time_point> m_Inputs;
+    bool m_Empty = false;
+
+public:
+    void PostInput() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Inputs.push_back(Bench::Clock::now());
+        }
+        m_Signal.notify_one();
+    }
+
+    void PostEmptyEvent() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Empty = true;
+        }
+        m_Signal.notify_one();
+    }
+
+    /// glfwPollEvents() when the timeout is zero, glfwWaitEventsTimeout() otherwise
+    template<typename Handler>
+    void Process(std::chrono::duration<double> timeout, const Handler &handle) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (timeout.count() > 0.0)
+            m_Signal.wait_for(lock, timeout, [this] { return m_Empty || !m_Inputs.empty(); });
+        m_Empty = false;
+        while (!m_Inputs.empty()) {
+            handle(m_Inputs.front());
+            m_Inputs.pop_front();
+        }
+    }
+};
+
+
+struct Result {
+    double cpuPercent;
+    double jobsPerSecond;
+    double inputLatencyUs;
+    double taskLatencyUs;
+};
+
+
+/**
+ * The main loop of Application::Run with the window system replaced by MockEventQueue. Every
+ * hardware thread runs a worker kept busy by a streaming thread, the main thread competes with
+ * them for a core. An input thread posts an event every millisecond and another thread submits
+ * a main-thread task every five, their delivery delays are the latencies.
+ */
+static auto MeasureMainLoop(bool wait, std::chrono::milliseconds duration) -> Result {
+    constexpr unsigned JOB_COST = 20'000;
+    constexpr double WAIT_TIMEOUT_S = 0.1;
+
+    unsigned workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    TaskSystem taskSystem(workerCount);
+    MainThreadQueue mainThreadTasks;
+    MockEventQueue events;
+    std::atomic<bool> wakePending{false};
+    auto wakeMainThread = [&] {
+        if (wait && !wakePending.exchange(true, std::memory_order_acq_rel))
+            events.PostEmptyEvent();
+    };
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> jobsDone{0};
+    std::thread streamer([&] {
+        TaskCounter pending;
+        while (running.load(std::memory_order_relaxed)) {
+            if (pending.Pending() < 4 * workerCount) {
+                taskSystem.Spawn(pending, [&jobsDone] {
+                    Bench::Spin(JOB_COST);
+                    jobsDone.fetch_add(1, std::memory_order_relaxed);
+                });
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        taskSystem.Wait(pending);
+    });
+
+    std::thread input([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            events.PostInput();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    double taskLatencyUs = 0.0;
+    uint64_t taskCount = 0;
+    std::thread submitter([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            auto submitted = Bench::Clock::now();
+            mainThreadTasks.Submit([&taskLatencyUs, &taskCount, submitted] {
+                taskLatencyUs += std::chrono::duration<double, std::micro>(Bench::Clock::now() - submitted).count();
+                taskCount++;
+            });
+            wakeMainThread();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    double inputLatencyUs = 0.0;
+    uint64_t inputCount = 0;
+    auto start = Bench::Clock::now();
+    auto cpuStart = ThreadAffinity::CpuTime();
+    uint64_t jobsStart = jobsDone.load();
+    while (Bench::Clock::now() - start < duration) {
+        events.Process(std::chrono::duration<double>(wait ? WAIT_TIMEOUT_S : 0.0), [&](Bench::Clock::time_point posted) {
+            inputLatencyUs += std::chrono::duration<double, std::micro>(Bench::Clock::now() - posted).count();
+            inputCount++;
+        });
+        wakePending.exchange(false, std::memory_order_acq_rel);
+        mainThreadTasks.Execute();
+    }
+    double elapsedS = std::chrono::duration<double>(Bench::Clock::now() - start).count();
+
+    Result result{};
+    result.cpuPercent = std::chrono::duration<double>(ThreadAffinity::CpuTime() - cpuStart).count() / elapsedS * 100.0;
+    result.jobsPerSecond = (jobsDone.load() - jobsStart) / elapsedS;
+
+    running = false;
+    input.join();
+    submitter.join();
+    streamer.join();
+    mainThreadTasks.Execute();
+
+    result.inputLatencyUs = inputCount ? inputLatencyUs / inputCount : 0.0;
+    result.taskLatencyUs = taskCount ? taskLatencyUs / taskCount : 0.0;
+    return result;
+}
+
+
+int main(int argc, char **argv) {
+    auto duration = std::chrono::milliseconds(argc > 1 ? std::stoul(argv[1]) : 2000);
+
+    std::printf("Main loop benchmark, %u workers, %lld ms per mode\n", std::max(std::thread::hardware_concurrency(), 1u),
+                static_cast<long long>(duration.count()));
+    std::printf("%-6s | %14s | %14s | %18s | %18s\n", "mode", "main CPU [%]", "jobs/s", "input latency [us]",
+                "task latency [us]");
+    for (bool wait : {false, true}) {
+        Result result = MeasureMainLoop(wait, duration);
+        std::printf("%-6s | %14.1f | %14.0f | %18.1f | %18.1f\n", wait ? "wait" : "poll", result.cpuPercent,
+                    result.jobsPerSecond, result.inputLatencyUs, result.taskLatencyUs);
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/MeshCache.h>
+#include "BenchmarkUtils.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+/// Same size as the engine's Vertex, the benchmark doesn't pull in glm
+constexpr uint32_t VERTEX_SIZE = 56;
+
+
+struct LoadedMesh {
+    std::vector<uint8_t> layout;
+    uint32_t vertexSize = 0;
+    uint64_t vertexCount = 0;
+    std::vector<uint8_t> vertexData;
+    std::vector<uint32_t> indices;
+};
+
+
+/// The unversioned <file>.dump format Mesh::FromOBJ used before, kept for comparison
+namespace Legacy {
+    void WriteDump(const std::string &path, const LoadedMesh &mesh) {
+        std::ofstream dumpOutput(path, std::ios::out | std::ios::binary);
+        size_t indexCount = mesh.indices.size();
+        size_t layoutSize = mesh.layout.size();
+        dumpOutput.write((char *) &layoutSize, sizeof(layoutSize));
+        dumpOutput.write((char *) mesh.layout.data(), layoutSize);
+        dumpOutput.write((char *) &mesh.vertexSize, sizeof(mesh.vertexSize));
+        dumpOutput.write((char *) &mesh.vertexCount, sizeof(mesh.vertexCount));
+        dumpOutput.write((char *) mesh.vertexData.data(), mesh.vertexData.size());
+        dumpOutput.write((char *) &indexCount, sizeof(indexCount));
+        dumpOutput.write((char *) mesh.indices.data(), sizeof(uint32_t) * indexCount);
+    }
+
+    auto ReadDump(const std::string &path) -> LoadedMesh {
+        LoadedMesh mesh;
+        std::ifstream dumpFile(path, std::ios::in | std::ios::binary);
+        size_t layoutSize = 0;
+        dumpFile.read((char *) &layoutSize, sizeof(layoutSize));
+        mesh.layout.resize(layoutSize);
+        dumpFile.read((char *) mesh.layout.data(), layoutSize);
+        dumpFile.read((char *) &mesh.vertexSize, sizeof(mesh.vertexSize));
+        dumpFile.read((char *) &mesh.vertexCount, sizeof(mesh.vertexCount));
+        mesh.vertexData.resize(mesh.vertexCount * mesh.vertexSize);
+        dumpFile.read((char *) mesh.vertexData.data(), mesh.vertexData.size());
+        size_t indexCount = 0;
+        dumpFile.read((char *) &indexCount, sizeof(indexCount));
+        mesh.indices.resize(indexCount);
+        dumpFile.read((char *) mesh.indices.data(), sizeof(uint32_t) * indexCount);
+        return mesh;
+    }
+}
+
+
+static auto MakeMesh(uint64_t vertexCount) -> LoadedMesh {
+    LoadedMesh mesh;
+    mesh.layout = {12, 12, 8};
+    mesh.vertexSize = VERTEX_SIZE;
+    mesh.vertexCount = vertexCount;
+    mesh.vertexData.resize(vertexCount * VERTEX_SIZE);
+    std::mt19937 random(7);
+    for (size_t i = 0; i < mesh.vertexData.size(); i += 4) {
+        auto value = static_cast<float>(random()) / static_cast<float>(random.max());
+        std::memcpy(&mesh.vertexData[i], &value, sizeof(value));
+    }
+    // Roughly two triangles per vertex, like a closed triangle mesh
+    mesh.indices.resize(vertexCount * 6);
+    for (size_t i = 0; i < mesh.indices.size(); i++)
+        mesh.indices[i] = static_cast<uint32_t>(random() % vertexCount);
+    return mesh;
+}
+
+
+/// Drops the file from the page cache so the next load has to go to the disk
+static void Evict(const std::string &path) {
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+
+/// Median of loads which each start with the files evicted, eviction itself isn't timed
+static auto ColdMs(const std::function<void()> &body, const std::vector<std::string> &files) -> double {
+    constexpr int REPETITIONS = 5;
+    std::vector<double> samples;
+    for (int i = 0; i < REPETITIONS; i++) {
+        for (const auto &file : files)
+            Evict(file);
+        auto start = Bench::Clock::now();
+        body();
+        samples.push_back(Bench::MillisecondsSince(start));
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+
+/// Stands in for RingStageBuffer::StageMesh, the data ends up in host visible memory either way
+static void Stage(std::vector<uint8_t> &staging, const uint8_t *vertices, size_t vertexBytes,
+                  const uint32_t *indices, size_t indexCount) {
+    std::memcpy(staging.data(), vertices, vertexBytes);
+    std::memcpy(staging.data() + vertexBytes, indices, indexCount * sizeof(uint32_t));
+    Bench::DoNotOptimize(staging[staging.size() - 1]);
+}
+
+
+int main(int argc, char **argv) {
+    uint64_t vertexCount = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+    std::string directory = argc > 2 ? argv[2] : ".";
+
+    std::string sourcePath = directory + "/mesh_cache_benchmark.obj";
+    std::string dumpPath = sourcePath + ".dump";
+    std::string cachePath = MeshCache::PathFor(sourcePath);
+    std::string codecCachePath = directory + "/mesh_cache_benchmark_codec.meshcache";
+
+    LoadedMesh mesh = MakeMesh(vertexCount);
+    {
+        // Stand-in source, only its size and contents matter for the staleness check
+        std::ofstream source(sourcePath, std::ios::out | std::ios::binary);
+        source.write(reinterpret_cast<const char *>(mesh.vertexData.data()),
+                     static_cast<std::streamsize>(mesh.vertexData.size() / 4));
+    }
+
+    Legacy::WriteDump(dumpPath, mesh);
+    MeshCacheData data;
+    data.layout = mesh.layout;
+    data.vertexSize = mesh.vertexSize;
+    data.vertexCount = mesh.vertexCount;
+    data.vertices = mesh.vertexData;
+    data.indices = mesh.indices;
+    if (!MeshCache::Write(cachePath, sourcePath, MESH_IMPORT_DEDUPLICATE, data)) {
+        std::fprintf(stderr, "Failed to write %s\n", cachePath.c_str());
+        return 1;
+    }
+    data.vertexEncoding = SectionEncoding::MESH_CODEC;
+    data.indexEncoding = SectionEncoding::MESH_CODEC;
+    if (!MeshCache::Write(codecCachePath, sourcePath, MESH_IMPORT_DEDUPLICATE, data)) {
+        std::fprintf(stderr, "Failed to write %s\n", codecCachePath.c_str());
+        return 1;
+    }
+
+    size_t vertexBytes = mesh.vertexData.size();
+    size_t indexCount = mesh.indices.size();
+    std::vector<uint8_t> staging(vertexBytes + indexCount * sizeof(uint32_t));
+    std::printf("Mesh cache benchmark, %llu vertices, %llu indices, %.1f MB of mesh data\n",
+                static_cast<unsigned long long>(vertexCount), static_cast<unsigned long long>(indexCount),
+                staging.size() / (1024.0 * 1024.0));
+    mesh = LoadedMesh();
+
+    auto loadDump = [&] {
+        LoadedMesh loaded = Legacy::ReadDump(dumpPath);
+        Bench::DoNotOptimize(loaded.indices.back());
+    };
+    auto stageDump = [&] {
+        LoadedMesh loaded = Legacy::ReadDump(dumpPath);
+        Stage(staging, loaded.vertexData.data(), loaded.vertexData.size(), loaded.indices.data(), loaded.indices.size());
+    };
+    auto openCache = [&](const std::string &path) {
+        return [&] {
+            auto view = MeshCache::Open(path, sourcePath, MESH_IMPORT_DEDUPLICATE);
+            Bench::DoNotOptimize(view->indices.size());
+        };
+    };
+    auto stageCache = [&](const std::string &path) {
+        return [&] {
+            auto view = MeshCache::Open(path, sourcePath, MESH_IMPORT_DEDUPLICATE);
+            Stage(staging, view->vertices.data(), view->vertices.size(), view->indices.data(), view->indices.size());
+        };
+    };
+
+    struct Variant {
+        const char *name;
+        std::function<void()> body;
+        const std::string *file;
+    };
+    const Variant variants[] = {
+            {".dump load", loadDump, &dumpPath},
+            {".dump load + stage", stageDump, &dumpPath},
+            {"raw cache open", openCache(cachePath), &cachePath},
+            {"raw cache open + stage", stageCache(cachePath), &cachePath},
+            {"codec cache open", openCache(codecCachePath), &codecCachePath},
+            {"codec cache open + stage", stageCache(codecCachePath), &codecCachePath},
+    };
+
+    std::printf("%-26s | %10s | %10s | %10s\n", "variant", "size [MB]", "warm [ms]", "cold [ms]");
+    for (const auto &variant : variants) {
+        double size = 0.0;
+        if (auto file = MappedFile::Open(*variant.file))
+            size = file->Size() / (1024.0 * 1024.0);
+        double warm = Bench::MedianMs(variant.body);
+        double cold = ColdMs(variant.body, {*variant.file, sourcePath});
+        std::printf("%-26s | %10.1f | %10.2f | %10.2f\n", variant.name, size, warm, cold);
+    }
+
+    std::remove(sourcePath.c_str());
+    std::remove(dumpPath.c_str());
+    std::remove(cachePath.c_str());
+    std::remove(codecCachePath.c_str());
+    return 0;
+}
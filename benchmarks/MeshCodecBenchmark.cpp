@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/MeshCodec.h>
+#include <Engine/Renderer/MeshOptimizer.h>
+#include <Engine/Renderer/ObjParser.h>
+#include <Engine/Renderer/VertexCompression.h>
+#include "BenchmarkUtils.h"
+
+
+/// Same layout as the engine's Vertex
+struct BenchVertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+    float texCoords[2];
+};
+
+static_assert(sizeof(BenchVertex) == VertexCompression::FULL_VERTEX_SIZE, "Benchmark vertex has to match Vertex");
+
+
+struct BenchMesh {
+    std::vector<uint8_t> vertices;
+    std::vector<uint32_t> indices;
+};
+
+
+/// Wavy UV sphere with an analytic tangent frame, indexed as a grid
+static auto BumpySphere(unsigned segments) -> BenchMesh {
+    std::vector<BenchVertex> vertices;
+    for (unsigned y = 0; y <= segments; y++) {
+        for (unsigned x = 0; x <= segments; x++) {
+            float theta = float(y) / segments * 3.14159265f, phi = float(x) / segments * 6.2831853f;
+            float radius = 1.0f + 0.05f * std::sin(phi * 6.0f) * std::sin(theta * 5.0f);
+            BenchVertex vertex{};
+            float normal[3] = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            float tangent[3] = {-std::sin(phi), 0.0f, std::cos(phi)};
+            for (size_t c = 0; c < 3; c++) {
+                vertex.position[c] = normal[c] * radius;
+                vertex.normal[c] = normal[c];
+                vertex.tangent[c] = tangent[c];
+            }
+            vertex.bitangent[0] = normal[1] * tangent[2] - normal[2] * tangent[1];
+            vertex.bitangent[1] = normal[2] * tangent[0] - normal[0] * tangent[2];
+            vertex.bitangent[2] = normal[0] * tangent[1] - normal[1] * tangent[0];
+            vertex.texCoords[0] = float(x) / segments * 4.0f;
+            vertex.texCoords[1] = float(y) / segments * 2.0f;
+            vertices.push_back(vertex);
+        }
+    }
+    BenchMesh mesh;
+    for (unsigned y = 0; y < segments; y++) {
+        for (unsigned x = 0; x < segments; x++) {
+            uint32_t a = y * (segments + 1) + x, b = a + 1, c = a + segments + 2, d = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, b, a, d, c});
+        }
+    }
+    const auto *bytes = reinterpret_cast<const uint8_t *>(vertices.data());
+    mesh.vertices.assign(bytes, bytes + vertices.size() * sizeof(BenchVertex));
+    return mesh;
+}
+
+
+/// One vertex per OBJ position with the attributes of its first corner, OBJ files carry no tangent frame
+static auto LoadObj(const std::string &path) -> BenchMesh {
+    TaskSystem taskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, path);
+    std::vector<BenchVertex> vertices(obj.positions.size() / 3, BenchVertex{});
+    std::vector<bool> seen(vertices.size(), false);
+    BenchMesh mesh;
+    for (const auto &corner : obj.indices) {
+        auto index = static_cast<uint32_t>(corner.position);
+        mesh.indices.push_back(index);
+        if (seen[index])
+            continue;
+        seen[index] = true;
+        std::memcpy(vertices[index].position, &obj.positions[3 * corner.position], sizeof(float) * 3);
+        if (corner.normal >= 0)
+            std::memcpy(vertices[index].normal, &obj.normals[3 * corner.normal], sizeof(float) * 3);
+        if (corner.texcoord >= 0)
+            std::memcpy(vertices[index].texCoords, &obj.texcoords[2 * corner.texcoord], sizeof(float) * 2);
+    }
+    const auto *bytes = reinterpret_cast<const uint8_t *>(vertices.data());
+    mesh.vertices.assign(bytes, bytes + vertices.size() * sizeof(BenchVertex));
+    return mesh;
+}
+
+
+static void ReportStream(const char *label, size_t rawBytes, size_t encodedBytes, double encodeMs, double decodeMs,
+                         bool lossless) {
+    std::printf("  %-16s %.2f MB -> %.2f MB (%.2fx), encode %.2f ms (%.2f GB/s), decode %.2f ms (%.2f GB/s), "
+                "lossless %s\n", label, rawBytes / 1e6, encodedBytes / 1e6, double(rawBytes) / encodedBytes,
+                encodeMs, rawBytes / (encodeMs * 1e6), decodeMs, rawBytes / (decodeMs * 1e6),
+                lossless ? "yes" : "NO");
+}
+
+
+static void ReportVertices(const char *label, const std::vector<uint8_t> &vertices, size_t vertexSize) {
+    size_t count = vertices.size() / vertexSize;
+    std::vector<uint8_t> encoded, decoded(vertices.size());
+    double encodeMs = Bench::MedianMs([&] {
+        encoded = MeshCodec::EncodeVertices(vertices.data(), count, vertexSize);
+        Bench::DoNotOptimize(encoded.data());
+    }, 5);
+    bool valid = true;
+    double decodeMs = Bench::MedianMs([&] {
+        valid &= MeshCodec::DecodeVertices(encoded, count, vertexSize, decoded.data());
+        Bench::DoNotOptimize(decoded.data());
+    }, 9);
+    ReportStream(label, vertices.size(), encoded.size(), encodeMs, decodeMs, valid && decoded == vertices);
+}
+
+
+static void Report(const char *name, BenchMesh mesh) {
+    size_t vertexCount = mesh.vertices.size() / sizeof(BenchVertex);
+    // Same order the importer writes into the caches
+    mesh.indices = MeshOptimizer::OptimizeVertexCache(mesh.indices, vertexCount);
+    vertexCount = MeshOptimizer::OptimizeVertexFetch(mesh.indices, mesh.vertices, sizeof(BenchVertex));
+    std::printf("%s, %zu triangles, %zu vertices\n", name, mesh.indices.size() / 3, vertexCount);
+
+    ReportVertices("full vertices", mesh.vertices, sizeof(BenchVertex));
+
+    auto quantization = VertexCompression::Quantization(mesh.vertices.data(), vertexCount);
+    std::vector<uint8_t> compact(vertexCount * sizeof(CompactVertex));
+    VertexCompression::Encode(mesh.vertices.data(), vertexCount, quantization,
+                              reinterpret_cast<CompactVertex *>(compact.data()));
+    ReportVertices("compact vertices", compact, sizeof(CompactVertex));
+
+    std::vector<uint8_t> encoded;
+    std::vector<uint32_t> decoded(mesh.indices.size());
+    double encodeMs = Bench::MedianMs([&] {
+        encoded = MeshCodec::EncodeIndices(mesh.indices);
+        Bench::DoNotOptimize(encoded.data());
+    }, 5);
+    bool valid = true;
+    double decodeMs = Bench::MedianMs([&] {
+        valid &= MeshCodec::DecodeIndices(encoded, mesh.indices.size(), decoded.data());
+        Bench::DoNotOptimize(decoded.data());
+    }, 9);
+    size_t indexBytes = mesh.indices.size() * sizeof(uint32_t);
+    ReportStream("indices", indexBytes, encoded.size(), encodeMs, decodeMs, valid && decoded == mesh.indices);
+    std::printf("  index upload     %zu bit indices, %.2f MB\n", MeshCodec::IndexSize(vertexCount) * size_t(8),
+                mesh.indices.size() * MeshCodec::IndexSize(vertexCount) / 1e6);
+}
+
+
+int main(int argc, char **argv) {
+    unsigned segments = argc > 1 ? std::stoul(argv[1]) : 1024;
+    Report("bumpy sphere", BumpySphere(segments));
+    Report("bumpy sphere, 16 bit indices", BumpySphere(std::min(segments, 200u)));
+    for (int i = 2; i < argc; i++)
+        Report(argv[i], LoadObj(argv[i]));
+    return 0;
+}
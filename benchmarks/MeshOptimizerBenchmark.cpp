@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/MeshOptimizer.h>
+#include <Engine/Renderer/ObjParser.h>
+#include "BenchmarkUtils.h"
+
+
+/// Triangulated size x size vertex grid, rows in order like a scanline export
+static auto GridIndices(unsigned size) -> std::vector<uint32_t> {
+    std::vector<uint32_t> indices;
+    indices.reserve(size_t(size - 1) * (size - 1) * 6);
+    for (unsigned y = 0; y + 1 < size; y++) {
+        for (unsigned x = 0; x + 1 < size; x++) {
+            uint32_t a = y * size + x, b = a + 1, c = a + size + 1, d = a + size;
+            indices.insert(indices.end(), {a, b, c, a, c, d});
+        }
+    }
+    return indices;
+}
+
+
+/// Same triangles in random order, the worst case of a careless exporter or a merged scene
+static auto Shuffled(std::vector<uint32_t> indices) -> std::vector<uint32_t> {
+    std::vector<uint32_t> order(indices.size() / 3);
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+    std::vector<uint32_t> shuffled(indices.size());
+    for (size_t i = 0; i < order.size(); i++)
+        std::copy_n(&indices[order[i] * 3], 3, &shuffled[i * 3]);
+    return shuffled;
+}
+
+
+struct PositionMesh {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+};
+
+
+/// Overlapping closed spheres in random triangle order, a stand-in for a model with shells and interior parts
+static auto SphereCluster(unsigned sphereCount, unsigned segments) -> PositionMesh {
+    PositionMesh mesh;
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    for (unsigned s = 0; s < sphereCount; s++) {
+        float cx = offset(random), cy = offset(random), cz = offset(random);
+        float radius = 0.5f + 0.5f * std::abs(offset(random));
+        auto base = static_cast<uint32_t>(mesh.positions.size() / 3);
+        for (unsigned y = 0; y <= segments; y++) {
+            for (unsigned x = 0; x <= segments; x++) {
+                float theta = float(y) / segments * 3.14159265f, phi = float(x) / segments * 6.2831853f;
+                mesh.positions.insert(mesh.positions.end(), {cx + radius * std::sin(theta) * std::cos(phi),
+                                                             cy + radius * std::cos(theta),
+                                                             cz + radius * std::sin(theta) * std::sin(phi)});
+            }
+        }
+        for (unsigned y = 0; y < segments; y++) {
+            for (unsigned x = 0; x < segments; x++) {
+                uint32_t a = base + y * (segments + 1) + x, b = a + 1, c = a + segments + 2, d = a + segments + 1;
+                mesh.indices.insert(mesh.indices.end(), {a, b, c, a, c, d});
+            }
+        }
+    }
+    mesh.indices = Shuffled(mesh.indices);
+    return mesh;
+}
+
+
+static auto LoadObj(const std::string &path) -> PositionMesh {
+    TaskSystem taskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, path);
+    PositionMesh mesh;
+    mesh.positions = std::move(obj.positions);
+    for (const auto &corner : obj.indices)
+        mesh.indices.push_back(static_cast<uint32_t>(corner.position));
+    return mesh;
+}
+
+
+static void ReportOverdraw(const char *name, const PositionMesh &mesh, float threshold) {
+    size_t vertexCount = mesh.positions.size() / 3;
+    const auto *positions = reinterpret_cast<const uint8_t *>(mesh.positions.data());
+    constexpr size_t STRIDE = sizeof(float) * 3;
+    auto cacheOptimized = MeshOptimizer::OptimizeVertexCache(mesh.indices, vertexCount);
+    std::vector<uint32_t> overdrawOptimized;
+    double ms = Bench::MedianMs([&] {
+        overdrawOptimized = MeshOptimizer::OptimizeOverdraw(cacheOptimized, positions, vertexCount, STRIDE, threshold);
+    }, 3);
+
+    auto report = [&](const char *order, const std::vector<uint32_t> &indices) {
+        auto cache = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+        auto overdraw = MeshOptimizer::AnalyzeOverdraw(indices, positions, vertexCount, STRIDE);
+        std::printf("  %-26s | %7.3f | %9.3f\n", order, cache.acmr, overdraw.overdraw);
+    };
+    std::printf("%s, %zu triangles, threshold %.2f\n", name, mesh.indices.size() / 3, threshold);
+    std::printf("  %-26s | %7s | %9s\n", "order", "ACMR", "overdraw");
+    report("input", mesh.indices);
+    report("Tipsify", cacheOptimized);
+    report("Tipsify + overdraw", overdrawOptimized);
+    std::printf("  overdraw ordering time %.1f ms\n", ms);
+}
+
+
+static void Report(const char *name, const std::vector<uint32_t> &indices, size_t vertexCount) {
+    auto fifo16 = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount, 16, VertexCacheModel::FIFO);
+    auto fifo32 = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount, 32, VertexCacheModel::FIFO);
+    auto lru16 = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount, 16, VertexCacheModel::LRU);
+    std::printf("%-28s | %7.3f %7.3f | %7.3f %7.3f | %7.3f %7.3f\n", name,
+                fifo16.acmr, fifo16.atvr, fifo32.acmr, fifo32.atvr, lru16.acmr, lru16.atvr);
+}
+
+
+int main(int argc, char **argv) {
+    unsigned gridSize = argc > 1 ? std::stoul(argv[1]) : 1000;
+    std::string objPath = argc > 2 ? argv[2] : "";
+    size_t vertexCount = size_t(gridSize) * gridSize;
+    auto scanline = GridIndices(gridSize);
+    auto shuffled = Shuffled(scanline);
+
+    std::printf("Vertex cache optimization, %zu triangles, %zu vertices\n", scanline.size() / 3, vertexCount);
+    std::printf("%-28s | %15s | %15s | %15s\n", "", "FIFO 16", "FIFO 32", "LRU 16");
+    std::printf("%-28s | %7s %7s | %7s %7s | %7s %7s\n", "order", "ACMR", "ATVR", "ACMR", "ATVR", "ACMR", "ATVR");
+
+    for (const auto &input : {std::make_pair("scanline", &scanline), std::make_pair("shuffled", &shuffled)}) {
+        std::vector<uint32_t> optimized;
+        double ms = Bench::MedianMs([&] {
+            optimized = MeshOptimizer::OptimizeVertexCache(*input.second, vertexCount);
+        }, 3);
+
+        Report(input.first, *input.second, vertexCount);
+        std::string name = std::string(input.first) + " + Tipsify";
+        Report(name.c_str(), optimized, vertexCount);
+        std::printf("%-28s   %.1f ms\n", "  optimization time", ms);
+    }
+
+    std::printf("\nOverdraw ordering, FIFO 16, %u^2 estimate from the 6 axis directions\n",
+                MeshOptimizer::OVERDRAW_RESOLUTION);
+    auto spheres = SphereCluster(24, 96);
+    for (float threshold : {1.0f, MeshOptimizer::DEFAULT_OVERDRAW_THRESHOLD, 1.25f})
+        ReportOverdraw("sphere cluster", spheres, threshold);
+    if (!objPath.empty())
+        ReportOverdraw(objPath.c_str(), LoadObj(objPath), MeshOptimizer::DEFAULT_OVERDRAW_THRESHOLD);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/MeshOptimizer.h>
+#include <Engine/Renderer/MeshSimplifier.h>
+#include <Engine/Renderer/ObjParser.h>
+#include "BenchmarkUtils.h"
+
+
+/// Same size as the engine's Vertex
+struct BenchVertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+    float texCoords[2];
+};
+
+
+struct BenchMesh {
+    std::vector<BenchVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+
+/// UV sphere with a wavy surface so the simplifier has curvature to preserve, the texture seam stays locked
+static auto BumpySphere(unsigned segments) -> BenchMesh {
+    BenchMesh mesh;
+    for (unsigned y = 0; y <= segments; y++) {
+        for (unsigned x = 0; x <= segments; x++) {
+            float theta = float(y) / segments * 3.14159265f, phi = float(x) / segments * 6.2831853f;
+            float nx = std::sin(theta) * std::cos(phi), ny = std::cos(theta), nz = std::sin(theta) * std::sin(phi);
+            float radius = 1.0f + 0.05f * std::sin(phi * 6.0f) * std::sin(theta * 5.0f);
+            BenchVertex vertex{};
+            vertex.position[0] = nx * radius, vertex.position[1] = ny * radius, vertex.position[2] = nz * radius;
+            vertex.normal[0] = nx, vertex.normal[1] = ny, vertex.normal[2] = nz;
+            vertex.texCoords[0] = float(x) / segments, vertex.texCoords[1] = float(y) / segments;
+            mesh.vertices.push_back(vertex);
+        }
+    }
+    for (unsigned y = 0; y < segments; y++) {
+        for (unsigned x = 0; x < segments; x++) {
+            uint32_t a = y * (segments + 1) + x, b = a + 1, c = a + segments + 2, d = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, b, a, d, c});
+        }
+    }
+    return mesh;
+}
+
+
+/// Positions only, every OBJ corner becomes its own vertex welded by position index
+static auto LoadObj(const std::string &path) -> BenchMesh {
+    TaskSystem taskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, path);
+    BenchMesh mesh;
+    mesh.vertices.resize(obj.positions.size() / 3);
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        mesh.vertices[i] = BenchVertex{};
+        for (size_t c = 0; c < 3; c++)
+            mesh.vertices[i].position[c] = obj.positions[i * 3 + c];
+    }
+    for (const auto &corner : obj.indices)
+        mesh.indices.push_back(static_cast<uint32_t>(corner.position));
+    return mesh;
+}
+
+
+/// The chain Mesh::GenerateLods builds with its default settings
+static void ReportLodChain(const char *name, const BenchMesh &mesh) {
+    constexpr uint32_t LEVELS = 4;
+    constexpr float REDUCTION = 0.5f, MAX_ERROR = 0.05f;
+    const SimplifyAttribute attributes[] = {
+            {offsetof(BenchVertex, normal), 3, 0.5f},
+            {offsetof(BenchVertex, texCoords), 2, 0.5f},
+    };
+    const auto *vertices = reinterpret_cast<const uint8_t *>(mesh.vertices.data());
+    float extent = MeshSimplifier::Extent(mesh.indices, vertices, sizeof(BenchVertex));
+
+    std::printf("%s, %zu triangles, %zu vertices, extent %.3f\n", name, mesh.indices.size() / 3,
+                mesh.vertices.size(), extent);
+    std::printf("  %-5s | %10s | %8s | %12s | %9s\n", "LOD", "triangles", "ratio", "error", "time [ms]");
+    std::printf("  %-5u | %10zu | %8.3f | %12.6f | %9s\n", 0u, mesh.indices.size() / 3, 1.0, 0.0, "-");
+
+    std::vector<uint32_t> previous = mesh.indices;
+    float error = 0.0f;
+    for (uint32_t level = 1; level <= LEVELS; level++) {
+        size_t target = static_cast<size_t>(previous.size() / 3 * REDUCTION) * 3;
+        SimplifyResult result;
+        double ms = Bench::MedianMs([&] {
+            result = MeshSimplifier::Simplify(previous, vertices, mesh.vertices.size(), sizeof(BenchVertex),
+                                              {attributes, std::size(attributes)}, target, MAX_ERROR - error);
+        }, 3);
+        if (result.indices.empty() || result.indices.size() * 10 > previous.size() * 9) {
+            std::printf("  chain stops, LOD %u kept %zu of %zu triangles\n", level, result.indices.size() / 3,
+                        previous.size() / 3);
+            break;
+        }
+        error += result.error;
+        std::printf("  %-5u | %10zu | %8.3f | %12.6f | %9.1f\n", level, result.indices.size() / 3,
+                    double(result.indices.size()) / mesh.indices.size(), error * extent, ms);
+        previous = MeshOptimizer::OptimizeVertexCache(result.indices, mesh.vertices.size());
+    }
+}
+
+
+int main(int argc, char **argv) {
+    unsigned segments = argc > 1 ? std::stoul(argv[1]) : 256;
+    std::string objPath = argc > 2 ? argv[2] : "";
+
+    ReportLodChain("bumpy sphere", BumpySphere(segments));
+    if (!objPath.empty())
+        ReportLodChain(objPath.c_str(), LoadObj(objPath));
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/MeshletBuilder.h>
+#include <Engine/Renderer/MeshOptimizer.h>
+#include <Engine/Renderer/ObjParser.h>
+#include "BenchmarkUtils.h"
+
+
+struct PositionMesh {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+};
+
+
+/// Wavy UV sphere, curved enough that meshlet cones differ from each other
+static auto BumpySphere(unsigned segments) -> PositionMesh {
+    PositionMesh mesh;
+    for (unsigned y = 0; y <= segments; y++) {
+        for (unsigned x = 0; x <= segments; x++) {
+            float theta = float(y) / segments * 3.14159265f, phi = float(x) / segments * 6.2831853f;
+            float radius = 1.0f + 0.05f * std::sin(phi * 6.0f) * std::sin(theta * 5.0f);
+            mesh.positions.insert(mesh.positions.end(), {radius * std::sin(theta) * std::cos(phi),
+                                                         radius * std::cos(theta),
+                                                         radius * std::sin(theta) * std::sin(phi)});
+        }
+    }
+    for (unsigned y = 0; y < segments; y++) {
+        for (unsigned x = 0; x < segments; x++) {
+            uint32_t a = y * (segments + 1) + x, b = a + 1, c = a + segments + 2, d = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, b, a, d, c});
+        }
+    }
+    return mesh;
+}
+
+
+static auto LoadObj(const std::string &path) -> PositionMesh {
+    TaskSystem taskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, path);
+    PositionMesh mesh;
+    mesh.positions = std::move(obj.positions);
+    for (const auto &corner : obj.indices)
+        mesh.indices.push_back(static_cast<uint32_t>(corner.position));
+    return mesh;
+}
+
+
+static void Report(const char *name, const PositionMesh &mesh) {
+    size_t vertexCount = mesh.positions.size() / 3;
+    const auto *positions = reinterpret_cast<const uint8_t *>(mesh.positions.data());
+    constexpr size_t STRIDE = sizeof(float) * 3;
+    // Same input as at import, meshlets are built after the vertex cache optimization
+    auto indices = MeshOptimizer::OptimizeVertexCache(mesh.indices, vertexCount);
+
+    MeshletBuffers meshlets;
+    double ms = Bench::MedianMs([&] {
+        meshlets = MeshletBuilder::Build(indices, positions, vertexCount, STRIDE);
+    }, 3);
+    auto again = MeshletBuilder::Build(indices, positions, vertexCount, STRIDE);
+    bool deterministic = again.vertices == meshlets.vertices && again.triangles == meshlets.triangles &&
+                         again.meshlets.size() == meshlets.meshlets.size() &&
+                         std::memcmp(again.meshlets.data(), meshlets.meshlets.data(),
+                                     meshlets.meshlets.size() * sizeof(Meshlet)) == 0;
+
+    // Cameras on the six axes, twice as far as the mesh extends
+    float extent = 0.0f;
+    for (float value : mesh.positions)
+        extent = std::max(extent, std::abs(value));
+    size_t culledTriangles = 0, totalTriangles = 0;
+    for (int axis = 0; axis < 6; axis++) {
+        float camera[3] = {0.0f, 0.0f, 0.0f};
+        camera[axis % 3] = (axis < 3 ? 2.0f : -2.0f) * extent;
+        for (const auto &meshlet : meshlets.meshlets) {
+            totalTriangles += meshlet.triangleCount;
+            if (MeshletBuilder::IsBackfacing(meshlet, camera))
+                culledTriangles += meshlet.triangleCount;
+        }
+    }
+
+    auto stats = MeshletBuilder::Analyze(meshlets.View(), vertexCount);
+    std::printf("%s, %zu triangles, %zu vertices\n", name, indices.size() / 3, vertexCount);
+    std::printf("  build time          %.1f ms (%.2f Mtriangles/s), deterministic: %s\n", ms,
+                indices.size() / 3 / (ms * 1000.0), deterministic ? "yes" : "NO");
+    std::printf("  meshlets            %zu, %.1f triangles / %.1f vertices on average\n", stats.meshletCount,
+                stats.triangleFill * Meshlet::MAX_TRIANGLES, stats.vertexFill * Meshlet::MAX_VERTICES);
+    std::printf("  vertex duplication  %.3f\n", stats.vertexDuplication);
+    std::printf("  cullable cones      %.1f%%\n", stats.cullableCones * 100.0);
+    std::printf("  backface culled     %.1f%% of the triangles, averaged over 6 axis views\n",
+                totalTriangles ? 100.0 * culledTriangles / totalTriangles : 0.0);
+}
+
+
+int main(int argc, char **argv) {
+    unsigned segments = argc > 1 ? std::stoul(argv[1]) : 512;
+    std::printf("Meshlet builder, at most %u vertices and %u triangles per meshlet\n", Meshlet::MAX_VERTICES,
+                Meshlet::MAX_TRIANGLES);
+    Report("bumpy sphere", BumpySphere(segments));
+    for (int i = 2; i < argc; i++)
+        Report(argv[i], LoadObj(argv[i]));
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/ObjParser.h>
+#include "BenchmarkUtils.h"
+
+#if __has_include(<tiny_obj_loader.h>)
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+#define HAS_TINYOBJ 1
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define HAS_FORK 1
+#endif
+
+
+/// Grid of quads with positions, texture coordinates and normals, roughly 170 bytes per vertex
+static void WriteGridObj(const std::string &path, unsigned size) {
+    FILE *file = std::fopen(path.c_str(), "w");
+    for (unsigned y = 0; y < size; y++) {
+        for (unsigned x = 0; x < size; x++)
+            std::fprintf(file, "v %.6f %.6f %.6f\n", x * 0.01f, std::sin(x * 0.1f) * std::cos(y * 0.1f), y * 0.01f);
+    }
+    for (unsigned y = 0; y < size; y++) {
+        for (unsigned x = 0; x < size; x++)
+            std::fprintf(file, "vt %.6f %.6f\n", float(x) / size, float(y) / size);
+    }
+    for (unsigned y = 0; y < size; y++) {
+        for (unsigned x = 0; x < size; x++)
+            std::fprintf(file, "vn %.6f %.6f %.6f\n", 0.0f, 1.0f, 0.0f);
+    }
+    for (unsigned y = 0; y + 1 < size; y++) {
+        for (unsigned x = 0; x + 1 < size; x++) {
+            unsigned a = y * size + x + 1, b = a + 1, c = a + size + 1, d = a + size;
+            std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c, d, d, d);
+        }
+    }
+    std::fclose(file);
+}
+
+
+struct Result {
+    double ms = 0.0;
+    size_t corners = 0;
+    long peakRssKb = 0;
+};
+
+
+/**
+ * Peak RSS only ever grows, so every variant runs in its own child process. The mapped file's
+ * pages count towards RSS while they are resident, same as tinyobj's read buffers do.
+ */
+static auto RunIsolated(const std::function<size_t()> &parse) -> Result {
+    Result result;
+#if defined(HAS_FORK)
+    int fds[2];
+    if (pipe(fds) != 0)
+        return result;
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        Result measured;
+        auto start = Bench::Clock::now();
+        measured.corners = parse();
+        measured.ms = Bench::MillisecondsSince(start);
+        ssize_t written = write(fds[1], &measured, sizeof(measured));
+        _exit(written == sizeof(measured) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t received = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    rusage usage{};
+    wait4(child, &status, 0, &usage);
+    if (received != sizeof(result))
+        return Result();
+    // Kilobytes on Linux, bytes on macOS
+#if defined(__APPLE__)
+    result.peakRssKb = usage.ru_maxrss / 1024;
+#else
+    result.peakRssKb = usage.ru_maxrss;
+#endif
+#else
+    auto start = Bench::Clock::now();
+    result.corners = parse();
+    result.ms = Bench::MillisecondsSince(start);
+#endif
+    return result;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned gridSize = argc > 1 ? std::stoul(argv[1]) : 1400;
+    std::string path = argc > 2 ? argv[2] : "obj_parser_benchmark.obj";
+    bool generated = argc <= 2;
+    if (generated)
+        WriteGridObj(path, gridSize);
+
+    FILE *file = std::fopen(path.c_str(), "rb");
+    std::fseek(file, 0, SEEK_END);
+    double sizeMb = std::ftell(file) / (1024.0 * 1024.0);
+    std::fclose(file);
+
+    std::printf("OBJ parser benchmark, %.1f MB, %u workers\n", sizeMb, TaskSystem().ThreadCount());
+
+    struct Variant {
+        const char *name;
+        std::function<size_t()> parse;
+    };
+    std::vector<Variant> variants;
+#if defined(HAS_TINYOBJ)
+    variants.push_back({"tinyobj::LoadObj", [&path] {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+        tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str());
+        size_t corners = 0;
+        for (const auto &shape : shapes)
+            corners += shape.mesh.indices.size();
+        return corners;
+    }});
+#endif
+    variants.push_back({"ObjParser::Parse", [&path] {
+        // Created in the child, a forked process doesn't inherit the parent's worker threads
+        TaskSystem taskSystem;
+        return ObjParser::Parse(taskSystem, path).indices.size();
+    }});
+
+    std::printf("%-20s | %10s | %12s | %14s | %9s\n", "parser", "time [ms]", "MB/s", "peak RSS [MB]", "corners");
+    for (const auto &variant : variants) {
+        // Warm the page cache first, the comparison is about parsing
+        RunIsolated(variant.parse);
+        Result result = RunIsolated(variant.parse);
+        std::printf("%-20s | %10.1f | %12.1f | %14.1f | %9zu\n", variant.name, result.ms,
+                    sizeMb / (result.ms / 1000.0), result.peakRssKb / 1024.0, result.corners);
+    }
+
+    if (generated)
+        std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/Parallel.h>
+#include "BenchmarkUtils.h"
+
+
+using Mat4 = std::array<float, 16>;
+
+static auto Multiply(const Mat4 &a, const Mat4 &b) -> Mat4 {
+    Mat4 result{};
+    for (int column = 0; column < 4; column++)
+        for (int row = 0; row < 4; row++)
+            for (int k = 0; k < 4; k++)
+                result[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+    return result;
+}
+
+/// Cofactor inverse, same amount of work glm::inverse does for a mat4
+static auto Inverse(const Mat4 &m) -> Mat4 {
+    Mat4 inv;
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+    for (float &value : inv)
+        value *= invDet;
+    return inv;
+}
+
+
+/// Mirrors Entity::UpdateTransformsUB: view-model, mvp and inverse-transpose per instance
+struct TransformOutput {
+    Mat4 viewModel;
+    Mat4 mvp;
+    Mat4 viewNormal;
+};
+
+static void UpdateTransform(const Mat4 &view, const Mat4 &projection, const Mat4 &model, TransformOutput &out) {
+    out.viewModel = Multiply(view, model);
+    out.mvp = Multiply(projection, out.viewModel);
+    out.viewNormal = Inverse(out.viewModel);
+}
+
+
+int main(int argc, char **argv) {
+    constexpr size_t INSTANCE_COUNT = 200'000;
+    constexpr size_t REDUCE_COUNT = 16'000'000;
+    constexpr size_t SORT_COUNT = 4'000'000;
+
+    unsigned maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    Mat4 view{}, projection{};
+    for (int i = 0; i < 16; i++) {
+        view[i] = distribution(rng);
+        projection[i] = distribution(rng);
+    }
+    std::vector<Mat4> models(INSTANCE_COUNT);
+    for (auto &model : models)
+        for (float &value : model)
+            value = distribution(rng);
+    std::vector<TransformOutput> outputs(INSTANCE_COUNT);
+
+    std::vector<float> values(REDUCE_COUNT);
+    for (float &value : values)
+        value = distribution(rng);
+
+    std::vector<uint32_t> keys(SORT_COUNT);
+    for (auto &key : keys)
+        key = rng();
+
+    double serialTransforms = Bench::MedianMs([&] {
+        for (size_t i = 0; i < INSTANCE_COUNT; i++)
+            UpdateTransform(view, projection, models[i], outputs[i]);
+    });
+    double serialReduce = Bench::MedianMs([&] {
+        double sum = 0.0;
+        for (float value : values)
+            sum += value;
+        Bench::DoNotOptimize(sum);
+    });
+    double serialSort = Bench::MedianMs([&] {
+        std::vector<uint32_t> copy = keys;
+        std::sort(copy.begin(), copy.end());
+    });
+
+    std::printf("Parallel primitives benchmark, %u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("serial: transforms %.2f ms, reduce %.2f ms, sort %.2f ms\n\n", serialTransforms, serialReduce,
+                serialSort);
+    std::printf("%-8s | %-24s | %-24s | %-24s\n", "workers",
+                "200k transforms [ms]", "16M sum reduce [ms]", "4M uint32 sort [ms]");
+
+    for (unsigned threads : threadCounts) {
+        TaskSystem taskSystem(threads);
+
+        double transforms = Bench::MedianMs([&] {
+            Parallel::For(taskSystem, 0, INSTANCE_COUNT, [&](size_t i) {
+                UpdateTransform(view, projection, models[i], outputs[i]);
+            }, 64);
+        });
+        double reduce = Bench::MedianMs([&] {
+            double sum = Parallel::Reduce(taskSystem, 0, REDUCE_COUNT, 0.0,
+                                          [&](size_t begin, size_t end, double partial) {
+                                              for (size_t i = begin; i < end; i++)
+                                                  partial += values[i];
+                                              return partial;
+                                          },
+                                          [](double a, double b) { return a + b; }, 1 << 14);
+            Bench::DoNotOptimize(sum);
+        });
+        double sort = Bench::MedianMs([&] {
+            std::vector<uint32_t> copy = keys;
+            Parallel::Sort(taskSystem, copy.begin(), copy.end());
+        });
+
+        std::printf("%-8u | %10.2f (x%5.2f)     | %10.2f (x%5.2f)     | %10.2f (x%5.2f)\n", threads,
+                    transforms, serialTransforms / transforms,
+                    reduce, serialReduce / reduce,
+                    sort, serialSort / sort);
+    }
+    return 0;
+}
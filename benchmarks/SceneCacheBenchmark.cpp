@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <Engine/Renderer/SceneCache.h>
+#include "BenchmarkUtils.h"
+
+
+/// Same flags as ModelAsset::LoadModel
+constexpr uint32_t POST_PROCESS_FLAGS = aiProcess_Triangulate |
+                                        aiProcess_FlipUVs |
+                                        aiProcess_JoinIdenticalVertices |
+                                        aiProcess_RemoveRedundantMaterials |
+                                        aiProcess_OptimizeMeshes |
+                                        aiProcess_OptimizeGraph |
+                                        aiProcess_CalcTangentSpace;
+
+
+/// Interleaved like the engine's Vertex, the benchmark doesn't pull in the renderer
+struct BenchVertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+    float texCoords[2];
+};
+
+
+struct ImportedMesh {
+    uint32_t materialIdx = 0;
+    std::vector<uint8_t> vertices;
+    std::vector<uint32_t> indices;
+};
+
+
+/// What LoadModel does on a cache miss: Assimp import, AoS conversion, index flattening and the cache write
+static auto ColdLoad(const std::string &sourcePath, const std::string &cachePath) -> size_t {
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(sourcePath, POST_PROCESS_FLAGS);
+    if (!scene || !scene->mRootNode)
+        return 0;
+
+    std::vector<SceneCacheMaterial> materials(scene->mNumMaterials);
+    for (unsigned i = 0; i < scene->mNumMaterials; i++)
+        materials[i].name = scene->mMaterials[i]->GetName().C_Str();
+
+    std::vector<ImportedMesh> imported(scene->mNumMeshes);
+    for (unsigned m = 0; m < scene->mNumMeshes; m++) {
+        const aiMesh *source = scene->mMeshes[m];
+        ImportedMesh &mesh = imported[m];
+        mesh.materialIdx = source->mMaterialIndex;
+        mesh.vertices.resize(source->mNumVertices * sizeof(BenchVertex));
+        auto *vertex = reinterpret_cast<BenchVertex *>(mesh.vertices.data());
+        for (unsigned i = 0; i < source->mNumVertices; i++, vertex++) {
+            std::memcpy(vertex->position, &source->mVertices[i], sizeof(vertex->position));
+            std::memcpy(vertex->normal, &source->mNormals[i], sizeof(vertex->normal));
+            if (source->mTangents) {
+                std::memcpy(vertex->tangent, &source->mTangents[i], sizeof(vertex->tangent));
+                std::memcpy(vertex->bitangent, &source->mBitangents[i], sizeof(vertex->bitangent));
+            }
+            if (source->mTextureCoords[0])
+                std::memcpy(vertex->texCoords, &source->mTextureCoords[0][i], sizeof(vertex->texCoords));
+        }
+        for (unsigned f = 0; f < source->mNumFaces; f++)
+            mesh.indices.insert(mesh.indices.end(), source->mFaces[f].mIndices,
+                                source->mFaces[f].mIndices + source->mFaces[f].mNumIndices);
+    }
+
+    static const std::vector<uint8_t> s_Layout{12, 12, 8};
+    std::vector<SceneCacheMesh> meshes(imported.size());
+    size_t indexCount = 0;
+    for (size_t i = 0; i < imported.size(); i++) {
+        meshes[i].materialIdx = imported[i].materialIdx;
+        meshes[i].data.layout = s_Layout;
+        meshes[i].data.vertexSize = sizeof(BenchVertex);
+        meshes[i].data.vertexCount = imported[i].vertices.size() / sizeof(BenchVertex);
+        meshes[i].data.vertices = imported[i].vertices;
+        meshes[i].data.indices = imported[i].indices;
+        indexCount += imported[i].indices.size();
+    }
+    SceneCache::Write(cachePath, sourcePath, POST_PROCESS_FLAGS, materials, meshes);
+    return indexCount;
+}
+
+
+/// Cache hit, the meshes alias the mapping so touching the indices stands in for staging them
+static auto WarmLoad(const std::string &sourcePath, const std::string &cachePath) -> size_t {
+    auto contents = SceneCache::Open(cachePath, sourcePath, POST_PROCESS_FLAGS);
+    if (!contents)
+        return 0;
+
+    size_t indexCount = 0;
+    uint32_t checksum = 0;
+    for (const auto &mesh : contents->meshes) {
+        indexCount += mesh.data.indices.size();
+        for (uint32_t index : mesh.data.indices)
+            checksum += index;
+    }
+    Bench::DoNotOptimize(checksum);
+    return indexCount;
+}
+
+
+int main(int argc, char **argv) {
+    std::vector<std::string> models;
+    for (int i = 1; i < argc; i++)
+        models.emplace_back(argv[i]);
+    if (models.empty())
+        models = {BASE_DIR "/models/Cerberus_LP.FBX", BASE_DIR "/models/car.obj"};
+
+    std::printf("%-40s | %10s | %12s | %12s | %8s\n", "model", "indices", "cold [ms]", "warm [ms]", "speedup");
+    for (const auto &model : models) {
+        std::string cachePath = "scene_cache_benchmark.scenecache";
+        size_t indexCount = 0;
+        double cold = Bench::MedianMs([&] { indexCount = ColdLoad(model, cachePath); }, 3);
+        double warm = Bench::MedianMs([&] { Bench::DoNotOptimize(WarmLoad(model, cachePath)); });
+        if (indexCount == 0) {
+            std::printf("%-40s | failed to import\n", model.c_str());
+            continue;
+        }
+
+        std::string name = model.substr(model.find_last_of("/\\") + 1);
+        std::printf("%-40s | %10zu | %12.2f | %12.2f | %7.1fx\n", name.c_str(), indexCount, cold, warm, cold / warm);
+        std::remove(cachePath.c_str());
+    }
+    return 0;
+}
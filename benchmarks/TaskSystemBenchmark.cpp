@@ -0,0 +1,171 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <string>
+#include <utility>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/TaskSystem.h>
+#include "BenchmarkUtils.h"
+#include "LegacyTaskSystem.h"
+
+
+/// Every global allocation in this binary is counted, shows what a task submission costs the allocator
+static std::atomic<uint64_t> s_AllocationCount{0};
+
+void *operator new(size_t size) {
+    s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+
+/// Both systems are driven through the same calls, the legacy one returns futures, the new one handles
+static auto Submit(Legacy::TaskSystem &system, std::function<void()> f) { return system.Async(std::move(f)); }
+
+template<typename F>
+static auto Submit(TaskSystem &system, F &&f) { return system.Async(std::forward<F>(f)); }
+
+static void Await(Legacy::TaskSystem &, std::future<void> &future) { future.wait(); }
+
+static void Await(TaskSystem &system, const TaskHandle &handle) { system.Wait(handle); }
+
+
+/// Many tiny tasks submitted from an external thread, measures scheduling overhead
+template<typename System>
+auto Throughput(System &system, unsigned taskCount) -> double {
+    using Handle = decltype(Submit(system, std::declval<void (*)()>()));
+    std::vector<Handle> handles;
+    handles.reserve(taskCount);
+    return Bench::MedianMs([&] {
+        handles.clear();
+        for (unsigned i = 0; i < taskCount; ++i)
+            handles.emplace_back(Submit(system, [] { Bench::Spin(16); }));
+        for (auto &handle : handles)
+            Await(system, handle);
+    });
+}
+
+
+/// Few coarse tasks, measures how well the work is spread over the workers
+template<typename System>
+auto FanOut(System &system, unsigned taskCount, unsigned taskCost) -> double {
+    using Handle = decltype(Submit(system, std::declval<void (*)()>()));
+    std::vector<Handle> handles;
+    handles.reserve(taskCount);
+    return Bench::MedianMs([&] {
+        handles.clear();
+        for (unsigned i = 0; i < taskCount; ++i)
+            handles.emplace_back(Submit(system, [taskCost] { Bench::Spin(taskCost); }));
+        for (auto &handle : handles)
+            Await(system, handle);
+    });
+}
+
+
+/// Round trip of a single task into an idle system, includes waking a parked worker
+template<typename System>
+auto LatencyUs(System &system, unsigned samples) -> double {
+    double total = 0.0;
+    for (unsigned i = 0; i < samples; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        auto start = Bench::Clock::now();
+        auto handle = Submit(system, [] {});
+        Await(system, handle);
+        total += Bench::MillisecondsSince(start) * 1000.0;
+    }
+    return total / samples;
+}
+
+
+struct SubmissionCost {
+    double nanoseconds;
+    double allocations;
+};
+
+/// Cost of the submitting side only: time and global allocations per submitted task
+template<typename System>
+auto SubmissionOverhead(System &system, unsigned taskCount) -> SubmissionCost {
+    using Handle = decltype(Submit(system, std::declval<void (*)()>()));
+    std::vector<Handle> handles;
+    handles.reserve(taskCount);
+
+    // Warm-up, lets pools and queues reach their steady state
+    for (unsigned i = 0; i < taskCount; ++i)
+        handles.emplace_back(Submit(system, [] {}));
+    for (auto &handle : handles)
+        Await(system, handle);
+    handles.clear();
+
+    uint64_t allocationsBefore = s_AllocationCount.load();
+    auto start = Bench::Clock::now();
+    for (unsigned i = 0; i < taskCount; ++i)
+        handles.emplace_back(Submit(system, [] {}));
+    double elapsedMs = Bench::MillisecondsSince(start);
+    uint64_t allocations = s_AllocationCount.load() - allocationsBefore;
+
+    for (auto &handle : handles)
+        Await(system, handle);
+
+    return {elapsedMs * 1e6 / taskCount, static_cast<double>(allocations) / taskCount};
+}
+
+
+int main(int argc, char **argv) {
+    constexpr unsigned SMALL_TASKS = 100'000;
+    constexpr unsigned COARSE_TASKS = 2'000;
+    constexpr unsigned COARSE_COST = 20'000;
+    constexpr unsigned LATENCY_SAMPLES = 200;
+    constexpr unsigned SUBMISSION_TASKS = 2'000;
+
+    unsigned maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    std::printf("TaskSystem benchmark, %u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("%-8s | %-22s | %-22s | %-22s | %-22s | %-22s\n", "threads",
+                "100k tiny tasks [ms]", "2k coarse tasks [ms]", "wake latency [us]",
+                "submit cost [ns/task]", "allocations / task");
+    std::printf("%-8s | %10s %11s | %10s %11s | %10s %11s | %10s %11s | %10s %11s\n", "",
+                "legacy", "stealing", "legacy", "stealing", "legacy", "stealing", "legacy", "stealing",
+                "legacy", "stealing");
+
+    for (unsigned threads : threadCounts) {
+        double legacyThroughput, legacyFanOut, legacyLatency;
+        SubmissionCost legacySubmission{};
+        {
+            Legacy::TaskSystem legacy(threads);
+            legacyThroughput = Throughput(legacy, SMALL_TASKS);
+            legacyFanOut = FanOut(legacy, COARSE_TASKS, COARSE_COST);
+            legacyLatency = LatencyUs(legacy, LATENCY_SAMPLES);
+            legacySubmission = SubmissionOverhead(legacy, SUBMISSION_TASKS);
+        }
+
+        double throughput, fanOut, latency;
+        SubmissionCost submission{};
+        {
+            TaskSystem system(threads);
+            throughput = Throughput(system, SMALL_TASKS);
+            fanOut = FanOut(system, COARSE_TASKS, COARSE_COST);
+            latency = LatencyUs(system, LATENCY_SAMPLES);
+            submission = SubmissionOverhead(system, SUBMISSION_TASKS);
+        }
+
+        std::printf("%-8u | %10.2f %11.2f | %10.2f %11.2f | %10.2f %11.2f | %10.1f %11.1f | %10.2f %11.2f\n",
+                    threads,
+                    legacyThroughput, throughput, legacyFanOut, fanOut, legacyLatency, latency,
+                    legacySubmission.nanoseconds, submission.nanoseconds,
+                    legacySubmission.allocations, submission.allocations);
+    }
+    return 0;
+}
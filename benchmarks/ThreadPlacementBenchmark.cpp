@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/CpuTopology.h>
+#include <Engine/Core/Parallel.h>
+#include "BenchmarkUtils.h"
+
+
+struct FrameTimes {
+    double meanMs;
+    double stddevMs;
+    double p99Ms;
+    double maxMs;
+};
+
+
+/**
+ * Simulated frame: frame-critical parallel work followed by serial submission work on the calling
+ * thread, which plays the render thread. A background thread keeps streaming jobs into the system
+ * the way asset loading does, that's where placement starts to matter.
+ */
+static auto MeasureFrames(const CpuTopology &topology, const ThreadConfig &config, unsigned frameCount) -> FrameTimes {
+    constexpr size_t ITEMS_PER_FRAME = 4096;
+    constexpr unsigned ITEM_COST = 400;
+    constexpr unsigned SUBMIT_COST = 200'000;
+    constexpr unsigned BACKGROUND_COST = 50'000;
+
+    ThreadPlacement placement = ThreadPlacement::Plan(topology, config);
+    TaskSystem taskSystem(placement.workers);
+    ThreadAffinity::Apply(placement.render);
+
+    std::atomic<bool> streaming{true};
+    std::thread streamer([&] {
+        ThreadAffinity::Apply(placement.main);
+        TaskCounter pending;
+        while (streaming.load(std::memory_order_relaxed)) {
+            if (pending.Pending() < taskSystem.ThreadCount())
+                taskSystem.Spawn(TaskPriority::BACKGROUND, pending, [] { Bench::Spin(BACKGROUND_COST); });
+            else
+                std::this_thread::yield();
+        }
+        taskSystem.Wait(pending);
+    });
+
+    std::vector<double> frames;
+    frames.reserve(frameCount);
+    for (unsigned frame = 0; frame < frameCount; frame++) {
+        auto start = Bench::Clock::now();
+        {
+            TaskSystem::PriorityScope scope(TaskPriority::FRAME_CRITICAL);
+            Parallel::For(taskSystem, 0, ITEMS_PER_FRAME, [](size_t) { Bench::Spin(ITEM_COST); }, 64);
+        }
+        Bench::Spin(SUBMIT_COST);
+        frames.push_back(Bench::MillisecondsSince(start));
+    }
+
+    streaming = false;
+    streamer.join();
+    // Later configurations must start from an unrestricted benchmark thread
+    CpuSet all;
+    for (const auto &cpu : topology.Cpus())
+        all.push_back(cpu.id);
+    ThreadAffinity::Apply(all);
+
+    FrameTimes times{};
+    for (double ms : frames)
+        times.meanMs += ms;
+    times.meanMs /= frames.size();
+    for (double ms : frames)
+        times.stddevMs += (ms - times.meanMs) * (ms - times.meanMs);
+    times.stddevMs = std::sqrt(times.stddevMs / frames.size());
+
+    std::sort(frames.begin(), frames.end());
+    times.p99Ms = frames[std::min(frames.size() - 1, frames.size() * 99 / 100)];
+    times.maxMs = frames.back();
+    return times;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned frameCount = argc > 1 ? std::stoul(argv[1]) : 500;
+
+    CpuTopology topology = CpuTopology::Detect();
+    std::printf("Thread placement benchmark, %s, %u frames\n", topology.Describe().c_str(), frameCount);
+
+    struct Variant {
+        const char *name;
+        ThreadConfig config;
+    };
+
+    ThreadConfig oversubscribed;
+    oversubscribed.workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    ThreadConfig sized;
+    ThreadConfig restricted;
+    restricted.affinity = ThreadConfig::Affinity::RESTRICTED;
+    ThreadConfig pinned;
+    pinned.affinity = ThreadConfig::Affinity::PINNED;
+
+    const Variant variants[] = {
+            {"hardware_concurrency workers", oversubscribed},
+            {"one worker per free core", sized},
+            {"restricted to worker cores", restricted},
+            {"pinned", pinned},
+    };
+
+    std::printf("%-30s | %-28s | %9s | %9s | %9s | %9s\n", "variant", "placement", "mean [ms]", "stddev", "p99", "max");
+    for (const auto &variant : variants) {
+        ThreadPlacement placement = ThreadPlacement::Plan(topology, variant.config);
+        FrameTimes times = MeasureFrames(topology, variant.config, frameCount);
+        std::string layout = std::to_string(placement.workers.size()) + " workers" +
+                             (variant.config.affinity == ThreadConfig::Affinity::NONE ? ", unbound" : ", bound");
+        std::printf("%-30s | %-28s | %9.3f | %9.3f | %9.3f | %9.3f\n", variant.name, layout.c_str(),
+                    times.meanMs, times.stddevMs, times.p99Ms, times.maxMs);
+    }
+    return 0;
+}
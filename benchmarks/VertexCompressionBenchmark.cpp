@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Engine/Renderer/ObjParser.h>
+#include <Engine/Renderer/VertexCompression.h>
+#include "BenchmarkUtils.h"
+
+
+/// Same layout as the engine's Vertex
+struct BenchVertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+    float texCoords[2];
+};
+
+static_assert(sizeof(BenchVertex) == VertexCompression::FULL_VERTEX_SIZE, "Benchmark vertex has to match Vertex");
+
+
+/// Wavy UV sphere with an analytic tangent frame, mirrored in the southern half so both bitangent signs occur
+static auto BumpySphere(unsigned segments) -> std::vector<BenchVertex> {
+    std::vector<BenchVertex> vertices;
+    for (unsigned y = 0; y <= segments; y++) {
+        for (unsigned x = 0; x <= segments; x++) {
+            float theta = float(y) / segments * 3.14159265f, phi = float(x) / segments * 6.2831853f;
+            float radius = 1.0f + 0.05f * std::sin(phi * 6.0f) * std::sin(theta * 5.0f);
+            float sign = theta > 1.5707963f ? -1.0f : 1.0f;
+            BenchVertex vertex{};
+            float normal[3] = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            float tangent[3] = {-std::sin(phi), 0.0f, std::cos(phi)};
+            for (size_t c = 0; c < 3; c++) {
+                vertex.position[c] = normal[c] * radius;
+                vertex.normal[c] = normal[c];
+                vertex.tangent[c] = tangent[c];
+            }
+            vertex.bitangent[0] = sign * (normal[1] * tangent[2] - normal[2] * tangent[1]);
+            vertex.bitangent[1] = sign * (normal[2] * tangent[0] - normal[0] * tangent[2]);
+            vertex.bitangent[2] = sign * (normal[0] * tangent[1] - normal[1] * tangent[0]);
+            vertex.texCoords[0] = float(x) / segments * 4.0f;
+            vertex.texCoords[1] = float(y) / segments * 2.0f;
+            vertices.push_back(vertex);
+        }
+    }
+    return vertices;
+}
+
+
+/// Every OBJ corner becomes a vertex, OBJ files carry no tangent frame
+static auto LoadObj(const std::string &path) -> std::vector<BenchVertex> {
+    TaskSystem taskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, path);
+    std::vector<BenchVertex> vertices(obj.indices.size(), BenchVertex{});
+    for (size_t i = 0; i < obj.indices.size(); i++) {
+        const ObjIndex &corner = obj.indices[i];
+        std::memcpy(vertices[i].position, &obj.positions[3 * corner.position], sizeof(float) * 3);
+        if (corner.normal >= 0)
+            std::memcpy(vertices[i].normal, &obj.normals[3 * corner.normal], sizeof(float) * 3);
+        if (corner.texcoord >= 0)
+            std::memcpy(vertices[i].texCoords, &obj.texcoords[2 * corner.texcoord], sizeof(float) * 2);
+    }
+    return vertices;
+}
+
+
+/// Prints the error next to its bound, returns false when the bound is exceeded
+static auto Check(const char *attribute, float error, float bound, const char *unit) -> bool {
+    bool passed = error <= bound;
+    std::printf("  %-16s %.4g%s (bound %.4g%s) %s\n", attribute, error, unit, bound, unit, passed ? "ok" : "EXCEEDED");
+    return passed;
+}
+
+
+/// Returns false when the round trip exceeds the quantization bounds
+static auto Report(const char *name, const std::vector<BenchVertex> &vertices, bool orthonormalFrames) -> bool {
+    const auto *source = reinterpret_cast<const uint8_t *>(vertices.data());
+    size_t count = vertices.size();
+    auto quantization = VertexCompression::Quantization(source, count);
+    std::vector<CompactVertex> compact(count);
+    std::vector<BenchVertex> decoded(count);
+    auto *decodedBytes = reinterpret_cast<uint8_t *>(decoded.data());
+
+    double encodeMs = Bench::MedianMs([&] {
+        VertexCompression::Encode(source, count, quantization, compact.data());
+        Bench::DoNotOptimize(compact.data());
+    }, 5);
+    double decodeMs = Bench::MedianMs([&] {
+        VertexCompression::Decode(compact.data(), count, quantization, decodedBytes);
+        Bench::DoNotOptimize(decoded.data());
+    }, 5);
+    auto error = VertexCompression::MeasureError(source, decodedBytes, count);
+    auto bound = VertexCompression::ErrorBound(source, count, quantization);
+    float maxExtent = std::max({quantization.scale[0], quantization.scale[1], quantization.scale[2]});
+
+    size_t fullBytes = count * sizeof(BenchVertex), compactBytes = count * sizeof(CompactVertex);
+    std::printf("%s, %zu vertices\n", name, count);
+    std::printf("  size             %.1f MB -> %.1f MB (%.2fx smaller)\n", fullBytes / 1e6, compactBytes / 1e6,
+                double(fullBytes) / compactBytes);
+    std::printf("  encode           %.2f ms (%.0f Mvertices/s, %.2f GB/s of full vertices)\n", encodeMs,
+                count / (encodeMs * 1000.0), fullBytes / (encodeMs * 1e6));
+    std::printf("  decode           %.2f ms (%.0f Mvertices/s, %.2f GB/s of full vertices)\n", decodeMs,
+                count / (decodeMs * 1000.0), fullBytes / (decodeMs * 1e6));
+    std::printf("  position step    %.3g (%.3g of the largest extent)\n", maxExtent / 65535.0f, 1.0 / 65535.0);
+
+    bool passed = Check("position error", error.position, bound.position, "");
+    passed &= Check("normal error", error.normal, bound.normal, " deg");
+    passed &= Check("tangent error", error.tangent, bound.tangent, " deg");
+    if (orthonormalFrames)
+        passed &= Check("bitangent error", error.bitangent, bound.bitangent, " deg");
+    else
+        std::printf("  bitangent error  %.4g deg (input frames aren't orthonormal, not bounded)\n", error.bitangent);
+    passed &= Check("uv error", error.texCoord, bound.texCoord, "");
+
+    // Both paths have to produce the same bits, the scalar tail covers the last count % 4 vertices only
+    std::vector<CompactVertex> scalar(count);
+    for (size_t i = 0; i < count; i++)
+        VertexCompression::Encode(source + i * sizeof(BenchVertex), 1, quantization, &scalar[i]);
+    bool identical = count == 0 || std::memcmp(scalar.data(), compact.data(), count * sizeof(CompactVertex)) == 0;
+    std::printf("  scalar encode    %s\n", identical ? "identical" : "DIFFERS");
+    return passed && identical;
+}
+
+
+/// Unit vectors all over the sphere, including the octahedron's face centers where the encoding is coarsest
+static auto RandomFrames(size_t count) -> std::vector<BenchVertex> {
+    std::mt19937 random(7);
+    std::normal_distribution<float> gaussian;
+    std::uniform_real_distribution<float> uniform(-64.0f, 64.0f);
+    std::vector<BenchVertex> vertices(count, BenchVertex{});
+    for (size_t i = 0; i < count; i++) {
+        BenchVertex &vertex = vertices[i];
+        float normal[3], helper[3];
+        for (size_t c = 0; c < 3; c++) {
+            vertex.position[c] = uniform(random);
+            normal[c] = gaussian(random);
+            helper[c] = gaussian(random);
+        }
+        if (i % 8 == 0) {
+            // Face center of a random octant
+            for (size_t c = 0; c < 3; c++)
+                normal[c] = normal[c] < 0.0f ? -1.0f : 1.0f;
+        }
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (float &component : normal)
+            component /= length;
+
+        // Gram-Schmidt against the normal, then the bitangent completes the frame with a random handedness
+        float projection = helper[0] * normal[0] + helper[1] * normal[1] + helper[2] * normal[2];
+        float tangent[3];
+        for (size_t c = 0; c < 3; c++)
+            tangent[c] = helper[c] - projection * normal[c];
+        length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+        for (float &component : tangent)
+            component /= length;
+
+        float sign = i % 2 ? -1.0f : 1.0f;
+        for (size_t c = 0; c < 3; c++) {
+            vertex.normal[c] = normal[c];
+            vertex.tangent[c] = tangent[c];
+        }
+        vertex.bitangent[0] = sign * (normal[1] * tangent[2] - normal[2] * tangent[1]);
+        vertex.bitangent[1] = sign * (normal[2] * tangent[0] - normal[0] * tangent[2]);
+        vertex.bitangent[2] = sign * (normal[0] * tangent[1] - normal[1] * tangent[0]);
+        vertex.texCoords[0] = uniform(random);
+        vertex.texCoords[1] = uniform(random) / 4096.0f;
+    }
+    return vertices;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned segments = argc > 1 ? std::stoul(argv[1]) : 1024;
+    std::printf("Compact vertices, %zu bytes instead of %zu\n", sizeof(CompactVertex), sizeof(BenchVertex));
+    bool passed = Report("bumpy sphere", BumpySphere(segments), true);
+    passed &= Report("random frames", RandomFrames(1 << 20), true);
+    for (int i = 2; i < argc; i++)
+        passed &= Report(argv[i], LoadObj(argv[i]), false);
+
+    if (!passed) {
+        std::printf("Round-trip error exceeds the quantization bounds\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Renderer/ObjParser.h>
+#include <Engine/Renderer/VertexWeld.h>
+#include "BenchmarkUtils.h"
+
+
+/// The hash_combine from Mesh.h, copied so the benchmark doesn't pull in the renderer
+template<class T>
+inline void hash_combine(std::size_t &s, const T &v) {
+    std::hash<T> h;
+    s ^= h(v) + 0x9e3779b9 + (s << 6u) + (s >> 2u);
+}
+
+struct ObjIndexHashCombine {
+    auto operator()(const ObjIndex &index) const -> size_t {
+        size_t res = 0;
+        hash_combine(res, index.normal);
+        hash_combine(res, index.texcoord);
+        hash_combine(res, index.position);
+        return res;
+    }
+};
+
+
+/// Same size as the engine's Vertex
+struct BenchVertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+    float texCoords[2];
+
+    auto operator==(const BenchVertex &other) const -> bool {
+        return std::memcmp(this, &other, sizeof(BenchVertex)) == 0;
+    }
+};
+
+struct BenchVertexHashCombine {
+    auto operator()(const BenchVertex &vertex) const -> size_t {
+        size_t res = 0;
+        const float *values = vertex.position;
+        for (size_t i = 0; i < sizeof(BenchVertex) / sizeof(float); i++)
+            hash_combine(res, values[i]);
+        return res;
+    }
+};
+
+
+/**
+ * Corners of a size x size grid of quads the way an OBJ export references them: positions and
+ * texture coordinates shared by neighbouring faces, one normal per 8x8 patch so some corners of
+ * the same position split into separate vertices. Rows are emitted in a shuffled order so the
+ * first occurrences aren't perfectly sequential.
+ */
+static auto GenerateCorners(unsigned size) -> std::vector<ObjIndex> {
+    std::vector<unsigned> rows(size - 1);
+    for (unsigned y = 0; y + 1 < size; y++)
+        rows[y] = y;
+    std::shuffle(rows.begin(), rows.end(), std::mt19937(42));
+
+    std::vector<ObjIndex> corners;
+    corners.reserve(size_t(size - 1) * (size - 1) * 6);
+    for (unsigned y : rows) {
+        for (unsigned x = 0; x + 1 < size; x++) {
+            auto corner = [&](unsigned cx, unsigned cy) {
+                auto position = static_cast<int32_t>(cy * size + cx);
+                auto normal = static_cast<int32_t>((y / 8) * (size / 8 + 1) + x / 8);
+                return ObjIndex{position, position, normal};
+            };
+            ObjIndex a = corner(x, y), b = corner(x + 1, y), c = corner(x + 1, y + 1), d = corner(x, y + 1);
+            corners.insert(corners.end(), {a, b, c, a, c, d});
+        }
+    }
+    return corners;
+}
+
+
+/// Unindexed triangle soup of the same grid, every corner a full vertex
+static auto ExpandCorners(const std::vector<ObjIndex> &corners, unsigned size) -> std::vector<BenchVertex> {
+    std::vector<BenchVertex> vertices(corners.size());
+    for (size_t i = 0; i < corners.size(); i++) {
+        const ObjIndex &index = corners[i];
+        BenchVertex &vertex = vertices[i];
+        std::memset(&vertex, 0, sizeof(vertex));
+        vertex.position[0] = float(index.position % size);
+        vertex.position[2] = float(index.position / size);
+        vertex.normal[1] = 1.0f;
+        vertex.normal[0] = float(index.normal) * 1e-6f;
+        vertex.texCoords[0] = vertex.position[0] / size;
+        vertex.texCoords[1] = vertex.position[2] / size;
+    }
+    return vertices;
+}
+
+
+int main(int argc, char **argv) {
+    unsigned gridSize = argc > 1 ? std::stoul(argv[1]) : 1200;
+    TaskSystem taskSystem;
+
+    auto corners = GenerateCorners(gridSize);
+    size_t attributeCount = size_t(gridSize) * gridSize;
+    std::printf("Vertex welding benchmark, %zu corners, %u workers\n", corners.size(), taskSystem.ThreadCount());
+    std::printf("%-36s | %10s | %12s | %10s\n", "variant", "time [ms]", "Mcorners/s", "unique");
+
+    auto report = [&](const char *name, double ms, size_t unique) {
+        std::printf("%-36s | %10.1f | %12.1f | %10zu\n", name, ms, corners.size() / (ms * 1000.0), unique);
+    };
+
+    // What Mesh::FromOBJ did before: node-based map, indices pushed one by one
+    size_t unique = 0;
+    double ms = Bench::MedianMs([&] {
+        std::unordered_map<ObjIndex, uint32_t, ObjIndexHashCombine> uniqueIndices;
+        std::vector<ObjIndex> vertexSources;
+        std::vector<uint32_t> indices;
+        indices.reserve(corners.size());
+        for (const auto &index : corners) {
+            auto it = uniqueIndices.find(index);
+            if (it == uniqueIndices.cend()) {
+                it = uniqueIndices.insert(std::make_pair(index, vertexSources.size())).first;
+                vertexSources.push_back(index);
+            }
+            indices.push_back(it->second);
+        }
+        unique = vertexSources.size();
+        Bench::DoNotOptimize(indices.data());
+    }, 3);
+    report("indices: unordered_map", ms, unique);
+
+    ms = Bench::MedianMs([&] {
+        WeldTable<ObjIndex, VertexWeld::PodHash<ObjIndex>, std::equal_to<ObjIndex>> uniqueIndices(attributeCount);
+        std::vector<uint32_t> indices(corners.size());
+        for (size_t i = 0; i < corners.size(); i++)
+            indices[i] = uniqueIndices.Insert(corners[i]);
+        unique = uniqueIndices.Size();
+        Bench::DoNotOptimize(indices.data());
+    }, 3);
+    report("indices: WeldTable", ms, unique);
+
+    ms = Bench::MedianMs([&] {
+        // Worst case for the estimate, the table has to grow all the way up
+        WeldTable<ObjIndex, VertexWeld::PodHash<ObjIndex>, std::equal_to<ObjIndex>> uniqueIndices(0);
+        std::vector<uint32_t> indices(corners.size());
+        for (size_t i = 0; i < corners.size(); i++)
+            indices[i] = uniqueIndices.Insert(corners[i]);
+        unique = uniqueIndices.Size();
+        Bench::DoNotOptimize(indices.data());
+    }, 3);
+    report("indices: WeldTable, not pre-sized", ms, unique);
+
+    auto soup = ExpandCorners(corners, gridSize);
+    ms = Bench::MedianMs([&] {
+        std::unordered_map<BenchVertex, uint32_t, BenchVertexHashCombine> uniqueVertices;
+        std::vector<BenchVertex> welded;
+        std::vector<uint32_t> indices;
+        indices.reserve(soup.size());
+        for (const auto &vertex : soup) {
+            auto it = uniqueVertices.find(vertex);
+            if (it == uniqueVertices.cend()) {
+                it = uniqueVertices.insert(std::make_pair(vertex, welded.size())).first;
+                welded.push_back(vertex);
+            }
+            indices.push_back(it->second);
+        }
+        unique = welded.size();
+        Bench::DoNotOptimize(indices.data());
+    }, 3);
+    report("values: unordered_map + push_back", ms, unique);
+
+    ms = Bench::MedianMs([&] {
+        const auto *bytes = reinterpret_cast<const uint8_t *>(soup.data());
+        auto result = VertexWeld::WeldByValue(bytes, soup.size(), sizeof(BenchVertex));
+        auto welded = VertexWeld::EmitVertices(taskSystem, bytes, sizeof(BenchVertex), result.representatives);
+        unique = result.representatives.size();
+        Bench::DoNotOptimize(welded.data());
+    }, 3);
+    report("values: WeldByValue + EmitVertices", ms, unique);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#version 450
+#extension GL_EXT_scalar_block_layout : enable
+
+// CompactVertex from VertexCompression.h, unpacked by hand since the inputs are reflected as plain uints
+layout(location = 0) in uvec2 inPosition;
+layout(location = 1) in uvec2 inNormalTangent;
+layout(location = 2) in uint inTexCoords;
+
+
+layout(location = 0) out vec3 NormalView;
+layout(location = 1) out vec3 NormalWorld;
+layout(location = 2) out vec3 FragPosView;
+layout(location = 3) out vec3 FragPosWorld;
+layout(location = 4) out vec2 TexCoords;
+layout(location = 5) out flat mat3 TBN;
+
+layout(std430, set=0, binding = 0) uniform TransformUBO {
+    mat4 mvp;
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+    mat4 viewModel;
+    mat4 viewNormalMatrix;
+    mat4 modelNormalMatrix;
+} transformUBO;
+
+layout(push_constant) uniform MeshData {
+    vec4 positionOffset;
+    vec4 positionScale;
+} constants;
+
+vec3 OctahedronDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main() {
+    vec2 positionXY = unpackUnorm2x16(inPosition.x);
+    vec2 positionZW = unpackUnorm2x16(inPosition.y);
+    vec3 position = constants.positionOffset.xyz + vec3(positionXY, positionZW.x) * constants.positionScale.xyz;
+    vec3 normal = OctahedronDecode(unpackSnorm2x16(inNormalTangent.x));
+    vec3 tangent = OctahedronDecode(unpackSnorm2x16(inNormalTangent.y));
+    vec3 bitangent = (positionZW.y * 2.0 - 1.0) * cross(normal, tangent);
+
+    vec3 T = normalize(vec3(transformUBO.modelNormalMatrix * vec4(tangent, 0.0)));
+    vec3 B = normalize(vec3(transformUBO.modelNormalMatrix * vec4(bitangent, 0.0)));
+    vec3 N = normalize(vec3(transformUBO.modelNormalMatrix * vec4(normal, 0.0)));
+    TBN = mat3(T, B, N);
+
+    gl_Position = transformUBO.mvp * vec4(position, 1.0);
+    FragPosView = vec3(transformUBO.viewModel * vec4(position, 1.0));
+    FragPosWorld = vec3(transformUBO.model * vec4(position, 1.0));
+    NormalView = normalize(vec3(transformUBO.viewNormalMatrix * vec4(normal, 0.0f)));
+    NormalWorld = normalize(vec3(transformUBO.modelNormalMatrix * vec4(normal, 0.0f)));
+    TexCoords = unpackHalf2x16(inTexCoords);
+}
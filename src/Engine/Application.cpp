@@ -2,6 +2,7 @@
 #include "Core.h"
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <thread>
 #include <Engine/Renderer/Renderer.h>
 #include <Engine/Renderer/utils.h>
@@ -11,7 +12,10 @@
 Application* Application::s_Application;
 
 
-Application::Application(const char* name) : m_Name(name), m_LayerStack(this) {
+Application::Application(const char* name, const ThreadConfig& threadConfig)
+      : m_Name(name), m_LayerStack(this), m_ThreadConfig(threadConfig),
+        m_ThreadPlacement(ThreadPlacement::Plan(CpuTopology::Detect(), threadConfig)),
+        m_TaskSystem(m_ThreadPlacement.workers) {
    if (s_Application) {
       std::ostringstream ss;
       ss << "[Application] '" << s_Application->m_Name << " [" << s_Application << "]' already exists!";
@@ -19,11 +23,14 @@ Application::Application(const char* name) : m_Name(name), m_LayerStack(this) {
    }
 
    s_Application = this;
+   LOG_INFO("[{}] {}, {}", m_Name, CpuTopology::Detect().Describe(), m_ThreadPlacement.Describe());
+   if (!ThreadAffinity::Apply(m_ThreadPlacement.main))
+      LOG_WARNING("[Application] Failed to set the main thread affinity");
    Init();
 }
 
 Application::~Application() {
-   std::cout << currentTime() << "[" << s_Application->m_Name << "] Exiting" << std::endl;
+   LOG_INFO("[{}] Exiting", s_Application->m_Name);
    Renderer::Destroy();
 
 //    g_object_unref (m_GtkApp);
@@ -31,174 +38,275 @@ Application::~Application() {
 
 void Application::Init() {
    m_Window = std::make_unique<AppWindow>(800, 600, m_Name.data());
-   m_Window->SetEventCallback([this](std::unique_ptr<Event> event) { OnEvent(std::move(event)); });
+   m_WindowEventBatch.reserve(m_WindowEvents.Capacity() + 1);
+   m_Window->SetEventCallback([this](const EventRecord& record) { OnEvent(record); });
 
    Renderer::Init();
 
 //    m_GtkApp = gtk_application_new("org.gtkmm.example", GApplicationFlags::G_APPLICATION_FLAGS_NONE);
 //    gtk_init(nullptr, nullptr);
 
-   std::cout << currentTime() << "[" << s_Application->m_Name << "] Initialized" << std::endl;
+   LOG_INFO("[{}] Initialized", s_Application->m_Name);
+}
+
+void Application::SetFrameMode(FrameMode mode) {
+   if (m_Running)
+      throw std::runtime_error("[Application] Frame mode can't be changed while running");
+   m_FrameMode = mode;
+}
+
+void Application::SetMainLoopMode(MainLoopMode mode) {
+   if (m_Running)
+      throw std::runtime_error("[Application] Main loop mode can't be changed while running");
+   m_MainLoopMode = mode;
 }
 
 void Application::Run() {
    m_Running = true;
+   bool pipelined = m_FrameMode == FrameMode::PIPELINED;
 
-   std::thread renderThread([this]() {
-//        std::chrono::milliseconds frameTiming(16);
-
-      std::vector<VkCommandBuffer> submitBuffers;
+   std::thread renderThread([this, pipelined]() {
+      if (!ThreadAffinity::Apply(m_ThreadPlacement.render))
+         LOG_WARNING("[Application] Failed to set the render thread affinity");
+      if (m_ThreadConfig.elevateRenderThread && !ThreadAffinity::Elevate())
+         LOG_WARNING("[Application] Failed to raise the render thread priority");
 
       try {
-         while (m_Running) {
-            auto currentTime = TIME_NOW;
-            Timestep timestep(currentTime - m_LastFrameTime);
-            m_LastFrameTime = currentTime;
-
-            ProcessEventQueue();
-
-            Renderer::NewFrame();
-            m_LayerStack.UpdateLayers(timestep);
-            m_LayerStack.DrawLayers();
-            Renderer::PresentFrame();
-
-//                submitBuffers.clear();
-
-//                auto imageIndex = m_Renderer->AcquireNextImage();
-
-            // Inheritance info for the secondary command buffers
-//                VkCommandBufferInheritanceInfo inheritanceInfo = {};
-//                inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
-//                inheritanceInfo.renderPass = (VkRenderPass) m_Renderer->GetRenderPass().VkHandle();
-//                inheritanceInfo.framebuffer = m_Renderer->GetFramebuffer().data();
-//
-//                m_LayerStack.UpdateLayers(timestep, imageIndex);
-//                m_LayerStack.DrawLayers(imageIndex, submitBuffers, inheritanceInfo);
-//                m_Renderer->DrawFrame(submitBuffers);
-
-//                auto drawEnd = TIME_NOW;
-//                auto drawTime = std::chrono::duration_cast<std::chrono::microseconds>(drawEnd - currentTime);
-//                double frameTime = drawTime.count() / 1000000.0;
-//                printf("Frametime: %f, FPS: %d\n", frameTime, (uint32_t)(1.0 / frameTime));
-//                if (drawTime < frameTiming)
-//                    std::this_thread::sleep_for(frameTiming - drawTime);
+         if (pipelined) {
+            while (FramePacket* packet = m_FramePackets.AcquireForRender()) {
+               RenderFrame(*packet);
+               m_FramePackets.Release(packet);
+            }
+         } else {
+            while (m_Running) {
+               FramePacket* packet = m_FramePackets.AcquireForBuild();
+               BuildFrame(*packet);
+               m_FramePackets.Publish(packet);
+
+               packet = m_FramePackets.AcquireForRender();
+               RenderFrame(*packet);
+               m_FramePackets.Release(packet);
+            }
          }
 
          Renderer::WaitIdle();
 
       } catch (const std::exception& e) {
-         std::cerr << e.what() << std::endl;
+         LOG_ERROR("[Application] {}", e.what());
+         Stop();
+         m_FramePackets.Close();
       }
    });
+
+   std::thread updateThread;
+   if (pipelined) {
+      updateThread = std::thread([this]() {
+         // Shares the main thread's core, the main thread mostly waits for window events
+         ThreadAffinity::Apply(m_ThreadPlacement.main);
+         try {
+            while (m_Running) {
+               FramePacket* packet = m_FramePackets.AcquireForBuild();
+               if (!packet)
+                  break;
+               BuildFrame(*packet);
+               m_FramePackets.Publish(packet);
+            }
+         } catch (const std::exception& e) {
+            LOG_ERROR("[Application] {}", e.what());
+            Stop();
+         }
+         // Lets the render thread finish the published packets and exit
+         m_FramePackets.Close();
+      });
+   }
+
+   RunMainLoop();
+
+   if (updateThread.joinable())
+      updateThread.join();
+   renderThread.join();
+
+   auto stats = m_FrameStats.Summarize();
+   LOG_INFO("[{}] {} frames: {}, frame time {} ms (max {} ms), update {} ms, render {} ms, latency {} ms (max {} ms)",
+            m_Name, pipelined ? "Pipelined" : "Serial", stats.frameCount, stats.frameMs, stats.maxFrameMs,
+            stats.updateMs, stats.renderMs, stats.latencyMs, stats.maxLatencyMs);
+}
+
+void Application::RunMainLoop() {
+   bool wait = m_MainLoopMode == MainLoopMode::WAIT;
+   auto loopStart = TIME_NOW;
+   auto cpuStart = ThreadAffinity::CpuTime();
+   auto sampleStart = loopStart;
+   auto sampleCpuStart = cpuStart;
+
    while (m_Running) {
-      m_Window->OnUpdate();
+      if (wait)
+         m_Window->WaitEvents(MAIN_LOOP_WAIT_TIMEOUT_S);
+      else
+         m_Window->PollEvents();
+
+      // Acquires the tasks submitted before the wakeup was requested
+      if (m_WakePending.exchange(false, std::memory_order_acq_rel))
+         m_MainLoopWakeups.fetch_add(1, std::memory_order_relaxed);
       ExecuteMainThreadTasks();
+      m_MainLoopIterations.fetch_add(1, std::memory_order_relaxed);
+
+      auto now = TIME_NOW;
+      if (now - sampleStart >= MAIN_LOOP_SAMPLE_INTERVAL) {
+         auto cpu = ThreadAffinity::CpuTime();
+         m_MainThreadCpuUsage.store(std::chrono::duration<float>(cpu - sampleCpuStart) /
+                                    std::chrono::duration<float>(now - sampleStart), std::memory_order_relaxed);
+         sampleStart = now;
+         sampleCpuStart = cpu;
+      }
    }
 
-   renderThread.join();
+   double cpuUsage = std::chrono::duration<double>(ThreadAffinity::CpuTime() - cpuStart) /
+                     std::chrono::duration<double>(TIME_NOW - loopStart);
+   LOG_INFO("[{}] Main loop ({}): {} iterations, {} wakeups, main thread CPU {}% of a core", m_Name,
+            wait ? "wait" : "poll", m_MainLoopIterations.load(), m_MainLoopWakeups.load(), cpuUsage * 100.0);
 }
 
-void Application::OnEvent(std::unique_ptr<Event> e) {
-   std::unique_lock<std::mutex> lock(m_WindowEventMutex);
-   if (m_WindowEventQueue.size() < 50)
-      m_WindowEventQueue.push(std::move(e));
+void Application::WakeMainThread() {
+   if (m_MainLoopMode == MainLoopMode::WAIT && !m_WakePending.exchange(true, std::memory_order_acq_rel))
+      AppWindow::PostEmptyEvent();
 }
 
-void Application::OnWindowClose(WindowCloseEvent&) {
-   std::cout << currentTime() << "[" << s_Application->m_Name << "] Closing window" << std::endl;
+void Application::Stop() {
    m_Running = false;
+   WakeMainThread();
+}
+
+auto Application::GetMainLoopStats() const -> MainLoopStats {
+   MainLoopStats stats;
+   stats.iterations = m_MainLoopIterations.load(std::memory_order_relaxed);
+   stats.wakeups = m_MainLoopWakeups.load(std::memory_order_relaxed);
+   stats.cpuUsage = m_MainThreadCpuUsage.load(std::memory_order_relaxed);
+   return stats;
+}
+
+void Application::BuildFrame(FramePacket& packet) {
+   packet.buildStart = TIME_NOW;
+   Timestep timestep(packet.buildStart - m_LastFrameTime);
+   m_LastFrameTime = packet.buildStart;
+
+   // Jobs spawned by the update stage are frame-critical unless they ask otherwise, background
+   // work isn't started shortly before the frame is expected to be done
+   TaskSystem::PriorityScope framePriority(TaskPriority::FRAME_CRITICAL);
+   double frameMs = m_FrameStats.Summarize().frameMs;
+   auto frameBudget = std::chrono::duration<double, std::milli>(frameMs > 0.0 ? frameMs : DEFAULT_FRAME_BUDGET_MS);
+   m_TaskSystem.SetFrameDeadline(packet.buildStart + std::chrono::duration_cast<std::chrono::nanoseconds>(frameBudget));
+
+   Renderer::BeginFrame(packet);
+   ProcessEventQueue();
+   Renderer::NewFrame();
+   m_LayerStack.UpdateLayers(timestep);
+   m_LayerStack.DrawLayers();
+   Renderer::EndFrame();
+
+   packet.buildEnd = TIME_NOW;
+}
+
+void Application::RenderFrame(FramePacket& packet) {
+   auto renderStart = TIME_NOW;
+   Renderer::RenderFrame(packet);
+   m_FrameStats.Record(packet, renderStart, TIME_NOW);
+}
+
+void Application::OnEvent(const EventRecord& record) {
+   m_WindowEvents.Post(record);
+}
+
+void Application::OnWindowClose(WindowCloseEvent&) {
+   LOG_INFO("[{}] Closing window", s_Application->m_Name);
+   Stop();
 }
 
 void Application::OnWindowResize(WindowResizeEvent& e) {
-   std::cout << currentTime() << "[" << s_Application->m_Name << "] Resizing window ["
-             << e.Width() << ", " << e.Height() << "]" << std::endl;
+   LOG_DEBUG("[{}] Resizing window [{}, {}]", s_Application->m_Name, e.Width(), e.Height());
 
    Renderer::OnWindowResize(e);
 }
 
 void Application::ProcessEventQueue() {
-   std::unique_lock<std::mutex> lock(m_WindowEventMutex);
-   std::unique_ptr<Event> resizeEvent = nullptr;
-   while (!m_WindowEventQueue.empty()) {
-      auto event = std::move(m_WindowEventQueue.front());
-      m_WindowEventQueue.pop();
+   std::optional<EventRecord> resize;
+   m_WindowEvents.Drain(m_WindowEventBatch);
 
-      switch (event->Type()) {
+   for (const EventRecord& record : m_WindowEventBatch) {
+      switch (record.type) {
          case EventType::None:
          case EventType::WindowMove:
-            return;
+            break;
 
          case EventType::WindowResize:
-            resizeEvent = std::move(event);
-            continue;
-         case EventType::WindowClose:
-            OnWindowClose(static_cast<WindowCloseEvent&>(*event));
-            continue;
-
-         case EventType::MouseButtonPress:
-            OnMouseButtonPress(static_cast<MouseButtonPressEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<MouseButtonPressEvent&>(*event),
-                                        &Layer::OnMouseButtonPress);
+            resize = record;
             break;
 
-         case EventType::MouseButtonRelease:
-            OnMouseButtonRelease(static_cast<MouseButtonReleaseEvent&>(*event));
-            m_LayerStack.PropagateEvent(
-                    static_cast<MouseButtonReleaseEvent&>(*event),
-                    &Layer::OnMouseButtonRelease);
+         case EventType::WindowClose: {
+            WindowCloseEvent event;
+            OnWindowClose(event);
             break;
+         }
 
-         case EventType::MouseMove:
-            OnMouseMove(static_cast<MouseMoveEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<MouseMoveEvent&>(*event),
-                                        &Layer::OnMouseMove);
+         case EventType::MouseButtonPress: {
+            MouseButtonPressEvent event(record.button);
+            OnMouseButtonPress(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnMouseButtonPress);
             break;
+         }
 
-         case EventType::MouseScroll:
-            OnMouseScroll(static_cast<MouseScrollEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<MouseScrollEvent&>(*event),
-                                        &Layer::OnMouseScroll);
+         case EventType::MouseButtonRelease: {
+            MouseButtonReleaseEvent event(record.button);
+            OnMouseButtonRelease(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnMouseButtonRelease);
             break;
+         }
 
-         case EventType::KeyPress:
-            OnKeyPress(static_cast<KeyPressEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<KeyPressEvent&>(*event),
-                                        &Layer::OnKeyPress);
+         case EventType::MouseMove: {
+            MouseMoveEvent event(record.mouse.x, record.mouse.y);
+            OnMouseMove(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnMouseMove);
             break;
+         }
 
-         case EventType::KeyRelease:
-            OnKeyRelease(static_cast<KeyReleaseEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<KeyReleaseEvent&>(*event),
-                                        &Layer::OnKeyRelease);
+         case EventType::MouseScroll: {
+            MouseScrollEvent event(record.mouse.x, record.mouse.y);
+            OnMouseScroll(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnMouseScroll);
             break;
+         }
 
-         case EventType::CharacterPress:
-            OnCharacterPress(static_cast<CharacterPressEvent&>(*event));
-            m_LayerStack.PropagateEvent(static_cast<CharacterPressEvent&>(*event),
-                                        &Layer::OnCharacterPress);
+         case EventType::KeyPress: {
+            KeyPressEvent event(record.key.keyCode, record.key.repeatCount);
+            OnKeyPress(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnKeyPress);
+            break;
+         }
+
+         case EventType::KeyRelease: {
+            KeyReleaseEvent event(record.key.keyCode);
+            OnKeyRelease(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnKeyRelease);
+            break;
+         }
+
+         case EventType::CharacterPress: {
+            CharacterPressEvent event(record.key.keyCode);
+            OnCharacterPress(event);
+            m_LayerStack.PropagateEvent(event, &Layer::OnCharacterPress);
+            break;
+         }
       }
    }
 
-   if (resizeEvent) {
-      OnWindowResize(static_cast<WindowResizeEvent&>(*resizeEvent));
-      m_LayerStack.PropagateEvent(static_cast<WindowResizeEvent&>(*resizeEvent), &Layer::OnWindowResize);
+   // Only the last resize matters, recreating the swapchain for every intermediate size is wasted work
+   if (resize) {
+      WindowResizeEvent event(resize->resize.width, resize->resize.height);
+      OnWindowResize(event);
+      m_LayerStack.PropagateEvent(event, &Layer::OnWindowResize);
    }
 }
 
-void Application::ExecuteOnMainThread(const std::function<std::shared_ptr<void>()>& task,
-                                      const std::function<void(std::shared_ptr<void>)>& onCompleteCallback) {
-   std::unique_lock<std::mutex> lock(s_Application->m_MainThreadTaskQueueMutex);
-   s_Application->m_MainThreadTaskQueue.push({task, onCompleteCallback});
-}
-
 void Application::ExecuteMainThreadTasks() {
-   std::unique_lock<std::mutex> lock(m_MainThreadTaskQueueMutex);
-   while (!m_MainThreadTaskQueue.empty()) {
-      auto task = std::move(m_MainThreadTaskQueue.front());
-      m_MainThreadTaskQueue.pop();
-      task.second(task.first());
-//      task.first();
-//      auto result = std::static_pointer_cast<std::string>(task.first());
-//      std::cout << *result << std::endl;
-   }
+   m_MainThreadTasks.Execute();
 }
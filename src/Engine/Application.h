@@ -1,12 +1,15 @@
 #ifndef VULKAN_APPLICATION_H
 #define VULKAN_APPLICATION_H
 
+#include <atomic>
 #include <iostream>
-#include <mutex>
-#include <queue>
-#include <Engine/Core/NotificationQueue.h>
+#include <Engine/Core/CpuTopology.h>
+#include <Engine/Core/MainThreadQueue.h>
+#include <Engine/Core/TaskSystem.h>
+#include <Engine/Renderer/FramePipeline.h>
 
 #include "Events/Event.h"
+#include "Events/EventChannel.h"
 #include "Events/WindowEvents.h"
 #include "Events/MouseEvents.h"
 #include "Events/KeyEvents.h"
@@ -18,31 +21,71 @@ struct _GtkApplication;
 
 
 class Application {
+public:
+    enum class FrameMode {
+        /// Update and rendering run back to back on the render thread
+        SERIAL,
+        /// The update stage builds frame N+1 on its own thread while frame N is recorded and submitted
+        PIPELINED
+    };
+
+    enum class MainLoopMode {
+        /// Polls window events in a loop, lowest input latency but the main thread occupies a whole core
+        POLL,
+        /// Sleeps in the window system until an event arrives or the main thread is woken explicitly
+        WAIT
+    };
+
+    struct MainLoopStats {
+        uint64_t iterations = 0;
+        /// Iterations started by WakeMainThread() instead of a window event or the timeout
+        uint64_t wakeups = 0;
+        /// Share of one core the main thread used during the last sample interval
+        float cpuUsage = 0.0f;
+    };
+
 private:
     static Application *s_Application;
 
+    /// Frame deadline estimate until the first frames were measured
+    constexpr static double DEFAULT_FRAME_BUDGET_MS = 1000.0 / 60.0;
+    /// Upper bound of a main loop wait, wakeups are explicit so this is only a safety net
+    constexpr static double MAIN_LOOP_WAIT_TIMEOUT_S = 0.1;
+    constexpr static std::chrono::milliseconds MAIN_LOOP_SAMPLE_INTERVAL{500};
+
     const std::string m_Name;
 
     std::unique_ptr<AppWindow> m_Window = nullptr;
 
     _GtkApplication* m_GtkApp;
 
-    std::queue<std::unique_ptr<Event>> m_WindowEventQueue;
-    std::queue<std::pair<
-            std::function<std::shared_ptr<void>()>,
-            std::function<void(std::shared_ptr<void>)>>> m_MainThreadTaskQueue;
-
-    std::mutex m_WindowEventMutex;
-    std::mutex m_MainThreadTaskQueueMutex;
+    EventChannel m_WindowEvents;
+    /// Reused by ProcessEventQueue(), events are dispatched from here without holding anything
+    std::vector<EventRecord> m_WindowEventBatch;
+    MainThreadQueue m_MainThreadTasks;
 
     LayerStack m_LayerStack;
-    bool m_Running = false;
+    std::atomic<bool> m_Running{false};
     std::chrono::steady_clock::time_point m_LastFrameTime;
 
+    const ThreadConfig m_ThreadConfig;
+    /// Planned before the task system is created, its workers are bound as they start
+    const ThreadPlacement m_ThreadPlacement;
+
+    FrameMode m_FrameMode = FrameMode::SERIAL;
+    MainLoopMode m_MainLoopMode = MainLoopMode::WAIT;
+    /// Set by the first WakeMainThread() call until the main loop picks it up, later ones don't post again
+    std::atomic<bool> m_WakePending{false};
+    std::atomic<uint64_t> m_MainLoopIterations{0};
+    std::atomic<uint64_t> m_MainLoopWakeups{0};
+    std::atomic<float> m_MainThreadCpuUsage{0.0f};
+    FramePacketRing m_FramePackets;
+    FrameStats m_FrameStats;
+
     void Init();
 
-    //TODO: temporary, event system will be reworked to avoid allocations
-    void OnEvent(std::unique_ptr<Event> e);
+    /// Called from the window callbacks, only posts the record
+    void OnEvent(const EventRecord &record);
 
     void OnWindowClose(WindowCloseEvent &e);
 
@@ -66,8 +109,22 @@ private:
 
     void ExecuteMainThreadTasks();
 
+    void RunMainLoop();
+
+    /// Interrupts the main loop's wait for window events, can be called from any thread
+    void WakeMainThread();
+
+    /// Ends Run() from any thread
+    void Stop();
+
+    /// Update stage: events, layer updates and scene submission into the packet
+    void BuildFrame(FramePacket &packet);
+
+    /// Render stage: records, submits and presents a finished packet
+    void RenderFrame(FramePacket &packet);
+
 protected:
-    explicit Application(const char *name);
+    explicit Application(const char *name, const ThreadConfig &threadConfig = ThreadConfig());
 
     auto PushLayer(std::unique_ptr<Layer> layer) -> Layer * { return m_LayerStack.PushLayer(std::move(layer)); }
 
@@ -77,6 +134,12 @@ protected:
 
     auto PopOverlay(const Layer *overlay) -> std::unique_ptr<Layer> { return m_LayerStack.PopOverlay(overlay); }
 
+    /// Has to be selected before Run()
+    void SetFrameMode(FrameMode mode);
+
+    /// Has to be selected before Run()
+    void SetMainLoopMode(MainLoopMode mode);
+
 public:
     virtual ~Application();
 
@@ -84,6 +147,18 @@ public:
 
     void Run();
 
+    auto GetFrameMode() const -> FrameMode { return m_FrameMode; }
+
+    auto GetMainLoopMode() const -> MainLoopMode { return m_MainLoopMode; }
+
+    auto GetMainLoopStats() const -> MainLoopStats;
+
+    auto GetThreadPlacement() const -> const ThreadPlacement & { return m_ThreadPlacement; }
+
+    auto GetFrameStats() const -> FrameStats::Summary { return m_FrameStats.Summarize(); }
+
+    auto GetWindowEventStats() const -> EventChannel::Stats { return m_WindowEvents.GetStats(); }
+
     static auto Get() -> Application & { return *s_Application; }
 
     static auto GetWindow() -> AppWindow & { return *s_Application->m_Window; }
@@ -92,8 +167,21 @@ public:
 
     static auto CreateApplication() -> std::unique_ptr<Application>;
 
-    static void ExecuteOnMainThread(const std::function<std::shared_ptr<void>()>& task,
-            const std::function<void(std::shared_ptr<void>)>& onCompleteCallback);
+    static auto IsMainThread() -> bool { return s_Application->m_MainThreadTasks.IsMainThread(); }
+
+    /// Queues the task for the next main loop iteration, exceptions are only logged
+    template<typename F>
+    static void ExecuteOnMainThread(F &&task) {
+        s_Application->m_MainThreadTasks.Submit(std::forward<F>(task));
+        s_Application->WakeMainThread();
+    }
+
+    /// Result is delivered to the future, poll it with IsReady() or block a non-main thread with Wait()
+    template<typename T, typename F>
+    static void ExecuteOnMainThread(MainThreadFuture<T> &future, F &&task) {
+        s_Application->m_MainThreadTasks.Submit(future, std::forward<F>(task));
+        s_Application->WakeMainThread();
+    }
 
     TaskSystem m_TaskSystem;
 };
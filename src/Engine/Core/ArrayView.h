@@ -0,0 +1,43 @@
+#ifndef GAME_ENGINE_ARRAY_VIEW_H
+#define GAME_ENGINE_ARRAY_VIEW_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+
+/// Non-owning view of contiguous elements, either a vector's storage or a region of a mapped file
+template<typename T>
+class ArrayView {
+    T *m_Data = nullptr;
+    size_t m_Size = 0;
+
+public:
+    ArrayView() = default;
+
+    ArrayView(T *data, size_t size) : m_Data(data), m_Size(size) {}
+
+    template<typename U>
+    ArrayView(const std::vector<U> &vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+
+    template<typename U>
+    ArrayView(std::vector<U> &vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+
+    auto data() const -> T * { return m_Data; }
+
+    auto size() const -> size_t { return m_Size; }
+
+    auto empty() const -> bool { return m_Size == 0; }
+
+    auto begin() const -> T * { return m_Data; }
+
+    auto end() const -> T * { return m_Data + m_Size; }
+
+    auto operator[](size_t idx) const -> T & {
+        assert(idx < m_Size);
+        return m_Data[idx];
+    }
+};
+
+
+#endif //GAME_ENGINE_ARRAY_VIEW_H
@@ -0,0 +1,101 @@
+#ifndef GAME_ENGINE_BOUNDED_QUEUE_H
+#define GAME_ENGINE_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "Concurrency.h"
+
+
+/**
+ * Bounded lock-free multi-producer multi-consumer ring (D. Vyukov's sequence-number design).
+ * Every slot carries a sequence counter telling producers and consumers whose turn it is,
+ * so neither side ever takes a lock. Capacity must be a power of two.
+ */
+template<typename T>
+class BoundedQueue {
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_Slots;
+    const uint64_t m_Mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_EnqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_DequeuePos{0};
+
+public:
+    explicit BoundedQueue(uint64_t capacity) : m_Slots(new Slot[capacity]), m_Mask(capacity - 1) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("[BoundedQueue] capacity has to be a power of two");
+
+        for (uint64_t i = 0; i < capacity; ++i)
+            m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue &other) = delete;
+
+    auto operator=(const BoundedQueue &other) -> BoundedQueue & = delete;
+
+    template<typename U>
+    auto TryPush(U &&value) -> bool {
+        uint64_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &m_Slots[pos & m_Mask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::forward<U>(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto TryPop(T &value) -> bool {
+        uint64_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &m_Slots[pos & m_Mask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos + 1);
+            if (diff == 0) {
+                if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_DequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(slot->value);
+        slot->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto Capacity() const -> uint64_t { return m_Mask + 1; }
+
+    /// Approximate, only meant for heuristics and statistics
+    auto Size() const -> uint64_t {
+        uint64_t enqueued = m_EnqueuePos.load(std::memory_order_relaxed);
+        uint64_t dequeued = m_DequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    auto Empty() const -> bool { return Size() == 0; }
+};
+
+
+#endif //GAME_ENGINE_BOUNDED_QUEUE_H
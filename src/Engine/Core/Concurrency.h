@@ -0,0 +1,98 @@
+#ifndef GAME_ENGINE_CONCURRENCY_H
+#define GAME_ENGINE_CONCURRENCY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+/// Fixed instead of std::hardware_destructive_interference_size which isn't ABI-stable across compilers
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+
+/// Hint for spin-wait loops, keeps the sibling hyper-thread from starving while we poll
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+
+/**
+ * Lets idle threads sleep without putting a lock on the notifying side. Waiters announce
+ * themselves with PrepareWait(), re-check their condition and only then block in Wait().
+ * Notify() is a single atomic load when nobody is parked.
+ */
+class EventCount {
+    std::atomic<uint64_t> m_Epoch{0};
+    std::atomic<uint32_t> m_Waiters{0};
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+
+public:
+    auto PrepareWait() -> uint64_t {
+        m_Waiters.fetch_add(1, std::memory_order_seq_cst);
+        return m_Epoch.load(std::memory_order_seq_cst);
+    }
+
+    void CancelWait() { m_Waiters.fetch_sub(1, std::memory_order_seq_cst); }
+
+    void Wait(uint64_t epoch) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [&] { return m_Epoch.load(std::memory_order_seq_cst) != epoch; });
+        }
+        m_Waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    /// Wait() which gives up at the given time
+    template<typename Clock, typename Duration>
+    void WaitUntil(uint64_t epoch, const std::chrono::time_point<Clock, Duration> &time) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait_until(lock, time, [&] { return m_Epoch.load(std::memory_order_seq_cst) != epoch; });
+        }
+        m_Waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void NotifyOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Waiters.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+        }
+        m_Condition.notify_one();
+    }
+
+    void NotifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Waiters.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+        }
+        m_Condition.notify_all();
+    }
+
+    auto Waiters() const -> uint32_t { return m_Waiters.load(std::memory_order_relaxed); }
+};
+
+
+#endif //GAME_ENGINE_CONCURRENCY_H
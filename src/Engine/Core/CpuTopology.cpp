@@ -0,0 +1,312 @@
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+
+namespace {
+    constexpr const char *SYSFS_CPU = "/sys/devices/system/cpu";
+    constexpr const char *SYSFS_NODE = "/sys/devices/system/node";
+
+    auto ReadLine(const std::string &path, std::string &line) -> bool {
+        std::ifstream file(path);
+        return file && std::getline(file, line);
+    }
+
+    auto ReadInt(const std::string &path, int fallback) -> int {
+        std::string line;
+        if (!ReadLine(path, line))
+            return fallback;
+        try {
+            return std::stoi(line);
+        } catch (const std::exception &) {
+            return fallback;
+        }
+    }
+
+    /// Parses the kernel's list format, e.g. "0-3,8,10-11"
+    auto ParseCpuList(const std::string &list) -> CpuSet {
+        CpuSet cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            if (range.empty())
+                continue;
+            size_t dash = range.find('-');
+            try {
+                unsigned first = std::stoul(range.substr(0, dash));
+                unsigned last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for (unsigned cpu = first; cpu <= last; cpu++)
+                    cpus.push_back(cpu);
+            } catch (const std::exception &) {
+                return {};
+            }
+        }
+        return cpus;
+    }
+
+    auto ReadCpuList(const std::string &path) -> CpuSet {
+        std::string line;
+        return ReadLine(path, line) ? ParseCpuList(line) : CpuSet{};
+    }
+
+    auto FormatCpuSet(const CpuSet &cpus) -> std::string {
+        if (cpus.empty())
+            return "any";
+
+        std::ostringstream out;
+        for (size_t i = 0; i < cpus.size(); i++)
+            out << (i ? "," : "") << cpus[i];
+        return out.str();
+    }
+
+    /// CPUs this process may run on, containers and taskset commonly restrict it
+    auto AllowedCpus() -> CpuSet {
+        CpuSet cpus;
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &mask))
+                    cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+}
+
+
+auto CpuTopology::Flat(unsigned cpuCount) -> CpuTopology {
+    CpuTopology topology;
+    for (unsigned cpu = 0; cpu < std::max(cpuCount, 1u); cpu++) {
+        CpuInfo info;
+        info.id = cpu;
+        info.core = cpu;
+        topology.m_Cpus.push_back(info);
+    }
+    return topology;
+}
+
+
+auto CpuTopology::Detect() -> CpuTopology {
+    CpuSet online = ReadCpuList(std::string(SYSFS_CPU) + "/online");
+    if (online.empty())
+        return Flat(std::thread::hardware_concurrency());
+
+    CpuSet allowed = AllowedCpus();
+    if (!allowed.empty()) {
+        CpuSet usable;
+        std::set_intersection(online.begin(), online.end(), allowed.begin(), allowed.end(), std::back_inserter(usable));
+        if (!usable.empty())
+            online = std::move(usable);
+    }
+
+    std::map<unsigned, int> cpuNodes;
+    for (unsigned node : ReadCpuList(std::string(SYSFS_NODE) + "/online")) {
+        for (unsigned cpu : ReadCpuList(std::string(SYSFS_NODE) + "/node" + std::to_string(node) + "/cpulist"))
+            cpuNodes[cpu] = static_cast<int>(node);
+    }
+
+    CpuTopology topology;
+    topology.m_Detected = true;
+    for (unsigned cpu : online) {
+        std::string base = std::string(SYSFS_CPU) + "/cpu" + std::to_string(cpu);
+        CpuInfo info;
+        info.id = cpu;
+        info.core = static_cast<unsigned>(std::max(ReadInt(base + "/topology/core_id", static_cast<int>(cpu)), 0));
+        info.package = static_cast<unsigned>(std::max(ReadInt(base + "/topology/physical_package_id", 0), 0));
+        auto node = cpuNodes.find(cpu);
+        info.numaNode = node != cpuNodes.end() ? node->second : -1;
+
+        // The highest cache level present is the last-level cache
+        int llcLevel = 0;
+        for (int index = 0;; index++) {
+            std::string cache = base + "/cache/index" + std::to_string(index);
+            int level = ReadInt(cache + "/level", -1);
+            if (level < 0)
+                break;
+
+            CpuSet shared = ReadCpuList(cache + "/shared_cpu_list");
+            if (level > llcLevel && !shared.empty()) {
+                llcLevel = level;
+                info.llcDomain = static_cast<int>(shared.front());
+            }
+        }
+
+        topology.m_Cpus.push_back(info);
+    }
+    return topology;
+}
+
+
+auto CpuTopology::Find(unsigned cpu) const -> const CpuInfo * {
+    auto it = std::find_if(m_Cpus.begin(), m_Cpus.end(), [cpu](const CpuInfo &info) { return info.id == cpu; });
+    return it != m_Cpus.end() ? &*it : nullptr;
+}
+
+
+auto CpuTopology::PhysicalCoreCount() const -> unsigned {
+    CpuSet all;
+    for (const auto &info : m_Cpus)
+        all.push_back(info.id);
+    return static_cast<unsigned>(PrimaryThreads(all).size());
+}
+
+
+auto CpuTopology::Domain(unsigned cpu) const -> CpuSet {
+    const CpuInfo *origin = Find(cpu);
+    CpuSet domain;
+    for (const auto &info : m_Cpus) {
+        bool sameDomain = true;
+        if (origin && origin->llcDomain >= 0)
+            sameDomain = info.llcDomain == origin->llcDomain;
+        else if (origin && origin->numaNode >= 0)
+            sameDomain = info.numaNode == origin->numaNode;
+        if (sameDomain)
+            domain.push_back(info.id);
+    }
+    return domain;
+}
+
+
+auto CpuTopology::PrimaryThreads(const CpuSet &cpus) const -> CpuSet {
+    std::map<std::pair<unsigned, unsigned>, unsigned> cores;
+    for (unsigned cpu : cpus) {
+        if (const CpuInfo *info = Find(cpu)) {
+            auto key = std::make_pair(info->package, info->core);
+            auto it = cores.find(key);
+            if (it == cores.end() || cpu < it->second)
+                cores[key] = cpu;
+        }
+    }
+
+    CpuSet primaries;
+    for (const auto &core : cores)
+        primaries.push_back(core.second);
+    std::sort(primaries.begin(), primaries.end());
+    return primaries;
+}
+
+
+auto CpuTopology::Describe() const -> std::string {
+    std::ostringstream out;
+    std::map<int, unsigned> domains;
+    for (const auto &info : m_Cpus)
+        domains[info.llcDomain]++;
+
+    out << m_Cpus.size() << " logical CPUs, " << PhysicalCoreCount() << " physical cores, "
+        << domains.size() << " LLC domain(s)" << (m_Detected ? "" : " (topology unknown)");
+    return out.str();
+}
+
+
+auto ThreadPlacement::Plan(const CpuTopology &topology, const ThreadConfig &config) -> ThreadPlacement {
+    ThreadPlacement placement;
+
+    CpuSet all;
+    for (const auto &info : topology.Cpus())
+        all.push_back(info.id);
+
+    CpuSet candidates = all;
+    if (config.singleDomain && config.affinity != ThreadConfig::Affinity::NONE) {
+        int current = ThreadAffinity::CurrentCpu();
+        candidates = topology.Domain(current >= 0 ? static_cast<unsigned>(current) : all.front());
+    }
+
+    // SMT siblings share execution units, workers on both halves of a core would slow each other down
+    CpuSet cores = topology.PrimaryThreads(candidates);
+    // At least one core is always left to the workers
+    auto reserved = static_cast<unsigned>(std::min<size_t>(config.reservedCores, cores.size() - 1));
+    CpuSet workerCores(cores.begin() + reserved, cores.end());
+
+    unsigned workerCount = config.workerCount > 0 ? config.workerCount : static_cast<unsigned>(workerCores.size());
+    placement.workers.resize(workerCount);
+    if (config.affinity == ThreadConfig::Affinity::NONE)
+        return placement;
+
+    if (reserved > 0)
+        placement.main = {cores[0]};
+    placement.render = reserved > 1 ? CpuSet{cores[1]} : placement.main;
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        if (config.affinity == ThreadConfig::Affinity::PINNED)
+            placement.workers[i] = {workerCores[i % workerCores.size()]};
+        else
+            placement.workers[i] = workerCores;
+    }
+    return placement;
+}
+
+
+auto ThreadPlacement::Describe() const -> std::string {
+    std::ostringstream out;
+    out << workers.size() << " workers, main on " << FormatCpuSet(main) << ", render on " << FormatCpuSet(render);
+    if (!workers.empty())
+        out << ", first worker on " << FormatCpuSet(workers.front());
+    return out.str();
+}
+
+
+namespace ThreadAffinity {
+
+    auto Apply(const CpuSet &cpus) -> bool {
+        if (cpus.empty())
+            return true;
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (unsigned cpu : cpus)
+            CPU_SET(cpu, &mask);
+        return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+        return false;
+#endif
+    }
+
+    auto Elevate() -> bool {
+#if defined(__linux__)
+        // Per-thread nice value, real-time classes would let a spinning render thread starve the system
+        constexpr int RENDER_THREAD_NICE = -10;
+        auto tid = static_cast<id_t>(syscall(SYS_gettid));
+        return setpriority(PRIO_PROCESS, tid, RENDER_THREAD_NICE) == 0;
+#else
+        return false;
+#endif
+    }
+
+    auto CurrentCpu() -> int {
+#if defined(__linux__)
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+    auto CpuTime() -> std::chrono::nanoseconds {
+#if defined(__linux__) || defined(__APPLE__)
+        timespec time{};
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+            return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+        return std::chrono::nanoseconds(0);
+    }
+}
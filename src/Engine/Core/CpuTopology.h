@@ -0,0 +1,108 @@
+#ifndef GAME_ENGINE_CPU_TOPOLOGY_H
+#define GAME_ENGINE_CPU_TOPOLOGY_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Logical CPU ids, empty means the thread may run anywhere
+using CpuSet = std::vector<unsigned>;
+
+
+struct CpuInfo {
+    unsigned id = 0;
+    /// Physical core, SMT siblings share it within a package
+    unsigned core = 0;
+    unsigned package = 0;
+    /// -1 when unknown
+    int numaNode = -1;
+    /// Lowest CPU id sharing the last-level cache, identifies the LLC domain, -1 when unknown
+    int llcDomain = -1;
+};
+
+
+/**
+ * Logical CPUs grouped by physical core, NUMA node and last-level cache. On Linux this is read
+ * from sysfs, elsewhere (or when sysfs isn't readable) every logical CPU counts as its own core
+ * in a single domain, which makes placement degrade to no affinity at all.
+ */
+class CpuTopology {
+    std::vector<CpuInfo> m_Cpus;
+    bool m_Detected = false;
+
+public:
+    static auto Detect() -> CpuTopology;
+
+    /// Same shape as an undetected topology, mostly useful for comparisons in benchmarks
+    static auto Flat(unsigned cpuCount) -> CpuTopology;
+
+    auto Cpus() const -> const std::vector<CpuInfo> & { return m_Cpus; }
+
+    auto IsDetected() const -> bool { return m_Detected; }
+
+    auto Find(unsigned cpu) const -> const CpuInfo *;
+
+    auto PhysicalCoreCount() const -> unsigned;
+
+    /// CPUs sharing the given CPU's LLC (or NUMA node when the cache topology is unknown)
+    auto Domain(unsigned cpu) const -> CpuSet;
+
+    /// Lowest logical CPU of every physical core in the set, SMT siblings are left out
+    auto PrimaryThreads(const CpuSet &cpus) const -> CpuSet;
+
+    auto Describe() const -> std::string;
+};
+
+
+struct ThreadConfig {
+    enum class Affinity {
+        /// Scheduler decides, only the worker count is applied
+        NONE,
+        /// Workers may float over all worker cores, main and render thread get their reserved cores
+        RESTRICTED,
+        /// Every thread is bound to a single core
+        PINNED
+    };
+
+    /// Zero picks one worker per physical core which isn't reserved
+    unsigned workerCount = 0;
+    Affinity affinity = Affinity::NONE;
+    /// Physical cores kept free of workers, the first for the main/update thread, the second for rendering
+    unsigned reservedCores = 2;
+    /// Keep every thread within the LLC domain (or NUMA node) the application started on
+    bool singleDomain = true;
+    bool elevateRenderThread = false;
+};
+
+
+/// Which CPUs each engine thread may run on
+struct ThreadPlacement {
+    CpuSet main;
+    CpuSet render;
+    /// One entry per worker, its size is the worker count
+    std::vector<CpuSet> workers;
+
+    static auto Plan(const CpuTopology &topology, const ThreadConfig &config) -> ThreadPlacement;
+
+    auto Describe() const -> std::string;
+};
+
+
+namespace ThreadAffinity {
+    /// Binds the calling thread, an empty set is a no-op. False when the platform refused or isn't supported.
+    auto Apply(const CpuSet &cpus) -> bool;
+
+    /// Raises the calling thread's scheduling priority, usually needs CAP_SYS_NICE on Linux
+    auto Elevate() -> bool;
+
+    /// CPU the calling thread currently runs on, -1 when unknown
+    auto CurrentCpu() -> int;
+
+    /// CPU time the calling thread consumed so far, zero when unsupported
+    auto CpuTime() -> std::chrono::nanoseconds;
+}
+
+
+#endif //GAME_ENGINE_CPU_TOPOLOGY_H
@@ -0,0 +1,105 @@
+#ifndef GAME_ENGINE_HASH_H
+#define GAME_ENGINE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+/**
+ * 64-bit non-cryptographic hash (the XXH64 construction). Results only have to be stable between
+ * runs on the same machine, they are written into cache files which are rejected on a different
+ * endianness anyway.
+ */
+namespace Hash {
+
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ull;
+
+    inline auto Rotl(uint64_t x, unsigned bits) -> uint64_t {
+        return (x << bits) | (x >> (64u - bits));
+    }
+
+    inline auto Read64(const uint8_t *p) -> uint64_t {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline auto Read32(const uint8_t *p) -> uint32_t {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline auto Round(uint64_t acc, uint64_t input) -> uint64_t {
+        acc += input * PRIME_2;
+        return Rotl(acc, 31) * PRIME_1;
+    }
+
+    inline auto MergeRound(uint64_t acc, uint64_t value) -> uint64_t {
+        acc ^= Round(0, value);
+        return acc * PRIME_1 + PRIME_4;
+    }
+
+    /// Final avalanche, also usable on its own to scramble integer keys
+    inline auto Mix(uint64_t h) -> uint64_t {
+        h ^= h >> 33u;
+        h *= PRIME_2;
+        h ^= h >> 29u;
+        h *= PRIME_3;
+        h ^= h >> 32u;
+        return h;
+    }
+
+    inline auto Hash64(const void *data, size_t size, uint64_t seed = 0) -> uint64_t {
+        const auto *p = static_cast<const uint8_t *>(data);
+        const uint8_t *end = p + size;
+        uint64_t h;
+
+        if (size >= 32) {
+            uint64_t v1 = seed + PRIME_1 + PRIME_2;
+            uint64_t v2 = seed + PRIME_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME_1;
+            const uint8_t *limit = end - 32;
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+            h = MergeRound(h, v1);
+            h = MergeRound(h, v2);
+            h = MergeRound(h, v3);
+            h = MergeRound(h, v4);
+        } else {
+            h = seed + PRIME_5;
+        }
+
+        h += static_cast<uint64_t>(size);
+        for (; p + 8 <= end; p += 8)
+            h = Rotl(h ^ Round(0, Read64(p)), 27) * PRIME_1 + PRIME_4;
+        if (p + 4 <= end) {
+            h = Rotl(h ^ (uint64_t(Read32(p)) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+            p += 4;
+        }
+        for (; p < end; p++)
+            h = Rotl(h ^ (*p * PRIME_5), 11) * PRIME_1;
+        return Mix(h);
+    }
+
+    template<typename T>
+    inline auto Combine(uint64_t seed, const T &value) -> uint64_t {
+        return Hash64(&value, sizeof(T), seed);
+    }
+}
+
+
+#endif //GAME_ENGINE_HASH_H
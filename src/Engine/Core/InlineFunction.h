@@ -0,0 +1,104 @@
+#ifndef GAME_ENGINE_INLINE_FUNCTION_H
+#define GAME_ENGINE_INLINE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+template<typename Signature, size_t Capacity>
+class InlineFunction;
+
+
+/**
+ * Move-only std::function replacement which never allocates. The closure is constructed inside
+ * a fixed buffer, closures that don't fit are rejected at compile time. Type erasure goes through
+ * two plain function pointers instead of a vtable.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+    using Invoker = R (*)(void *storage, Args &&... args);
+    /// Move-constructs the closure from src into dst and destroys src, only destroys src when dst is null
+    using Manager = void (*)(void *dst, void *src);
+
+    alignas(std::max_align_t) unsigned char m_Storage[Capacity];
+    Invoker m_Invoke = nullptr;
+    Manager m_Manage = nullptr;
+
+    template<typename F>
+    static auto Invoke(void *storage, Args &&... args) -> R {
+        return (*std::launder(reinterpret_cast<F *>(storage)))(std::forward<Args>(args)...);
+    }
+
+    template<typename F>
+    static void Manage(void *dst, void *src) {
+        auto *source = std::launder(reinterpret_cast<F *>(src));
+        if (dst)
+            ::new(dst) F(std::move(*source));
+        source->~F();
+    }
+
+    void MoveFrom(InlineFunction &other) {
+        if (other.m_Manage) {
+            other.m_Manage(m_Storage, other.m_Storage);
+            m_Invoke = std::exchange(other.m_Invoke, nullptr);
+            m_Manage = std::exchange(other.m_Manage, nullptr);
+        }
+    }
+
+public:
+    InlineFunction() = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction>>>
+    InlineFunction(F &&f) {
+        Emplace(std::forward<F>(f));
+    }
+
+    InlineFunction(const InlineFunction &other) = delete;
+
+    auto operator=(const InlineFunction &other) -> InlineFunction & = delete;
+
+    InlineFunction(InlineFunction &&other) noexcept { MoveFrom(other); }
+
+    auto operator=(InlineFunction &&other) noexcept -> InlineFunction & {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    ~InlineFunction() { Reset(); }
+
+    template<typename F>
+    void Emplace(F &&f) {
+        using Closure = std::decay_t<F>;
+        static_assert(sizeof(Closure) <= Capacity,
+                      "[InlineFunction] Closure doesn't fit the inline storage, capture less or by reference");
+        static_assert(alignof(Closure) <= alignof(std::max_align_t),
+                      "[InlineFunction] Closure is over-aligned");
+        static_assert(std::is_invocable_r_v<R, Closure &, Args...>,
+                      "[InlineFunction] Closure has an incompatible signature");
+
+        Reset();
+        ::new(m_Storage) Closure(std::forward<F>(f));
+        m_Invoke = &Invoke<Closure>;
+        m_Manage = &Manage<Closure>;
+    }
+
+    void Reset() {
+        if (m_Manage) {
+            m_Manage(nullptr, m_Storage);
+            m_Invoke = nullptr;
+            m_Manage = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return m_Invoke != nullptr; }
+
+    auto operator()(Args... args) -> R { return m_Invoke(m_Storage, std::forward<Args>(args)...); }
+};
+
+
+#endif //GAME_ENGINE_INLINE_FUNCTION_H
@@ -0,0 +1,214 @@
+#include "Logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+
+thread_local Logger::RingOwner Logger::t_Ring;
+
+
+namespace LogFormat {
+    void AppendInteger(std::string &out, int64_t value) {
+        char buffer[24];
+        int length = std::snprintf(buffer, sizeof(buffer), "%" PRId64, value);
+        out.append(buffer, length);
+    }
+
+    void AppendUnsigned(std::string &out, uint64_t value) {
+        char buffer[24];
+        int length = std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+        out.append(buffer, length);
+    }
+
+    void AppendFloat(std::string &out, double value) {
+        // Same as the default std::ostream formatting
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+        out.append(buffer, length);
+    }
+
+    void AppendAddress(std::string &out, uintptr_t value) {
+        char buffer[24];
+        int length = std::snprintf(buffer, sizeof(buffer), "0x%" PRIxPTR, value);
+        out.append(buffer, length);
+    }
+}
+
+
+auto LogRing::Reserve(size_t size) -> uint8_t * {
+    uint64_t head = m_Head.load(std::memory_order_relaxed);
+    size_t offset = head & (CAPACITY - 1);
+    size_t contiguous = CAPACITY - offset;
+    size_t needed = size <= contiguous ? size : contiguous + size;
+
+    if (size > MAX_RECORD_SIZE) {
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (head + needed - m_CachedTail > CAPACITY) {
+        m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        if (head + needed - m_CachedTail > CAPACITY) {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    if (size > contiguous) {
+        // The consumer skips tails too short for a header on its own
+        if (contiguous >= sizeof(RecordHeader)) {
+            RecordHeader padding{nullptr, nullptr, 0, static_cast<uint32_t>(contiguous), 0};
+            std::memcpy(&m_Buffer[offset], &padding, sizeof(padding));
+        }
+        head += contiguous;
+        offset = 0;
+    }
+    m_Reserved = head + size;
+    return &m_Buffer[offset];
+}
+
+
+Logger::Logger() :
+        m_StartTicks(Ticks()),
+        m_StartSteady(std::chrono::steady_clock::now()),
+        m_StartSystem(std::chrono::system_clock::now()) {
+    m_Thread = std::thread(&Logger::Run, this);
+}
+
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+
+auto Logger::Get() -> Logger & {
+    static Logger s_Logger;
+    return s_Logger;
+}
+
+
+auto Logger::RegisterThread() -> LogRing & {
+    t_Ring.ring = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Rings.push_back(t_Ring.ring);
+    return *t_Ring.ring;
+}
+
+
+void Logger::Flush() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    uint64_t ticket = ++m_FlushRequested;
+    m_Wake.notify_one();
+    m_Flushed.wait(lock, [this, ticket] { return m_FlushCompleted >= ticket; });
+}
+
+
+void Logger::Run() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+        m_Wake.wait_for(lock, POLL_INTERVAL, [this] { return m_Stop || m_FlushRequested > m_FlushCompleted; });
+        bool stop = m_Stop;
+        uint64_t requested = m_FlushRequested;
+        // Rings registered meanwhile are picked up in the next round, their records can't be older than the flush
+        std::vector<std::shared_ptr<LogRing>> rings = m_Rings;
+        lock.unlock();
+
+        // Abandoned before the drain means nothing can be written after it
+        std::vector<std::shared_ptr<LogRing>> finished;
+        for (const auto &ring : rings) {
+            if (ring->IsAbandoned())
+                finished.push_back(ring);
+        }
+        Drain(rings);
+
+        lock.lock();
+        m_Rings.erase(std::remove_if(m_Rings.begin(), m_Rings.end(), [&finished](const auto &ring) {
+            return std::find(finished.begin(), finished.end(), ring) != finished.end();
+        }), m_Rings.end());
+        m_FlushCompleted = requested;
+        m_Flushed.notify_all();
+        if (stop)
+            break;
+    }
+}
+
+
+void Logger::Drain(const std::vector<std::shared_ptr<LogRing>> &rings) {
+    m_Pending.clear();
+    uint64_t dropped = 0;
+    for (const auto &ring : rings) {
+        ring->Drain([this](const LogRing::RecordHeader &header, const uint8_t *args) {
+            Pending pending{header.ticks, header.site->level, {}};
+            header.format(header.site->format, args, pending.text);
+            m_Pending.push_back(std::move(pending));
+        });
+        dropped += ring->TakeDropped();
+    }
+    if (m_Pending.empty() && dropped == 0)
+        return;
+
+    Calibrate();
+    // Every ring is in order already, the merge only interleaves the threads
+    std::stable_sort(m_Pending.begin(), m_Pending.end(), [](const Pending &a, const Pending &b) {
+        return a.ticks < b.ticks;
+    });
+
+    m_Out.clear();
+    m_Err.clear();
+    for (const auto &pending : m_Pending) {
+        std::string &out = pending.level >= LogLevel::WARNING ? m_Err : m_Out;
+        AppendTimestamp(out, pending.ticks);
+        out.append(pending.text);
+        out.push_back('\n');
+    }
+    if (dropped > 0) {
+        AppendTimestamp(m_Err, Ticks());
+        m_Err.append("[Logger] Dropped ");
+        LogFormat::AppendUnsigned(m_Err, dropped);
+        m_Err.append(" messages, a thread's log ring was full\n");
+    }
+
+    if (!m_Out.empty()) {
+        std::fwrite(m_Out.data(), 1, m_Out.size(), stdout);
+        std::fflush(stdout);
+    }
+    if (!m_Err.empty()) {
+        std::fwrite(m_Err.data(), 1, m_Err.size(), stderr);
+        std::fflush(stderr);
+    }
+}
+
+
+void Logger::Calibrate() {
+    uint64_t ticks = Ticks();
+    auto elapsed = std::chrono::steady_clock::now() - m_StartSteady;
+    auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    // Too short an interval gives a poor estimate, the first drain happens at least one poll interval in
+    if (elapsedNs >= std::chrono::duration_cast<std::chrono::nanoseconds>(POLL_INTERVAL).count() && ticks > m_StartTicks)
+        m_TicksPerNs = double(ticks - m_StartTicks) / elapsedNs;
+}
+
+
+void Logger::AppendTimestamp(std::string &out, uint64_t ticks) const {
+    double sinceStartNs = ticks > m_StartTicks ? (ticks - m_StartTicks) / m_TicksPerNs : 0.0;
+    auto time = m_StartSystem + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::duration<double, std::nano>(sinceStartNs));
+
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+    tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char buffer[24];
+    size_t length = std::strftime(buffer, sizeof(buffer), "[%X", &local);
+    length += std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d]", static_cast<int>(milliseconds));
+    out.append(buffer, length);
+}
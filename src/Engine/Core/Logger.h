@@ -0,0 +1,397 @@
+#ifndef GAME_ENGINE_LOGGER_H
+#define GAME_ENGINE_LOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Concurrency.h"
+
+#if defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+#define ENGINE_LOG_LEVEL_TRACE 0
+#define ENGINE_LOG_LEVEL_DEBUG 1
+#define ENGINE_LOG_LEVEL_INFO 2
+#define ENGINE_LOG_LEVEL_WARNING 3
+#define ENGINE_LOG_LEVEL_ERROR 4
+#define ENGINE_LOG_LEVEL_OFF 5
+
+/// Messages below this level are removed by the preprocessor, their arguments aren't even evaluated
+#ifndef ENGINE_LOG_LEVEL
+#ifdef NDEBUG
+#define ENGINE_LOG_LEVEL ENGINE_LOG_LEVEL_INFO
+#else
+#define ENGINE_LOG_LEVEL ENGINE_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+
+enum class LogLevel : uint8_t {
+    TRACE = ENGINE_LOG_LEVEL_TRACE,
+    DEBUG = ENGINE_LOG_LEVEL_DEBUG,
+    INFO = ENGINE_LOG_LEVEL_INFO,
+    WARNING = ENGINE_LOG_LEVEL_WARNING,
+    ERROR = ENGINE_LOG_LEVEL_ERROR
+};
+
+
+/// One per logging statement, its address identifies the format of the records written there
+struct LogSite {
+    LogLevel level;
+    /// Arguments replace "{}" placeholders in order
+    const char *format;
+};
+
+
+/**
+ * Binary encoding of a single log argument. Numbers are copied as they are, strings by value
+ * since they may be gone by the time the backend formats the record. Formatting happens on
+ * the backend thread only.
+ */
+template<typename T, typename Enable = void>
+struct LogArg {
+    static_assert(sizeof(T) == 0, "Type can't be logged, convert it to a number or string first");
+};
+
+template<typename T>
+struct LogArg<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> {
+    static auto Size(T) -> size_t { return sizeof(T); }
+
+    static void Encode(uint8_t *&data, T value) {
+        std::memcpy(data, &value, sizeof(T));
+        data += sizeof(T);
+    }
+
+    static void Format(const uint8_t *&data, std::string &out);
+};
+
+template<>
+struct LogArg<std::string_view> {
+    /// Longer strings are truncated, a record has to fit into a fraction of the thread's ring
+    constexpr static uint32_t MAX_LENGTH = 2048;
+
+    static auto Length(std::string_view value) -> uint32_t {
+        return static_cast<uint32_t>(std::min<size_t>(value.size(), MAX_LENGTH));
+    }
+
+    static auto Size(std::string_view value) -> size_t { return sizeof(uint32_t) + Length(value); }
+
+    static void Encode(uint8_t *&data, std::string_view value) {
+        uint32_t length = Length(value);
+        std::memcpy(data, &length, sizeof(length));
+        std::memcpy(data + sizeof(length), value.data(), length);
+        data += sizeof(length) + length;
+    }
+
+    static void Format(const uint8_t *&data, std::string &out) {
+        uint32_t length;
+        std::memcpy(&length, data, sizeof(length));
+        out.append(reinterpret_cast<const char *>(data + sizeof(length)), length);
+        data += sizeof(length) + length;
+    }
+};
+
+template<>
+struct LogArg<std::string> : LogArg<std::string_view> {};
+
+template<>
+struct LogArg<const char *> : LogArg<std::string_view> {
+    static auto Size(const char *value) -> size_t { return LogArg<std::string_view>::Size(value ? value : "(null)"); }
+
+    static void Encode(uint8_t *&data, const char *value) { LogArg<std::string_view>::Encode(data, value ? value : "(null)"); }
+};
+
+template<>
+struct LogArg<char *> : LogArg<const char *> {};
+
+/// Other pointers are printed as addresses
+template<typename T>
+struct LogArg<T *, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>> {
+    static auto Size(const T *) -> size_t { return sizeof(uintptr_t); }
+
+    static void Encode(uint8_t *&data, const T *value) { LogArg<uintptr_t>::Encode(data, reinterpret_cast<uintptr_t>(value)); }
+
+    static void Format(const uint8_t *&data, std::string &out);
+};
+
+
+/**
+ * Single producer, single consumer byte ring owned by one logging thread. Records are 8-byte aligned
+ * and never wrap, the producer skips the end of the buffer when a record doesn't fit there. A full
+ * ring drops the record instead of waiting, the backend reports how many were lost.
+ */
+class LogRing {
+public:
+    struct RecordHeader {
+        /// Null for padding at the end of the buffer
+        const LogSite *site;
+        void (*format)(const char *format, const uint8_t *args, std::string &out);
+        uint64_t ticks;
+        uint32_t size;
+        uint32_t padding;
+    };
+
+    constexpr static size_t CAPACITY = 64 * 1024;
+    constexpr static size_t MAX_RECORD_SIZE = CAPACITY / 4;
+
+private:
+    std::unique_ptr<uint8_t[]> m_Buffer{new uint8_t[CAPACITY]};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_Head{0};
+    /// Producer-only copies, the shared tail is reloaded only when the ring looks full
+    uint64_t m_CachedTail = 0;
+    uint64_t m_Reserved = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_Tail{0};
+    std::atomic<uint64_t> m_Dropped{0};
+    std::atomic<bool> m_Abandoned{false};
+
+public:
+    /// Producer side, null when the ring is full. The record becomes visible with Commit().
+    auto Reserve(size_t size) -> uint8_t *;
+
+    void Commit() { m_Head.store(m_Reserved, std::memory_order_release); }
+
+    /// Consumer side, formats every committed record and frees its space
+    template<typename Consumer>
+    void Drain(const Consumer &consume) {
+        uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+        uint64_t head = m_Head.load(std::memory_order_acquire);
+        while (tail < head) {
+            size_t offset = tail & (CAPACITY - 1);
+            if (CAPACITY - offset < sizeof(RecordHeader)) {
+                tail += CAPACITY - offset;
+                continue;
+            }
+
+            RecordHeader header;
+            std::memcpy(&header, &m_Buffer[offset], sizeof(header));
+            if (header.site)
+                consume(header, &m_Buffer[offset + sizeof(header)]);
+            tail += header.size;
+        }
+        m_Tail.store(tail, std::memory_order_release);
+    }
+
+    auto TakeDropped() -> uint64_t { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+    /// Set when the owning thread exits, the backend forgets the ring once it's drained
+    void Abandon() { m_Abandoned.store(true, std::memory_order_release); }
+
+    auto IsAbandoned() const -> bool { return m_Abandoned.load(std::memory_order_acquire); }
+};
+
+
+/**
+ * Asynchronous logger. Threads write compact binary records (format site, TSC timestamp, encoded
+ * arguments) into their own LogRing, which costs a few dozen nanoseconds and never blocks: the
+ * first message of a thread registers its ring, a full ring drops messages. A background thread
+ * collects the records every few milliseconds, orders them by timestamp, formats them and writes
+ * them out, warnings and errors to stderr, everything else to stdout.
+ *
+ * Use the LOG_* macros, they remove messages below ENGINE_LOG_LEVEL at compile time.
+ */
+class Logger {
+    constexpr static std::chrono::milliseconds POLL_INTERVAL{5};
+
+    struct Pending {
+        uint64_t ticks;
+        LogLevel level;
+        std::string text;
+    };
+
+    /// Abandons the ring when its thread exits, the backend still holds a reference until it's drained
+    struct RingOwner {
+        std::shared_ptr<LogRing> ring;
+
+        ~RingOwner() {
+            if (ring)
+                ring->Abandon();
+        }
+    };
+
+    static thread_local RingOwner t_Ring;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Flushed;
+    std::vector<std::shared_ptr<LogRing>> m_Rings;
+    uint64_t m_FlushRequested = 0;
+    uint64_t m_FlushCompleted = 0;
+    bool m_Stop = false;
+
+    /// Tick to wall clock conversion, refined on every drain
+    const uint64_t m_StartTicks;
+    const std::chrono::steady_clock::time_point m_StartSteady;
+    const std::chrono::system_clock::time_point m_StartSystem;
+    double m_TicksPerNs = 1.0;
+
+    std::vector<Pending> m_Pending;
+    std::string m_Out;
+    std::string m_Err;
+    std::thread m_Thread;
+
+    Logger();
+
+    void Run();
+
+    void Drain(const std::vector<std::shared_ptr<LogRing>> &rings);
+
+    void Calibrate();
+
+    void AppendTimestamp(std::string &out, uint64_t ticks) const;
+
+    auto RegisterThread() -> LogRing &;
+
+    auto ThreadRing() -> LogRing & { return t_Ring.ring ? *t_Ring.ring : RegisterThread(); }
+
+    template<typename... Args>
+    static void FormatRecord(const char *format, [[maybe_unused]] const uint8_t *args, std::string &out) {
+        // Appends the format text up to the next placeholder, all of it once the arguments ran out
+        [[maybe_unused]] auto nextPlaceholder = [&format, &out] {
+            const char *placeholder = std::strstr(format, "{}");
+            size_t length = placeholder ? placeholder - format : std::strlen(format);
+            out.append(format, length);
+            format += placeholder ? length + 2 : length;
+        };
+        ((nextPlaceholder(), LogArg<Args>::Format(args, out)), ...);
+        out.append(format);
+    }
+
+public:
+    ~Logger();
+
+    Logger(const Logger &other) = delete;
+
+    auto operator=(const Logger &other) -> Logger & = delete;
+
+    static auto Get() -> Logger &;
+
+    /// Timestamp source of the records, the TSC where available
+    static auto Ticks() -> uint64_t {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    template<typename... Args>
+    void Write(const LogSite &site, const Args &... args) {
+        size_t size = sizeof(LogRing::RecordHeader) + (size_t(0) + ... + LogArg<std::decay_t<Args>>::Size(args));
+        size = (size + 7) & ~size_t(7);
+
+        LogRing &ring = ThreadRing();
+        uint8_t *data = ring.Reserve(size);
+        if (!data)
+            return;
+
+        LogRing::RecordHeader header{&site, &FormatRecord<std::decay_t<Args>...>, Ticks(),
+                                     static_cast<uint32_t>(size), 0};
+        std::memcpy(data, &header, sizeof(header));
+        data += sizeof(header);
+        (LogArg<std::decay_t<Args>>::Encode(data, args), ...);
+        ring.Commit();
+    }
+
+    /// Blocks until everything logged before the call has been written out
+    void Flush();
+};
+
+
+namespace LogFormat {
+    void AppendInteger(std::string &out, int64_t value);
+
+    void AppendUnsigned(std::string &out, uint64_t value);
+
+    void AppendFloat(std::string &out, double value);
+
+    void AppendAddress(std::string &out, uintptr_t value);
+}
+
+
+template<typename T>
+void LogArg<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>::Format(const uint8_t *&data,
+                                                                                          std::string &out) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+
+    if constexpr (std::is_enum_v<T>) {
+        LogFormat::AppendInteger(out, static_cast<int64_t>(value));
+    } else if constexpr (std::is_same_v<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_same_v<T, char>) {
+        out.push_back(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        LogFormat::AppendFloat(out, value);
+    } else if constexpr (std::is_signed_v<T>) {
+        LogFormat::AppendInteger(out, value);
+    } else {
+        LogFormat::AppendUnsigned(out, value);
+    }
+}
+
+
+template<typename T>
+void LogArg<T *, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>>::Format(const uint8_t *&data,
+                                                                                        std::string &out) {
+    uintptr_t value;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    LogFormat::AppendAddress(out, value);
+}
+
+
+#define ENGINE_LOG(logLevel, logFormat, ...)                                   \
+    do {                                                                       \
+        static constexpr LogSite s_LogSite{logLevel, logFormat};               \
+        Logger::Get().Write(s_LogSite, ##__VA_ARGS__);                         \
+    } while (false)
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_TRACE
+#define LOG_TRACE(...) ENGINE_LOG(LogLevel::TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void) 0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) ENGINE_LOG(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void) 0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_INFO
+#define LOG_INFO(...) ENGINE_LOG(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void) 0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_WARNING
+#define LOG_WARNING(...) ENGINE_LOG(LogLevel::WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void) 0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_ERROR
+#define LOG_ERROR(...) ENGINE_LOG(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void) 0)
+#endif
+
+
+#endif //GAME_ENGINE_LOGGER_H
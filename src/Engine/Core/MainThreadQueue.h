@@ -0,0 +1,181 @@
+#ifndef GAME_ENGINE_MAIN_THREAD_QUEUE_H
+#define GAME_ENGINE_MAIN_THREAD_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Concurrency.h"
+#include "InlineFunction.h"
+#include "Logger.h"
+
+
+/// Closures up to this size are stored inline, enough for a few strings/vectors and a callback
+constexpr size_t MAIN_THREAD_CLOSURE_SIZE = 128;
+
+
+/**
+ * Result slot of a main-thread task, owned by whoever submitted the task and it has to outlive
+ * the task. IsReady() never blocks, so the render thread can poll it once per frame. A future can
+ * be reused for another task once the previous one finished.
+ */
+template<typename T>
+class MainThreadFuture {
+    friend class MainThreadQueue;
+
+    using Storage = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+    enum class State : uint8_t {
+        IDLE,
+        PENDING,
+        READY
+    };
+
+    std::atomic<State> m_State{State::IDLE};
+    std::optional<Storage> m_Value;
+    std::exception_ptr m_Exception;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Signalled = false;
+
+    void Acquire() {
+        if (m_State.exchange(State::PENDING, std::memory_order_acq_rel) == State::PENDING)
+            throw std::runtime_error("[MainThreadFuture] Future is still waiting for a previous task");
+        m_Signalled = false;
+        m_Value.reset();
+        m_Exception = nullptr;
+    }
+
+    template<typename F>
+    void Run(F &task) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                task();
+                m_Value.emplace(true);
+            } else {
+                m_Value.emplace(task());
+            }
+        } catch (...) {
+            m_Exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Signalled = true;
+            m_Condition.notify_all();
+        }
+        // Has to be the last access, the owner may destroy or reuse the future as soon as it sees the state
+        m_State.store(State::READY, std::memory_order_release);
+    }
+
+public:
+    MainThreadFuture() = default;
+
+    MainThreadFuture(const MainThreadFuture &other) = delete;
+
+    auto operator=(const MainThreadFuture &other) -> MainThreadFuture & = delete;
+
+    auto IsPending() const -> bool { return m_State.load(std::memory_order_acquire) == State::PENDING; }
+
+    auto IsReady() const -> bool { return m_State.load(std::memory_order_acquire) == State::READY; }
+
+    /// Blocks the calling thread, must not be called from the main thread
+    void Wait() {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Signalled; });
+        }
+        // The ready state follows the signal within a few instructions
+        while (!IsReady())
+            CpuRelax();
+    }
+
+    /// Rethrows the task's exception, only valid once IsReady() returned true
+    auto Get() -> std::add_lvalue_reference_t<T> {
+        if (!IsReady())
+            throw std::runtime_error("[MainThreadFuture] Result isn't ready yet");
+        if (m_Exception)
+            std::rethrow_exception(m_Exception);
+        if constexpr (!std::is_void_v<T>)
+            return *m_Value;
+    }
+};
+
+
+/**
+ * Work which has to run on the main thread (window system, native dialogs), submitted from any thread.
+ * Closures are stored inline and the two task buffers are swapped under the lock, tasks then run
+ * without holding it, so a task can submit further tasks. Buffers keep their capacity, once warmed
+ * up submitting doesn't allocate.
+ */
+class MainThreadQueue {
+    using TaskFunction = InlineFunction<void(), MAIN_THREAD_CLOSURE_SIZE>;
+
+    constexpr static size_t INITIAL_CAPACITY = 64;
+
+    std::mutex m_Mutex;
+    std::vector<TaskFunction> m_Pending;
+    std::vector<TaskFunction> m_Executing;
+    std::thread::id m_MainThreadId;
+
+public:
+    MainThreadQueue() : m_MainThreadId(std::this_thread::get_id()) {
+        m_Pending.reserve(INITIAL_CAPACITY);
+        m_Executing.reserve(INITIAL_CAPACITY);
+    }
+
+    MainThreadQueue(const MainThreadQueue &other) = delete;
+
+    auto operator=(const MainThreadQueue &other) -> MainThreadQueue & = delete;
+
+    /// Fire-and-forget, exceptions are logged as errors
+    template<typename F>
+    void Submit(F &&task) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Pending.emplace_back(std::forward<F>(task));
+    }
+
+    /// The task's result (or exception) ends up in the future
+    template<typename T, typename F>
+    void Submit(MainThreadFuture<T> &future, F &&task) {
+        future.Acquire();
+        Submit([&future, task = std::forward<F>(task)]() mutable { future.Run(task); });
+    }
+
+    /// Runs everything submitted before the call, has to be called from the main thread
+    void Execute() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            std::swap(m_Pending, m_Executing);
+        }
+
+        // The batch is cleared however the loop is left, the next Execute() mustn't see stale tasks
+        struct ClearGuard {
+            std::vector<TaskFunction> &batch;
+
+            ~ClearGuard() { batch.clear(); }
+        } clearGuard{m_Executing};
+
+        for (auto &task : m_Executing) {
+            try {
+                task();
+            } catch (const std::exception &e) {
+                LOG_ERROR("[MainThreadQueue] Task failed: {}", e.what());
+            } catch (...) {
+                LOG_ERROR("[MainThreadQueue] Task failed");
+            }
+        }
+    }
+
+    auto IsMainThread() const -> bool { return std::this_thread::get_id() == m_MainThreadId; }
+};
+
+
+#endif //GAME_ENGINE_MAIN_THREAD_QUEUE_H
@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#define MAPPED_FILE_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+auto FileStamp::Of(const std::string &filepath) -> std::optional<FileStamp> {
+#if defined(MAPPED_FILE_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filepath.c_str(), GetFileExInfoStandard, &attributes))
+        return std::nullopt;
+
+    FileStamp stamp;
+    stamp.size = (uint64_t(attributes.nFileSizeHigh) << 32u) | attributes.nFileSizeLow;
+    // FILETIME counts 100 ns intervals
+    uint64_t ticks = (uint64_t(attributes.ftLastWriteTime.dwHighDateTime) << 32u) |
+                     attributes.ftLastWriteTime.dwLowDateTime;
+    stamp.modified = ticks * 100;
+    return stamp;
+#else
+    struct stat info{};
+    if (stat(filepath.c_str(), &info) != 0)
+        return std::nullopt;
+
+    FileStamp stamp;
+    stamp.size = static_cast<uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    stamp.modified = uint64_t(info.st_mtimespec.tv_sec) * 1'000'000'000u + info.st_mtimespec.tv_nsec;
+#else
+    stamp.modified = uint64_t(info.st_mtim.tv_sec) * 1'000'000'000u + info.st_mtim.tv_nsec;
+#endif
+    return stamp;
+#endif
+}
+
+
+auto MappedFile::Open(const std::string &filepath) -> std::shared_ptr<MappedFile> {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#if defined(MAPPED_FILE_WIN32)
+    HANDLE handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    file->m_File = handle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+        return nullptr;
+    file->m_Size = static_cast<size_t>(size.QuadPart);
+
+    file->m_Mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file->m_Mapping)
+        return nullptr;
+    file->m_Data = static_cast<const uint8_t *>(MapViewOfFile(file->m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!file->m_Data)
+        return nullptr;
+#else
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping keeps the file referenced, the descriptor isn't needed afterwards
+    void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    file->m_Data = static_cast<const uint8_t *>(data);
+    file->m_Size = static_cast<size_t>(info.st_size);
+#endif
+    return file;
+}
+
+
+MappedFile::~MappedFile() {
+#if defined(MAPPED_FILE_WIN32)
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+#else
+    if (m_Data)
+        munmap(const_cast<uint8_t *>(m_Data), m_Size);
+#endif
+}
+
+
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+    if (offset >= m_Size)
+        return;
+    size = std::min(size, m_Size - offset);
+#if defined(MAPPED_FILE_WIN32)
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t *>(m_Data) + offset, size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page aligned start
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset & ~(pageSize - 1);
+    madvise(const_cast<uint8_t *>(m_Data) + alignedOffset, size + (offset - alignedOffset), MADV_WILLNEED);
+#endif
+}
+
+
+void MappedFile::Release(size_t offset, size_t size) const {
+#if !defined(MAPPED_FILE_WIN32)
+    // Only whole pages inside the range, a partially covered page may still be in use by the neighbour
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = (offset + pageSize - 1) & ~(pageSize - 1);
+    size_t last = std::min(offset + size, m_Size) & ~(pageSize - 1);
+    if (first < last)
+        madvise(const_cast<uint8_t *>(m_Data) + first, last - first, MADV_DONTNEED);
+#endif
+}
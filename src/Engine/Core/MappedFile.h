@@ -0,0 +1,64 @@
+#ifndef GAME_ENGINE_MAPPED_FILE_H
+#define GAME_ENGINE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+
+/// Size and modification time of a file, cheap staleness check for derived cache files
+struct FileStamp {
+    uint64_t size = 0;
+    /// Nanoseconds since the epoch, zero when unknown
+    uint64_t modified = 0;
+
+    static auto Of(const std::string &filepath) -> std::optional<FileStamp>;
+
+    auto operator==(const FileStamp &other) const -> bool {
+        return size == other.size && modified == other.modified;
+    }
+
+    auto operator!=(const FileStamp &other) const -> bool { return !(*this == other); }
+};
+
+
+/**
+ * Read-only view of a whole file mapped into memory. Pages are loaded on first access, so opening
+ * a large file is cheap and data which is only copied once (e.g. into a staging buffer) never
+ * passes through an intermediate heap allocation.
+ */
+class MappedFile {
+    const uint8_t *m_Data = nullptr;
+    size_t m_Size = 0;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+    void *m_File = nullptr;
+    void *m_Mapping = nullptr;
+#endif
+
+    MappedFile() = default;
+
+public:
+    /// Nullptr when the file doesn't exist or can't be mapped
+    static auto Open(const std::string &filepath) -> std::shared_ptr<MappedFile>;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &other) = delete;
+
+    auto operator=(const MappedFile &other) -> MappedFile & = delete;
+
+    auto Data() const -> const uint8_t * { return m_Data; }
+
+    auto Size() const -> size_t { return m_Size; }
+
+    /// Hints that the range is about to be read front to back
+    void Prefetch(size_t offset, size_t size) const;
+
+    /// Hints that the range won't be needed soon, its pages may be dropped until the next access
+    void Release(size_t offset, size_t size) const;
+};
+
+
+#endif //GAME_ENGINE_MAPPED_FILE_H
@@ -1 +0,0 @@
-#include "NotificationQueue.h"
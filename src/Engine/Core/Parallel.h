@@ -0,0 +1,228 @@
+#ifndef GAME_ENGINE_PARALLEL_H
+#define GAME_ENGINE_PARALLEL_H
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "TaskSystem.h"
+
+
+/**
+ * Data-parallel helpers on top of TaskSystem. Ranges are split recursively in halves, the calling
+ * thread keeps working on the left half while the right half is spawned, so stealing workers
+ * pick up large pieces first. Waiting is done by helping with other tasks, which makes the
+ * helpers safe to use from inside tasks (nested parallelism) without risking a deadlock.
+ */
+namespace Parallel {
+
+    /// How many chunks per thread the automatic grain size aims for, leaves room for load balancing
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    /// Below this size sorting isn't worth splitting
+    constexpr size_t MIN_SORT_CHUNK = 4096;
+
+    inline auto GrainSize(const TaskSystem &taskSystem, size_t count, size_t minGrainSize) -> size_t {
+        // +1 because the calling thread takes part as well
+        size_t chunkCount = (taskSystem.ThreadCount() + 1) * CHUNKS_PER_THREAD;
+        return std::max<size_t>({minGrainSize, (count + chunkCount - 1) / chunkCount, 1});
+    }
+
+
+    namespace detail {
+        /// Keeps the first exception thrown by any chunk so it can be rethrown on the calling thread
+        class ExceptionSlot {
+            std::mutex m_Mutex;
+            std::exception_ptr m_Exception;
+
+        public:
+            void Capture() {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (!m_Exception)
+                    m_Exception = std::current_exception();
+            }
+
+            void RethrowIfSet() {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Exception)
+                    std::rethrow_exception(m_Exception);
+            }
+        };
+
+        /**
+         * Merge path co-rank: how many of the first k outputs of merging a (length n) with b (length m)
+         * come from a. Ties go to a first, like std::merge.
+         */
+        template<typename It, typename Compare>
+        auto CoRank(size_t k, It a, size_t n, It b, size_t m, Compare &comp) -> size_t {
+            size_t low = k > m ? k - m : 0;
+            size_t high = std::min(k, n);
+            while (low < high) {
+                size_t i = low + (high - low) / 2;
+                if (comp(b[k - i - 1], a[i]))
+                    high = i;
+                else
+                    low = i + 1;
+            }
+            return low;
+        }
+
+        template<typename F>
+        void SplitRange(TaskSystem &taskSystem, TaskCounter &counter, ExceptionSlot &exceptions,
+                        size_t begin, size_t end, size_t grainSize, const F &body) {
+            while (end - begin > grainSize) {
+                size_t middle = begin + (end - begin) / 2;
+                taskSystem.Spawn(counter, [&taskSystem, &counter, &exceptions, middle, end, grainSize, &body]() {
+                    SplitRange(taskSystem, counter, exceptions, middle, end, grainSize, body);
+                });
+                end = middle;
+            }
+
+            try {
+                body(begin, end);
+            } catch (...) {
+                exceptions.Capture();
+            }
+        }
+    }
+
+
+    /**
+     * Calls body(chunkBegin, chunkEnd) for disjoint chunks covering [begin, end). Chunks have at least
+     * minGrainSize elements, otherwise the size is picked from the range length and worker count.
+     */
+    template<typename F>
+    void ForChunks(TaskSystem &taskSystem, size_t begin, size_t end, F &&body, size_t minGrainSize = 1) {
+        if (end <= begin)
+            return;
+
+        size_t grainSize = GrainSize(taskSystem, end - begin, minGrainSize);
+        if (end - begin <= grainSize) {
+            body(begin, end);
+            return;
+        }
+
+        TaskCounter counter;
+        detail::ExceptionSlot exceptions;
+        detail::SplitRange(taskSystem, counter, exceptions, begin, end, grainSize, body);
+        taskSystem.Wait(counter);
+        exceptions.RethrowIfSet();
+    }
+
+
+    /// Calls body(i) for every i in [begin, end)
+    template<typename F>
+    void For(TaskSystem &taskSystem, size_t begin, size_t end, F &&body, size_t minGrainSize = 1) {
+        ForChunks(taskSystem, begin, end, [&body](size_t chunkBegin, size_t chunkEnd) {
+            for (size_t i = chunkBegin; i < chunkEnd; i++)
+                body(i);
+        }, minGrainSize);
+    }
+
+
+    /**
+     * reduceChunk(chunkBegin, chunkEnd, identity) -> T reduces one chunk, partial results are then
+     * combined in chunk order with combine(T, T) -> T, so the result doesn't depend on scheduling.
+     */
+    template<typename T, typename ReduceChunk, typename Combine>
+    auto Reduce(TaskSystem &taskSystem, size_t begin, size_t end, T identity,
+                ReduceChunk &&reduceChunk, Combine &&combine, size_t minGrainSize = 1) -> T {
+        if (end <= begin)
+            return identity;
+
+        size_t count = end - begin;
+        size_t grainSize = GrainSize(taskSystem, count, minGrainSize);
+        size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+        std::vector<T> partials(chunkCount, identity);
+        ForChunks(taskSystem, 0, chunkCount, [&](size_t firstChunk, size_t lastChunk) {
+            for (size_t chunk = firstChunk; chunk < lastChunk; chunk++) {
+                size_t chunkBegin = begin + chunk * grainSize;
+                size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+                partials[chunk] = reduceChunk(chunkBegin, chunkEnd, identity);
+            }
+        });
+
+        T result = std::move(identity);
+        for (auto &partial : partials)
+            result = combine(std::move(result), std::move(partial));
+        return result;
+    }
+
+
+    /**
+     * Merge sort: chunks are sorted concurrently with std::sort, then merged pairwise in parallel
+     * rounds through a scratch buffer. Every round is split into chunk-sized pieces of output, the
+     * merge path co-rank finds where each piece starts in both inputs, so the last rounds with only
+     * a few large merges still keep all threads busy. Not stable, same guarantees as std::sort.
+     */
+    template<typename RandomIt, typename Compare = std::less<>>
+    void Sort(TaskSystem &taskSystem, RandomIt first, RandomIt last, Compare comp = Compare()) {
+        using Value = typename std::iterator_traits<RandomIt>::value_type;
+
+        size_t count = std::distance(first, last);
+        size_t grainSize = GrainSize(taskSystem, count, MIN_SORT_CHUNK);
+        if (count <= grainSize) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        size_t chunkCount = (count + grainSize - 1) / grainSize;
+        For(taskSystem, 0, chunkCount, [&](size_t chunk) {
+            auto chunkBegin = first + chunk * grainSize;
+            auto chunkEnd = first + std::min((chunk + 1) * grainSize, count);
+            std::sort(chunkBegin, chunkEnd, comp);
+        });
+
+        std::vector<Value> scratch(std::make_move_iterator(first), std::make_move_iterator(last));
+        Value *source = scratch.data();
+        std::vector<Value> target(count);
+        Value *destination = target.data();
+
+        // Widths are multiples of the grain size, so no piece crosses the boundary of a pair. Split points
+        // are found before merging, a merge moves elements out which other pieces' searches would read.
+        std::vector<std::pair<size_t, size_t>> pieceSplits(chunkCount);
+        for (size_t width = grainSize; width < count; width *= 2) {
+            auto pieceInputs = [&](size_t piece, size_t &left, size_t &middle, size_t &right) {
+                size_t pieceBegin = piece * grainSize;
+                left = pieceBegin - pieceBegin % (2 * width);
+                middle = std::min(left + width, count);
+                right = std::min(left + 2 * width, count);
+            };
+
+            For(taskSystem, 0, chunkCount, [&](size_t piece) {
+                size_t left, middle, right;
+                pieceInputs(piece, left, middle, right);
+                size_t pieceBegin = piece * grainSize - left;
+                size_t pieceEnd = std::min((piece + 1) * grainSize, count) - left;
+                const Value *a = source + left, *b = source + middle;
+                pieceSplits[piece] = {detail::CoRank(pieceBegin, a, middle - left, b, right - middle, comp),
+                                      detail::CoRank(pieceEnd, a, middle - left, b, right - middle, comp)};
+            });
+
+            For(taskSystem, 0, chunkCount, [&](size_t piece) {
+                size_t left, middle, right;
+                pieceInputs(piece, left, middle, right);
+                size_t pieceBegin = piece * grainSize;
+                size_t pieceEnd = std::min(pieceBegin + grainSize, count);
+                auto [aBegin, aEnd] = pieceSplits[piece];
+                size_t bBegin = pieceBegin - left - aBegin, bEnd = pieceEnd - left - aEnd;
+                std::merge(std::make_move_iterator(source + left + aBegin), std::make_move_iterator(source + left + aEnd),
+                           std::make_move_iterator(source + middle + bBegin),
+                           std::make_move_iterator(source + middle + bEnd),
+                           destination + pieceBegin, comp);
+            });
+            std::swap(source, destination);
+        }
+
+        Value *sorted = source;
+        For(taskSystem, 0, count, [&](size_t i) { first[i] = std::move(sorted[i]); }, grainSize);
+    }
+}
+
+
+#endif //GAME_ENGINE_PARALLEL_H
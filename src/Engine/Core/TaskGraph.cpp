@@ -0,0 +1,157 @@
+#include "TaskGraph.h"
+
+#include <stdexcept>
+#include <utility>
+
+
+TaskGraph::~TaskGraph() {
+    /// Running tasks reference the graph, it must not go away underneath them
+    if (m_TaskSystem && !m_Counter.IsDone())
+        m_TaskSystem->Wait(m_Counter);
+}
+
+
+auto TaskGraph::Add(std::string name, std::function<void()> function, const std::vector<TaskId> &predecessors)
+-> TaskId {
+    if (!m_Counter.IsDone())
+        throw std::runtime_error("[TaskGraph] Tasks can't be added while the graph is running");
+
+    auto id = static_cast<TaskId>(m_Nodes.size());
+    m_Nodes.emplace_back(std::make_unique<Node>());
+    m_Nodes.back()->name = std::move(name);
+    m_Nodes.back()->function = std::move(function);
+
+    for (TaskId predecessor : predecessors)
+        Precede(predecessor, id);
+
+    return id;
+}
+
+
+void TaskGraph::Precede(TaskId before, TaskId after) {
+    if (before >= m_Nodes.size() || after >= m_Nodes.size() || before == after)
+        throw std::runtime_error("[TaskGraph] Invalid dependency " + std::to_string(before) + " -> " +
+                                 std::to_string(after));
+
+    m_Nodes[before]->successors.push_back(after);
+    m_Nodes[after]->predecessorCount++;
+}
+
+
+auto TaskGraph::TopologicalOrder() const -> std::vector<TaskId> {
+    // Kahn's algorithm, every node has to be reachable through finished predecessors
+    std::vector<uint32_t> remaining(m_Nodes.size());
+    std::vector<TaskId> ready;
+    for (TaskId id = 0; id < m_Nodes.size(); id++) {
+        remaining[id] = m_Nodes[id]->predecessorCount;
+        if (remaining[id] == 0)
+            ready.push_back(id);
+    }
+
+    std::vector<TaskId> order;
+    order.reserve(m_Nodes.size());
+    while (!ready.empty()) {
+        TaskId id = ready.back();
+        ready.pop_back();
+        order.push_back(id);
+        for (TaskId successor : m_Nodes[id]->successors) {
+            if (--remaining[successor] == 0)
+                ready.push_back(successor);
+        }
+    }
+
+    if (order.size() != m_Nodes.size())
+        throw std::runtime_error("[TaskGraph] Dependency cycle detected");
+
+    return order;
+}
+
+
+void TaskGraph::Run(TaskSystem &taskSystem, TaskPriority priority) {
+    if (!m_Counter.IsDone())
+        throw std::runtime_error("[TaskGraph] Graph is already running");
+
+    TopologicalOrder();
+
+    m_TaskSystem = &taskSystem;
+    m_Priority = priority;
+    m_Failed.store(false, std::memory_order_relaxed);
+    m_Exception = nullptr;
+    m_StartTime = std::chrono::steady_clock::now();
+
+    for (auto &node : m_Nodes) {
+        node->pendingPredecessors.store(node->predecessorCount, std::memory_order_relaxed);
+        node->duration = {};
+    }
+
+    m_Counter.Add(m_Nodes.size());
+    for (TaskId id = 0; id < m_Nodes.size(); id++) {
+        if (m_Nodes[id]->predecessorCount == 0)
+            Schedule(id);
+    }
+}
+
+
+void TaskGraph::Schedule(TaskId id) {
+    m_TaskSystem->Spawn(m_Priority, [this, id] { Execute(id); });
+}
+
+
+void TaskGraph::Execute(TaskId id) {
+    Node &node = *m_Nodes[id];
+
+    /// After a failure the remaining tasks are only retired so that Wait() can return
+    if (!m_Failed.load(std::memory_order_relaxed)) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            node.function();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+            if (!m_Exception)
+                m_Exception = std::current_exception();
+            m_Failed.store(true, std::memory_order_relaxed);
+        }
+        node.duration = std::chrono::steady_clock::now() - start;
+    }
+
+    for (TaskId successor : node.successors) {
+        if (m_Nodes[successor]->pendingPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Schedule(successor);
+    }
+
+    m_Counter.Done();
+}
+
+
+void TaskGraph::Wait() {
+    if (!m_TaskSystem)
+        return;
+
+    m_TaskSystem->Wait(m_Counter);
+    m_WallTime = std::chrono::steady_clock::now() - m_StartTime;
+
+    std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+    if (m_Exception)
+        std::rethrow_exception(std::exchange(m_Exception, nullptr));
+}
+
+
+auto TaskGraph::TotalTaskTime() const -> std::chrono::steady_clock::duration {
+    std::chrono::steady_clock::duration total{};
+    for (const auto &node : m_Nodes)
+        total += node->duration;
+    return total;
+}
+
+
+auto TaskGraph::CriticalPathTime() const -> std::chrono::steady_clock::duration {
+    std::vector<std::chrono::steady_clock::duration> finish(m_Nodes.size());
+    std::chrono::steady_clock::duration longest{};
+    for (TaskId id : TopologicalOrder()) {
+        finish[id] += m_Nodes[id]->duration;
+        longest = std::max(longest, finish[id]);
+        for (TaskId successor : m_Nodes[id]->successors)
+            finish[successor] = std::max(finish[successor], finish[id]);
+    }
+    return longest;
+}
@@ -0,0 +1,103 @@
+#ifndef GAME_ENGINE_TASK_GRAPH_H
+#define GAME_ENGINE_TASK_GRAPH_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "TaskSystem.h"
+
+
+/**
+ * Directed acyclic graph of tasks executed on a TaskSystem. A node is submitted as soon as
+ * all of its predecessors finished, so independent branches run concurrently and the total
+ * time is bound by the critical path. Nodes can only be added while the graph isn't running.
+ */
+class TaskGraph {
+public:
+    using TaskId = uint32_t;
+
+private:
+    struct Node {
+        std::string name;
+        std::function<void()> function;
+        std::vector<TaskId> successors;
+        uint32_t predecessorCount = 0;
+        std::atomic<uint32_t> pendingPredecessors{0};
+        std::chrono::steady_clock::duration duration{};
+    };
+
+    std::vector<std::unique_ptr<Node>> m_Nodes;
+    TaskSystem *m_TaskSystem = nullptr;
+    TaskPriority m_Priority = TaskPriority::NORMAL;
+    TaskCounter m_Counter;
+    std::chrono::steady_clock::time_point m_StartTime;
+    std::chrono::steady_clock::duration m_WallTime{};
+
+    std::atomic<bool> m_Failed{false};
+    std::mutex m_ExceptionMutex;
+    std::exception_ptr m_Exception;
+
+    void Schedule(TaskId id);
+
+    void Execute(TaskId id);
+
+    /// Throws when the dependencies contain a cycle
+    auto TopologicalOrder() const -> std::vector<TaskId>;
+
+public:
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph &other) = delete;
+
+    auto operator=(const TaskGraph &other) -> TaskGraph & = delete;
+
+    ~TaskGraph();
+
+    auto Add(std::string name, std::function<void()> function, const std::vector<TaskId> &predecessors = {}) -> TaskId;
+
+    /// Adds an ordering edge between two existing tasks
+    void Precede(TaskId before, TaskId after);
+
+    /// Continuation which starts once the given task finished
+    auto Then(TaskId task, std::string name, std::function<void()> function) -> TaskId {
+        return Add(std::move(name), std::move(function), {task});
+    }
+
+    /// Continuation which starts once all of the given tasks finished
+    auto WhenAll(const std::vector<TaskId> &tasks, std::string name, std::function<void()> function) -> TaskId {
+        return Add(std::move(name), std::move(function), tasks);
+    }
+
+    /// Submits every task without predecessors, returns immediately. All nodes run in the given lane
+    void Run(TaskSystem &taskSystem, TaskPriority priority = TaskSystem::CurrentPriority());
+
+    /// Helps executing tasks until the graph finished, rethrows the first exception thrown by a task
+    void Wait();
+
+    auto IsDone() const -> bool { return m_Counter.IsDone(); }
+
+    auto TaskCount() const -> size_t { return m_Nodes.size(); }
+
+    auto TaskName(TaskId id) const -> const std::string & { return m_Nodes[id]->name; }
+
+    /// Valid after Wait(), time spent executing the task body
+    auto TaskDuration(TaskId id) const -> std::chrono::steady_clock::duration { return m_Nodes[id]->duration; }
+
+    /// Valid after Wait(), time between Run() and the graph finishing
+    auto WallTime() const -> std::chrono::steady_clock::duration { return m_WallTime; }
+
+    /// Sum of all task durations, what a serial execution of the graph would roughly cost
+    auto TotalTaskTime() const -> std::chrono::steady_clock::duration;
+
+    /// Longest chain of dependent task durations, the lower bound for WallTime()
+    auto CriticalPathTime() const -> std::chrono::steady_clock::duration;
+};
+
+
+#endif //GAME_ENGINE_TASK_GRAPH_H
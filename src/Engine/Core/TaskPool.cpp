@@ -0,0 +1,68 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+
+
+thread_local TaskPool::ThreadCache TaskPool::t_Cache;
+
+
+TaskPool::ThreadCache::~ThreadCache() {
+    if (!tasks.empty())
+        TaskPool::Get().Drain(tasks, 0);
+}
+
+
+auto TaskPool::Get() -> TaskPool & {
+    // Intentionally leaked, thread caches of detached threads may still return tasks during exit
+    static auto *pool = new TaskPool();
+    return *pool;
+}
+
+
+void TaskPool::Refill(std::vector<Task *> &cache) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_FreeTasks.empty()) {
+        m_Slabs.emplace_back(new Task[SLAB_SIZE]);
+        Task *slab = m_Slabs.back().get();
+        for (size_t i = 0; i < SLAB_SIZE; i++)
+            m_FreeTasks.push_back(&slab[i]);
+    }
+
+    size_t count = std::min(m_FreeTasks.size(), THREAD_CACHE_SIZE / 2);
+    cache.insert(cache.end(), m_FreeTasks.end() - count, m_FreeTasks.end());
+    m_FreeTasks.resize(m_FreeTasks.size() - count);
+}
+
+
+void TaskPool::Drain(std::vector<Task *> &cache, size_t keep) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeTasks.insert(m_FreeTasks.end(), cache.begin() + keep, cache.end());
+    cache.resize(keep);
+}
+
+
+auto TaskPool::Acquire() -> Task * {
+    auto &cache = t_Cache.tasks;
+    if (cache.empty()) {
+        cache.reserve(THREAD_CACHE_SIZE);
+        Refill(cache);
+    }
+
+    Task *task = cache.back();
+    cache.pop_back();
+    return task;
+}
+
+
+void TaskPool::Release(Task *task) {
+    auto &cache = t_Cache.tasks;
+    cache.push_back(task);
+    if (cache.size() >= THREAD_CACHE_SIZE)
+        Drain(cache, THREAD_CACHE_SIZE / 2);
+}
+
+
+auto TaskPool::Capacity() -> size_t {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Slabs.size() * SLAB_SIZE;
+}
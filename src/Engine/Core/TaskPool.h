@@ -0,0 +1,110 @@
+#ifndef GAME_ENGINE_TASK_POOL_H
+#define GAME_ENGINE_TASK_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Concurrency.h"
+#include "InlineFunction.h"
+
+
+class TaskCounter;
+
+
+/// Closures up to this size are stored inside the task itself, keeps a task at two cache lines
+constexpr size_t TASK_CLOSURE_SIZE = 96;
+
+
+enum class TaskPriority : uint8_t {
+    /// Work the current frame waits for, always picked first
+    FRAME_CRITICAL,
+    NORMAL,
+    /// Streaming and other long jobs, not started while a frame deadline is near
+    BACKGROUND
+};
+
+constexpr size_t TASK_PRIORITY_COUNT = 3;
+
+
+struct alignas(CACHE_LINE_SIZE) Task {
+    InlineFunction<void(), TASK_CLOSURE_SIZE> function;
+    /// Optional group the task reports its completion to
+    TaskCounter *counter = nullptr;
+    /// Bumped every time the task finishes, handles compare it with the value captured at submission
+    std::atomic<uint32_t> generation{0};
+    /// Microseconds, wraps around, only the difference to the start time is used for queue latency
+    uint32_t submitTimeUs = 0;
+};
+
+static_assert(sizeof(Task) == 2 * CACHE_LINE_SIZE, "[Task] Task grew beyond two cache lines");
+
+
+/**
+ * Refers to a submitted task without owning it. Tasks are recycled, so completion is detected
+ * through the generation counter instead of a shared state; the handle stays valid (and reports
+ * completion) after the task's memory has been reused.
+ */
+class TaskHandle {
+    const Task *m_Task = nullptr;
+    uint32_t m_Generation = 0;
+
+public:
+    TaskHandle() = default;
+
+    TaskHandle(const Task *task, uint32_t generation) : m_Task(task), m_Generation(generation) {}
+
+    auto IsValid() const -> bool { return m_Task != nullptr; }
+
+    auto IsDone() const -> bool {
+        return !m_Task || m_Task->generation.load(std::memory_order_acquire) != m_Generation;
+    }
+};
+
+
+/**
+ * Recycles Task objects so that submitting doesn't touch the global allocator. Every thread keeps
+ * a small private cache, batches move between the caches and a shared free list, which handles
+ * tasks being created on one thread and finished on another. Memory is only returned on exit.
+ */
+class TaskPool {
+    constexpr static size_t SLAB_SIZE = 512;
+    constexpr static size_t THREAD_CACHE_SIZE = 128;
+
+    struct ThreadCache {
+        std::vector<Task *> tasks;
+
+        ~ThreadCache();
+    };
+
+    static thread_local ThreadCache t_Cache;
+
+    std::mutex m_Mutex;
+    std::vector<std::unique_ptr<Task[]>> m_Slabs;
+    std::vector<Task *> m_FreeTasks;
+
+    TaskPool() = default;
+
+    void Refill(std::vector<Task *> &cache);
+
+    void Drain(std::vector<Task *> &cache, size_t keep);
+
+public:
+    TaskPool(const TaskPool &other) = delete;
+
+    auto operator=(const TaskPool &other) -> TaskPool & = delete;
+
+    static auto Get() -> TaskPool &;
+
+    auto Acquire() -> Task *;
+
+    void Release(Task *task);
+
+    /// Number of tasks ever allocated, only grows when more tasks are in flight than before
+    auto Capacity() -> size_t;
+};
+
+
+#endif //GAME_ENGINE_TASK_POOL_H
@@ -0,0 +1,137 @@
+#include "TaskProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+
+void TaskTraceRing::Push(const TaskTraceEvent &event) {
+    uint64_t head = m_Head.load(std::memory_order_relaxed);
+    // Readers which see any part of this write are guaranteed to see the head up to this slot
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Slot &slot = m_Slots[head & (CAPACITY - 1)];
+    slot.beginNs.store(event.beginNs, std::memory_order_relaxed);
+    slot.endNs.store(event.endNs, std::memory_order_relaxed);
+    slot.info.store(static_cast<uint64_t>(event.kind) | (static_cast<uint64_t>(event.priority) << 8u) |
+                    (uint64_t(event.queueDepth) << 16u), std::memory_order_relaxed);
+    m_Head.store(head + 1, std::memory_order_release);
+}
+
+
+auto TaskTraceRing::Read(std::vector<TaskTraceEvent> &events, uint64_t since) const -> uint64_t {
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    uint64_t first = std::max(since, head > CAPACITY ? head - CAPACITY : 0);
+
+    size_t start = events.size();
+    for (uint64_t i = first; i < head; i++) {
+        const Slot &slot = m_Slots[i & (CAPACITY - 1)];
+        uint64_t info = slot.info.load(std::memory_order_relaxed);
+        TaskTraceEvent event;
+        event.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+        event.endNs = slot.endNs.load(std::memory_order_relaxed);
+        event.kind = static_cast<TaskTraceKind>(info & 0xFFu);
+        event.priority = static_cast<TaskPriority>((info >> 8u) & 0xFFu);
+        event.queueDepth = static_cast<uint32_t>(info >> 16u);
+        events.push_back(event);
+    }
+
+    // Slot i may have been torn by the write of event i + CAPACITY, which is at most the current head
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t latest = m_Head.load(std::memory_order_relaxed);
+    if (latest >= CAPACITY && latest - CAPACITY + 1 > first) {
+        uint64_t torn = std::min(latest - CAPACITY + 1, head) - first;
+        events.erase(events.begin() + start, events.begin() + start + torn);
+    }
+    return head;
+}
+
+
+TaskProfiler::TaskProfiler(unsigned workerCount) {
+    m_Workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(std::make_unique<Worker>());
+}
+
+
+void TaskProfiler::RecordTask(unsigned worker, uint64_t beginNs, uint64_t endNs, TaskPriority priority,
+                              uint32_t queueDepth, bool nested) {
+    Worker &w = *m_Workers[worker];
+    uint64_t duration = endNs - beginNs;
+    Accumulate(w.tasks, 1);
+    if (!nested)
+        Accumulate(w.busyNs, duration);
+    KeepMax(w.maxTaskNs, duration);
+    w.queueDepth.store(queueDepth, std::memory_order_relaxed);
+    KeepMax(w.maxQueueDepth, queueDepth);
+    w.trace.Push({beginNs, endNs, TaskTraceKind::TASK, priority, queueDepth});
+}
+
+
+void TaskProfiler::RecordIdle(unsigned worker, TaskTraceKind kind, uint64_t beginNs, uint64_t endNs) {
+    Worker &w = *m_Workers[worker];
+    Accumulate(kind == TaskTraceKind::PARK ? w.parkNs : w.spinNs, endNs - beginNs);
+    w.trace.Push({beginNs, endNs, kind, TaskPriority::NORMAL, 0});
+}
+
+
+auto TaskProfiler::GetWorkerStats(unsigned worker) const -> WorkerStats {
+    const Worker &w = *m_Workers[worker];
+    WorkerStats stats;
+    stats.tasks = w.tasks.load(std::memory_order_relaxed);
+    stats.steals = w.steals.load(std::memory_order_relaxed);
+    stats.failedSteals = w.failedSteals.load(std::memory_order_relaxed);
+    stats.busyNs = w.busyNs.load(std::memory_order_relaxed);
+    stats.spinNs = w.spinNs.load(std::memory_order_relaxed);
+    stats.parkNs = w.parkNs.load(std::memory_order_relaxed);
+    stats.queueDepth = w.queueDepth.load(std::memory_order_relaxed);
+    stats.maxQueueDepth = w.maxQueueDepth.load(std::memory_order_relaxed);
+    stats.maxTaskNs = w.maxTaskNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+
+void TaskProfiler::ExportChromeTrace(std::ostream &out) const {
+    static const char *s_TaskNames[] = {"Frame-critical task", "Task", "Background task"};
+    static const char *s_IdleNames[] = {"", "Spin", "Park"};
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    // Trace-event timestamps are in microseconds, three decimals keep the nanosecond resolution
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<TaskTraceEvent> events;
+    for (unsigned worker = 0; worker < WorkerCount(); worker++) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << worker
+            << ",\"args\":{\"name\":\"Worker " << worker << "\"}}";
+        first = false;
+
+        events.clear();
+        m_Workers[worker]->trace.Read(events);
+        for (const auto &event : events) {
+            bool isTask = event.kind == TaskTraceKind::TASK;
+            out << ",\n{\"name\":\"" << (isTask ? s_TaskNames[static_cast<size_t>(event.priority)]
+                                                 : s_IdleNames[static_cast<size_t>(event.kind)])
+                << "\",\"cat\":\"" << (isTask ? "task" : "idle")
+                << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << worker
+                << ",\"ts\":" << event.beginNs / 1000.0 << ",\"dur\":" << (event.endNs - event.beginNs) / 1000.0;
+            if (isTask)
+                out << ",\"args\":{\"queueDepth\":" << event.queueDepth << "}";
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+
+auto TaskProfiler::ExportChromeTrace(const std::string &filepath) const -> bool {
+    std::ofstream file(filepath);
+    if (!file)
+        return false;
+    ExportChromeTrace(file);
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,154 @@
+#ifndef GAME_ENGINE_TASK_PROFILER_H
+#define GAME_ENGINE_TASK_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Concurrency.h"
+#include "TaskPool.h"
+
+
+enum class TaskTraceKind : uint8_t {
+    TASK,
+    /// Worker is looking for work without sleeping
+    SPIN,
+    /// Worker sleeps on the idle EventCount
+    PARK
+};
+
+
+struct TaskTraceEvent {
+    /// Nanoseconds since the profiler was created
+    uint64_t beginNs = 0;
+    uint64_t endNs = 0;
+    TaskTraceKind kind = TaskTraceKind::TASK;
+    TaskPriority priority = TaskPriority::NORMAL;
+    /// Size of the worker's own deque when the task started
+    uint32_t queueDepth = 0;
+};
+
+
+/**
+ * Fixed-size trace ring with a single writer (the owning worker) and any number of readers.
+ * The writer never waits, old events are overwritten. Readers copy the slots and afterwards
+ * discard everything the writer could have been overwriting meanwhile, the same idea as a seqlock.
+ */
+class TaskTraceRing {
+public:
+    constexpr static uint64_t CAPACITY = 4096;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> beginNs{0};
+        std::atomic<uint64_t> endNs{0};
+        /// Kind in the low byte, priority in the next one, queue depth above them
+        std::atomic<uint64_t> info{0};
+    };
+
+    std::unique_ptr<Slot[]> m_Slots{new Slot[CAPACITY]};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_Head{0};
+
+public:
+    void Push(const TaskTraceEvent &event);
+
+    /// Appends the events recorded since the given position and returns the position to continue from
+    auto Read(std::vector<TaskTraceEvent> &events, uint64_t since = 0) const -> uint64_t;
+};
+
+
+/**
+ * Optional instrumentation of TaskSystem workers. Disabled by default, the workers then only pay
+ * for one relaxed load per scheduling decision. Counters are cumulative and written by their worker
+ * only, utilization is derived by sampling them twice.
+ */
+class TaskProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct WorkerStats {
+        uint64_t tasks = 0;
+        uint64_t steals = 0;
+        /// Victims which had nothing to steal or lost the race for their last task
+        uint64_t failedSteals = 0;
+        /// Time spent in top-level tasks, tasks run while waiting inside another task aren't counted twice
+        uint64_t busyNs = 0;
+        uint64_t spinNs = 0;
+        uint64_t parkNs = 0;
+        uint32_t queueDepth = 0;
+        uint32_t maxQueueDepth = 0;
+        /// Longest task so far, a hint at tasks which should have been split
+        uint64_t maxTaskNs = 0;
+    };
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        TaskTraceRing trace;
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> failedSteals{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> spinNs{0};
+        std::atomic<uint64_t> parkNs{0};
+        std::atomic<uint32_t> queueDepth{0};
+        std::atomic<uint32_t> maxQueueDepth{0};
+        std::atomic<uint64_t> maxTaskNs{0};
+    };
+
+    const Clock::time_point m_Epoch = Clock::now();
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::atomic<bool> m_Enabled{false};
+
+    /// Only the owning worker writes, a plain load and store is enough
+    static void Accumulate(std::atomic<uint64_t> &counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    static void KeepMax(std::atomic<T> &counter, T value) {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+public:
+    explicit TaskProfiler(unsigned workerCount);
+
+    TaskProfiler(const TaskProfiler &other) = delete;
+
+    auto operator=(const TaskProfiler &other) -> TaskProfiler & = delete;
+
+    void SetEnabled(bool enabled) { m_Enabled.store(enabled, std::memory_order_relaxed); }
+
+    auto IsEnabled() const -> bool { return m_Enabled.load(std::memory_order_relaxed); }
+
+    auto Now() const -> uint64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_Epoch).count();
+    }
+
+    auto WorkerCount() const -> unsigned { return static_cast<unsigned>(m_Workers.size()); }
+
+    /// Nested tasks still show up in the trace but don't add to the busy time
+    void RecordTask(unsigned worker, uint64_t beginNs, uint64_t endNs, TaskPriority priority, uint32_t queueDepth,
+                    bool nested);
+
+    void RecordIdle(unsigned worker, TaskTraceKind kind, uint64_t beginNs, uint64_t endNs);
+
+    void RecordSteal(unsigned worker, bool success) {
+        Worker &w = *m_Workers[worker];
+        Accumulate(success ? w.steals : w.failedSteals, 1);
+    }
+
+    auto GetWorkerStats(unsigned worker) const -> WorkerStats;
+
+    /// Chrome trace-event JSON (chrome://tracing, Perfetto) of whatever the rings still hold
+    void ExportChromeTrace(std::ostream &out) const;
+
+    auto ExportChromeTrace(const std::string &filepath) const -> bool;
+};
+
+
+#endif //GAME_ENGINE_TASK_PROFILER_H
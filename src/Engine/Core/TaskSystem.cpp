@@ -0,0 +1,311 @@
+#include "TaskSystem.h"
+
+#include <algorithm>
+
+#include "Logger.h"
+
+
+thread_local TaskSystem *TaskSystem::t_Owner = nullptr;
+thread_local unsigned TaskSystem::t_WorkerIndex = 0;
+thread_local unsigned TaskSystem::t_TaskDepth = 0;
+thread_local TaskPriority TaskSystem::t_Priority = TaskPriority::NORMAL;
+thread_local unsigned TaskSystem::t_BlockingWaits = 0;
+
+
+TaskSystem::TaskSystem(unsigned threadCount) : TaskSystem(std::vector<CpuSet>(std::max(threadCount, 1u))) {}
+
+
+TaskSystem::TaskSystem(const std::vector<CpuSet> &workerAffinity)
+        : m_ThreadCount(std::max(static_cast<unsigned>(workerAffinity.size()), 1u)), m_Profiler(m_ThreadCount) {
+    m_Workers.reserve(m_ThreadCount);
+    for (unsigned i = 0; i < m_ThreadCount; ++i) {
+        m_Workers.emplace_back(std::make_unique<Worker>());
+        m_Workers.back()->randomState = 0x9E3779B9u * (i + 1);
+        if (i < workerAffinity.size())
+            m_Workers.back()->affinity = workerAffinity[i];
+    }
+
+    /// Threads are started only after every queue exists, workers steal from each other right away
+    for (unsigned i = 0; i < m_ThreadCount; ++i) {
+        m_Workers[i]->thread = std::thread([this, i] { Run(i); });
+    }
+}
+
+
+TaskSystem::~TaskSystem() {
+    m_Done.store(true, std::memory_order_seq_cst);
+    m_Idle.NotifyAll();
+    for (auto &worker : m_Workers)
+        worker->thread.join();
+}
+
+
+void TaskSystem::Submit(Task *task, TaskPriority priority) {
+    auto lane = static_cast<size_t>(priority);
+    task->submitTimeUs = NowUs();
+    if (t_Owner == this) {
+        m_Workers[t_WorkerIndex]->queues[lane].Push(task);
+    } else {
+        /// Injection queue is full, help draining it instead of blocking the producer
+        while (!m_InjectionQueues[lane].TryPush(task)) {
+            if (!TryRunPendingTask())
+                std::this_thread::yield();
+        }
+    }
+    m_Idle.NotifyOne();
+}
+
+
+void TaskSystem::Execute(Task *task) {
+    try {
+        task->function();
+    } catch (const std::exception &e) {
+        LOG_ERROR("[TaskSystem] Task failed: {}", e.what());
+    } catch (...) {
+        LOG_ERROR("[TaskSystem] Task failed");
+    }
+
+    // Closure goes first, waiters may tear down whatever it references once they are notified
+    task->function.Reset();
+    TaskCounter *counter = task->counter;
+    task->generation.fetch_add(1, std::memory_order_release);
+    if (counter)
+        counter->Done();
+
+    TaskPool::Get().Release(task);
+}
+
+
+void TaskSystem::RecordLatency(TaskPriority priority, uint32_t latencyUs) {
+    auto lane = static_cast<size_t>(priority);
+    if (t_Owner == this) {
+        // Single writer, no read-modify-write needed
+        LaneCounters &counters = m_Workers[t_WorkerIndex]->counters[lane];
+        counters.executed.store(counters.executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.latencyUs.store(counters.latencyUs.load(std::memory_order_relaxed) + latencyUs, std::memory_order_relaxed);
+        if (latencyUs > counters.maxLatencyUs.load(std::memory_order_relaxed))
+            counters.maxLatencyUs.store(latencyUs, std::memory_order_relaxed);
+    } else {
+        LaneCounters &counters = m_ExternalCounters[lane];
+        counters.executed.fetch_add(1, std::memory_order_relaxed);
+        counters.latencyUs.fetch_add(latencyUs, std::memory_order_relaxed);
+        uint64_t max = counters.maxLatencyUs.load(std::memory_order_relaxed);
+        while (latencyUs > max && !counters.maxLatencyUs.compare_exchange_weak(max, latencyUs, std::memory_order_relaxed)) {}
+    }
+}
+
+
+void TaskSystem::RunTask(Task *task, TaskPriority priority) {
+    // Unsigned difference stays correct across the wrap-around of the microsecond clock
+    RecordLatency(priority, NowUs() - task->submitTimeUs);
+
+    // Tasks spawned from this one default to its priority
+    TaskPriority previousPriority = t_Priority;
+    t_Priority = priority;
+
+    if (t_Owner != this) {
+        Execute(task);
+        t_Priority = previousPriority;
+        return;
+    }
+
+    // Depth is tracked even while disabled so that enabling mid-task doesn't count nested tasks as busy time
+    bool nested = t_TaskDepth++ > 0;
+    if (m_Profiler.IsEnabled()) {
+        auto lane = static_cast<size_t>(priority);
+        auto queueDepth = static_cast<uint32_t>(m_Workers[t_WorkerIndex]->queues[lane].Size());
+        uint64_t begin = m_Profiler.Now();
+        Execute(task);
+        m_Profiler.RecordTask(t_WorkerIndex, begin, m_Profiler.Now(), priority, queueDepth, nested);
+    } else {
+        Execute(task);
+    }
+    t_TaskDepth--;
+    t_Priority = previousPriority;
+}
+
+
+auto TaskSystem::StealTask(Worker *self, TaskPriority priority) -> Task * {
+    auto lane = static_cast<size_t>(priority);
+    bool profiling = self && m_Profiler.IsEnabled();
+    unsigned start = 0;
+    if (self) {
+        // xorshift32, cheap per-worker victim randomization
+        uint32_t x = self->randomState;
+        x ^= x << 13u;
+        x ^= x >> 17u;
+        x ^= x << 5u;
+        self->randomState = x;
+        start = x % m_ThreadCount;
+    }
+
+    for (unsigned i = 0; i < m_ThreadCount; ++i) {
+        Worker *victim = m_Workers[(start + i) % m_ThreadCount].get();
+        if (victim == self)
+            continue;
+
+        Task *task = victim->queues[lane].Steal();
+        if (profiling)
+            m_Profiler.RecordSteal(t_WorkerIndex, task != nullptr);
+        if (task)
+            return task;
+    }
+    return nullptr;
+}
+
+
+auto TaskSystem::FindTask(Worker *self, TaskPriority &priority, TaskPriority lowest) -> Task * {
+    for (size_t lane = 0; lane <= static_cast<size_t>(lowest); lane++) {
+        priority = static_cast<TaskPriority>(lane);
+        // Shutting down drains every lane, queued background work must not be lost
+        if (priority == TaskPriority::BACKGROUND && IsBackgroundThrottled() &&
+            !m_Done.load(std::memory_order_relaxed))
+            break;
+
+        Task *task = nullptr;
+        if (self && (task = self->queues[lane].Pop()))
+            return task;
+
+        if (m_InjectionQueues[lane].TryPop(task))
+            return task;
+
+        if ((task = StealTask(self, priority)))
+            return task;
+    }
+    return nullptr;
+}
+
+
+void TaskSystem::SetFrameDeadline(Clock::time_point deadline) {
+    m_FrameDeadlineNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count(),
+                            std::memory_order_relaxed);
+}
+
+
+auto TaskSystem::IsBackgroundThrottled() const -> bool {
+    int64_t deadline = m_FrameDeadlineNs.load(std::memory_order_relaxed);
+    if (deadline == 0)
+        return false;
+
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    return now < deadline && now >= deadline - m_ThrottleWindowNs.load(std::memory_order_relaxed);
+}
+
+
+auto TaskSystem::GetLaneStats(TaskPriority priority) const -> LaneStats {
+    auto lane = static_cast<size_t>(priority);
+    LaneStats stats;
+    auto accumulate = [&stats](const LaneCounters &counters) {
+        stats.executed += counters.executed.load(std::memory_order_relaxed);
+        stats.totalLatencyUs += counters.latencyUs.load(std::memory_order_relaxed);
+        stats.maxLatencyUs = std::max(stats.maxLatencyUs, counters.maxLatencyUs.load(std::memory_order_relaxed));
+    };
+
+    accumulate(m_ExternalCounters[lane]);
+    stats.queued = m_InjectionQueues[lane].Size();
+    for (const auto &worker : m_Workers) {
+        accumulate(worker->counters[lane]);
+        stats.queued += std::max<int64_t>(worker->queues[lane].Size(), 0);
+    }
+    return stats;
+}
+
+
+auto TaskSystem::TryRunPendingTask(TaskPriority lowest) -> bool {
+    Worker *self = (t_Owner == this) ? m_Workers[t_WorkerIndex].get() : nullptr;
+    TaskPriority priority;
+    if (Task *task = FindTask(self, priority, lowest)) {
+        RunTask(task, priority);
+        return true;
+    }
+    return false;
+}
+
+
+auto TaskSystem::GetExternalWaitStats() const -> ExternalWaitStats {
+    ExternalWaitStats stats;
+    stats.waits = m_ExternalWaits.load(std::memory_order_relaxed);
+    stats.waitNs = m_ExternalWaitNs.load(std::memory_order_relaxed);
+    stats.tasks = m_ExternalWaitTasks.load(std::memory_order_relaxed);
+    stats.recoveredNs = m_ExternalWaitRecoveredNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+
+template<typename Predicate>
+void TaskSystem::WaitUntil(const Predicate &isDone) {
+    unsigned idleRounds = 0;
+    while (!isDone()) {
+        if (TryRunPendingTask()) {
+            idleRounds = 0;
+        } else if (++idleRounds < SPIN_ROUNDS) {
+            CpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+void TaskSystem::Wait(const TaskCounter &counter) {
+    WaitUntil([&counter] { return counter.IsDone(); });
+}
+
+
+void TaskSystem::Wait(const TaskHandle &handle) {
+    WaitUntil([&handle] { return handle.IsDone(); });
+}
+
+
+void TaskSystem::Run(unsigned workerIdx) {
+    t_Owner = this;
+    t_WorkerIndex = workerIdx;
+    Worker *self = m_Workers[workerIdx].get();
+    if (!ThreadAffinity::Apply(self->affinity))
+        LOG_WARNING("[TaskSystem] Failed to set the affinity of worker {}", workerIdx);
+
+    while (true) {
+        TaskPriority priority;
+        Task *task = FindTask(self, priority);
+        if (!task) {
+            bool profiling = m_Profiler.IsEnabled();
+            uint64_t spinStart = profiling ? m_Profiler.Now() : 0;
+            for (unsigned round = 0; !task && round < SPIN_ROUNDS; ++round) {
+                CpuRelax();
+                task = FindTask(self, priority);
+            }
+
+            if (!task) {
+                uint64_t epoch = m_Idle.PrepareWait();
+                /// Re-check after announcing ourselves, a producer might have pushed in between
+                if ((task = FindTask(self, priority))) {
+                    m_Idle.CancelWait();
+                } else if (m_Done.load(std::memory_order_seq_cst)) {
+                    m_Idle.CancelWait();
+                    break;
+                } else {
+                    uint64_t parkStart = profiling ? m_Profiler.Now() : 0;
+                    // Held-back background work becomes runnable at the deadline without anyone notifying
+                    if (IsBackgroundThrottled()) {
+                        auto deadline = Clock::time_point(std::chrono::nanoseconds(m_FrameDeadlineNs.load(std::memory_order_relaxed)));
+                        m_Idle.WaitUntil(epoch, deadline);
+                    } else {
+                        m_Idle.Wait(epoch);
+                    }
+                    if (profiling) {
+                        m_Profiler.RecordIdle(workerIdx, TaskTraceKind::SPIN, spinStart, parkStart);
+                        m_Profiler.RecordIdle(workerIdx, TaskTraceKind::PARK, parkStart, m_Profiler.Now());
+                    }
+                    continue;
+                }
+            }
+
+            if (profiling)
+                m_Profiler.RecordIdle(workerIdx, TaskTraceKind::SPIN, spinStart, m_Profiler.Now());
+        }
+
+        RunTask(task, priority);
+    }
+
+    t_Owner = nullptr;
+}
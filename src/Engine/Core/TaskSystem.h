@@ -0,0 +1,302 @@
+#ifndef GAME_ENGINE_TASK_SYSTEM_H
+#define GAME_ENGINE_TASK_SYSTEM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Concurrency.h"
+#include "CpuTopology.h"
+#include "TaskProfiler.h"
+#include "TaskPool.h"
+#include "WorkStealingQueue.h"
+
+
+/**
+ * Counts outstanding tasks, lets a caller wait for a whole group instead of collecting
+ * one handle per task. Waiting is done through TaskSystem::Wait() which keeps executing
+ * other tasks in the meantime.
+ */
+class TaskCounter {
+    std::atomic<uint32_t> m_Pending{0};
+
+public:
+    TaskCounter() = default;
+
+    TaskCounter(const TaskCounter &other) = delete;
+
+    auto operator=(const TaskCounter &other) -> TaskCounter & = delete;
+
+    void Add(uint32_t count = 1) { m_Pending.fetch_add(count, std::memory_order_relaxed); }
+
+    void Done() { m_Pending.fetch_sub(1, std::memory_order_acq_rel); }
+
+    auto Pending() const -> uint32_t { return m_Pending.load(std::memory_order_acquire); }
+
+    auto IsDone() const -> bool { return Pending() == 0; }
+};
+
+
+/**
+ * Work-stealing scheduler. Every worker owns a Chase-Lev deque per priority lane, tasks spawned
+ * from a worker go to its own deque (lock-free, LIFO for locality), tasks coming from other threads
+ * go through a shared lock-free injection queue of their lane. Idle workers steal from random
+ * victims, spin for a short while and then park on an EventCount.
+ *
+ * Lanes are searched in priority order, frame-critical work anywhere in the system is picked before
+ * normal work. Background tasks aren't started within the throttle window before the frame deadline,
+ * running ones finish undisturbed. Tasks spawned without an explicit priority inherit the priority
+ * of the task (or PriorityScope) they are spawned from.
+ *
+ * Tasks come from a recycled pool and keep their closure inline, submitting doesn't allocate.
+ * Exceptions can't travel through a handle, a throwing task is logged as an error.
+ */
+class TaskSystem {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct LaneStats {
+        uint64_t executed = 0;
+        /// Tasks waiting in the lane's deques and injection queue
+        uint64_t queued = 0;
+        /// Sum of the time between submission and start, divide by executed for the average
+        uint64_t totalLatencyUs = 0;
+        uint64_t maxLatencyUs = 0;
+    };
+
+    /// Cumulative over all WaitExternal() calls
+    struct ExternalWaitStats {
+        uint64_t waits = 0;
+        uint64_t waitNs = 0;
+        /// Tasks executed by waiting threads and the time they took, work which would otherwise be lost to blocking
+        uint64_t tasks = 0;
+        uint64_t recoveredNs = 0;
+    };
+
+    /// Sets the default priority of tasks submitted by the current thread for the scope's lifetime
+    class PriorityScope {
+        TaskPriority m_Previous;
+
+    public:
+        explicit PriorityScope(TaskPriority priority) : m_Previous(t_Priority) { t_Priority = priority; }
+
+        PriorityScope(const PriorityScope &other) = delete;
+
+        auto operator=(const PriorityScope &other) -> PriorityScope & = delete;
+
+        ~PriorityScope() { t_Priority = m_Previous; }
+    };
+
+    /**
+     * Makes WaitExternal() on the current thread block instead of running pending tasks for the scope's
+     * lifetime. For code owning a result other tasks may wait for, a task run inline could end up waiting
+     * for its own caller.
+     */
+    class BlockingWaitScope {
+    public:
+        BlockingWaitScope() { t_BlockingWaits++; }
+
+        BlockingWaitScope(const BlockingWaitScope &other) = delete;
+
+        auto operator=(const BlockingWaitScope &other) -> BlockingWaitScope & = delete;
+
+        ~BlockingWaitScope() { t_BlockingWaits--; }
+    };
+
+private:
+    /// Written by a single worker, except for the shared slot of non-worker threads
+    struct LaneCounters {
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> latencyUs{0};
+        std::atomic<uint64_t> maxLatencyUs{0};
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        std::array<WorkStealingQueue<Task *>, TASK_PRIORITY_COUNT> queues;
+        std::array<LaneCounters, TASK_PRIORITY_COUNT> counters;
+        std::thread thread;
+        CpuSet affinity;
+        uint32_t randomState = 0;
+    };
+
+    /// How many rounds an idle worker keeps looking for work before it parks
+    constexpr static unsigned SPIN_ROUNDS = 64;
+    constexpr static uint64_t INJECTION_QUEUE_CAPACITY = 4096;
+    constexpr static std::chrono::nanoseconds DEFAULT_THROTTLE_WINDOW = std::chrono::milliseconds(2);
+    /// How long WaitExternal() blocks in the poll when there's no task to run, bounds the delay of new tasks
+    constexpr static std::chrono::nanoseconds EXTERNAL_POLL_TIMEOUT = std::chrono::microseconds(100);
+
+    static thread_local TaskSystem *t_Owner;
+    static thread_local unsigned t_WorkerIndex;
+    /// Tasks currently executing on this worker, more than one while a task waits for others
+    static thread_local unsigned t_TaskDepth;
+    /// Inherited by tasks submitted without an explicit priority
+    static thread_local TaskPriority t_Priority;
+    /// Open BlockingWaitScopes of this thread
+    static thread_local unsigned t_BlockingWaits;
+
+    const unsigned m_ThreadCount;
+    TaskProfiler m_Profiler;
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::array<BoundedQueue<Task *>, TASK_PRIORITY_COUNT> m_InjectionQueues{
+            BoundedQueue<Task *>(INJECTION_QUEUE_CAPACITY),
+            BoundedQueue<Task *>(INJECTION_QUEUE_CAPACITY),
+            BoundedQueue<Task *>(INJECTION_QUEUE_CAPACITY)};
+    std::array<LaneCounters, TASK_PRIORITY_COUNT> m_ExternalCounters;
+    EventCount m_Idle;
+    std::atomic<bool> m_Done{false};
+
+    /// Nanoseconds on Clock, zero while no deadline is set
+    std::atomic<int64_t> m_FrameDeadlineNs{0};
+    std::atomic<int64_t> m_ThrottleWindowNs{DEFAULT_THROTTLE_WINDOW.count()};
+
+    std::atomic<uint64_t> m_ExternalWaits{0};
+    std::atomic<uint64_t> m_ExternalWaitNs{0};
+    std::atomic<uint64_t> m_ExternalWaitTasks{0};
+    std::atomic<uint64_t> m_ExternalWaitRecoveredNs{0};
+
+    void Run(unsigned workerIdx);
+
+    void Submit(Task *task, TaskPriority priority);
+
+    /// Lanes below the lowest priority aren't searched
+    auto FindTask(Worker *self, TaskPriority &priority, TaskPriority lowest = TaskPriority::BACKGROUND) -> Task *;
+
+    auto StealTask(Worker *self, TaskPriority priority) -> Task *;
+
+    /// Execute() plus latency accounting, priority inheritance and instrumentation
+    void RunTask(Task *task, TaskPriority priority);
+
+    void RecordLatency(TaskPriority priority, uint32_t latencyUs);
+
+    static void Execute(Task *task);
+
+    static auto NowUs() -> uint32_t {
+        return static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+    }
+
+    template<typename F>
+    static auto CreateTask(F &&f, TaskCounter *counter) -> Task * {
+        Task *task = TaskPool::Get().Acquire();
+        task->function.Emplace(std::forward<F>(f));
+        task->counter = counter;
+        return task;
+    }
+
+    template<typename Predicate>
+    void WaitUntil(const Predicate &isDone);
+
+public:
+    explicit TaskSystem(unsigned threadCount = std::thread::hardware_concurrency());
+
+    /// One worker per entry, each bound to its CPU set (see ThreadPlacement)
+    explicit TaskSystem(const std::vector<CpuSet> &workerAffinity);
+
+    TaskSystem(const TaskSystem &other) = delete;
+
+    auto operator=(const TaskSystem &other) -> TaskSystem & = delete;
+
+    ~TaskSystem();
+
+    template<typename F>
+    auto Async(TaskPriority priority, F &&f) -> TaskHandle {
+        Task *task = CreateTask(std::forward<F>(f), nullptr);
+        TaskHandle handle(task, task->generation.load(std::memory_order_relaxed));
+        Submit(task, priority);
+        return handle;
+    }
+
+    template<typename F>
+    auto Async(F &&f) -> TaskHandle { return Async(t_Priority, std::forward<F>(f)); }
+
+    /// Fire-and-forget
+    template<typename F>
+    void Spawn(TaskPriority priority, F &&f) {
+        Submit(CreateTask(std::forward<F>(f), nullptr), priority);
+    }
+
+    template<typename F>
+    void Spawn(F &&f) { Spawn(t_Priority, std::forward<F>(f)); }
+
+    /// Counter is decremented once the function finishes, even if it throws
+    template<typename F>
+    void Spawn(TaskPriority priority, TaskCounter &counter, F &&f) {
+        counter.Add();
+        Submit(CreateTask(std::forward<F>(f), &counter), priority);
+    }
+
+    template<typename F>
+    void Spawn(TaskCounter &counter, F &&f) { Spawn(t_Priority, counter, std::forward<F>(f)); }
+
+    /// Blocks until the counter reaches zero, runs pending tasks while waiting
+    void Wait(const TaskCounter &counter);
+
+    /// Blocks until the task finished, runs pending tasks while waiting
+    void Wait(const TaskHandle &handle);
+
+    /// Runs one pending task on the calling thread, lets waiting threads help instead of blocking
+    auto TryRunPendingTask(TaskPriority lowest = TaskPriority::BACKGROUND) -> bool;
+
+    /**
+     * Blocks until an event outside of the task system happens (a GPU fence, ...) and runs pending
+     * tasks of the given lanes meanwhile. The poll takes a timeout in nanoseconds and returns true
+     * once the event happened, it's first called with zero and only blocks when there is nothing
+     * to run. A task started right before the event happens delays the waiter by its length,
+     * latency-sensitive callers should leave out lanes with long tasks.
+     */
+    template<typename Poll>
+    void WaitExternal(const Poll &isSignalled, TaskPriority lowest = TaskPriority::BACKGROUND) {
+        auto start = Clock::now();
+        uint64_t tasks = 0;
+        Clock::duration recovered{};
+        while (!isSignalled(uint64_t(0))) {
+            auto taskStart = Clock::now();
+            if (t_BlockingWaits == 0 && TryRunPendingTask(lowest)) {
+                tasks++;
+                recovered += Clock::now() - taskStart;
+            } else if (isSignalled(static_cast<uint64_t>(EXTERNAL_POLL_TIMEOUT.count()))) {
+                break;
+            }
+        }
+
+        m_ExternalWaits.fetch_add(1, std::memory_order_relaxed);
+        m_ExternalWaitNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+                                   std::memory_order_relaxed);
+        if (tasks > 0) {
+            m_ExternalWaitTasks.fetch_add(tasks, std::memory_order_relaxed);
+            m_ExternalWaitRecoveredNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(recovered).count(),
+                                                std::memory_order_relaxed);
+        }
+    }
+
+    auto GetExternalWaitStats() const -> ExternalWaitStats;
+
+    /// Background tasks aren't started during the throttle window preceding the deadline
+    void SetFrameDeadline(Clock::time_point deadline);
+
+    void SetThrottleWindow(std::chrono::nanoseconds window) { m_ThrottleWindowNs.store(window.count(), std::memory_order_relaxed); }
+
+    auto IsBackgroundThrottled() const -> bool;
+
+    auto GetLaneStats(TaskPriority priority) const -> LaneStats;
+
+    auto ThreadCount() const -> unsigned { return m_ThreadCount; }
+
+    /// True when called from one of this system's workers
+    auto IsWorkerThread() const -> bool { return t_Owner == this; }
+
+    /// Priority new tasks from the calling thread get by default
+    static auto CurrentPriority() -> TaskPriority { return t_Priority; }
+
+    auto GetProfiler() -> TaskProfiler & { return m_Profiler; }
+
+    auto GetProfiler() const -> const TaskProfiler & { return m_Profiler; }
+};
+
+
+#endif //GAME_ENGINE_TASK_SYSTEM_H
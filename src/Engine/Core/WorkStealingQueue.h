@@ -0,0 +1,126 @@
+#ifndef GAME_ENGINE_WORK_STEALING_QUEUE_H
+#define GAME_ENGINE_WORK_STEALING_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "Concurrency.h"
+
+
+/**
+ * Chase-Lev work-stealing deque (memory orderings follow Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models"). Only the owning thread may call Push() and Pop(),
+ * any thread may call Steal(). Stores raw pointers, nullptr is reserved for "no item".
+ */
+template<typename T>
+class WorkStealingQueue {
+    static_assert(std::is_pointer_v<T>, "WorkStealingQueue stores pointers only");
+
+    struct Array {
+        const int64_t capacity;
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(int64_t size) : capacity(size), mask(size - 1), items(new std::atomic<T>[size]) {}
+
+        auto Get(int64_t idx) const -> T { return items[idx & mask].load(std::memory_order_relaxed); }
+
+        void Put(int64_t idx, T item) { items[idx & mask].store(item, std::memory_order_relaxed); }
+
+        auto Grow(int64_t bottom, int64_t top) const -> Array * {
+            auto *array = new Array(capacity * 2);
+            for (int64_t i = top; i != bottom; ++i)
+                array->Put(i, Get(i));
+            return array;
+        }
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_Top{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_Bottom{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<Array *> m_Array;
+
+    /// Thieves may still read from a replaced array, so retired arrays live as long as the queue
+    std::vector<std::unique_ptr<Array>> m_RetiredArrays;
+
+public:
+    explicit WorkStealingQueue(int64_t capacity = 1024) : m_Array(new Array(capacity)) {}
+
+    WorkStealingQueue(const WorkStealingQueue &other) = delete;
+
+    auto operator=(const WorkStealingQueue &other) -> WorkStealingQueue & = delete;
+
+    ~WorkStealingQueue() { delete m_Array.load(std::memory_order_relaxed); }
+
+    void Push(T item) {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        Array *array = m_Array.load(std::memory_order_relaxed);
+
+        if (bottom - top > array->capacity - 1) {
+            m_RetiredArrays.emplace_back(array);
+            array = array->Grow(bottom, top);
+            m_Array.store(array, std::memory_order_release);
+        }
+
+        array->Put(bottom, item);
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    auto Pop() -> T {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        Array *array = m_Array.load(std::memory_order_relaxed);
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // Empty
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = array->Get(bottom);
+        if (top == bottom) {
+            // Last item, race against thieves
+            if (!m_Top.compare_exchange_strong(top, top + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    auto Steal() -> T {
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return nullptr;
+
+        Array *array = m_Array.load(std::memory_order_acquire);
+        T item = array->Get(top);
+        if (!m_Top.compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /// Approximate, only meant for heuristics and statistics
+    auto Size() const -> int64_t {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+        return bottom > top ? bottom - top : 0;
+    }
+
+    auto Empty() const -> bool { return Size() == 0; }
+};
+
+
+#endif //GAME_ENGINE_WORK_STEALING_QUEUE_H
@@ -4,7 +4,7 @@
 #include <Engine/Renderer/utils.h>
 
 auto main(int, char**) -> int {
-   std::cout << currentTime() << "[Engine] Initializing..." << std::endl;
+   LOG_INFO("[Engine] Initializing...");
    int result = EXIT_SUCCESS;
    try {
       Input::InitInputSubsystem();
@@ -13,12 +13,13 @@ auto main(int, char**) -> int {
       app->Run();
    }
    catch (const std::exception& e) {
-      std::cout << e.what() << std::endl;
+      LOG_ERROR("{}", e.what());
       result = EXIT_FAILURE;
    }
 
    TerminateGLFW();
-   std::cout << currentTime() << "[Engine] Finalizing..." << std::endl;
+   LOG_INFO("[Engine] Finalizing...");
+   Logger::Get().Flush();
    return result;
 }
 
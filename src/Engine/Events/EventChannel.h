@@ -0,0 +1,235 @@
+#ifndef GAME_ENGINE_EVENT_CHANNEL_H
+#define GAME_ENGINE_EVENT_CHANNEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <Engine/Core/BoundedQueue.h>
+
+#include "Event.h"
+
+
+/**
+ * Plain-data form of a window event, small enough to be copied through a lock-free ring.
+ * The payload is interpreted according to the type, the matching Event object is only created
+ * on the stack while dispatching.
+ */
+struct EventRecord {
+    struct SizePayload {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct KeyPayload {
+        int keyCode;
+        uint32_t repeatCount;
+    };
+
+    struct PointPayload {
+        float x;
+        float y;
+    };
+
+    EventType type = EventType::None;
+
+    union {
+        SizePayload resize;
+        KeyPayload key;
+        /// Cursor position or scroll offsets
+        PointPayload mouse;
+        int button;
+    };
+
+    EventRecord() : resize{0, 0} {}
+
+    static auto WindowClose() -> EventRecord { return Create(EventType::WindowClose); }
+
+    static auto WindowResize(uint32_t width, uint32_t height) -> EventRecord {
+        EventRecord record = Create(EventType::WindowResize);
+        record.resize = {width, height};
+        return record;
+    }
+
+    static auto KeyPress(int keyCode, uint32_t repeatCount) -> EventRecord {
+        EventRecord record = Create(EventType::KeyPress);
+        record.key = {keyCode, repeatCount};
+        return record;
+    }
+
+    static auto KeyRelease(int keyCode) -> EventRecord {
+        EventRecord record = Create(EventType::KeyRelease);
+        record.key = {keyCode, 0};
+        return record;
+    }
+
+    static auto CharacterPress(int keyCode) -> EventRecord {
+        EventRecord record = Create(EventType::CharacterPress);
+        record.key = {keyCode, 0};
+        return record;
+    }
+
+    static auto MouseMove(float x, float y) -> EventRecord {
+        EventRecord record = Create(EventType::MouseMove);
+        record.mouse = {x, y};
+        return record;
+    }
+
+    static auto MouseScroll(float offsetX, float offsetY) -> EventRecord {
+        EventRecord record = Create(EventType::MouseScroll);
+        record.mouse = {offsetX, offsetY};
+        return record;
+    }
+
+    static auto MouseButtonPress(int button) -> EventRecord {
+        EventRecord record = Create(EventType::MouseButtonPress);
+        record.button = button;
+        return record;
+    }
+
+    static auto MouseButtonRelease(int button) -> EventRecord {
+        EventRecord record = Create(EventType::MouseButtonRelease);
+        record.button = button;
+        return record;
+    }
+
+private:
+    static auto Create(EventType type) -> EventRecord {
+        EventRecord record;
+        record.type = type;
+        return record;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<EventRecord>, "[EventRecord] Records are copied through a lock-free ring");
+
+
+/**
+ * Bounded lock-free channel from the window callbacks (any thread) to the thread which processes
+ * events. Posting never blocks and never allocates. Mouse moves are state rather than discrete
+ * events, they may only take a quarter of the ring. Moves past that share go to a small overflow
+ * ring instead, which drops its oldest moves once full. A burst of high-rate mouse input can't take
+ * the space key or button events need nor lose the cursor.
+ */
+class EventChannel {
+public:
+    constexpr static uint64_t DEFAULT_CAPACITY = 2048;
+
+    struct Stats {
+        uint64_t posted = 0;
+        /// Discrete events which didn't fit into the ring
+        uint64_t dropped = 0;
+        /// Mouse moves which went to the overflow ring because their share of the ring was full
+        uint64_t coalescedMoves = 0;
+        uint64_t depth = 0;
+        uint64_t maxDepth = 0;
+    };
+
+private:
+    constexpr static uint64_t MOVE_OVERFLOW_CAPACITY = 8;
+
+    /// Moves are numbered in posting order, zero for every other event
+    struct Entry {
+        EventRecord record;
+        uint64_t moveTicket = 0;
+    };
+
+    BoundedQueue<Entry> m_Queue;
+    BoundedQueue<Entry> m_MoveOverflow{MOVE_OVERFLOW_CAPACITY};
+    /// Moves allowed in the ring at once, the rest of it is kept for discrete events
+    const uint64_t m_MoveShare;
+    /// Counted before a move is pushed and after it's popped, never less than the moves in the ring
+    std::atomic<uint64_t> m_QueuedMoves{0};
+    std::atomic<uint64_t> m_MoveTickets{0};
+    /// Consumer only, ticket of the newest move handed out, older moves still queued are skipped
+    uint64_t m_DeliveredMove = 0;
+
+    std::atomic<uint64_t> m_Posted{0};
+    std::atomic<uint64_t> m_Dropped{0};
+    std::atomic<uint64_t> m_CoalescedMoves{0};
+    std::atomic<uint64_t> m_MaxDepth{0};
+
+public:
+    explicit EventChannel(uint64_t capacity = DEFAULT_CAPACITY)
+            : m_Queue(capacity), m_MoveShare(std::max<uint64_t>(m_Queue.Capacity() / 4, 1)) {}
+
+    EventChannel(const EventChannel &other) = delete;
+
+    auto operator=(const EventChannel &other) -> EventChannel & = delete;
+
+    /// Returns false when the event didn't fit, mouse moves are still kept in that case
+    auto Post(const EventRecord &record) -> bool {
+        m_Posted.fetch_add(1, std::memory_order_relaxed);
+        Entry entry{record};
+        if (record.type == EventType::MouseMove)
+            entry.moveTicket = m_MoveTickets.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if (entry.moveTicket) {
+            // Claimed before the push, so concurrent posters can't exceed the share between them
+            if (m_QueuedMoves.fetch_add(1, std::memory_order_acq_rel) >= m_MoveShare || !m_Queue.TryPush(entry)) {
+                m_QueuedMoves.fetch_sub(1, std::memory_order_release);
+                // Only the newest overflowed move matters, make room by discarding older ones
+                Entry discarded;
+                while (!m_MoveOverflow.TryPush(entry))
+                    m_MoveOverflow.TryPop(discarded);
+                m_CoalescedMoves.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } else if (!m_Queue.TryPush(entry)) {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint64_t depth = m_Queue.Size();
+        uint64_t maxDepth = m_MaxDepth.load(std::memory_order_relaxed);
+        while (depth > maxDepth && !m_MaxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {}
+        return true;
+    }
+
+    /**
+     * Moves everything posted so far into the batch (cleared first) and returns the record count.
+     * Single consumer. The newest overflowed move comes last if nothing newer came through the ring,
+     * moves older than one already handed out are skipped so the cursor never jumps back.
+     */
+    auto Drain(std::vector<EventRecord> &batch) -> size_t {
+        batch.clear();
+        Entry entry;
+        // Bounded so that a producer posting faster than we pop can't keep the consumer here forever
+        for (uint64_t i = 0; i < m_Queue.Capacity() && m_Queue.TryPop(entry); i++) {
+            if (entry.moveTicket) {
+                m_QueuedMoves.fetch_sub(1, std::memory_order_release);
+                if (entry.moveTicket < m_DeliveredMove)
+                    continue;
+                m_DeliveredMove = entry.moveTicket;
+            }
+            batch.push_back(entry.record);
+        }
+
+        Entry newestMove;
+        for (uint64_t i = 0; i < MOVE_OVERFLOW_CAPACITY && m_MoveOverflow.TryPop(entry); i++) {
+            if (entry.moveTicket > newestMove.moveTicket)
+                newestMove = entry;
+        }
+        if (newestMove.moveTicket > m_DeliveredMove) {
+            m_DeliveredMove = newestMove.moveTicket;
+            batch.push_back(newestMove.record);
+        }
+        return batch.size();
+    }
+
+    auto Capacity() const -> uint64_t { return m_Queue.Capacity(); }
+
+    auto GetStats() const -> Stats {
+        Stats stats;
+        stats.posted = m_Posted.load(std::memory_order_relaxed);
+        stats.dropped = m_Dropped.load(std::memory_order_relaxed);
+        stats.coalescedMoves = m_CoalescedMoves.load(std::memory_order_relaxed);
+        stats.depth = m_Queue.Size();
+        stats.maxDepth = m_MaxDepth.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+
+#endif //GAME_ENGINE_EVENT_CHANNEL_H
@@ -0,0 +1,23 @@
+#include "ImGuiDrawSnapshot.h"
+
+
+void ImGuiDrawSnapshot::Capture(const ImDrawData *drawData) {
+    Clear();
+    if (!drawData || !drawData->Valid)
+        return;
+
+    m_CmdLists.reserve(drawData->CmdListsCount);
+    for (int i = 0; i < drawData->CmdListsCount; i++)
+        m_CmdLists.push_back(drawData->CmdLists[i]->CloneOutput());
+
+    m_DrawData = *drawData;
+    m_DrawData.CmdLists = m_CmdLists.data();
+}
+
+
+void ImGuiDrawSnapshot::Clear() {
+    for (ImDrawList *cmdList : m_CmdLists)
+        IM_DELETE(cmdList);
+    m_CmdLists.clear();
+    m_DrawData = ImDrawData();
+}
@@ -0,0 +1,34 @@
+#ifndef GAME_ENGINE_IMGUI_DRAW_SNAPSHOT_H
+#define GAME_ENGINE_IMGUI_DRAW_SNAPSHOT_H
+
+#include <vector>
+#include <imgui.h>
+
+
+/**
+ * Deep copy of the draw data produced by ImGui::Render(). ImGui reuses its draw lists on the next
+ * NewFrame(), a copy lets the UI of frame N be recorded while frame N+1 is already being built.
+ */
+class ImGuiDrawSnapshot {
+    ImDrawData m_DrawData{};
+    std::vector<ImDrawList *> m_CmdLists;
+
+public:
+    ImGuiDrawSnapshot() = default;
+
+    ImGuiDrawSnapshot(const ImGuiDrawSnapshot &other) = delete;
+
+    auto operator=(const ImGuiDrawSnapshot &other) -> ImGuiDrawSnapshot & = delete;
+
+    ~ImGuiDrawSnapshot() { Clear(); }
+
+    void Capture(const ImDrawData *drawData);
+
+    void Clear();
+
+    /// Null when nothing was captured
+    auto DrawData() -> ImDrawData * { return m_DrawData.Valid ? &m_DrawData : nullptr; }
+};
+
+
+#endif //GAME_ENGINE_IMGUI_DRAW_SNAPSHOT_H
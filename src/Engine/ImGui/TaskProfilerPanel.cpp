@@ -0,0 +1,127 @@
+#include "TaskProfilerPanel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <imgui.h>
+
+
+void TaskProfilerPanel::Sample(const TaskProfiler &profiler) {
+    auto now = TaskProfiler::Clock::now();
+    double elapsedNs = std::chrono::duration<double, std::nano>(now - m_LastSample).count();
+    bool first = m_Previous.size() != profiler.WorkerCount();
+    m_Previous.resize(profiler.WorkerCount());
+    m_Utilization.resize(profiler.WorkerCount());
+
+    for (unsigned worker = 0; worker < profiler.WorkerCount(); worker++) {
+        TaskProfiler::WorkerStats stats = profiler.GetWorkerStats(worker);
+        TaskProfiler::WorkerStats &previous = m_Previous[worker];
+        if (!first && elapsedNs > 0.0) {
+            Utilization &utilization = m_Utilization[worker];
+            utilization.busy = static_cast<float>((stats.busyNs - previous.busyNs) / elapsedNs);
+            utilization.spinning = static_cast<float>((stats.spinNs - previous.spinNs) / elapsedNs);
+            utilization.parked = static_cast<float>((stats.parkNs - previous.parkNs) / elapsedNs);
+            utilization.tasksPerSecond = (stats.tasks - previous.tasks) * 1e9 / elapsedNs;
+        }
+        previous = stats;
+    }
+}
+
+
+void TaskProfilerPanel::SampleLanes(const TaskSystem &taskSystem) {
+    for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; lane++) {
+        TaskSystem::LaneStats stats = taskSystem.GetLaneStats(static_cast<TaskPriority>(lane));
+        LaneLatency &latency = m_Lanes[lane];
+        uint64_t executed = stats.executed - latency.previous.executed;
+        if (executed > 0)
+            latency.averageUs = double(stats.totalLatencyUs - latency.previous.totalLatencyUs) / executed;
+        latency.previous = stats;
+    }
+}
+
+
+void TaskProfilerPanel::SampleExternalWaits(const TaskSystem &taskSystem, double elapsedNs) {
+    TaskSystem::ExternalWaitStats stats = taskSystem.GetExternalWaitStats();
+    TaskSystem::ExternalWaitStats &previous = m_ExternalWaits.previous;
+    if (previous.waits > 0 && elapsedNs > 0.0) {
+        m_ExternalWaits.waitMs = (stats.waitNs - previous.waitNs) / elapsedNs * 1e3;
+        m_ExternalWaits.recoveredMs = (stats.recoveredNs - previous.recoveredNs) / elapsedNs * 1e3;
+        m_ExternalWaits.tasks = (stats.tasks - previous.tasks) * 1e9 / elapsedNs;
+    }
+    previous = stats;
+}
+
+
+void TaskProfilerPanel::DrawLanes() {
+    static const char *s_LaneNames[] = {"Frame-critical", "Normal", "Background"};
+
+    for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; lane++) {
+        const LaneLatency &latency = m_Lanes[lane];
+        ImGui::Text("%-15s queued %4llu, latency %8.1f us (max %llu us)", s_LaneNames[lane],
+                    (unsigned long long) latency.previous.queued, latency.averageUs,
+                    (unsigned long long) latency.previous.maxLatencyUs);
+    }
+}
+
+
+void TaskProfilerPanel::Draw(TaskSystem &taskSystem) {
+    TaskProfiler &profiler = taskSystem.GetProfiler();
+    bool enabled = profiler.IsEnabled();
+
+    double sinceSampleNs = std::chrono::duration<double, std::nano>(TaskProfiler::Clock::now() - m_LastSample).count();
+    if (sinceSampleNs >= SAMPLE_INTERVAL_MS * 1e6) {
+        SampleLanes(taskSystem);
+        SampleExternalWaits(taskSystem, sinceSampleNs);
+        if (enabled)
+            Sample(profiler);
+        m_LastSample = TaskProfiler::Clock::now();
+    }
+
+    ImGui::Begin("Task system");
+    DrawLanes();
+    ImGui::Text("Background throttled: %s", taskSystem.IsBackgroundThrottled() ? "yes" : "no");
+    double recoveredShare = m_ExternalWaits.waitMs > 0.0 ? m_ExternalWaits.recoveredMs / m_ExternalWaits.waitMs : 0.0;
+    ImGui::Text("GPU waits: %.2f ms/s, recovered %.2f ms/s (%.0f%%) in %.0f tasks/s", m_ExternalWaits.waitMs,
+                m_ExternalWaits.recoveredMs, recoveredShare * 100.0, m_ExternalWaits.tasks);
+    ImGui::Separator();
+    if (ImGui::Checkbox("Instrumentation", &enabled)) {
+        profiler.SetEnabled(enabled);
+        // Intervals during which the counters didn't run would show up as idle workers
+        m_Previous.clear();
+        m_Utilization.clear();
+    }
+
+    if (!enabled) {
+        ImGui::TextDisabled("Enable instrumentation to collect worker statistics");
+        ImGui::End();
+        return;
+    }
+
+    for (unsigned worker = 0; worker < m_Utilization.size(); worker++) {
+        const Utilization &utilization = m_Utilization[worker];
+        const TaskProfiler::WorkerStats &stats = m_Previous[worker];
+
+        ImGui::PushID(static_cast<int>(worker));
+        char label[64];
+        std::snprintf(label, sizeof(label), "%.0f%% busy", utilization.busy * 100.0f);
+        ImGui::Text("Worker %u", worker);
+        ImGui::SameLine(80.0f);
+        ImGui::ProgressBar(utilization.busy, ImVec2(-1.0f, 0.0f), label);
+        ImGui::Text("  spin %.0f%%, parked %.0f%%, %.0f tasks/s", utilization.spinning * 100.0f,
+                    utilization.parked * 100.0f, utilization.tasksPerSecond);
+        ImGui::Text("  steals %llu (failed %llu), queue %u (max %u), longest task %.3f ms",
+                    (unsigned long long) stats.steals, (unsigned long long) stats.failedSteals,
+                    stats.queueDepth, stats.maxQueueDepth, stats.maxTaskNs / 1e6);
+        ImGui::PopID();
+    }
+
+    ImGui::Separator();
+    if (ImGui::Button("Export trace")) {
+        m_ExportStatus = profiler.ExportChromeTrace(m_TracePath) ? "Saved " + m_TracePath
+                                                                  : "Failed to write " + m_TracePath;
+    }
+    if (!m_ExportStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(m_ExportStatus.c_str());
+    }
+    ImGui::End();
+}
@@ -0,0 +1,61 @@
+#ifndef GAME_ENGINE_TASK_PROFILER_PANEL_H
+#define GAME_ENGINE_TASK_PROFILER_PANEL_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <Engine/Core/TaskSystem.h>
+
+
+/**
+ * ImGui window with live per-worker utilization of a TaskSystem. Counters are sampled a few times
+ * per second, the bars show which share of the last interval each worker spent in tasks, spinning
+ * and parked. Also toggles the instrumentation and exports the trace rings to Chrome trace JSON.
+ * Queue latency of the priority lanes and the work recovered during external (GPU) waits are always
+ * collected and shown as well.
+ */
+class TaskProfilerPanel {
+    constexpr static double SAMPLE_INTERVAL_MS = 250.0;
+
+    struct Utilization {
+        float busy = 0.0f;
+        float spinning = 0.0f;
+        float parked = 0.0f;
+        double tasksPerSecond = 0.0;
+    };
+
+    struct LaneLatency {
+        TaskSystem::LaneStats previous;
+        double averageUs = 0.0;
+    };
+
+    struct ExternalWaits {
+        TaskSystem::ExternalWaitStats previous;
+        /// Per second of the last interval
+        double waitMs = 0.0;
+        double recoveredMs = 0.0;
+        double tasks = 0.0;
+    };
+
+    std::array<LaneLatency, TASK_PRIORITY_COUNT> m_Lanes{};
+    ExternalWaits m_ExternalWaits;
+    std::vector<TaskProfiler::WorkerStats> m_Previous;
+    std::vector<Utilization> m_Utilization;
+    TaskProfiler::Clock::time_point m_LastSample;
+    std::string m_TracePath = "task_trace.json";
+    std::string m_ExportStatus;
+
+    void Sample(const TaskProfiler &profiler);
+
+    void SampleLanes(const TaskSystem &taskSystem);
+
+    void SampleExternalWaits(const TaskSystem &taskSystem, double elapsedNs);
+
+    void DrawLanes();
+
+public:
+    void Draw(TaskSystem &taskSystem);
+};
+
+
+#endif //GAME_ENGINE_TASK_PROFILER_PANEL_H
@@ -2,7 +2,9 @@
 #define VULKAN_ENGINE_H
 
 #include <Engine/ImGui/ImGuiLayer.h>
+#include <Engine/ImGui/TaskProfilerPanel.h>
 #include <Engine/Application.h>
+#include <Engine/Core/TaskGraph.h>
 #include <Engine/AppWindow.h>
 #include <Engine/EntryPoint.h>
 #include <Engine/Layer.h>
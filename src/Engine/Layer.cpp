@@ -5,11 +5,11 @@
 void Layer::OnAttach(const LayerStack *stack) {
     m_Parent = stack;
     const std::string& appName = m_Parent->m_Parent->GetName();
-    std::cout << currentTime() << "[" << appName << "][LayerStack] " << m_DebugName << "::Attached" << std::endl;
+    LOG_DEBUG("[{}][LayerStack] {}::Attached", appName, m_DebugName);
 }
 
 void Layer::OnDetach() {
     const std::string& appName = m_Parent->m_Parent->GetName();
-    std::cout << currentTime() << "[" << appName << "][LayerStack] " << m_DebugName << "::Detached" << std::endl;
+    LOG_DEBUG("[{}][LayerStack] {}::Detached", appName, m_DebugName);
     m_Parent = nullptr;
 }
@@ -21,7 +21,7 @@ public:
     explicit Layer(const char *name = "Layer") : m_DebugName(name) {}
 
     virtual ~Layer() {
-        std::cout << currentTime() << "[Layer] " << m_DebugName << "::Destroyed" << std::endl;
+        LOG_DEBUG("[Layer] {}::Destroyed", m_DebugName);
     }
 
     virtual void OnAttach(const LayerStack *stack);
@@ -27,7 +27,7 @@ auto LayerStack::PopOverlay(const Layer* overlay) -> std::unique_ptr<Layer> {
 }
 
 LayerStack::~LayerStack() {
-    std::cout << currentTime() << "[" << m_Parent->GetName() << "][LayerStack] Deconstructing" << std::endl;
+    LOG_DEBUG("[{}][LayerStack] Deconstructing", m_Parent->GetName());
     while (!m_Layers.empty()) {
         m_Layers.back()->OnDetach();
         m_Layers.pop_back();
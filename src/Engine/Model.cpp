@@ -1,12 +1,16 @@
-#include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <glm/gtx/string_cast.hpp>
 
+#include <Engine/Application.h>
+#include <Engine/Core/Parallel.h>
 #include <Engine/Renderer/UniformBuffer.h>
 #include "Model.h"
 #include "Renderer/Mesh.h"
+#include "Renderer/SceneCache.h"
 #include "Renderer/Camera.h"
 
 
@@ -25,8 +29,11 @@ void Entity::AllocateTransformsUB(uint32_t entityCount) {
 
 
 void Entity::UpdateTransformsUB(const PerspectiveCamera &camera) {
+    /// Roughly where the matrix inverse per instance starts to outweigh the task overhead
+    constexpr size_t MIN_INSTANCES_PER_TASK = 64;
+
     std::vector<TransformUBO> ubos(s_InstanceCount);
-    for (size_t i = 0; i < s_InstanceCount; i++) {
+    Parallel::For(Application::Get().m_TaskSystem, 0, s_InstanceCount, [&](size_t i) {
         ubos[i].model = s_ModelMatrices[i];
         ubos[i].view = camera.GetView();
         ubos[i].projection = camera.GetProjection();
@@ -38,12 +45,19 @@ void Entity::UpdateTransformsUB(const PerspectiveCamera &camera) {
 
 //        ubos[i].normalMatrix = m_NormalMatrices[i] * camera.GetView();
 //        std::fill(ubos.begin(), ubos.end(), TransformUBO{mvp, viewModel, normalMatrix});
-    }
+    }, MIN_INSTANCES_PER_TASK);
     s_TransformsUB->SetData(ubos.data(), s_InstanceCount, 0);
 }
 
 
-auto ModelAsset::LoadModel(const std::string &filepath) -> std::unique_ptr<ModelAsset> {
+auto ModelAsset::LoadModel(const std::string &filepath, VertexFormat format) -> std::unique_ptr<ModelAsset> {
+    constexpr uint32_t POST_PROCESS_FLAGS = aiProcess_Triangulate |
+                                            aiProcess_FlipUVs |
+                                            aiProcess_JoinIdenticalVertices |
+                                            aiProcess_RemoveRedundantMaterials |
+                                            aiProcess_OptimizeMeshes |
+                                            aiProcess_OptimizeGraph |
+                                            aiProcess_CalcTangentSpace;
 
     static std::unordered_map<Texture2D::Type, aiTextureType> textureTypes{
 //            {Texture2D::Type::SPECULAR, aiTextureType_SPECULAR},
@@ -55,51 +69,117 @@ auto ModelAsset::LoadModel(const std::string &filepath) -> std::unique_ptr<Model
             {Texture2D::Type::NORMAL,   aiTextureType_NORMAL_CAMERA},
     };
 
-    Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(filepath, aiProcess_Triangulate |
-                                                       aiProcess_FlipUVs |
-                                                       aiProcess_JoinIdenticalVertices |
-                                                       aiProcess_RemoveRedundantMaterials |
-                                                       aiProcess_OptimizeMeshes |
-                                                       aiProcess_OptimizeGraph |
-                                                       aiProcess_CalcTangentSpace);
-    if (!scene || scene->mFlags & (unsigned) AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
-        return {};
-    }
-
-
+    auto start = std::chrono::steady_clock::now();
+    // Waits inside Parallel help with other tasks, loading from a worker can't deadlock the system
+    TaskSystem &taskSystem = Application::Get().m_TaskSystem;
     auto asset = std::make_unique<ModelAsset>();
-    asset->m_Materials.reserve(scene->mNumMaterials);
-
-    aiString tmp;
-    for (size_t materialIdx = 0; materialIdx < scene->mNumMaterials; materialIdx++) {
-        aiMaterial *sourceMaterial = scene->mMaterials[materialIdx];
-        asset->m_Materials.emplace_back(sourceMaterial->GetName().C_Str());
-        asset->m_Textures.emplace_back();
-        auto &materialTextures = asset->m_Textures.back();
-        for (const auto &type : textureTypes) {
-            VkFormat format = type.first == Texture2D::Type::NORMAL ? VK_FORMAT_R8G8B8A8_UNORM :
-                              VK_FORMAT_R8G8B8A8_SRGB;
-
-            auto textureCount = sourceMaterial->GetTextureCount(type.second);
-            auto &textures = materialTextures.emplace(type.first, std::vector<const Texture2D *>()).first->second;
-            for (unsigned int i = 0; i < textureCount; i++) {
-                sourceMaterial->GetTexture(type.second, i, &tmp);
-                std::string textureName(tmp.C_Str());
-                std::string path = std::string(BASE_DIR "/textures/") + textureName;
-                textures.emplace_back(Texture2D::Create(path.c_str(), format, true));
-//                asset->m_Materials[materialIdx].BindTextures(type.first, Texture2D::Create(path.c_str()));
+    std::vector<SceneCacheMaterial> materials;
+    std::string cachePath = SceneCache::PathFor(filepath);
+    auto cache = SceneCache::Open(cachePath, filepath, POST_PROCESS_FLAGS);
+    // The key only covers the importer's flags, a cache of the other vertex format is rebuilt
+    if (cache && std::any_of(cache->meshes.begin(), cache->meshes.end(),
+                             [format](const SceneCacheMeshView &mesh) { return mesh.data.format != format; }))
+        cache.reset();
+    if (cache) {
+        materials = std::move(cache->materials);
+        asset->m_Meshes.reserve(cache->meshes.size());
+        for (auto &mesh : cache->meshes)
+            asset->m_Meshes.emplace_back(std::move(mesh.data), mesh.materialIdx);
+    } else {
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(filepath, POST_PROCESS_FLAGS);
+        if (!scene || scene->mFlags & (unsigned) AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+            LOG_ERROR("[ModelAsset] Failed to import {}: {}", filepath, importer.GetErrorString());
+            return {};
+        }
+
+        aiString tmp;
+        materials.resize(scene->mNumMaterials);
+        for (size_t materialIdx = 0; materialIdx < scene->mNumMaterials; materialIdx++) {
+            aiMaterial *sourceMaterial = scene->mMaterials[materialIdx];
+            materials[materialIdx].name = sourceMaterial->GetName().C_Str();
+            for (const auto &type : textureTypes) {
+                auto textureCount = sourceMaterial->GetTextureCount(type.second);
+                for (unsigned int i = 0; i < textureCount; i++) {
+                    sourceMaterial->GetTexture(type.second, i, &tmp);
+                    materials[materialIdx].textures.push_back({static_cast<uint32_t>(type.first), tmp.C_Str()});
+                }
             }
         }
+
+        // Every mesh is built into its own slot, the asset keeps the scene's order whatever finishes first
+        std::vector<std::unique_ptr<Mesh>> meshes(scene->mNumMeshes);
+        Parallel::For(taskSystem, 0, scene->mNumMeshes, [&](size_t i) {
+            const auto *sourceMesh = scene->mMeshes[i];
+            auto mesh = Mesh::Create(sourceMesh, sourceMesh->mMaterialIndex);
+            mesh->Optimize();
+            mesh->GenerateLods();
+            mesh->BuildMeshlets();
+            if (format == VertexFormat::COMPACT)
+                mesh->Compress();
+            meshes[i] = std::move(mesh);
+        });
+        asset->m_Meshes.reserve(meshes.size());
+        for (auto &mesh : meshes)
+            asset->m_Meshes.push_back(std::move(*mesh));
+
+        std::vector<SceneCacheMesh> cacheMeshes(asset->m_Meshes.size());
+        for (size_t i = 0; i < asset->m_Meshes.size(); i++) {
+            const Mesh &mesh = asset->m_Meshes[i];
+            cacheMeshes[i].materialIdx = mesh.AssimpMaterialIdx();
+            cacheMeshes[i].data.layout = mesh.VertexLayout();
+            cacheMeshes[i].data.vertexSize = mesh.VertexSize();
+            cacheMeshes[i].data.vertexCount = mesh.VertexCount();
+            cacheMeshes[i].data.format = mesh.Format();
+            cacheMeshes[i].data.quantization = mesh.Quantization();
+            cacheMeshes[i].data.vertices = mesh.VertexData();
+            cacheMeshes[i].data.indices = mesh.Indices();
+            cacheMeshes[i].data.lods = mesh.Lods();
+            cacheMeshes[i].data.meshlets = mesh.Meshlets();
+        }
+        if (!SceneCache::Write(cachePath, filepath, POST_PROCESS_FLAGS, materials, cacheMeshes))
+            LOG_WARNING("[ModelAsset] Failed to write scene cache {}", cachePath);
     }
 
-    asset->m_Meshes.reserve(scene->mNumMeshes);
-    for (size_t i = 0; i < scene->mNumMeshes; i++) {
-        const auto *sourceMesh = scene->mMeshes[i];
-        asset->m_Meshes.emplace_back(sourceMesh, sourceMesh->mMaterialIndex);
+    // Textures are decoded concurrently, one task per file. Texture2D::Create deduplicates loads between
+    // models as well, but a file requested twice here would only make a second task wait for the first.
+    struct TextureLoad {
+        std::string path;
+        VkFormat format;
+        const Texture2D *texture = nullptr;
+    };
+    std::vector<TextureLoad> textureLoads;
+    std::unordered_map<std::string, size_t> textureSlots;
+    for (const auto &material : materials) {
+        for (const auto &texture : material.textures) {
+            auto type = static_cast<Texture2D::Type>(texture.type);
+            VkFormat format = type == Texture2D::Type::NORMAL ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB;
+            std::string path = std::string(BASE_DIR "/textures/") + texture.name;
+            if (textureSlots.emplace(path, textureLoads.size()).second)
+                textureLoads.push_back({std::move(path), format});
+        }
+    }
+    Parallel::For(taskSystem, 0, textureLoads.size(), [&](size_t i) {
+        textureLoads[i].texture = Texture2D::Create(textureLoads[i].path.c_str(), textureLoads[i].format, true);
+    });
+
+    asset->m_Materials.reserve(materials.size());
+    for (const auto &material : materials) {
+        asset->m_Materials.emplace_back(material.name);
+        auto &materialTextures = asset->m_Textures.emplace_back();
+        for (const auto &type : textureTypes)
+            materialTextures.emplace(type.first, std::vector<const Texture2D *>());
+
+        for (const auto &texture : material.textures) {
+            auto type = static_cast<Texture2D::Type>(texture.type);
+            std::string path = std::string(BASE_DIR "/textures/") + texture.name;
+            materialTextures[type].emplace_back(textureLoads[textureSlots.at(path)].texture);
+        }
     }
 
+    LOG_INFO("[ModelAsset] Loaded {} in {} ms ({})", filepath,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+             cache ? "scene cache" : "Assimp import");
     return asset;
 }
 
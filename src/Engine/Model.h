@@ -19,7 +19,8 @@ class ModelAsset {
     std::vector<std::unordered_map<Texture2D::Type, std::vector<const Texture2D *>>> m_Textures;
 
 public:
-    static auto LoadModel(const std::string &filepath) -> std::unique_ptr<ModelAsset>;
+    static auto LoadModel(const std::string &filepath, VertexFormat format = VertexFormat::FULL)
+    -> std::unique_ptr<ModelAsset>;
 
     static auto CreateCubeAsset() -> std::unique_ptr<ModelAsset>;
 
@@ -205,6 +206,8 @@ public:
 
     auto GetRotation() const -> const glm::vec3 & { return s_Rotations[m_InstanceID]; }
 
+    static auto ModelMatrix(uint32_t entityID) -> const glm::mat4 & { return s_ModelMatrices[entityID]; }
+
     static void AllocateTransformsUB(uint32_t entityCount);
 
     static void UpdateTransformsUB(const PerspectiveCamera &camera);
@@ -1,6 +1,5 @@
 #include "Device.h"
 
-#include <iostream>
 #include <set>
 #include <sstream>
 #include <algorithm>
@@ -33,25 +32,22 @@ auto Device::pickPhysicalDevice() -> VkPhysicalDevice {
    std::vector<VkPhysicalDevice> integrated;
    VkPhysicalDeviceProperties properties;
 
-   std::cout << currentTime() << "[Vulkan][Device] Enumerating physical devices" << std::endl;
+   LOG_DEBUG("[Vulkan][Device] Enumerating physical devices");
    for (const auto &device: devices) {
       vkGetPhysicalDeviceProperties(device, &properties);
       vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
       if (supportedFeatures.samplerAnisotropy) {
          switch (properties.deviceType) {
             case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
-               std::cout << currentTime() << "[Vulkan][Device] Found discrete GPU: "
-                         << properties.deviceName << std::endl;
+               LOG_INFO("[Vulkan][Device] Found discrete GPU: {}", properties.deviceName);
                discrete.push_back(device);
                break;
             case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
-               std::cout << currentTime() << "[Vulkan][Device] Found integrated GPU: "
-                         << properties.deviceName << std::endl;
+               LOG_INFO("[Vulkan][Device] Found integrated GPU: {}", properties.deviceName);
                integrated.push_back(device);
                break;
             default:
-               std::cout << currentTime() << "[Vulkan][Device] Ignoring GPU: "
-                         << properties.deviceName << std::endl;
+               LOG_INFO("[Vulkan][Device] Ignoring GPU: {}", properties.deviceName);
                break;
          }
       }
@@ -68,8 +64,7 @@ auto Device::pickPhysicalDevice() -> VkPhysicalDevice {
 
    vkGetPhysicalDeviceProperties(selectedDevice, &m_Properties);
    vkGetPhysicalDeviceFeatures(selectedDevice, &supportedFeatures);
-   std::cout << currentTime() << "[Vulkan][Device] Selected GPU: "
-             << m_Properties.deviceName << std::endl;
+   LOG_INFO("[Vulkan][Device] Selected GPU: {}", m_Properties.deviceName);
 
    VkSampleCountFlags supportedSamplesBitmask = std::min(
            m_Properties.limits.framebufferColorSampleCounts,
@@ -77,8 +72,7 @@ auto Device::pickPhysicalDevice() -> VkPhysicalDevice {
 
    for (uint32_t i = VK_SAMPLE_COUNT_1_BIT; i <= VK_SAMPLE_COUNT_64_BIT; i <<= 1u) {
       if (supportedSamplesBitmask & i) {
-         std::cout << currentTime() << "[Vulkan][" << m_Properties.deviceName
-                   << "] Supported sample count: " << i << std::endl;
+         LOG_DEBUG("[Vulkan][{}] Supported sample count: {}", m_Properties.deviceName, i);
          m_SupportedSamplesMSAA.emplace_back((VkSampleCountFlagBits) i);
       }
    }
@@ -121,7 +115,7 @@ auto Device::findSupportedFormat(const std::vector<VkFormat> &candidates, VkImag
 }
 
 void Device::Release() {
-   std::cout << "[Device] Destroying rendering device" << std::endl;
+   LOG_INFO("[Device] Destroying rendering device");
 }
 
 
@@ -224,7 +218,17 @@ void RingStageBuffer::Allocate(VkDeviceSize size) {
 void RingStageBuffer::StageMesh(const Mesh *mesh) {
    const auto &vertexData = mesh->VertexData();
    const auto &indices = mesh->Indices();
+   // Meshes below 65536 vertices are drawn with 16 bit indices, half the upload and the device memory
+   std::vector<uint16_t> narrowIndices;
+   const void *indexData = indices.data();
    auto indexDataSize = indices.size() * sizeof(uint32_t);
+   if (mesh->IndexSize() == sizeof(uint16_t)) {
+      // Padded to an even count so that the next mesh still starts 4 byte aligned
+      narrowIndices.resize(indices.size() + (indices.size() & 1u), 0);
+      MeshCodec::NarrowIndices(indices.data(), indices.size(), narrowIndices.data());
+      indexData = narrowIndices.data();
+      indexDataSize = narrowIndices.size() * sizeof(uint16_t);
+   }
    VkDeviceSize dataSize = vertexData.size() + indexDataSize;
    if (dataSize >= FreeSpace())
       throw std::runtime_error("[RingStageBuffer] Not enough free space");
@@ -248,8 +252,8 @@ void RingStageBuffer::StageMesh(const Mesh *mesh) {
          std::memcpy(bufferPtr, vertexData.data(), vertexData.size());
          bufferPtr += vertexData.size();
 
-         std::memcpy(bufferPtr, indices.data(), chunkSize - vertexData.size());
-         const uint8_t *dataPtr = (uint8_t *) indices.data() + (chunkSize - vertexData.size());
+         std::memcpy(bufferPtr, indexData, chunkSize - vertexData.size());
+         const uint8_t *dataPtr = (const uint8_t *) indexData + (chunkSize - vertexData.size());
          m_EndOffset = dataSize - chunkSize;
          assert(m_EndOffset == (indexDataSize - (chunkSize - vertexData.size())));
          std::memcpy(m_Memory->m_Mapped, dataPtr, m_EndOffset);
@@ -261,19 +265,19 @@ void RingStageBuffer::StageMesh(const Mesh *mesh) {
          bufferPtr = (uint8_t *) m_Memory->m_Mapped;
          std::memcpy(bufferPtr, dataPtr, vertexData.size() - chunkSize);
          bufferPtr += (vertexData.size() - chunkSize);
-         std::memcpy(bufferPtr, indices.data(), indexDataSize);
+         std::memcpy(bufferPtr, indexData, indexDataSize);
       } else {
          std::memcpy(bufferPtr, vertexData.data(), chunkSize);
          m_EndOffset = dataSize - chunkSize;
          assert(m_EndOffset == indexDataSize);
-         std::memcpy(m_Memory->m_Mapped, indices.data(), m_EndOffset);
+         std::memcpy(m_Memory->m_Mapped, indexData, m_EndOffset);
       }
    } else {
       regions.emplace_back(VkBufferCopy{m_EndOffset, 0, dataSize});
       uint8_t *bufferPtr = (uint8_t *) m_Memory->m_Mapped + m_EndOffset;
       std::memcpy(bufferPtr, vertexData.data(), vertexData.size());
       bufferPtr += vertexData.size();
-      std::memcpy(bufferPtr, indices.data(), indexDataSize);
+      std::memcpy(bufferPtr, indexData, indexDataSize);
       m_EndOffset += dataSize;
    }
 }
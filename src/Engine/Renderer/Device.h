@@ -7,6 +7,7 @@
 #include <array>
 #include <tuple>
 #include <cstring>
+#include <mutex>
 #include <queue>
 
 #include "utils.h"
@@ -30,6 +31,9 @@ private:
     vk::CommandPool *m_GfxCmdPool{};
     vk::CommandPool *m_TransferCmdPool{};
 
+    /// Serializes resource creation and queue access between the render thread and asset jobs
+    std::recursive_mutex m_Mutex;
+
     std::vector<std::unique_ptr<vk::Pipeline>> m_Pipelines;
     std::vector<std::unique_ptr<vk::PipelineLayout>> m_PipelineLayouts;
     std::vector<std::unique_ptr<vk::PipelineCache>> m_PipelineCaches;
@@ -117,6 +121,8 @@ public:
 
     auto GfxPool() const -> vk::CommandPool * { return m_GfxCmdPool; }
 
+    auto Lock() -> std::unique_lock<std::recursive_mutex> { return std::unique_lock<std::recursive_mutex>(m_Mutex); }
+
     auto TransferPool() const -> vk::CommandPool * { return m_TransferCmdPool; }
 
 
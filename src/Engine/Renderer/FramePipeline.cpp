@@ -0,0 +1,164 @@
+#include "FramePipeline.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "UniformBuffer.h"
+
+
+void FramePacket::Reset() {
+    commands.Clear();
+    uiDrawData.Clear();
+    resize.reset();
+    uniformWrites.clear();
+    uniformData.clear();
+    samplerWrites.clear();
+}
+
+
+void FramePacket::CaptureUniformData(const UniformBuffer *buffer, const void *data, size_t bytes,
+                                     uint32_t objectCount, uint32_t offset) {
+    size_t dataOffset = uniformData.size();
+    uniformData.resize(dataOffset + bytes);
+    std::memcpy(uniformData.data() + dataOffset, data, bytes);
+    uniformWrites.push_back({buffer, dataOffset, static_cast<uint32_t>(bytes), objectCount, offset});
+}
+
+
+void FramePacket::ApplyUniformData() const {
+    for (const auto &write : uniformWrites) {
+        const uint8_t *data = uniformData.data() + write.dataOffset;
+        if (write.objectCount > 0)
+            write.buffer->impl_SetData(data, write.objectCount, write.offset);
+        else
+            write.buffer->impl_SetMemberData(data, write.dataBytes, write.offset);
+    }
+}
+
+
+void FramePacket::CaptureSamplerWrite(const ShaderPipeline *pipeline, BindingKey bindingKey,
+                                      const std::vector<VkImageView> &views) {
+    samplerWrites.push_back({pipeline, bindingKey, views});
+}
+
+
+void FramePacket::ApplySamplerWrites() const {
+    for (const auto &write : samplerWrites)
+        write.pipeline->impl_WriteSamplers(write.bindingKey, write.views);
+}
+
+
+auto FramePacketRing::AcquireForBuild() -> FramePacket * {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    size_t idx = 0;
+    m_Condition.wait(lock, [&]() {
+        if (m_Closed)
+            return true;
+        auto it = std::find(m_States.begin(), m_States.end(), State::FREE);
+        idx = it - m_States.begin();
+        return it != m_States.end();
+    });
+
+    if (m_Closed)
+        return nullptr;
+
+    m_States[idx] = State::BUILDING;
+    FramePacket &packet = m_Packets[idx];
+    packet.Reset();
+    packet.frameNumber = m_NextFrameNumber++;
+    return &packet;
+}
+
+
+void FramePacketRing::Publish(FramePacket *packet) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        size_t idx = packet - m_Packets.data();
+        if (m_States[idx] != State::BUILDING)
+            throw std::runtime_error("[FramePacketRing] Publishing a packet which isn't being built");
+        m_States[idx] = State::READY;
+    }
+    m_Condition.notify_all();
+}
+
+
+auto FramePacketRing::AcquireForRender() -> FramePacket * {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    FramePacket *oldest = nullptr;
+    m_Condition.wait(lock, [&]() {
+        for (size_t i = 0; i < PACKET_COUNT; i++) {
+            if (m_States[i] == State::READY && (!oldest || m_Packets[i].frameNumber < oldest->frameNumber))
+                oldest = &m_Packets[i];
+        }
+        return oldest || m_Closed;
+    });
+
+    if (oldest)
+        m_States[oldest - m_Packets.data()] = State::RENDERING;
+    return oldest;
+}
+
+
+void FramePacketRing::Release(FramePacket *packet) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_States[packet - m_Packets.data()] = State::FREE;
+    }
+    m_Condition.notify_all();
+}
+
+
+void FramePacketRing::Close() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Closed = true;
+    }
+    m_Condition.notify_all();
+}
+
+
+void FrameStats::Record(const FramePacket &packet, FramePacket::Clock::time_point renderStart,
+                        FramePacket::Clock::time_point presentEnd) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Sample sample{};
+    sample.frameMs = m_FrameCount > 0 ? Duration(presentEnd - m_LastPresent).count() : 0.0;
+    sample.updateMs = Duration(packet.buildEnd - packet.buildStart).count();
+    sample.renderMs = Duration(presentEnd - renderStart).count();
+    sample.latencyMs = Duration(presentEnd - packet.buildStart).count();
+
+    m_LastPresent = presentEnd;
+    // The first frame has no predecessor to measure the frame time against
+    if (m_FrameCount++ == 0)
+        return;
+
+    m_Samples[m_SampleCount % WINDOW_SIZE] = sample;
+    m_SampleCount++;
+}
+
+
+auto FrameStats::Summarize() const -> Summary {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Summary summary;
+    summary.frameCount = m_FrameCount;
+
+    size_t count = std::min(m_SampleCount, WINDOW_SIZE);
+    if (count == 0)
+        return summary;
+
+    for (size_t i = 0; i < count; i++) {
+        const Sample &sample = m_Samples[i];
+        summary.frameMs += sample.frameMs;
+        summary.updateMs += sample.updateMs;
+        summary.renderMs += sample.renderMs;
+        summary.latencyMs += sample.latencyMs;
+        summary.maxFrameMs = std::max(summary.maxFrameMs, sample.frameMs);
+        summary.maxLatencyMs = std::max(summary.maxLatencyMs, sample.latencyMs);
+    }
+
+    summary.frameMs /= count;
+    summary.updateMs /= count;
+    summary.renderMs /= count;
+    summary.latencyMs /= count;
+    return summary;
+}
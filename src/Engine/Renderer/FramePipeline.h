@@ -0,0 +1,184 @@
+#ifndef GAME_ENGINE_FRAME_PIPELINE_H
+#define GAME_ENGINE_FRAME_PIPELINE_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <glm/matrix.hpp>
+#include <Engine/ImGui/ImGuiDrawSnapshot.h>
+
+#include "RenderCommand.h"
+#include "ShaderPipeline.h"
+
+
+class UniformBuffer;
+
+class TextureCubemap;
+
+
+struct CameraSnapshot {
+    glm::mat4 projection{1.0f};
+    glm::mat4 view{1.0f};
+    glm::vec3 position{0.0f};
+};
+
+
+/// Deferred UniformBuffer write, the data itself lives in FramePacket::m_UniformData
+struct UniformSnapshot {
+    const UniformBuffer *buffer;
+    size_t dataOffset;
+    uint32_t dataBytes;
+    /// Object count for SetData(), zero marks a SetMemberData() write
+    uint32_t objectCount;
+    uint32_t offset;
+};
+
+
+/// Deferred sampler descriptor write, holds the whole array bound to the binding at capture time
+struct SamplerSnapshot {
+    const ShaderPipeline *pipeline;
+    BindingKey bindingKey;
+    std::vector<VkImageView> views;
+};
+
+
+/**
+ * Everything the render stage needs to record one frame. The update stage fills a packet and
+ * publishes it, from then on it is never touched by the update stage again until the render stage
+ * releases it. Uniform writes are captured instead of going to mapped memory directly because the
+ * swapchain image (and with it the uniform buffer region) isn't known before the frame is acquired.
+ * Draw commands carry copies of the mesh and material data they need, the render stage never reads
+ * scene objects which the update stage is already mutating for the next frame.
+ */
+struct FramePacket {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t frameNumber = 0;
+    Clock::time_point buildStart;
+    Clock::time_point buildEnd;
+
+    CameraSnapshot camera;
+    RenderCommandQueue commands;
+    ImGuiDrawSnapshot uiDrawData;
+
+    const TextureCubemap *skybox = nullptr;
+    uint32_t skyboxTexIdx = 0;
+    bool skyboxEnabled = true;
+    float skyboxLOD = 0.0f;
+    float exposure = 1.0f;
+
+    /// Latest window size, the swapchain is recreated by the render stage before acquiring an image
+    std::optional<std::pair<uint32_t, uint32_t>> resize;
+
+    std::vector<UniformSnapshot> uniformWrites;
+    std::vector<uint8_t> uniformData;
+
+    std::vector<SamplerSnapshot> samplerWrites;
+
+    void Reset();
+
+    void CaptureUniformData(const UniformBuffer *buffer, const void *data, size_t bytes,
+                            uint32_t objectCount, uint32_t offset);
+
+    /// Replays captured uniform writes in submission order, must run after the swapchain image was acquired
+    void ApplyUniformData() const;
+
+    void CaptureSamplerWrite(const ShaderPipeline *pipeline, BindingKey bindingKey,
+                             const std::vector<VkImageView> &views);
+
+    /// Replays captured sampler writes in submission order, descriptor sets are only touched by the render stage
+    void ApplySamplerWrites() const;
+};
+
+
+/**
+ * Triple-buffered hand-off between the update stage and the render stage. With three packets one
+ * can be built, one can wait and one can be recorded at the same time, neither stage blocks the
+ * other unless it runs more than a frame ahead. Packets are rendered in the order they were published.
+ */
+class FramePacketRing {
+public:
+    constexpr static size_t PACKET_COUNT = 3;
+
+private:
+    enum class State : uint8_t {
+        FREE,
+        BUILDING,
+        READY,
+        RENDERING
+    };
+
+    std::array<FramePacket, PACKET_COUNT> m_Packets;
+    std::array<State, PACKET_COUNT> m_States{};
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    uint64_t m_NextFrameNumber = 0;
+    bool m_Closed = false;
+
+public:
+    /// Blocks until a packet is free, returns null once the ring was closed
+    auto AcquireForBuild() -> FramePacket *;
+
+    void Publish(FramePacket *packet);
+
+    /// Blocks until a packet is published, returns null once the ring was closed and drained
+    auto AcquireForRender() -> FramePacket *;
+
+    void Release(FramePacket *packet);
+
+    /// Wakes both stages, already published packets can still be rendered
+    void Close();
+};
+
+
+/**
+ * Rolling window of per-frame timings shared by both frame modes. Latency is measured from the
+ * start of the update stage (input sampling) until the frame was handed to the presentation engine.
+ */
+class FrameStats {
+public:
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    struct Summary {
+        uint64_t frameCount = 0;
+        double frameMs = 0.0;
+        double maxFrameMs = 0.0;
+        double updateMs = 0.0;
+        double renderMs = 0.0;
+        double latencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+
+        auto Fps() const -> double { return frameMs > 0.0 ? 1000.0 / frameMs : 0.0; }
+    };
+
+private:
+    constexpr static size_t WINDOW_SIZE = 128;
+
+    struct Sample {
+        double frameMs;
+        double updateMs;
+        double renderMs;
+        double latencyMs;
+    };
+
+    mutable std::mutex m_Mutex;
+    std::array<Sample, WINDOW_SIZE> m_Samples{};
+    size_t m_SampleCount = 0;
+    uint64_t m_FrameCount = 0;
+    FramePacket::Clock::time_point m_LastPresent;
+
+public:
+    /// Called by the render stage once the packet was presented
+    void Record(const FramePacket &packet, FramePacket::Clock::time_point renderStart,
+                FramePacket::Clock::time_point presentEnd);
+
+    auto Summarize() const -> Summary;
+};
+
+
+#endif //GAME_ENGINE_FRAME_PIPELINE_H
@@ -6,7 +6,7 @@
 #include <Engine/Core.h>
 
 auto GfxContext::Create(void* windowHandle) -> std::unique_ptr<GfxContext> {
-   std::cout << currentTime() << "[Engine][GfxContext] Constructing" << std::endl;
+   LOG_DEBUG("[Engine][GfxContext] Constructing");
    switch (RendererAPI::GetSelectedAPI()) {
        case RendererAPI::API::VULKAN: return std::make_unique<GfxContextVk>(static_cast<GLFWwindow*>(windowHandle));
    }
@@ -15,5 +15,5 @@ auto GfxContext::Create(void* windowHandle) -> std::unique_ptr<GfxContext> {
 }
 
 GfxContext::~GfxContext() {
-   std::cout << currentTime() << "[Engine][GfxContext] Destructing" << std::endl;
+   LOG_DEBUG("[Engine][GfxContext] Destructing");
 }
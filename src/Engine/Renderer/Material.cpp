@@ -1,7 +1,7 @@
 #include "Material.h"
 
 #include <utility>
-#include <iostream>
+#include <Engine/Core.h>
 #include "Renderer.h"
 
 
@@ -110,14 +110,14 @@ auto Material::BindTextures(const std::unordered_map<Texture2D::Type, const Text
                             BindingKey bindingKey) -> std::unordered_map<Texture2D::Type, uint32_t> {
 
     if (!m_ShaderPipeline) {
-        std::cout << "[(" << m_Name << ")->BindTextures2D] Missing ShaderProgram, ignoring texture bind" << std::endl;
+        LOG_WARNING("[({})->BindTextures2D] Missing ShaderProgram, ignoring texture bind", m_Name);
         return {};
     }
 
     std::vector<const Texture2D *> textureVector(textures.size());
     std::transform(textures.begin(), textures.end(), textureVector.begin(), [](auto x) { return x.second; });
 
-    auto indices = m_ShaderPipeline->BindTextures2D(textureVector, bindingKey);
+    auto indices = m_ShaderPipeline->BindTextures2D(textureVector, bindingKey, Renderer::BuildPacket());
     std::unordered_map<Texture2D::Type, uint32_t> mapping;
     size_t idx = 0;
     for (const auto&[type, texture] : textures) {
@@ -140,14 +140,14 @@ auto Material::BindTextures(const std::unordered_map<Texture2D::Type, const Text
 auto Material::BindCubemaps(const std::unordered_map<TextureCubemap::Type, const TextureCubemap *>& textures,
                            BindingKey bindingKey) -> std::unordered_map<TextureCubemap::Type, uint32_t> {
     if (!m_ShaderPipeline) {
-        std::cout << "[(" << m_Name << ")->BindCubemaps] Missing ShaderProgram, ignoring texture bind" << std::endl;
+        LOG_WARNING("[({})->BindCubemaps] Missing ShaderProgram, ignoring texture bind", m_Name);
         return {};
     }
 
     std::vector<const TextureCubemap *> textureVector(textures.size());
     std::transform(textures.begin(), textures.end(), textureVector.begin(), [](auto x) { return x.second; });
 
-    auto indices = m_ShaderPipeline->BindCubemaps(textureVector, bindingKey);
+    auto indices = m_ShaderPipeline->BindCubemaps(textureVector, bindingKey, Renderer::BuildPacket());
     std::unordered_map<TextureCubemap::Type, uint32_t> mapping;
     size_t idx = 0;
     for (const auto&[type, texture] : textures) {
@@ -186,8 +186,8 @@ auto Material::CreateInstance() -> MaterialInstance {
 
         auto sharedDataIt = m_SharedUniformData.find(key);
         if (sharedDataIt == m_SharedUniformData.end()) {
-            std::cout << "[(" << m_Name << ")->CreateInstance] Missing shared material state data for uniform"
-                      << " structure at binding {" << key.Set() << ";" << key.Binding() << "}" << std::endl;
+            LOG_WARNING("[({})->CreateInstance] Missing shared material state data for uniform structure at binding ({};{})",
+                        m_Name, key.Set(), key.Binding());
         } else {
             auto &sharedUniform = sharedDataIt->second;
             size_t instanceOffset = uniform.objectSize * newInstanceID;
@@ -1,24 +1,37 @@
 #define STB_IMAGE_IMPLEMENTATION
-#define TINYOBJLOADER_IMPLEMENTATION
 
 #include "Material.h"
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
 #include "Renderer.h"
+#include "VertexWeld.h"
+#include <Engine/Application.h>
+#include <Engine/Core/Parallel.h>
 
-#include <fstream>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
-#include <tiny_obj_loader.h>
 #include <stb_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <unordered_map>
 #include <functional>
 #include <numeric>
-#include <iostream>
 #include <unordered_set>
 
 
-uint32_t Mesh::s_MeshIdCounter = 0;
+std::atomic<uint32_t> Mesh::s_MeshIdCounter{0};
+
+static_assert(sizeof(Vertex) == VertexCompression::FULL_VERTEX_SIZE &&
+              offsetof(Vertex, normal) == VertexCompression::NORMAL_OFFSET &&
+              offsetof(Vertex, tangent) == VertexCompression::TANGENT_OFFSET &&
+              offsetof(Vertex, bitangent) == VertexCompression::BITANGENT_OFFSET &&
+              offsetof(Vertex, texCoords) == VertexCompression::TEXCOORD_OFFSET,
+              "Vertex compression expects the layout of Vertex");
 
 const std::array<glm::vec3, 36> Mesh::s_CubeVertexPositions{
         glm::vec3(-0.5f, -0.5f, 0.5f),
@@ -65,29 +78,6 @@ const std::array<glm::vec3, 36> Mesh::s_CubeVertexPositions{
 };
 
 
-namespace std {
-    template<>
-    struct hash<tinyobj::index_t> {
-        auto operator()(const tinyobj::index_t &index) const -> size_t {
-            size_t res = 0;
-            hash_combine(res, index.normal_index);
-            hash_combine(res, index.texcoord_index);
-            hash_combine(res, index.vertex_index);
-            return res;
-        }
-    };
-
-    template<>
-    struct equal_to<tinyobj::index_t> {
-        constexpr auto operator()(const tinyobj::index_t &lhs, const tinyobj::index_t &rhs) const -> bool {
-            return lhs.vertex_index == rhs.vertex_index
-                   && lhs.texcoord_index == rhs.texcoord_index
-                   && lhs.normal_index == rhs.normal_index;
-        }
-    };
-}
-
-
 void Mesh::StageData() {
     Renderer::StageMesh(this);
 }
@@ -514,121 +504,126 @@ auto Mesh::Sphere() -> std::unique_ptr<Mesh> {
 }
 
 
-auto Mesh::FromOBJ(const char *filepath) -> std::unique_ptr<Mesh> {
+auto Mesh::FromOBJ(const char *filepath, VertexFormat format) -> std::unique_ptr<Mesh> {
+    uint32_t importFlags = MESH_IMPORT_DEDUPLICATE | MESH_IMPORT_GENERATE_NORMALS | MESH_IMPORT_OPTIMIZE_VERTEX_CACHE |
+                           MESH_IMPORT_GENERATE_LODS | MESH_IMPORT_BUILD_MESHLETS;
+    if (format == VertexFormat::COMPACT)
+        importFlags |= MESH_IMPORT_COMPRESS_VERTICES;
+    std::string cachePath = MeshCache::PathFor(filepath);
+    if (auto cache = MeshCache::Open(cachePath, filepath, importFlags))
+        return std::make_unique<Mesh>(std::move(*cache));
+
     auto mesh(std::make_unique<Mesh>());
     auto &vertexData = mesh->m_VertexData;
     auto &indices = mesh->m_Indices;
-    std::ifstream dumpFile(std::string(filepath) + ".dump", std::ios::in | std::ios::binary);
-    if (dumpFile) {
-        /* Read vertex layout */
-        size_t layoutSize = 0;
-        dumpFile.read((char *) &layoutSize, sizeof(layoutSize));
-        mesh->m_VertexLayout.resize(layoutSize);
-        dumpFile.read((char *) mesh->m_VertexLayout.data(), layoutSize);
-
-        /* Read vertex data */
-        dumpFile.read((char *) &mesh->m_VertexSize, sizeof(mesh->m_VertexSize));
-        dumpFile.read((char *) &mesh->m_VertexCount, sizeof(mesh->m_VertexCount));
-        mesh->m_VertexData.resize(mesh->m_VertexCount * mesh->m_VertexSize);
-        dumpFile.read((char *) mesh->m_VertexData.data(), mesh->m_VertexData.size());
-
-        /* Read index data */
-        size_t indexCount = 0;
-        dumpFile.read((char *) &indexCount, sizeof(indexCount));
-        mesh->m_Indices.resize(indexCount);
-        dumpFile.read((char *) mesh->m_Indices.data(), sizeof(uint32_t) * indexCount);
-
-        dumpFile.close();
-    } else {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath)) {
-            throw std::runtime_error(warn + err);
-        }
+    TaskSystem &taskSystem = Application::Get().m_TaskSystem;
+    ObjMesh obj = ObjParser::Parse(taskSystem, filepath);
 
-        mesh->m_VertexLayout.push_back(sizeof(Vertex::position));
-        mesh->m_VertexLayout.push_back(sizeof(Vertex::normal));
-        mesh->m_VertexLayout.push_back(sizeof(Vertex::texCoords));
-        uint32_t vertexSize = sizeof(Vertex);
-        mesh->m_VertexSize = vertexSize;
-
-        size_t vertexCount = 0;
-        vertexData.reserve((attrib.vertices.size() / 3) * vertexSize);
-
-        std::unordered_map<tinyobj::index_t, uint32_t> uniqueIndices;
-        for (const auto &shape : shapes) {
-            for (const auto &index : shape.mesh.indices) {
-                auto it = uniqueIndices.find(index);
-                if (it == uniqueIndices.cend()) {
-                    it = uniqueIndices.insert(std::make_pair(index, vertexCount)).first;
-
-                    vertexData.resize(vertexData.size() + vertexSize);
-                    auto *vertexPtr = reinterpret_cast<Vertex *>(&vertexData[vertexCount * vertexSize]);
-                    auto *pos_ptr = &attrib.vertices[3 * index.vertex_index];
-                    std::memcpy(&vertexPtr->position.x, pos_ptr, sizeof(Vertex::position));
-
-                    if (!attrib.normals.empty()) {
-                        auto *normal_ptr = &attrib.normals[3 * index.normal_index];
-                        std::memcpy(&vertexPtr->normal.x, normal_ptr, sizeof(Vertex::normal));
-                    }
-                    if (!attrib.texcoords.empty()) {
-                        auto *texcoord_ptr = &attrib.texcoords[2 * index.texcoord_index];
-                        std::memcpy(&vertexPtr->texCoords.x, texcoord_ptr, sizeof(Vertex::texCoords));
-                    }
-
-                    vertexCount++;
-                }
-                indices.push_back(it->second);
-            }
-            std::cout << "Unique indices: " << uniqueIndices.size() << std::endl;
-
-            if (attrib.normals.empty()) {
-                // Try to estimate normals from faces
-                auto *vertexPtr = reinterpret_cast<Vertex *>(vertexData.data());
-                std::vector<glm::vec3> normals(vertexCount);
-                for (size_t i = 0; i < indices.size(); i += 3) {
-                    auto i1 = indices[i];
-                    auto i2 = indices[i + 1];
-                    auto i3 = indices[i + 2];
-                    Vertex *v1 = &vertexPtr[i1];
-                    Vertex *v2 = &vertexPtr[i2];
-                    Vertex *v3 = &vertexPtr[i3];
-                    glm::vec3 normal = glm::normalize(glm::cross(
-                            glm::vec3(v2->position) - glm::vec3(v1->position),
-                            glm::vec3(v3->position) - glm::vec3(v1->position)
-                    ));
-                    normals[i1] += normal;
-                    normals[i2] += normal;
-                    normals[i3] += normal;
-                }
-                for (size_t i = 0; i < vertexCount; i++) {
-                    vertexPtr[i].normal = glm::normalize(normals[i]);
-                }
-            }
+    mesh->m_VertexLayout.push_back(sizeof(Vertex::position));
+    mesh->m_VertexLayout.push_back(sizeof(Vertex::normal));
+    mesh->m_VertexLayout.push_back(sizeof(Vertex::texCoords));
+    uint32_t vertexSize = sizeof(Vertex);
+    mesh->m_VertexSize = vertexSize;
+
+    // Deduplication has to be serial, it only records which OBJ index becomes which vertex. Every
+    // attribute shows up in at least one vertex, so the largest attribute count is a lower bound
+    // on the unique vertices and a good guess for the table size.
+    size_t attributeCount = std::max({obj.positions.size() / 3, obj.normals.size() / 3, obj.texcoords.size() / 2});
+    WeldTable<ObjIndex, VertexWeld::PodHash<ObjIndex>, std::equal_to<ObjIndex>> uniqueIndices(attributeCount);
+    indices.resize(obj.indices.size());
+    for (size_t i = 0; i < obj.indices.size(); i++)
+        indices[i] = uniqueIndices.Insert(obj.indices[i]);
+    const std::vector<ObjIndex> &vertexSources = uniqueIndices.Keys();
+    LOG_DEBUG("[Mesh] {}: {} unique vertices", filepath, vertexSources.size());
+
+    size_t vertexCount = vertexSources.size();
+    vertexData.resize(vertexCount * vertexSize);
+    auto *vertexPtr = reinterpret_cast<Vertex *>(vertexData.data());
+
+    Parallel::For(taskSystem, 0, vertexCount, [&](size_t i) {
+        const auto &index = vertexSources[i];
+        auto *pos_ptr = &obj.positions[3 * index.position];
+        std::memcpy(&vertexPtr[i].position.x, pos_ptr, sizeof(Vertex::position));
+
+        if (index.normal >= 0) {
+            auto *normal_ptr = &obj.normals[3 * index.normal];
+            std::memcpy(&vertexPtr[i].normal.x, normal_ptr, sizeof(Vertex::normal));
         }
-
-        std::ofstream dumpOutput(std::string(filepath) + ".dump", std::ios::out | std::ios::binary);
-        if (dumpOutput) {
-            size_t indexCount = indices.size();
-            size_t layoutSize = mesh->m_VertexLayout.size() * sizeof(uint8_t);
-            dumpOutput.write((char *) &layoutSize, sizeof(layoutSize));
-            dumpOutput.write((char *) mesh->m_VertexLayout.data(), layoutSize);
-            dumpOutput.write((char *) &vertexSize, sizeof(vertexSize));
-            dumpOutput.write((char *) (&vertexCount), sizeof(vertexCount));
-            dumpOutput.write((char *) vertexData.data(), vertexData.size());
-            dumpOutput.write((char *) (&indexCount), sizeof(indexCount));
-            dumpOutput.write((char *) indices.data(), sizeof(uint32_t) * indices.size());
-            dumpOutput.close();
+        if (index.texcoord >= 0) {
+            auto *texcoord_ptr = &obj.texcoords[2 * index.texcoord];
+            std::memcpy(&vertexPtr[i].texCoords.x, texcoord_ptr, sizeof(Vertex::texCoords));
+        }
+    }, 1024);
+
+    if (obj.normals.empty()) {
+        // Try to estimate normals from faces, face normals are independent, accumulation isn't
+        std::vector<glm::vec3> faceNormals(indices.size() / 3);
+        Parallel::For(taskSystem, 0, faceNormals.size(), [&](size_t face) {
+            Vertex *v1 = &vertexPtr[indices[face * 3]];
+            Vertex *v2 = &vertexPtr[indices[face * 3 + 1]];
+            Vertex *v3 = &vertexPtr[indices[face * 3 + 2]];
+            faceNormals[face] = glm::normalize(glm::cross(
+                    glm::vec3(v2->position) - glm::vec3(v1->position),
+                    glm::vec3(v3->position) - glm::vec3(v1->position)
+            ));
+        }, 1024);
+
+        std::vector<glm::vec3> normals(vertexCount);
+        for (size_t face = 0; face < faceNormals.size(); face++) {
+            normals[indices[face * 3]] += faceNormals[face];
+            normals[indices[face * 3 + 1]] += faceNormals[face];
+            normals[indices[face * 3 + 2]] += faceNormals[face];
         }
+        Parallel::For(taskSystem, 0, vertexCount, [&](size_t i) {
+            vertexPtr[i].normal = glm::normalize(normals[i]);
+        }, 1024);
     }
 
+    mesh->m_VertexCount = vertexCount;
+    mesh->Optimize();
+    mesh->GenerateLods();
+    mesh->BuildMeshlets();
+    if (format == VertexFormat::COMPACT)
+        mesh->Compress();
+
+    MeshCacheData cacheData;
+    cacheData.layout = mesh->m_VertexLayout;
+    cacheData.vertexSize = mesh->m_VertexSize;
+    cacheData.vertexCount = mesh->m_VertexCount;
+    cacheData.format = mesh->m_VertexFormat;
+    cacheData.quantization = mesh->m_Quantization;
+    cacheData.vertices = vertexData;
+    cacheData.indices = indices;
+    cacheData.lods = mesh->m_Lods;
+    cacheData.meshlets = mesh->m_Meshlets.View();
+    if (!MeshCache::Write(cachePath, filepath, importFlags, cacheData))
+        LOG_WARNING("[Mesh] Failed to write mesh cache {}", cachePath);
+
     return mesh;
 }
 
 
+Mesh::Mesh(MeshCacheView cache, std::optional<uint32_t> assimpMaterialIdx)
+        : m_VertexData(std::move(cache.decodedVertices)),
+          m_Indices(std::move(cache.decodedIndices)),
+          m_VertexLayout(cache.layout.begin(), cache.layout.end()),
+          m_MappedFile(std::move(cache.file)),
+          m_MappedVertices(cache.vertices),
+          m_MappedIndices(cache.indices),
+          m_MappedLods(cache.lods),
+          m_MappedMeshlets(cache.meshlets),
+          m_VertexFormat(cache.format),
+          m_Quantization(cache.quantization),
+          m_VertexCount(cache.vertexCount),
+          m_VertexSize(cache.vertexSize),
+          m_MeshID(s_MeshIdCounter++),
+          m_AssimpMaterialIdx(assimpMaterialIdx) {
+    if (!m_MappedLods.empty())
+        CalculateBounds();
+}
+
+
 Mesh::Mesh(const aiMesh *sourceMesh, uint32_t assimpMaterialIdx)
         : m_VertexSize(sizeof(Vertex)),
           m_MeshID(s_MeshIdCounter++),
@@ -638,39 +633,195 @@ Mesh::Mesh(const aiMesh *sourceMesh, uint32_t assimpMaterialIdx)
     m_VertexLayout.push_back(sizeof(Vertex::texCoords));
     uint32_t vertexSize = sizeof(Vertex);
 
+    TaskSystem &taskSystem = Application::Get().m_TaskSystem;
     m_VertexData.resize(sourceMesh->mNumVertices * vertexSize);
     auto *vertexPtr = reinterpret_cast<Vertex *>(m_VertexData.data());
-    for (unsigned int i = 0; i < sourceMesh->mNumVertices; i++) {
-        vertexPtr->position.x = sourceMesh->mVertices[i].x;
-        vertexPtr->position.y = sourceMesh->mVertices[i].y;
-        vertexPtr->position.z = sourceMesh->mVertices[i].z;
-        vertexPtr->normal.x = sourceMesh->mNormals[i].x;
-        vertexPtr->normal.y = sourceMesh->mNormals[i].y;
-        vertexPtr->normal.z = sourceMesh->mNormals[i].z;
-        vertexPtr->tangent.x = sourceMesh->mTangents[i].x;
-        vertexPtr->tangent.y = sourceMesh->mTangents[i].y;
-        vertexPtr->tangent.z = sourceMesh->mTangents[i].z;
-        vertexPtr->bitangent.x = sourceMesh->mBitangents[i].x;
-        vertexPtr->bitangent.y = sourceMesh->mBitangents[i].y;
-        vertexPtr->bitangent.z = sourceMesh->mBitangents[i].z;
+    // Assimp keeps every attribute in its own array, vertices are independent of each other
+    Parallel::For(taskSystem, 0, sourceMesh->mNumVertices, [&](size_t i) {
+        vertexPtr[i].position.x = sourceMesh->mVertices[i].x;
+        vertexPtr[i].position.y = sourceMesh->mVertices[i].y;
+        vertexPtr[i].position.z = sourceMesh->mVertices[i].z;
+        vertexPtr[i].normal.x = sourceMesh->mNormals[i].x;
+        vertexPtr[i].normal.y = sourceMesh->mNormals[i].y;
+        vertexPtr[i].normal.z = sourceMesh->mNormals[i].z;
+        vertexPtr[i].tangent.x = sourceMesh->mTangents[i].x;
+        vertexPtr[i].tangent.y = sourceMesh->mTangents[i].y;
+        vertexPtr[i].tangent.z = sourceMesh->mTangents[i].z;
+        vertexPtr[i].bitangent.x = sourceMesh->mBitangents[i].x;
+        vertexPtr[i].bitangent.y = sourceMesh->mBitangents[i].y;
+        vertexPtr[i].bitangent.z = sourceMesh->mBitangents[i].z;
 
         if (sourceMesh->mTextureCoords[0]) {
-            vertexPtr->texCoords.x = sourceMesh->mTextureCoords[0][i].x;
-            vertexPtr->texCoords.y = sourceMesh->mTextureCoords[0][i].y;
+            vertexPtr[i].texCoords.x = sourceMesh->mTextureCoords[0][i].x;
+            vertexPtr[i].texCoords.y = sourceMesh->mTextureCoords[0][i].y;
+        }
+    }, 1024);
+
+    // Only pure triangle meshes know every face's position in the index buffer up front, the
+    // importer leaves points and lines alone and those meshes are flattened serially
+    if (sourceMesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+        m_Indices.resize(size_t(sourceMesh->mNumFaces) * 3);
+        Parallel::For(taskSystem, 0, sourceMesh->mNumFaces, [&](size_t i) {
+            const aiFace &face = sourceMesh->mFaces[i];
+            std::copy_n(face.mIndices, 3, &m_Indices[i * 3]);
+        }, 4096);
+    } else {
+        for (unsigned int i = 0; i < sourceMesh->mNumFaces; i++) {
+            const aiFace &face = sourceMesh->mFaces[i];
+            for (unsigned int j = 0; j < face.mNumIndices; j++)
+                m_Indices.push_back(face.mIndices[j]);
         }
-        vertexPtr++;
-    }
-
-    for (unsigned int i = 0; i < sourceMesh->mNumFaces; i++) {
-        const aiFace &face = sourceMesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++)
-            m_Indices.push_back(face.mIndices[j]);
     }
     m_VertexCount = sourceMesh->mNumVertices;
     m_AssimpMaterialIdx = sourceMesh->mMaterialIndex;
 }
 
 
+void Mesh::Optimize(float overdrawThreshold) {
+    if (m_MappedFile || m_Indices.empty())
+        return;
+
+    // Overdraw ordering needs the position as the leading three floats, true for every Vertex based mesh
+    bool hasPositions = !m_VertexLayout.empty() && m_VertexLayout[0] == sizeof(Vertex::position);
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+    // The statistics are only for the log, the overdraw estimate rasterizes the mesh six times
+    auto cacheBefore = MeshOptimizer::AnalyzeVertexCache(m_Indices, m_VertexCount);
+    OverdrawStats overdrawBefore;
+    if (hasPositions)
+        overdrawBefore = MeshOptimizer::AnalyzeOverdraw(m_Indices, m_VertexData.data(), m_VertexCount, m_VertexSize);
+#endif
+
+    m_Indices = MeshOptimizer::OptimizeVertexCache(m_Indices, m_VertexCount);
+    if (hasPositions) {
+        m_Indices = MeshOptimizer::OptimizeOverdraw(m_Indices, m_VertexData.data(), m_VertexCount, m_VertexSize,
+                                                    overdrawThreshold);
+    }
+    m_VertexCount = MeshOptimizer::OptimizeVertexFetch(m_Indices, m_VertexData, m_VertexSize);
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+    auto cacheAfter = MeshOptimizer::AnalyzeVertexCache(m_Indices, m_VertexCount);
+    LOG_DEBUG("[Mesh] Vertex cache ACMR {} -> {}, ATVR {} -> {}", cacheBefore.acmr, cacheAfter.acmr,
+              cacheBefore.atvr, cacheAfter.atvr);
+    if (hasPositions) {
+        auto overdrawAfter = MeshOptimizer::AnalyzeOverdraw(m_Indices, m_VertexData.data(), m_VertexCount, m_VertexSize);
+        LOG_DEBUG("[Mesh] Estimated overdraw {} -> {}", overdrawBefore.overdraw, overdrawAfter.overdraw);
+    }
+#endif
+}
+
+
+void Mesh::GenerateLods(const MeshLodSettings &settings) {
+    if (m_MappedFile || m_Indices.empty() || m_VertexSize != sizeof(Vertex))
+        return;
+
+    const SimplifyAttribute attributes[] = {
+            {offsetof(Vertex, normal), 3, settings.normalWeight},
+            {offsetof(Vertex, texCoords), 2, settings.texCoordWeight},
+    };
+    float extent = MeshSimplifier::Extent(m_Indices, m_VertexData.data(), m_VertexSize);
+    m_Lods = {MeshLod{0, static_cast<uint32_t>(m_Indices.size()), 0.0f}};
+
+    // Every level is simplified from the previous one, its error bound is the sum of the steps
+    std::vector<uint32_t> previous = m_Indices;
+    float error = 0.0f;
+    for (uint32_t level = 1; level <= settings.levels && m_Lods.size() < MeshCache::MAX_LODS; level++) {
+        size_t targetIndexCount = static_cast<size_t>(previous.size() / 3 * settings.reduction) * 3;
+        auto result = MeshSimplifier::Simplify(previous, m_VertexData.data(), m_VertexCount, m_VertexSize,
+                                               {attributes, std::size(attributes)}, targetIndexCount,
+                                               settings.maxError - error);
+        // A level which barely lost any triangles isn't worth its memory, the mesh is as coarse as the error allows
+        if (result.indices.empty() || result.indices.size() * 10 > previous.size() * 9)
+            break;
+
+        error += result.error;
+        auto indices = MeshOptimizer::OptimizeVertexCache(result.indices, m_VertexCount);
+        m_Lods.push_back(MeshLod{static_cast<uint32_t>(m_Indices.size()), static_cast<uint32_t>(indices.size()),
+                                 error * extent});
+        m_Indices.insert(m_Indices.end(), indices.begin(), indices.end());
+        LOG_DEBUG("[Mesh] LOD {}: {} triangles, error {}", level, indices.size() / 3, error * extent);
+        previous = std::move(indices);
+    }
+    if (m_Lods.size() == 1)
+        m_Lods.clear();
+    else
+        CalculateBounds();
+}
+
+
+void Mesh::BuildMeshlets() {
+    if (m_MappedFile || m_Indices.empty() || m_VertexLayout.empty() || m_VertexLayout[0] != sizeof(Vertex::position))
+        return;
+
+    MeshLod lod = Lod(0);
+    m_Meshlets = MeshletBuilder::Build({m_Indices.data() + lod.firstIndex, lod.indexCount}, m_VertexData.data(),
+                                       m_VertexCount, m_VertexSize);
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+    auto stats = MeshletBuilder::Analyze(m_Meshlets.View(), m_VertexCount);
+    LOG_DEBUG("[Mesh] {} meshlets, triangle fill {}, vertex duplication {}, cullable cones {}",
+              stats.meshletCount, stats.triangleFill, stats.vertexDuplication, stats.cullableCones);
+#endif
+}
+
+
+void Mesh::Compress() {
+    if (m_MappedFile || m_VertexFormat != VertexFormat::FULL || m_VertexSize != sizeof(Vertex))
+        return;
+
+    m_Quantization = VertexCompression::Quantization(m_VertexData.data(), m_VertexCount);
+    std::vector<uint8_t> compactData(m_VertexCount * sizeof(CompactVertex));
+    auto *compactVertices = reinterpret_cast<CompactVertex *>(compactData.data());
+    VertexCompression::Encode(m_VertexData.data(), m_VertexCount, m_Quantization, compactVertices);
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+    std::vector<uint8_t> decoded(m_VertexData.size());
+    VertexCompression::Decode(compactVertices, m_VertexCount, m_Quantization, decoded.data());
+    auto error = VertexCompression::MeasureError(m_VertexData.data(), decoded.data(), m_VertexCount);
+    LOG_DEBUG("[Mesh] Compressed {} -> {} bytes, max error: position {}, normal {} deg, tangent {} deg, uv {}",
+              m_VertexData.size(), compactData.size(), error.position, error.normal, error.tangent, error.texCoord);
+    auto bound = VertexCompression::ErrorBound(m_VertexData.data(), m_VertexCount, m_Quantization);
+    if (!VertexCompression::IsWithinBound(error, bound))
+        LOG_WARNING("[Mesh] Compression error exceeds its bound: position {} ({}), normal {} ({}) deg, "
+                    "tangent {} ({}) deg, uv {} ({})", error.position, bound.position, error.normal, bound.normal,
+                    error.tangent, bound.tangent, error.texCoord, bound.texCoord);
+#endif
+
+    // Matches the inputs of the compact vertex shaders: uvec2 position, uvec2 normal and tangent, uint uv
+    m_VertexLayout = {8, 8, 4};
+    m_VertexSize = sizeof(CompactVertex);
+    m_VertexData = std::move(compactData);
+    m_VertexFormat = VertexFormat::COMPACT;
+}
+
+
+void Mesh::CalculateBounds() {
+    // Centered on the bounding box, not the tightest sphere but within a few percent for typical models
+    const uint8_t *vertices = VertexData().data();
+    const PositionQuantization &q = m_Quantization;
+    glm::vec3 quantizationOffset(q.offset[0], q.offset[1], q.offset[2]);
+    glm::vec3 quantizationStep = glm::vec3(q.scale[0], q.scale[1], q.scale[2]) / 65535.0f;
+    auto position = [&](uint64_t i) -> glm::vec3 {
+        if (m_VertexFormat == VertexFormat::FULL)
+            return *reinterpret_cast<const glm::vec3 *>(vertices + i * m_VertexSize);
+        const auto *vertex = reinterpret_cast<const CompactVertex *>(vertices) + i;
+        return quantizationOffset +
+               glm::vec3(vertex->position[0], vertex->position[1], vertex->position[2]) * quantizationStep;
+    };
+
+    glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+    for (uint64_t i = 0; i < m_VertexCount; i++) {
+        min = glm::min(min, position(i));
+        max = glm::max(max, position(i));
+    }
+
+    m_Bounds.center = (min + max) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (uint64_t i = 0; i < m_VertexCount; i++) {
+        glm::vec3 offset = position(i) - m_Bounds.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    m_Bounds.radius = std::sqrt(radiusSquared);
+}
+
+
 //void Mesh::SetMaterial(Material *material,
 //                       const std::pair<uint32_t, uint32_t> &materialBinding,
 //                       const std::unordered_map<Texture2D::Type, uint32_t> &textureIndices) {
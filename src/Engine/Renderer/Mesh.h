@@ -1,12 +1,19 @@
 #ifndef GAME_ENGINE_MESH_H
 #define GAME_ENGINE_MESH_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <limits>
 #include <vector>
 #include <glm/glm.hpp>
 #include <assimp/material.h>
 #include <assimp/mesh.h>
+#include "MeshCache.h"
+#include "MeshCodec.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "VertexCompression.h"
 #include "Texture.h"
 #include "Material.h"
 
@@ -26,6 +33,26 @@ struct Vertex {
 };
 
 
+/// How Mesh::GenerateLods builds the level of detail chain
+struct MeshLodSettings {
+    /// Levels below the full mesh
+    uint32_t levels = 4;
+    /// Triangle count of every level relative to the previous one
+    float reduction = 0.5f;
+    /// No level deviates further from the full mesh, relative to the mesh extent
+    float maxError = 0.05f;
+    float normalWeight = 0.5f;
+    float texCoordWeight = 0.5f;
+};
+
+
+/// Bounding sphere in object space
+struct MeshBounds {
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+};
+
+
 struct MeshTexture {
     std::shared_ptr<Texture2D> texture;
     Texture2D::Type type;
@@ -42,6 +69,8 @@ class MeshRenderer {
 
     uint32_t m_ParentEntityID = 0;
     uint32_t m_MeshInstanceID = 0;
+    /// Written by the renderer's LOD selection, the previous choice is needed for hysteresis
+    mutable uint32_t m_SelectedLod = 0;
 
     explicit MeshRenderer(const Mesh *mesh, uint32_t instanceID, uint32_t parentEntityID) :
             m_Mesh(mesh), m_ParentEntityID(parentEntityID), m_MeshInstanceID(instanceID) {}
@@ -74,16 +103,35 @@ public:
     auto GetMesh() const -> const Mesh * { return m_Mesh; }
 
     auto ParentEntityID() const { return m_ParentEntityID; }
+
+    auto SelectedLod() const -> uint32_t { return m_SelectedLod; }
+
+    void SetSelectedLod(uint32_t level) const { m_SelectedLod = level; }
 };
 
 
 class Mesh {
 private:
-    static uint32_t s_MeshIdCounter;
+    /// Meshes are also created from asset loading jobs
+    static std::atomic<uint32_t> s_MeshIdCounter;
 
     std::vector<uint8_t> m_VertexData;
     std::vector<uint32_t> m_Indices;
     std::vector<uint8_t> m_VertexLayout;
+    /// Index ranges of the levels of detail inside m_Indices, empty when there is only the full mesh
+    std::vector<MeshLod> m_Lods;
+    MeshletBuffers m_Meshlets;
+    /// Set when the data is aliased from a mesh cache instead of the vectors above, encoded sections are decoded into them
+    std::shared_ptr<MappedFile> m_MappedFile;
+    ArrayView<const uint8_t> m_MappedVertices;
+    ArrayView<const uint32_t> m_MappedIndices;
+    ArrayView<const MeshLod> m_MappedLods;
+    MeshletView m_MappedMeshlets;
+    /// Only calculated for meshes with LODs, selection is the only user
+    MeshBounds m_Bounds;
+    VertexFormat m_VertexFormat = VertexFormat::FULL;
+    /// Only meaningful for compact vertices
+    PositionQuantization m_Quantization;
     uint64_t m_VertexCount = 0;
     uint32_t m_VertexSize = 0;
     uint32_t m_InstanceCount = 0;
@@ -91,6 +139,8 @@ private:
 
     std::optional<uint32_t> m_AssimpMaterialIdx;
 
+    void CalculateBounds();
+
 public:
     const static std::array<glm::vec3, 36> s_CubeVertexPositions;
 
@@ -98,6 +148,9 @@ public:
 
     Mesh(const aiMesh *sourceMesh, uint32_t assimpMaterialIdx);
 
+    /// Aliases the cached data and takes whatever was decoded, the mapping is kept alive by the mesh
+    explicit Mesh(MeshCacheView cache, std::optional<uint32_t> assimpMaterialIdx = std::nullopt);
+
     Mesh(const Mesh &other) = delete;
 
     auto operator=(const Mesh &other) -> Mesh & = delete;
@@ -120,19 +173,52 @@ public:
 
     static auto Sphere() -> std::unique_ptr<Mesh>;
 
-    static auto FromOBJ(const char *filepath) -> std::unique_ptr<Mesh>;
+    static auto FromOBJ(const char *filepath, VertexFormat format = VertexFormat::FULL) -> std::unique_ptr<Mesh>;
 
-    auto VertexData() const -> const auto & { return m_VertexData; }
+    auto VertexData() const -> ArrayView<const uint8_t> {
+        return m_MappedFile ? m_MappedVertices : ArrayView<const uint8_t>(m_VertexData);
+    }
 
-    auto Indices() const -> const auto & { return m_Indices; }
+    auto Indices() const -> ArrayView<const uint32_t> {
+        return m_MappedFile ? m_MappedIndices : ArrayView<const uint32_t>(m_Indices);
+    }
+
+    /// Bytes per index in the GPU's index buffer, the indices are narrowed while staging
+    auto IndexSize() const -> uint32_t { return MeshCodec::IndexSize(m_VertexCount); }
+
+    auto Lods() const -> ArrayView<const MeshLod> {
+        return m_MappedFile ? m_MappedLods : ArrayView<const MeshLod>(m_Lods);
+    }
+
+    auto LodCount() const -> size_t { return std::max<size_t>(Lods().size(), 1); }
+
+    /// Index range of the level, clamped to the coarsest one. Meshes without LODs only have level 0.
+    auto Lod(size_t level) const -> MeshLod {
+        auto lods = Lods();
+        if (lods.empty())
+            return MeshLod{0, static_cast<uint32_t>(Indices().size()), 0.0f};
+        return lods[std::min(level, lods.size() - 1)];
+    }
+
+    auto Bounds() const -> const MeshBounds & { return m_Bounds; }
+
+    /// Clusters of LOD 0, empty when the mesh wasn't clustered
+    auto Meshlets() const -> MeshletView { return m_MappedFile ? m_MappedMeshlets : m_Meshlets.View(); }
 
     template<typename T>
-    auto Vertices() const -> const T * { return m_VertexData.data(); }
+    auto Vertices() const -> const T * { return reinterpret_cast<const T *>(VertexData().data()); }
 
     auto VertexCount() const -> auto { return m_VertexCount; }
 
+    auto VertexSize() const -> auto { return m_VertexSize; }
+
     auto VertexLayout() const -> const auto & { return m_VertexLayout; }
 
+    auto Format() const -> VertexFormat { return m_VertexFormat; }
+
+    /// Decodes the compact positions, pushed to the compact vertex shaders
+    auto Quantization() const -> const PositionQuantization & { return m_Quantization; }
+
 //    void SetMaterial(Material *material,
 //                     const std::pair<uint32_t, uint32_t>& materialBinding,
 //                     const std::unordered_map<Texture2D::Type, uint32_t>& textureIndices);
@@ -143,6 +229,19 @@ public:
 
     auto AssimpMaterialIdx() const -> auto { return m_AssimpMaterialIdx.value(); }
 
+    /// Reorders the triangles and vertices of a triangle list mesh for the post-transform cache, overdraw
+    /// and vertex fetch. Meant for import time, meshes aliasing a cache were optimized before being written.
+    void Optimize(float overdrawThreshold = MeshOptimizer::DEFAULT_OVERDRAW_THRESHOLD);
+
+    /// Appends simplified levels to the index buffer, they all reference the full mesh's vertices. Run after Optimize.
+    void GenerateLods(const MeshLodSettings &settings = MeshLodSettings());
+
+    /// Splits LOD 0 into meshlets with culling bounds. Run after Optimize, the builder follows the index order.
+    void BuildMeshlets();
+
+    /// Re-encodes the vertices as CompactVertex. Run last, the other import passes read float positions.
+    void Compress();
+
     auto MeshID() const -> auto { return m_MeshID; }
 
     void StageData();
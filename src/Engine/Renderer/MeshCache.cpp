@@ -0,0 +1,330 @@
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <Engine/Core/Hash.h>
+
+
+namespace {
+    auto AlignUp(uint64_t value, uint64_t alignment) -> uint64_t {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    void WritePadding(std::ofstream &file, uint64_t from, uint64_t to) {
+        static const char s_Zeros[MeshCache::SECTION_ALIGNMENT]{};
+        file.write(s_Zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    auto IsValid(const MeshCacheHeader &header, size_t fileSize, uint32_t importFlags) -> bool {
+        if (header.magic != MeshCacheHeader::MAGIC || header.endianness != MeshCacheHeader::ENDIANNESS ||
+            header.version != MeshCacheHeader::VERSION || header.headerSize != sizeof(MeshCacheHeader))
+            return false;
+        if (header.importFlags != importFlags || header.fileSize != fileSize)
+            return false;
+        if (header.layoutCount > MeshCacheHeader::MAX_LAYOUT_ATTRIBUTES || header.indexSize != sizeof(uint32_t) ||
+            header.lodCount > MeshCache::MAX_LODS)
+            return false;
+        if (header.vertexFormat > static_cast<uint32_t>(VertexFormat::COMPACT) ||
+            (header.vertexFormat == static_cast<uint32_t>(VertexFormat::COMPACT) &&
+             header.vertexSize != sizeof(CompactVertex)))
+            return false;
+        if (header.vertexOffset % MeshCache::SECTION_ALIGNMENT || header.indexOffset % MeshCache::SECTION_ALIGNMENT)
+            return false;
+
+        if (header.meshletOffset % MeshCache::SECTION_ALIGNMENT ||
+            header.meshletVertexOffset % MeshCache::SECTION_ALIGNMENT ||
+            header.meshletTriangleOffset % MeshCache::SECTION_ALIGNMENT)
+            return false;
+
+        // Division instead of multiplication, a corrupted count must not overflow into a valid size
+        if (header.vertexSectionSize > fileSize || header.indexSectionSize > fileSize)
+            return false;
+        if (header.meshletCount > fileSize / sizeof(Meshlet) || header.meshletVertexCount > fileSize / sizeof(uint32_t) ||
+            header.meshletTriangleSize > fileSize)
+            return false;
+        uint64_t lodEnd = sizeof(MeshCacheHeader) + header.lodCount * sizeof(MeshLod);
+        uint64_t vertexEnd = header.vertexOffset + header.vertexSectionSize;
+        uint64_t indexEnd = header.indexOffset + header.indexSectionSize;
+        uint64_t meshletEnd = header.meshletOffset + header.meshletCount * sizeof(Meshlet);
+        uint64_t meshletVertexEnd = header.meshletVertexOffset + header.meshletVertexCount * sizeof(uint32_t);
+        return header.vertexOffset >= lodEnd && vertexEnd <= fileSize &&
+               header.indexOffset >= vertexEnd && indexEnd <= fileSize &&
+               header.meshletOffset >= indexEnd && meshletEnd <= fileSize &&
+               header.meshletVertexOffset >= meshletEnd && meshletVertexEnd <= fileSize &&
+               header.meshletTriangleOffset >= meshletVertexEnd &&
+               header.meshletTriangleOffset + header.meshletTriangleSize <= fileSize;
+    }
+}
+
+
+namespace MeshCache {
+
+    auto PathFor(const std::string &sourcePath) -> std::string {
+        return sourcePath + ".meshcache";
+    }
+
+
+    auto AreLodsValid(ArrayView<const MeshLod> lods, uint64_t indexCount) -> bool {
+        for (const auto &lod : lods) {
+            if (lod.firstIndex > indexCount || lod.indexCount > indexCount - lod.firstIndex || lod.indexCount % 3)
+                return false;
+        }
+        return true;
+    }
+
+
+    auto AreIndicesInRange(ArrayView<const uint32_t> indices, uint64_t vertexCount) -> bool {
+        // Running maximum instead of an early exit, so the loop vectorizes
+        uint32_t maxIndex = 0;
+        for (uint32_t index : indices)
+            maxIndex = std::max(maxIndex, index);
+        return indices.empty() || maxIndex < vertexCount;
+    }
+
+
+    auto AreMeshletsValid(const MeshletView &meshlets) -> bool {
+        for (const auto &meshlet : meshlets.meshlets) {
+            if (meshlet.vertexCount > Meshlet::MAX_VERTICES || meshlet.triangleCount > Meshlet::MAX_TRIANGLES ||
+                meshlet.vertexOffset > meshlets.vertices.size() ||
+                meshlet.vertexCount > meshlets.vertices.size() - meshlet.vertexOffset ||
+                meshlet.triangleOffset > meshlets.triangles.size() ||
+                meshlet.triangleCount * 3 > meshlets.triangles.size() - meshlet.triangleOffset)
+                return false;
+
+            const uint8_t *triangles = meshlets.triangles.data() + meshlet.triangleOffset;
+            if (!std::all_of(triangles, triangles + meshlet.triangleCount * 3,
+                             [&](uint8_t local) { return local < meshlet.vertexCount; }))
+                return false;
+        }
+        return true;
+    }
+
+
+    auto ReadSections(SectionEncoding vertexEncoding, ArrayView<const uint8_t> vertexSection,
+                      SectionEncoding indexEncoding, ArrayView<const uint8_t> indexSection, uint64_t indexCount,
+                      MeshCacheView &view) -> bool {
+        if (view.vertexSize == 0)
+            return false;
+
+        switch (vertexEncoding) {
+            case SectionEncoding::RAW:
+                // Division instead of multiplication, a corrupted count must not overflow into a valid size
+                if (view.vertexCount != vertexSection.size() / view.vertexSize ||
+                    vertexSection.size() % view.vertexSize)
+                    return false;
+                view.vertices = vertexSection;
+                break;
+            case SectionEncoding::MESH_CODEC:
+                // Bounds what a corrupted count can make us allocate before the decoder notices
+                if (view.vertexCount > vertexSection.size() * MeshCodec::MAX_EXPANSION / view.vertexSize)
+                    return false;
+                view.decodedVertices.resize(view.vertexCount * view.vertexSize);
+                if (!MeshCodec::DecodeVertices(vertexSection, view.vertexCount, view.vertexSize,
+                                               view.decodedVertices.data()))
+                    return false;
+                view.vertices = view.decodedVertices;
+                break;
+            default:
+                return false;
+        }
+
+        switch (indexEncoding) {
+            case SectionEncoding::RAW:
+                if (indexCount != indexSection.size() / sizeof(uint32_t) || indexSection.size() % sizeof(uint32_t))
+                    return false;
+                view.indices = {reinterpret_cast<const uint32_t *>(indexSection.data()), indexCount};
+                break;
+            case SectionEncoding::MESH_CODEC:
+                if (indexCount > indexSection.size() * MeshCodec::MAX_EXPANSION / sizeof(uint32_t))
+                    return false;
+                view.decodedIndices.resize(indexCount);
+                if (!MeshCodec::DecodeIndices(indexSection, indexCount, view.decodedIndices.data()))
+                    return false;
+                view.indices = view.decodedIndices;
+                break;
+            default:
+                return false;
+        }
+        return AreIndicesInRange(view.indices, view.vertexCount) &&
+               AreIndicesInRange(view.meshlets.vertices, view.vertexCount);
+    }
+
+
+    auto VertexSection(const MeshCacheData &data, std::vector<uint8_t> &storage) -> ArrayView<const uint8_t> {
+        if (data.vertexEncoding == SectionEncoding::RAW)
+            return data.vertices;
+        storage = MeshCodec::EncodeVertices(data.vertices.data(), data.vertexCount, data.vertexSize);
+        return storage;
+    }
+
+
+    auto IndexSection(const MeshCacheData &data, std::vector<uint8_t> &storage) -> ArrayView<const uint8_t> {
+        if (data.indexEncoding == SectionEncoding::RAW)
+            return {reinterpret_cast<const uint8_t *>(data.indices.data()), data.indices.size() * sizeof(uint32_t)};
+        storage = MeshCodec::EncodeIndices(data.indices);
+        return storage;
+    }
+
+
+    auto HashSource(const std::string &sourcePath) -> std::optional<uint64_t> {
+        auto source = MappedFile::Open(sourcePath);
+        if (!source)
+            return std::nullopt;
+        return Hash::Hash64(source->Data(), source->Size());
+    }
+
+
+    auto IsSourceCurrent(const std::string &sourcePath, uint64_t size, uint64_t modified, uint64_t hash) -> bool {
+        // Without the source there is nothing to be stale against, the cache may have been shipped alone
+        auto stamp = FileStamp::Of(sourcePath);
+        if (!stamp)
+            return true;
+        if (stamp->size != size)
+            return false;
+        return stamp->modified == modified || HashSource(sourcePath) == hash;
+    }
+
+
+    auto Open(const std::string &cachePath, const std::string &sourcePath, uint32_t importFlags)
+    -> std::optional<MeshCacheView> {
+        auto file = MappedFile::Open(cachePath);
+        if (!file || file->Size() < sizeof(MeshCacheHeader))
+            return std::nullopt;
+
+        MeshCacheHeader header{};
+        std::memcpy(&header, file->Data(), sizeof(header));
+        if (!IsValid(header, file->Size(), importFlags))
+            return std::nullopt;
+
+        ArrayView<const MeshLod> lods(reinterpret_cast<const MeshLod *>(file->Data() + sizeof(MeshCacheHeader)),
+                                      header.lodCount);
+        MeshletView meshlets;
+        meshlets.meshlets = {reinterpret_cast<const Meshlet *>(file->Data() + header.meshletOffset),
+                             header.meshletCount};
+        meshlets.vertices = {reinterpret_cast<const uint32_t *>(file->Data() + header.meshletVertexOffset),
+                             header.meshletVertexCount};
+        meshlets.triangles = {file->Data() + header.meshletTriangleOffset, header.meshletTriangleSize};
+        if (!AreLodsValid(lods, header.indexCount) || !AreMeshletsValid(meshlets))
+            return std::nullopt;
+
+        if (!IsSourceCurrent(sourcePath, header.sourceSize, header.sourceModified, header.sourceHash))
+            return std::nullopt;
+
+        MeshCacheView view;
+        view.layout = {file->Data() + offsetof(MeshCacheHeader, layout), header.layoutCount};
+        view.vertexSize = header.vertexSize;
+        view.vertexCount = header.vertexCount;
+        view.format = static_cast<VertexFormat>(header.vertexFormat);
+        std::memcpy(view.quantization.offset, header.positionOffset, sizeof(header.positionOffset));
+        std::memcpy(view.quantization.scale, header.positionScale, sizeof(header.positionScale));
+        view.lods = lods;
+        view.meshlets = meshlets;
+        file->Prefetch(header.vertexOffset, file->Size() - header.vertexOffset);
+        if (!ReadSections(static_cast<SectionEncoding>(header.vertexEncoding),
+                          {file->Data() + header.vertexOffset, header.vertexSectionSize},
+                          static_cast<SectionEncoding>(header.indexEncoding),
+                          {file->Data() + header.indexOffset, header.indexSectionSize}, header.indexCount, view))
+            return std::nullopt;
+        view.file = std::move(file);
+        return view;
+    }
+
+
+    auto Write(const std::string &cachePath, const std::string &sourcePath, uint32_t importFlags,
+               const MeshCacheData &data) -> bool {
+        if (data.layout.size() > MeshCacheHeader::MAX_LAYOUT_ATTRIBUTES ||
+            data.vertexSize == 0 || data.vertexSize % sizeof(uint32_t) ||
+            data.vertices.size() != data.vertexCount * data.vertexSize ||
+            data.lods.size() > MAX_LODS || !AreLodsValid(data.lods, data.indices.size()) ||
+            !AreMeshletsValid(data.meshlets) || !AreIndicesInRange(data.indices, data.vertexCount) ||
+            !AreIndicesInRange(data.meshlets.vertices, data.vertexCount))
+            return false;
+
+        auto stamp = FileStamp::Of(sourcePath);
+        auto sourceHash = HashSource(sourcePath);
+        if (!stamp || !sourceHash)
+            return false;
+
+        MeshCacheHeader header{};
+        header.magic = MeshCacheHeader::MAGIC;
+        header.version = MeshCacheHeader::VERSION;
+        header.endianness = MeshCacheHeader::ENDIANNESS;
+        header.headerSize = sizeof(MeshCacheHeader);
+        header.importFlags = importFlags;
+        header.sourceHash = *sourceHash;
+        header.sourceSize = stamp->size;
+        header.sourceModified = stamp->modified;
+        header.vertexSize = data.vertexSize;
+        header.indexSize = sizeof(uint32_t);
+        header.vertexCount = data.vertexCount;
+        header.vertexFormat = static_cast<uint32_t>(data.format);
+        std::memcpy(header.positionOffset, data.quantization.offset, sizeof(header.positionOffset));
+        std::memcpy(header.positionScale, data.quantization.scale, sizeof(header.positionScale));
+        header.lodCount = static_cast<uint32_t>(data.lods.size());
+        std::vector<uint8_t> encodedVertices, encodedIndices;
+        auto vertexSection = VertexSection(data, encodedVertices);
+        auto indexSection = IndexSection(data, encodedIndices);
+        header.vertexEncoding = static_cast<uint16_t>(data.vertexEncoding);
+        header.indexEncoding = static_cast<uint16_t>(data.indexEncoding);
+        header.vertexSectionSize = vertexSection.size();
+        header.indexSectionSize = indexSection.size();
+        uint64_t lodEnd = sizeof(MeshCacheHeader) + data.lods.size() * sizeof(MeshLod);
+        header.vertexOffset = AlignUp(lodEnd, SECTION_ALIGNMENT);
+        header.indexCount = data.indices.size();
+        header.indexOffset = AlignUp(header.vertexOffset + vertexSection.size(), SECTION_ALIGNMENT);
+        uint64_t indexEnd = header.indexOffset + indexSection.size();
+        header.meshletCount = data.meshlets.meshlets.size();
+        header.meshletOffset = AlignUp(indexEnd, SECTION_ALIGNMENT);
+        header.meshletVertexCount = data.meshlets.vertices.size();
+        header.meshletVertexOffset = AlignUp(header.meshletOffset + header.meshletCount * sizeof(Meshlet),
+                                             SECTION_ALIGNMENT);
+        header.meshletTriangleSize = data.meshlets.triangles.size();
+        header.meshletTriangleOffset = AlignUp(header.meshletVertexOffset + header.meshletVertexCount * sizeof(uint32_t),
+                                               SECTION_ALIGNMENT);
+        header.fileSize = header.meshletTriangleOffset + header.meshletTriangleSize;
+        header.layoutCount = static_cast<uint32_t>(data.layout.size());
+        std::memcpy(header.layout, data.layout.data(), data.layout.size());
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(data.lods.data()),
+                       static_cast<std::streamsize>(data.lods.size() * sizeof(MeshLod)));
+            WritePadding(file, lodEnd, header.vertexOffset);
+            file.write(reinterpret_cast<const char *>(vertexSection.data()),
+                       static_cast<std::streamsize>(vertexSection.size()));
+            WritePadding(file, header.vertexOffset + vertexSection.size(), header.indexOffset);
+            file.write(reinterpret_cast<const char *>(indexSection.data()),
+                       static_cast<std::streamsize>(indexSection.size()));
+            WritePadding(file, indexEnd, header.meshletOffset);
+            file.write(reinterpret_cast<const char *>(data.meshlets.meshlets.data()),
+                       static_cast<std::streamsize>(header.meshletCount * sizeof(Meshlet)));
+            WritePadding(file, header.meshletOffset + header.meshletCount * sizeof(Meshlet), header.meshletVertexOffset);
+            file.write(reinterpret_cast<const char *>(data.meshlets.vertices.data()),
+                       static_cast<std::streamsize>(header.meshletVertexCount * sizeof(uint32_t)));
+            WritePadding(file, header.meshletVertexOffset + header.meshletVertexCount * sizeof(uint32_t),
+                         header.meshletTriangleOffset);
+            file.write(reinterpret_cast<const char *>(data.meshlets.triangles.data()),
+                       static_cast<std::streamsize>(header.meshletTriangleSize));
+            if (!file) {
+                file.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        // Readers either see the old cache or the complete new one, never a partial write
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        // Windows doesn't replace an existing file on rename
+        std::remove(cachePath.c_str());
+#endif
+        return std::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+    }
+}
@@ -0,0 +1,244 @@
+#ifndef GAME_ENGINE_MESH_CACHE_H
+#define GAME_ENGINE_MESH_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <Engine/Core/ArrayView.h>
+#include <Engine/Core/MappedFile.h>
+#include "MeshCodec.h"
+#include "VertexCompression.h"
+
+
+/// How the cached data was produced from its source, a cache built with different flags is stale
+enum MeshImportFlags : uint32_t {
+    MESH_IMPORT_DEDUPLICATE = 0x1u,
+    MESH_IMPORT_GENERATE_NORMALS = 0x2u,
+    MESH_IMPORT_OPTIMIZE_VERTEX_CACHE = 0x4u,
+    MESH_IMPORT_GENERATE_LODS = 0x8u,
+    MESH_IMPORT_BUILD_MESHLETS = 0x10u,
+    MESH_IMPORT_COMPRESS_VERTICES = 0x20u,
+};
+
+
+/// How a vertex or index section is stored in a cache file
+enum class SectionEncoding : uint16_t {
+    /// Aligned and used straight from the mapping, the default
+    RAW = 0,
+    /**
+     * MeshCodec stream, roughly half the size of a raw vertex section and a third of an index section,
+     * but decoded into memory on every open. Only pays off when the cache is read from a slow disk or
+     * shipped over the network.
+     */
+    MESH_CODEC = 1,
+};
+
+
+/// Index range of one level of detail, every level indexes the same vertices
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    /// Bound on the object space distance between this level and the full mesh, 0 for the full mesh
+    float error;
+};
+
+static_assert(sizeof(MeshLod) == 12, "Mesh LOD record layout changed, bump the cache versions");
+
+
+/**
+ * Small cluster of LOD 0 triangles with its own culling bounds. The cone test only holds for
+ * pipelines which cull back faces with counter-clockwise front faces: the meshlet is entirely
+ * back facing when dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff.
+ */
+struct Meshlet {
+    /// 64 vertices and 126 triangles are the limits NVIDIA recommends for mesh shaders, 124 keeps the triangle table 4 byte aligned
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    /// First entry in the meshlet vertex table
+    uint32_t vertexOffset;
+    /// First byte in the meshlet triangle table, three local vertex indices per triangle
+    uint32_t triangleOffset;
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    float center[3];
+    float radius;
+    float coneApex[3];
+    /// Above 1 when the normals are spread too far for the cone to ever cull the meshlet
+    float coneCutoff;
+    float coneAxis[3];
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Meshlet) == 64, "Meshlet record layout changed, bump the cache versions");
+
+
+/// Meshlet tables of a mesh, empty when it wasn't clustered
+struct MeshletView {
+    ArrayView<const Meshlet> meshlets;
+    /// Mesh vertex indices referenced by the meshlets
+    ArrayView<const uint32_t> vertices;
+    /// Meshlet local vertex indices, every meshlet starts on a 4 byte boundary
+    ArrayView<const uint8_t> triangles;
+};
+
+
+/**
+ * On-disk layout, everything in native byte order. The header is followed by the LOD table and
+ * then the vertex, index and meshlet sections, all starting on a SECTION_ALIGNMENT boundary so
+ * they can be used straight from the mapping (and copied with aligned stores). Vertex and index
+ * sections may instead be MeshCodec streams, see SectionEncoding.
+ */
+struct MeshCacheHeader {
+    static constexpr uint32_t MAGIC = 0x434D5056u; // "VPMC"
+    /// 2: LOD table after the header, 3: meshlet sections, 4: vertex format and position quantization,
+    /// 5: encoded vertex and index sections, 6: raw or encoded per section
+    static constexpr uint16_t VERSION = 6;
+    /// Reads back as 0x0201 when the file was written on a machine with the other byte order
+    static constexpr uint16_t ENDIANNESS = 0x0102u;
+    static constexpr uint32_t MAX_LAYOUT_ATTRIBUTES = 32;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t endianness;
+    uint32_t headerSize;
+    uint32_t importFlags;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t sourceModified;
+    uint64_t fileSize;
+    uint32_t vertexSize;
+    uint32_t indexSize;
+    uint64_t vertexCount;
+    uint64_t vertexOffset;
+    uint64_t indexCount;
+    uint64_t indexOffset;
+    uint32_t layoutCount;
+    uint8_t layout[MAX_LAYOUT_ATTRIBUTES];
+    uint32_t lodCount;
+    uint64_t meshletCount;
+    uint64_t meshletOffset;
+    uint64_t meshletVertexCount;
+    uint64_t meshletVertexOffset;
+    uint64_t meshletTriangleSize;
+    uint64_t meshletTriangleOffset;
+    uint32_t vertexFormat;
+    float positionOffset[3];
+    float positionScale[3];
+    uint16_t vertexEncoding;
+    uint16_t indexEncoding;
+    /// Bytes the sections take in the file, differs from the count times the element size for encoded sections
+    uint64_t vertexSectionSize;
+    uint64_t indexSectionSize;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 224, "Mesh cache header layout changed, bump the version");
+
+
+/// Mesh data as it's written into the cache
+struct MeshCacheData {
+    ArrayView<const uint8_t> layout;
+    uint32_t vertexSize = 0;
+    uint64_t vertexCount = 0;
+    VertexFormat format = VertexFormat::FULL;
+    PositionQuantization quantization;
+    ArrayView<const uint8_t> vertices;
+    ArrayView<const uint32_t> indices;
+    /// Empty when the mesh has a single level
+    ArrayView<const MeshLod> lods;
+    MeshletView meshlets;
+    SectionEncoding vertexEncoding = SectionEncoding::RAW;
+    SectionEncoding indexEncoding = SectionEncoding::RAW;
+};
+
+
+/**
+ * Valid cache file, the views point into the mapping and stay valid as long as the file is kept.
+ * Encoded sections are decoded into the owned vectors instead, moving the view keeps the views into
+ * them valid but copying it doesn't.
+ */
+struct MeshCacheView {
+    std::shared_ptr<MappedFile> file;
+    ArrayView<const uint8_t> layout;
+    uint32_t vertexSize = 0;
+    uint64_t vertexCount = 0;
+    VertexFormat format = VertexFormat::FULL;
+    PositionQuantization quantization;
+    ArrayView<const uint8_t> vertices;
+    ArrayView<const uint32_t> indices;
+    /// Empty when the mesh has a single level
+    ArrayView<const MeshLod> lods;
+    MeshletView meshlets;
+    /// Storage of the sections which were encoded, empty for raw ones
+    std::vector<uint8_t> decodedVertices;
+    std::vector<uint32_t> decodedIndices;
+
+    MeshCacheView() = default;
+
+    MeshCacheView(const MeshCacheView &other) = delete;
+
+    auto operator=(const MeshCacheView &other) -> MeshCacheView & = delete;
+
+    MeshCacheView(MeshCacheView &&other) noexcept = default;
+
+    auto operator=(MeshCacheView &&other) noexcept -> MeshCacheView & = default;
+};
+
+
+namespace MeshCache {
+    constexpr size_t SECTION_ALIGNMENT = 64;
+    constexpr uint32_t MAX_LODS = 16;
+
+    /// Every level lies within the index buffer, shared by the mesh and the scene cache
+    auto AreLodsValid(ArrayView<const MeshLod> lods, uint64_t indexCount) -> bool;
+
+    /// Every index refers to one of the vertices
+    auto AreIndicesInRange(ArrayView<const uint32_t> indices, uint64_t vertexCount) -> bool;
+
+    /// Every meshlet's ranges lie within the tables, its triangles within its vertices, and it respects the meshlet limits
+    auto AreMeshletsValid(const MeshletView &meshlets) -> bool;
+
+    /**
+     * Points a view with its vertex count, size and meshlets set at the vertex and index sections,
+     * decoding the encoded ones. Sections have to start on a SECTION_ALIGNMENT boundary. False when
+     * corrupted, including indices and meshlet vertices past the vertex count.
+     */
+    auto ReadSections(SectionEncoding vertexEncoding, ArrayView<const uint8_t> vertexSection,
+                      SectionEncoding indexEncoding, ArrayView<const uint8_t> indexSection, uint64_t indexCount,
+                      MeshCacheView &view) -> bool;
+
+    /// Bytes of the vertex section as the data asks for it to be written, storage holds encoded sections
+    auto VertexSection(const MeshCacheData &data, std::vector<uint8_t> &storage) -> ArrayView<const uint8_t>;
+
+    /// Bytes of the index section as the data asks for it to be written, storage holds encoded sections
+    auto IndexSection(const MeshCacheData &data, std::vector<uint8_t> &storage) -> ArrayView<const uint8_t>;
+
+    /// Cache file belonging to the given source file
+    auto PathFor(const std::string &sourcePath) -> std::string;
+
+    /// Hash of the source file's contents, nullopt when it can't be read
+    auto HashSource(const std::string &sourcePath) -> std::optional<uint64_t>;
+
+    /**
+     * Whether a cache built from a source with the given size, timestamp and hash is still current.
+     * Contents are only hashed when the timestamp differs, a missing source counts as current.
+     */
+    auto IsSourceCurrent(const std::string &sourcePath, uint64_t size, uint64_t modified, uint64_t hash) -> bool;
+
+    /**
+     * Maps the cache and validates it against the source file. Nullopt when the cache is missing,
+     * malformed, written by another version or platform, built with other import flags or older
+     * than the source.
+     */
+    auto Open(const std::string &cachePath, const std::string &sourcePath, uint32_t importFlags)
+    -> std::optional<MeshCacheView>;
+
+    /// Writes into a temporary file which replaces the cache only once complete, false on failure
+    auto Write(const std::string &cachePath, const std::string &sourcePath, uint32_t importFlags,
+               const MeshCacheData &data) -> bool;
+}
+
+
+#endif //GAME_ENGINE_MESH_CACHE_H
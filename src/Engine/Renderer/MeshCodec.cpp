@@ -0,0 +1,391 @@
+#include "MeshCodec.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MESH_CODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+    using MeshCodec::BLOCK_VERTICES;
+    using MeshCodec::GROUP_SIZE;
+
+    constexpr size_t PLANES = sizeof(uint32_t);
+    /// Vertex words the decoder keeps unpacked at once
+    constexpr size_t MAX_STORED_WORDS = 4;
+    /// Packed size of a group for each selector: 0, 2, 4 and 8 bits per byte
+    constexpr size_t GROUP_BYTES[4] = {0, 4, 8, 16};
+
+    using BlockPlanes = uint8_t[PLANES][BLOCK_VERTICES];
+
+    auto ZigZag(uint32_t value) -> uint32_t {
+        return (value << 1u) ^ (0u - (value >> 31u));
+    }
+
+    auto GroupCount(size_t vertexCount) -> size_t {
+        return (vertexCount + GROUP_SIZE - 1) / GROUP_SIZE;
+    }
+
+    /// Two selector bits per group
+    auto SelectorBytes(size_t groupCount) -> size_t {
+        return (groupCount + 3) / 4;
+    }
+
+    auto Selector(const uint8_t *selectors, size_t group) -> uint32_t {
+        return (selectors[group / 4] >> (2 * (group % 4))) & 3u;
+    }
+
+    /// Appends the selectors of every group of the plane followed by the packed groups
+    void EncodePlane(const uint8_t *plane, size_t groupCount, std::vector<uint8_t> &output) {
+        size_t selectorStart = output.size();
+        output.resize(selectorStart + SelectorBytes(groupCount), 0);
+        for (size_t g = 0; g < groupCount; g++) {
+            const uint8_t *group = plane + g * GROUP_SIZE;
+            uint8_t max = *std::max_element(group, group + GROUP_SIZE);
+            uint32_t selector = max == 0 ? 0 : max < 4 ? 1 : max < 16 ? 2 : 3;
+            output[selectorStart + g / 4] |= static_cast<uint8_t>(selector << (2 * (g % 4)));
+            if (selector == 3) {
+                output.insert(output.end(), group, group + GROUP_SIZE);
+            } else if (selector != 0) {
+                // Earlier values go into the lower bits
+                uint32_t bits = selector == 1 ? 2 : 4, valuesPerByte = 8 / bits;
+                for (size_t i = 0; i < GROUP_SIZE; i += valuesPerByte) {
+                    uint32_t packed = 0;
+                    for (uint32_t j = 0; j < valuesPerByte; j++)
+                        packed |= uint32_t(group[i + j]) << (j * bits);
+                    output.push_back(static_cast<uint8_t>(packed));
+                }
+            }
+        }
+    }
+
+#ifdef MESH_CODEC_SSE2
+    /// Spreads the nibbles of 8 bytes into 16 bytes, low nibble first
+    auto UnpackNibbles(__m128i packed) -> __m128i {
+        __m128i mask = _mm_set1_epi8(0x0F);
+        return _mm_unpacklo_epi8(_mm_and_si128(packed, mask), _mm_and_si128(_mm_srli_epi16(packed, 4), mask));
+    }
+
+    void UnpackGroup(uint32_t selector, const uint8_t *data, uint8_t *output) {
+        __m128i values;
+        switch (selector) {
+            case 0:
+                values = _mm_setzero_si128();
+                break;
+            case 1: {
+                int32_t packed;
+                std::memcpy(&packed, data, sizeof(packed));
+                // Nibbles first, then each nibble's two 2 bit values
+                __m128i nibbles = UnpackNibbles(_mm_cvtsi32_si128(packed));
+                __m128i mask = _mm_set1_epi8(0x03);
+                values = _mm_unpacklo_epi8(_mm_and_si128(nibbles, mask),
+                                           _mm_and_si128(_mm_srli_epi16(nibbles, 2), mask));
+                break;
+            }
+            case 2:
+                values = UnpackNibbles(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data)));
+                break;
+            default:
+                values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+                break;
+        }
+        _mm_store_si128(reinterpret_cast<__m128i *>(output), values);
+    }
+
+    /**
+     * Branchless UnpackGroup, the selectors of neighbouring groups are too random to predict. Reads
+     * 16 bytes whatever the selector, the caller has to make sure they are there.
+     */
+    void UnpackGroupFast(uint32_t selector, const uint8_t *data, uint8_t *output) {
+        __m128i eightBits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        __m128i fourBits = UnpackNibbles(eightBits);
+        __m128i mask = _mm_set1_epi8(0x03);
+        __m128i twoBits = _mm_unpacklo_epi8(_mm_and_si128(fourBits, mask),
+                                            _mm_and_si128(_mm_srli_epi16(fourBits, 2), mask));
+        __m128i selectors = _mm_set1_epi8(static_cast<char>(selector));
+        __m128i values = _mm_or_si128(
+                _mm_and_si128(twoBits, _mm_cmpeq_epi8(selectors, _mm_set1_epi8(1))),
+                _mm_or_si128(_mm_and_si128(fourBits, _mm_cmpeq_epi8(selectors, _mm_set1_epi8(2))),
+                             _mm_and_si128(eightBits, _mm_cmpeq_epi8(selectors, _mm_set1_epi8(3)))));
+        _mm_store_si128(reinterpret_cast<__m128i *>(output), values);
+    }
+
+    /// Running sum of the four words plus the carry, the carry becomes the last sum
+    auto PrefixSum(__m128i deltas, __m128i &carry) -> __m128i {
+        deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+        deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+        deltas = _mm_add_epi32(deltas, carry);
+        carry = _mm_shuffle_epi32(deltas, _MM_SHUFFLE(3, 3, 3, 3));
+        return deltas;
+    }
+
+    /// Interleaves the byte planes of 16 vertices back into words and undoes the zig-zag and delta coding
+    void DecodeGroup(const BlockPlanes &planes, size_t first, __m128i &carry, __m128i (&words)[4]) {
+        __m128i p0 = _mm_load_si128(reinterpret_cast<const __m128i *>(planes[0] + first));
+        __m128i p1 = _mm_load_si128(reinterpret_cast<const __m128i *>(planes[1] + first));
+        __m128i p2 = _mm_load_si128(reinterpret_cast<const __m128i *>(planes[2] + first));
+        __m128i p3 = _mm_load_si128(reinterpret_cast<const __m128i *>(planes[3] + first));
+        __m128i low01 = _mm_unpacklo_epi8(p0, p1), high01 = _mm_unpackhi_epi8(p0, p1);
+        __m128i low23 = _mm_unpacklo_epi8(p2, p3), high23 = _mm_unpackhi_epi8(p2, p3);
+        words[0] = _mm_unpacklo_epi16(low01, low23);
+        words[1] = _mm_unpackhi_epi16(low01, low23);
+        words[2] = _mm_unpacklo_epi16(high01, high23);
+        words[3] = _mm_unpackhi_epi16(high01, high23);
+        __m128i one = _mm_set1_epi32(1);
+        for (auto &word : words) {
+            __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(word, one));
+            word = PrefixSum(_mm_xor_si128(_mm_srli_epi32(word, 1), sign), carry);
+        }
+    }
+
+    /**
+     * Writes N consecutive words of every vertex. The words of four vertices are transposed so each
+     * vertex gets one store of N words instead of N scattered ones.
+     */
+    template<size_t N>
+    void StoreWords(const BlockPlanes *planes, size_t count, uint32_t *last, uint8_t *output, size_t stride) {
+        __m128i carry[N];
+        for (size_t n = 0; n < N; n++)
+            carry[n] = _mm_set1_epi32(static_cast<int>(last[n]));
+
+        for (size_t i = 0; i < count; i += GROUP_SIZE) {
+            __m128i words[N][4];
+            for (size_t n = 0; n < N; n++)
+                DecodeGroup(planes[n], i, carry[n], words[n]);
+
+            if (count - i < GROUP_SIZE) {
+                alignas(16) uint32_t lanes[N][GROUP_SIZE];
+                for (size_t n = 0; n < N; n++) {
+                    for (size_t k = 0; k < 4; k++)
+                        _mm_store_si128(reinterpret_cast<__m128i *>(lanes[n] + 4 * k), words[n][k]);
+                }
+                for (size_t j = 0; j < count - i; j++) {
+                    for (size_t n = 0; n < N; n++)
+                        std::memcpy(output + (i + j) * stride + n * sizeof(uint32_t), &lanes[n][j], sizeof(uint32_t));
+                }
+                continue;
+            }
+
+            for (size_t k = 0; k < 4; k++) {
+                uint8_t *vertex = output + (i + 4 * k) * stride;
+                if constexpr (N == 4) {
+                    __m128 w0 = _mm_castsi128_ps(words[0][k]), w1 = _mm_castsi128_ps(words[1][k]);
+                    __m128 w2 = _mm_castsi128_ps(words[2][k]), w3 = _mm_castsi128_ps(words[3][k]);
+                    _MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+                    _mm_storeu_ps(reinterpret_cast<float *>(vertex), w0);
+                    _mm_storeu_ps(reinterpret_cast<float *>(vertex + stride), w1);
+                    _mm_storeu_ps(reinterpret_cast<float *>(vertex + 2 * stride), w2);
+                    _mm_storeu_ps(reinterpret_cast<float *>(vertex + 3 * stride), w3);
+                } else if constexpr (N == 2) {
+                    __m128i low = _mm_unpacklo_epi32(words[0][k], words[1][k]);
+                    __m128i high = _mm_unpackhi_epi32(words[0][k], words[1][k]);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(vertex), low);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(vertex + stride), _mm_unpackhi_epi64(low, low));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(vertex + 2 * stride), high);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(vertex + 3 * stride), _mm_unpackhi_epi64(high, high));
+                } else if (stride == sizeof(uint32_t)) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(vertex), words[0][k]);
+                } else {
+                    __m128i word = words[0][k];
+                    for (size_t j = 0; j < 4; j++) {
+                        uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(word));
+                        std::memcpy(vertex + j * stride, &value, sizeof(value));
+                        word = _mm_srli_si128(word, 4);
+                    }
+                }
+            }
+        }
+
+        for (size_t n = 0; n < N; n++)
+            last[n] = static_cast<uint32_t>(_mm_cvtsi128_si32(carry[n]));
+    }
+
+    void StoreWords(const BlockPlanes *planes, size_t wordCount, size_t count, uint32_t *last, uint8_t *output,
+                    size_t stride) {
+        if (wordCount == 4)
+            StoreWords<4>(planes, count, last, output, stride);
+        else if (wordCount == 2)
+            StoreWords<2>(planes, count, last, output, stride);
+        else
+            StoreWords<1>(planes, count, last, output, stride);
+    }
+#else
+    void UnpackGroup(uint32_t selector, const uint8_t *data, uint8_t *output) {
+        switch (selector) {
+            case 0:
+                std::memset(output, 0, GROUP_SIZE);
+                break;
+            case 1:
+                for (size_t i = 0; i < GROUP_SIZE; i++)
+                    output[i] = (data[i / 4] >> (2 * (i % 4))) & 0x03u;
+                break;
+            case 2:
+                for (size_t i = 0; i < GROUP_SIZE; i++)
+                    output[i] = (data[i / 2] >> (4 * (i % 2))) & 0x0Fu;
+                break;
+            default:
+                std::memcpy(output, data, GROUP_SIZE);
+                break;
+        }
+    }
+
+    auto UnZigZag(uint32_t value) -> uint32_t {
+        return (value >> 1u) ^ (0u - (value & 1u));
+    }
+
+    void StoreWords(const BlockPlanes *planes, size_t wordCount, size_t count, uint32_t *last, uint8_t *output,
+                    size_t stride) {
+        for (size_t n = 0; n < wordCount; n++) {
+            for (size_t i = 0; i < count; i++) {
+                uint32_t value = uint32_t(planes[n][0][i]) | uint32_t(planes[n][1][i]) << 8u |
+                                 uint32_t(planes[n][2][i]) << 16u | uint32_t(planes[n][3][i]) << 24u;
+                last[n] += UnZigZag(value);
+                std::memcpy(output + i * stride + n * sizeof(uint32_t), &last[n], sizeof(uint32_t));
+            }
+        }
+    }
+#endif
+
+    /// Unpacks one plane of a block, nullptr when the stream ends before the plane does
+    auto DecodePlane(const uint8_t *data, const uint8_t *end, size_t groupCount, uint8_t *plane) -> const uint8_t * {
+        size_t selectorBytes = SelectorBytes(groupCount);
+        if (static_cast<size_t>(end - data) < selectorBytes)
+            return nullptr;
+        const uint8_t *selectors = data;
+        data += selectorBytes;
+
+#ifdef MESH_CODEC_SSE2
+        // Unless the stream is about to end every group can read 16 bytes, whatever its selector
+        if (static_cast<size_t>(end - data) >= groupCount * GROUP_SIZE) {
+            for (size_t g = 0; g < groupCount; g++) {
+                uint32_t selector = Selector(selectors, g);
+                UnpackGroupFast(selector, data, plane + g * GROUP_SIZE);
+                data += GROUP_BYTES[selector];
+            }
+            return data;
+        }
+#endif
+        size_t packedBytes = 0;
+        for (size_t g = 0; g < groupCount; g++)
+            packedBytes += GROUP_BYTES[Selector(selectors, g)];
+        if (static_cast<size_t>(end - data) < packedBytes)
+            return nullptr;
+
+        for (size_t g = 0; g < groupCount; g++) {
+            uint32_t selector = Selector(selectors, g);
+            UnpackGroup(selector, data, plane + g * GROUP_SIZE);
+            data += GROUP_BYTES[selector];
+        }
+        return data;
+    }
+}
+
+
+namespace MeshCodec {
+
+    auto EncodedBound(size_t vertexCount, size_t vertexSize) -> size_t {
+        size_t fullBlocks = vertexCount / BLOCK_VERTICES, tailGroups = GroupCount(vertexCount % BLOCK_VERTICES);
+        size_t blockGroups = BLOCK_VERTICES / GROUP_SIZE;
+        size_t planeBytes = fullBlocks * (SelectorBytes(blockGroups) + blockGroups * GROUP_SIZE) +
+                            SelectorBytes(tailGroups) + tailGroups * GROUP_SIZE;
+        return vertexSize * planeBytes;
+    }
+
+
+    auto EncodeVertices(const uint8_t *vertices, size_t vertexCount, size_t vertexSize) -> std::vector<uint8_t> {
+        if (vertexSize == 0 || vertexSize % sizeof(uint32_t))
+            throw std::runtime_error("[MeshCodec] Vertex size has to be a multiple of 4 bytes");
+
+        std::vector<uint8_t> output;
+        output.reserve(EncodedBound(vertexCount, vertexSize));
+        size_t wordCount = vertexSize / sizeof(uint32_t);
+        std::vector<uint32_t> last(wordCount, 0);
+        alignas(16) BlockPlanes planes{};
+        for (size_t first = 0; first < vertexCount; first += BLOCK_VERTICES) {
+            size_t count = std::min(BLOCK_VERTICES, vertexCount - first);
+            size_t groupCount = GroupCount(count);
+            const uint8_t *block = vertices + first * vertexSize;
+            for (size_t w = 0; w < wordCount; w++) {
+                // The padding of the last group decodes as unchanged words
+                for (size_t i = 0; i < groupCount * GROUP_SIZE; i++) {
+                    uint32_t delta = 0;
+                    if (i < count) {
+                        uint32_t value;
+                        std::memcpy(&value, block + i * vertexSize + w * sizeof(uint32_t), sizeof(value));
+                        delta = ZigZag(value - last[w]);
+                        last[w] = value;
+                    }
+                    for (size_t p = 0; p < PLANES; p++)
+                        planes[p][i] = static_cast<uint8_t>(delta >> (8 * p));
+                }
+                for (const auto &plane : planes)
+                    EncodePlane(plane, groupCount, output);
+            }
+        }
+        return output;
+    }
+
+
+    auto DecodeVertices(ArrayView<const uint8_t> encoded, size_t vertexCount, size_t vertexSize, uint8_t *output)
+    -> bool {
+        if (vertexSize == 0 || vertexSize % sizeof(uint32_t))
+            return false;
+
+        const uint8_t *data = encoded.data(), *end = encoded.data() + encoded.size();
+        size_t wordCount = vertexSize / sizeof(uint32_t);
+        std::vector<uint32_t> last(wordCount, 0);
+        alignas(16) BlockPlanes planes[MAX_STORED_WORDS];
+        for (size_t first = 0; first < vertexCount; first += BLOCK_VERTICES) {
+            size_t count = std::min(BLOCK_VERTICES, vertexCount - first);
+            size_t groupCount = GroupCount(count);
+            uint8_t *block = output + first * vertexSize;
+            // Words are stored in runs of 4, 2 or 1, their planes follow each other in the stream
+            for (size_t w = 0; w < wordCount;) {
+                size_t runLength = wordCount - w >= 4 ? 4 : wordCount - w >= 2 ? 2 : 1;
+                for (size_t n = 0; n < runLength; n++) {
+                    for (auto &plane : planes[n]) {
+                        data = DecodePlane(data, end, groupCount, plane);
+                        if (!data)
+                            return false;
+                    }
+                }
+                StoreWords(planes, runLength, count, last.data() + w, block + w * sizeof(uint32_t), vertexSize);
+                w += runLength;
+            }
+        }
+        return data == end;
+    }
+
+
+    auto EncodeIndices(ArrayView<const uint32_t> indices) -> std::vector<uint8_t> {
+        return EncodeVertices(reinterpret_cast<const uint8_t *>(indices.data()), indices.size(), sizeof(uint32_t));
+    }
+
+
+    auto DecodeIndices(ArrayView<const uint8_t> encoded, size_t indexCount, uint32_t *output) -> bool {
+        return DecodeVertices(encoded, indexCount, sizeof(uint32_t), reinterpret_cast<uint8_t *>(output));
+    }
+
+
+    void NarrowIndices(const uint32_t *indices, size_t indexCount, uint16_t *output) {
+        size_t i = 0;
+#ifdef MESH_CODEC_SSE2
+        // Signed saturation would clamp indices above 32767, biasing them into the signed range avoids that
+        __m128i bias = _mm_set1_epi32(0x8000);
+        __m128i unbias = _mm_set1_epi16(static_cast<short>(0x8000));
+        for (; i + 8 <= indexCount; i += 8) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i + 4));
+            __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_xor_si128(packed, unbias));
+        }
+#endif
+        for (; i < indexCount; i++)
+            output[i] = static_cast<uint16_t>(indices[i]);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef GAME_ENGINE_MESH_CODEC_H
+#define GAME_ENGINE_MESH_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Engine/Core/ArrayView.h>
+
+
+/**
+ * Lossless compression of vertex and index buffers. Every 32 bit word of a vertex is delta coded
+ * against the same word of the previous vertex and zig-zag encoded, so small differences of either
+ * sign become small unsigned values. The four bytes of those values are split into byte planes,
+ * which leaves the high planes mostly zero, and every group of 16 bytes in a plane is packed with
+ * 0, 2, 4 or 8 bits per byte.
+ *
+ * Index buffers are coded as 4 byte vertices, a vertex cache optimized triangle list mostly refers
+ * to recently used vertices and its deltas stay small.
+ */
+namespace MeshCodec {
+    /// Vertices per block, the decoder's byte planes of a block stay in the L1 cache
+    constexpr size_t BLOCK_VERTICES = 256;
+    constexpr size_t GROUP_SIZE = 16;
+    /// A selector byte covers at most four groups, decoded data is at most this many times the encoded size
+    constexpr size_t MAX_EXPANSION = 4 * GROUP_SIZE;
+
+    /// Largest possible encoded size, incompressible data grows by the group selectors
+    auto EncodedBound(size_t vertexCount, size_t vertexSize) -> size_t;
+
+    /// The vertex size has to be a multiple of 4 bytes
+    auto EncodeVertices(const uint8_t *vertices, size_t vertexCount, size_t vertexSize) -> std::vector<uint8_t>;
+
+    /**
+     * Decodes exactly vertexCount vertices, with SSE2 where available. False when the stream is
+     * truncated, has trailing bytes or doesn't fit the vertex size, the output is partially written then.
+     */
+    auto DecodeVertices(ArrayView<const uint8_t> encoded, size_t vertexCount, size_t vertexSize, uint8_t *output)
+    -> bool;
+
+    auto EncodeIndices(ArrayView<const uint32_t> indices) -> std::vector<uint8_t>;
+
+    auto DecodeIndices(ArrayView<const uint8_t> encoded, size_t indexCount, uint32_t *output) -> bool;
+
+    /// Bytes per index on the GPU. Pipelines don't enable primitive restart, so 0xFFFF is a regular index.
+    inline auto IndexSize(uint64_t vertexCount) -> uint32_t {
+        return vertexCount < 0x10000u ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
+
+    /// Indices have to be below 65536
+    void NarrowIndices(const uint32_t *indices, size_t indexCount, uint16_t *output);
+}
+
+
+#endif //GAME_ENGINE_MESH_CODEC_H
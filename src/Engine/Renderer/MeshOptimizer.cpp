@@ -0,0 +1,422 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+namespace {
+    constexpr uint32_t INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    /// Triangles around every vertex in one flat array, a triangle with a repeated vertex is listed twice
+    struct VertexAdjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        VertexAdjacency(ArrayView<const uint32_t> indices, size_t vertexCount)
+                : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+            for (uint32_t index : indices)
+                offsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++)
+                offsets[v + 1] += offsets[v];
+
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        auto Count(uint32_t vertex) const -> uint32_t { return offsets[vertex + 1] - offsets[vertex]; }
+    };
+
+    struct Vec3 {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+
+        auto operator+(const Vec3 &o) const -> Vec3 { return {x + o.x, y + o.y, z + o.z}; }
+
+        auto operator-(const Vec3 &o) const -> Vec3 { return {x - o.x, y - o.y, z - o.z}; }
+
+        auto operator*(float s) const -> Vec3 { return {x * s, y * s, z * s}; }
+
+        auto operator[](int axis) const -> float { return axis == 0 ? x : axis == 1 ? y : z; }
+    };
+
+    auto Cross(const Vec3 &a, const Vec3 &b) -> Vec3 {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    auto Dot(const Vec3 &a, const Vec3 &b) -> float { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    auto Length(const Vec3 &v) -> float { return std::sqrt(Dot(v, v)); }
+
+    /// Strided positions, the vertices usually carry other attributes after the position
+    struct PositionReader {
+        const uint8_t *data;
+        size_t stride;
+
+        auto operator[](uint32_t vertex) const -> Vec3 {
+            Vec3 position;
+            std::memcpy(&position, data + vertex * stride, sizeof(float) * 3);
+            return position;
+        }
+    };
+
+    /// FIFO cache replay over whole triangles, returns the misses of the triangle
+    class FifoCache {
+        std::vector<uint64_t> m_InsertedAt;
+        uint64_t m_Misses = 0;
+        uint32_t m_Size;
+
+    public:
+        FifoCache(size_t vertexCount, uint32_t size)
+                : m_InsertedAt(vertexCount, std::numeric_limits<uint64_t>::max()), m_Size(size) {}
+
+        auto Triangle(const uint32_t *corners) -> uint32_t {
+            uint64_t before = m_Misses;
+            for (int i = 0; i < 3; i++) {
+                uint64_t inserted = m_InsertedAt[corners[i]];
+                if (inserted == std::numeric_limits<uint64_t>::max() || m_Misses - inserted >= m_Size)
+                    m_InsertedAt[corners[i]] = m_Misses++;
+            }
+            return static_cast<uint32_t>(m_Misses - before);
+        }
+
+        /// Ages every entry out without touching the per-vertex state
+        void Flush() { m_Misses += m_Size; }
+    };
+
+    /// Rasterizes triangles into a square depth buffer, counting depth test passes
+    class OverdrawRasterizer {
+        std::vector<float> m_Depth;
+        uint32_t m_Resolution;
+
+    public:
+        uint64_t shaded = 0;
+
+        explicit OverdrawRasterizer(uint32_t resolution)
+                : m_Depth(size_t(resolution) * resolution, std::numeric_limits<float>::max()),
+                  m_Resolution(resolution) {}
+
+        /// Vertices in pixel units, z is the depth
+        void Triangle(Vec3 a, Vec3 b, Vec3 c) {
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (area == 0.0f)
+                return;
+            // Both windings are drawn, flip to one of them so the edge functions are positive inside
+            if (area < 0.0f) {
+                std::swap(b, c);
+                area = -area;
+            }
+
+            auto minX = std::max(0, static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))));
+            auto minY = std::max(0, static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))));
+            auto maxX = std::min(int(m_Resolution) - 1, static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))));
+            auto maxY = std::min(int(m_Resolution) - 1, static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))));
+
+            // Top-left fill rule, pixels on an edge shared by two triangles are shaded once
+            auto edge = [](const Vec3 &from, const Vec3 &to, float px, float py) {
+                return (to.x - from.x) * (py - from.y) - (to.y - from.y) * (px - from.x);
+            };
+            auto isTopLeft = [](const Vec3 &from, const Vec3 &to) {
+                return (from.y == to.y && to.x < from.x) || to.y > from.y;
+            };
+            bool topLeft0 = isTopLeft(b, c), topLeft1 = isTopLeft(c, a), topLeft2 = isTopLeft(a, b);
+
+            for (int y = minY; y <= maxY; y++) {
+                float py = float(y) + 0.5f;
+                for (int x = minX; x <= maxX; x++) {
+                    float px = float(x) + 0.5f;
+                    float w0 = edge(b, c, px, py), w1 = edge(c, a, px, py), w2 = edge(a, b, px, py);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f ||
+                        (w0 == 0.0f && !topLeft0) || (w1 == 0.0f && !topLeft1) || (w2 == 0.0f && !topLeft2))
+                        continue;
+
+                    float depth = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+                    float &stored = m_Depth[size_t(y) * m_Resolution + x];
+                    if (depth < stored) {
+                        stored = depth;
+                        shaded++;
+                    }
+                }
+            }
+        }
+
+        auto Covered() const -> uint64_t {
+            return std::count_if(m_Depth.begin(), m_Depth.end(),
+                                 [](float depth) { return depth != std::numeric_limits<float>::max(); });
+        }
+    };
+}
+
+
+namespace MeshOptimizer {
+
+    auto AnalyzeVertexCache(ArrayView<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize,
+                            VertexCacheModel model) -> VertexCacheStats {
+        VertexCacheStats stats;
+        if (indices.empty())
+            return stats;
+
+        std::vector<bool> referenced(vertexCount, false);
+        size_t referencedCount = 0;
+        if (model == VertexCacheModel::FIFO) {
+            // A vertex is still cached when fewer than cacheSize misses happened since it was inserted
+            std::vector<uint64_t> insertedAt(vertexCount, std::numeric_limits<uint64_t>::max());
+            for (uint32_t index : indices) {
+                uint64_t inserted = insertedAt[index];
+                if (inserted == std::numeric_limits<uint64_t>::max() || stats.transforms - inserted >= cacheSize)
+                    insertedAt[index] = stats.transforms++;
+                if (!referenced[index]) {
+                    referenced[index] = true;
+                    referencedCount++;
+                }
+            }
+        } else {
+            // Most recently used first, small enough that a linear scan beats anything smarter
+            std::vector<uint32_t> cache;
+            cache.reserve(cacheSize + 1);
+            for (uint32_t index : indices) {
+                auto it = std::find(cache.begin(), cache.end(), index);
+                if (it == cache.end()) {
+                    stats.transforms++;
+                    cache.insert(cache.begin(), index);
+                    if (cache.size() > cacheSize)
+                        cache.pop_back();
+                } else {
+                    std::rotate(cache.begin(), it, it + 1);
+                }
+                if (!referenced[index]) {
+                    referenced[index] = true;
+                    referencedCount++;
+                }
+            }
+        }
+
+        stats.acmr = double(stats.transforms) / double(indices.size() / 3);
+        stats.atvr = double(stats.transforms) / double(referencedCount);
+        return stats;
+    }
+
+
+    auto OptimizeVertexCache(ArrayView<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+    -> std::vector<uint32_t> {
+        size_t triangleCount = indices.size() / 3;
+        std::vector<uint32_t> result;
+        result.reserve(triangleCount * 3);
+        if (triangleCount == 0)
+            return result;
+
+        VertexAdjacency adjacency(indices, vertexCount);
+        std::vector<uint32_t> liveTriangles(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            liveTriangles[v] = adjacency.Count(static_cast<uint32_t>(v));
+
+        // Time stamps start cacheSize + 1 apart from the zeroed cacheTime so nothing is cached initially
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+        uint32_t timeStamp = cacheSize + 1;
+        size_t cursor = 0;
+
+        auto skipDeadEnd = [&]() -> uint32_t {
+            while (!deadEnd.empty()) {
+                uint32_t vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[vertex] > 0)
+                    return vertex;
+            }
+            for (; cursor < vertexCount; cursor++) {
+                if (liveTriangles[cursor] > 0)
+                    return static_cast<uint32_t>(cursor);
+            }
+            return INVALID_VERTEX;
+        };
+
+        uint32_t fanning = skipDeadEnd();
+        while (fanning != INVALID_VERTEX) {
+            candidates.clear();
+            for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+                uint32_t triangle = adjacency.triangles[i];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    uint32_t vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    if (timeStamp - cacheTime[vertex] > cacheSize)
+                        cacheTime[vertex] = timeStamp++;
+                }
+            }
+
+            // Prefer the candidate that stays cached the longest while its remaining fan is emitted
+            uint32_t best = INVALID_VERTEX;
+            int64_t bestPriority = -1;
+            for (uint32_t vertex : candidates) {
+                if (liveTriangles[vertex] == 0)
+                    continue;
+                int64_t priority = 0;
+                int64_t age = int64_t(timeStamp) - cacheTime[vertex];
+                if (age + 2 * int64_t(liveTriangles[vertex]) <= int64_t(cacheSize))
+                    priority = age;
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    best = vertex;
+                }
+            }
+            fanning = best != INVALID_VERTEX ? best : skipDeadEnd();
+        }
+        return result;
+    }
+
+
+    auto OptimizeOverdraw(ArrayView<const uint32_t> indices, const uint8_t *positions, size_t vertexCount,
+                          size_t positionStride, float threshold, uint32_t cacheSize) -> std::vector<uint32_t> {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return std::vector<uint32_t>(indices.begin(), indices.end());
+
+        // Hard boundaries, where all three vertices of a triangle miss the cache is where Tipsify
+        // jumped to an unrelated part of the mesh and reordering costs no cache efficiency
+        std::vector<uint32_t> hardBoundaries;
+        std::vector<uint32_t> misses(triangleCount);
+        FifoCache hardCache(vertexCount, cacheSize);
+        for (size_t t = 0; t < triangleCount; t++) {
+            misses[t] = hardCache.Triangle(&indices[t * 3]);
+            if (t == 0 || misses[t] == 3)
+                hardBoundaries.push_back(static_cast<uint32_t>(t));
+        }
+        hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+        // Soft boundaries split every hard cluster further while the pieces stay within the threshold
+        std::vector<uint32_t> clusters;
+        FifoCache softCache(vertexCount, cacheSize);
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+            uint32_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+            uint64_t clusterMisses = 0;
+            for (uint32_t t = begin; t < end; t++)
+                clusterMisses += misses[t];
+            double limit = threshold * double(clusterMisses) / double(end - begin);
+
+            clusters.push_back(begin);
+            softCache.Flush();
+            uint64_t softMisses = 0;
+            uint32_t softBegin = begin;
+            for (uint32_t t = begin; t < end; t++) {
+                softMisses += softCache.Triangle(&indices[t * 3]);
+                if (t + 1 < end && double(softMisses) / double(t + 1 - softBegin) <= limit) {
+                    clusters.push_back(t + 1);
+                    softCache.Flush();
+                    softMisses = 0;
+                    softBegin = t + 1;
+                }
+            }
+        }
+        clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+        PositionReader position{positions, positionStride};
+        size_t clusterCount = clusters.size() - 1;
+        std::vector<Vec3> clusterCentroids(clusterCount);
+        std::vector<Vec3> clusterNormals(clusterCount);
+        Vec3 meshCentroid;
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusterCount; c++) {
+            Vec3 centroid, normal;
+            float clusterArea = 0.0f;
+            for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+                Vec3 a = position[indices[t * 3]], b = position[indices[t * 3 + 1]], c2 = position[indices[t * 3 + 2]];
+                Vec3 triangleNormal = Cross(b - a, c2 - a);
+                float area = Length(triangleNormal);
+                centroid = centroid + (a + b + c2) * (area / 3.0f);
+                normal = normal + triangleNormal;
+                clusterArea += area;
+            }
+            meshCentroid = meshCentroid + centroid;
+            meshArea += clusterArea;
+            clusterCentroids[c] = clusterArea > 0.0f ? centroid * (1.0f / clusterArea) : centroid;
+            float normalLength = Length(normal);
+            clusterNormals[c] = normalLength > 0.0f ? normal * (1.0f / normalLength) : normal;
+        }
+        if (meshArea > 0.0f)
+            meshCentroid = meshCentroid * (1.0f / meshArea);
+
+        // Clusters far out along their own normal face away from the rest of the mesh and tend to cover it
+        std::vector<float> occlusion(clusterCount);
+        std::vector<uint32_t> order(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++) {
+            occlusion[c] = Dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+            order[c] = c;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&occlusion](uint32_t a, uint32_t b) { return occlusion[a] > occlusion[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order)
+            result.insert(result.end(), indices.data() + clusters[c] * 3, indices.data() + clusters[c + 1] * 3);
+        return result;
+    }
+
+
+    auto AnalyzeOverdraw(ArrayView<const uint32_t> indices, const uint8_t *positions, size_t vertexCount,
+                         size_t positionStride, uint32_t resolution) -> OverdrawStats {
+        OverdrawStats stats;
+        if (indices.empty() || vertexCount == 0)
+            return stats;
+
+        // Uniform scale into the unit cube keeps the proportions the same from every direction
+        PositionReader position{positions, positionStride};
+        Vec3 min = position[indices[0]], max = min;
+        for (uint32_t index : indices) {
+            Vec3 p = position[index];
+            min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+            max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+        }
+        float extent = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+        float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+        for (int axis = 0; axis < 3; axis++) {
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            for (int direction = 0; direction < 2; direction++) {
+                OverdrawRasterizer rasterizer(resolution);
+                auto project = [&](uint32_t vertex) {
+                    Vec3 p = (position[vertex] - min) * scale;
+                    return Vec3{p[u] * float(resolution), p[v] * float(resolution),
+                                direction == 0 ? p[axis] : 1.0f - p[axis]};
+                };
+                for (size_t i = 0; i + 2 < indices.size(); i += 3)
+                    rasterizer.Triangle(project(indices[i]), project(indices[i + 1]), project(indices[i + 2]));
+
+                stats.pixelsShaded += rasterizer.shaded;
+                stats.pixelsCovered += rasterizer.Covered();
+            }
+        }
+        stats.overdraw = stats.pixelsCovered ? double(stats.pixelsShaded) / double(stats.pixelsCovered) : 0.0;
+        return stats;
+    }
+
+
+    auto OptimizeVertexFetch(std::vector<uint32_t> &indices, std::vector<uint8_t> &vertices,
+                             uint32_t vertexSize) -> size_t {
+        size_t vertexCount = vertices.size() / vertexSize;
+        std::vector<uint32_t> remap(vertexCount, INVALID_VERTEX);
+        uint32_t nextVertex = 0;
+        for (auto &index : indices) {
+            if (remap[index] == INVALID_VERTEX)
+                remap[index] = nextVertex++;
+            index = remap[index];
+        }
+
+        std::vector<uint8_t> reordered(size_t(nextVertex) * vertexSize);
+        for (size_t v = 0; v < vertexCount; v++) {
+            if (remap[v] != INVALID_VERTEX)
+                std::memcpy(&reordered[size_t(remap[v]) * vertexSize], &vertices[v * vertexSize], vertexSize);
+        }
+        vertices = std::move(reordered);
+        return nextVertex;
+    }
+}
@@ -0,0 +1,526 @@
+#include "MeshSimplifier.h"
+#include "VertexWeld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+namespace {
+    /// Borders are weighted like the triangles next to them times this, enough to keep silhouettes of open meshes
+    constexpr float BORDER_WEIGHT = 10.0f;
+    /// Collapses of one pass may cost at most this much more than the one at the pass goal
+    constexpr float PASS_COST_BOUND = 1.5f;
+    /// Rejects collapses which turn a triangle further than roughly 90 degrees
+    constexpr float FLIP_THRESHOLD = 1e-2f;
+
+    struct Vec3 {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+
+        auto operator+(const Vec3 &o) const -> Vec3 { return {x + o.x, y + o.y, z + o.z}; }
+
+        auto operator-(const Vec3 &o) const -> Vec3 { return {x - o.x, y - o.y, z - o.z}; }
+
+        auto operator*(float s) const -> Vec3 { return {x * s, y * s, z * s}; }
+    };
+
+    auto Cross(const Vec3 &a, const Vec3 &b) -> Vec3 {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    auto Dot(const Vec3 &a, const Vec3 &b) -> float { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    auto Length(const Vec3 &v) -> float { return std::sqrt(Dot(v, v)); }
+
+    auto ReadPosition(const uint8_t *vertices, size_t stride, uint32_t vertex) -> Vec3 {
+        Vec3 position;
+        std::memcpy(&position, vertices + vertex * stride, sizeof(float) * 3);
+        return position;
+    }
+
+    /// Symmetric 4x4 quadric, sum of weighted squared distances to a set of planes
+    struct Quadric {
+        float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+        float a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+        float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+        float c = 0.0f;
+        float weight = 0.0f;
+
+        /// Plane n.p + d = 0 with weight w, n doesn't have to be of unit length
+        void AddPlane(const Vec3 &n, float d, float w) {
+            a00 += w * n.x * n.x;
+            a11 += w * n.y * n.y;
+            a22 += w * n.z * n.z;
+            a10 += w * n.y * n.x;
+            a20 += w * n.z * n.x;
+            a21 += w * n.z * n.y;
+            b0 += w * n.x * d;
+            b1 += w * n.y * d;
+            b2 += w * n.z * d;
+            c += w * d * d;
+        }
+
+        void Add(const Quadric &o) {
+            a00 += o.a00;
+            a11 += o.a11;
+            a22 += o.a22;
+            a10 += o.a10;
+            a20 += o.a20;
+            a21 += o.a21;
+            b0 += o.b0;
+            b1 += o.b1;
+            b2 += o.b2;
+            c += o.c;
+            weight += o.weight;
+        }
+
+        auto Evaluate(const Vec3 &p) const -> float {
+            float rx = a00 * p.x + a10 * p.y + a20 * p.z;
+            float ry = a10 * p.x + a11 * p.y + a21 * p.z;
+            float rz = a20 * p.x + a21 * p.y + a22 * p.z;
+            float r = rx * p.x + ry * p.y + rz * p.z + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+            return std::max(r, 0.0f);
+        }
+    };
+
+    enum class VertexKind : uint8_t {
+        MANIFOLD,
+        /// On an open border, only collapses along it
+        BORDER,
+        /// Attribute seam or non-manifold, never moves
+        LOCKED,
+    };
+
+    struct Edge {
+        uint32_t a;
+        uint32_t b;
+        /// Triangles sharing the edge
+        uint32_t count;
+    };
+
+    /// Undirected edges of the triangles sorted by (a, b), a < b
+    auto CollectEdges(const std::vector<uint32_t> &indices) -> std::vector<Edge> {
+        std::vector<uint64_t> keys;
+        keys.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint32_t a = indices[i + e], b = indices[i + (e + 1) % 3];
+                keys.push_back(uint64_t(std::min(a, b)) << 32u | std::max(a, b));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<Edge> edges;
+        for (size_t i = 0; i < keys.size();) {
+            size_t run = i + 1;
+            while (run < keys.size() && keys[run] == keys[i])
+                run++;
+            edges.push_back({uint32_t(keys[i] >> 32u), uint32_t(keys[i]), uint32_t(run - i)});
+            i = run;
+        }
+        return edges;
+    }
+
+    auto FindEdge(const std::vector<Edge> &edges, uint32_t a, uint32_t b) -> const Edge * {
+        if (a > b)
+            std::swap(a, b);
+        auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(a, b),
+                                   [](const Edge &edge, const std::pair<uint32_t, uint32_t> &key) {
+                                       return edge.a < key.first || (edge.a == key.first && edge.b < key.second);
+                                   });
+        return it != edges.end() && it->a == a && it->b == b ? &*it : nullptr;
+    }
+
+    /// Triangles around every vertex, rebuilt every pass
+    struct TriangleAdjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        TriangleAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount)
+                : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+            for (uint32_t index : indices)
+                offsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++)
+                offsets[v + 1] += offsets[v];
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    };
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        float cost;
+        float error;
+        uint32_t removedTriangles;
+    };
+
+    struct PositionHash {
+        const uint8_t *vertices;
+        size_t stride;
+
+        auto operator()(uint32_t vertex) const -> uint64_t {
+            return Hash::Hash64(vertices + vertex * stride, sizeof(float) * 3);
+        }
+    };
+
+    struct PositionEqual {
+        const uint8_t *vertices;
+        size_t stride;
+
+        auto operator()(uint32_t a, uint32_t b) const -> bool {
+            return std::memcmp(vertices + a * stride, vertices + b * stride, sizeof(float) * 3) == 0;
+        }
+    };
+
+    class Simplifier {
+        const uint8_t *m_Vertices;
+        size_t m_VertexCount;
+        size_t m_Stride;
+        uint32_t m_Components = 0;
+
+        std::vector<Vec3> m_Positions;
+        std::vector<float> m_AttributeValues;
+        std::vector<VertexKind> m_Kinds;
+        std::vector<Quadric> m_Geometric;
+        /// Per vertex the quadric part of the attribute error, then per component sum(area * gradient), sum(area * offset)
+        std::vector<Quadric> m_AttributeQuadrics;
+        std::vector<float> m_AttributeGradients;
+
+        auto Gradient(uint32_t vertex, uint32_t component) -> float * {
+            return &m_AttributeGradients[(size_t(vertex) * m_Components + component) * 4];
+        }
+
+        auto Attribute(uint32_t vertex, uint32_t component) const -> float {
+            return m_AttributeValues[size_t(vertex) * m_Components + component];
+        }
+
+    public:
+        Simplifier(const uint8_t *vertices, size_t vertexCount, size_t stride,
+                   ArrayView<const SimplifyAttribute> attributes, float scale, const Vec3 &origin)
+                : m_Vertices(vertices), m_VertexCount(vertexCount), m_Stride(stride),
+                  m_Positions(vertexCount), m_Kinds(vertexCount, VertexKind::MANIFOLD),
+                  m_Geometric(vertexCount) {
+            for (const auto &attribute : attributes)
+                m_Components += attribute.components;
+            m_Components = std::min(m_Components, MeshSimplifier::MAX_ATTRIBUTE_COMPONENTS);
+
+            // Unit scale positions, errors and their limits are then relative to the mesh extent
+            for (uint32_t v = 0; v < vertexCount; v++)
+                m_Positions[v] = (ReadPosition(vertices, stride, v) - origin) * scale;
+
+            m_AttributeValues.resize(vertexCount * m_Components);
+            for (uint32_t v = 0; v < vertexCount; v++) {
+                uint32_t component = 0;
+                for (const auto &attribute : attributes) {
+                    for (uint32_t i = 0; i < attribute.components && component < m_Components; i++) {
+                        float value;
+                        std::memcpy(&value, vertices + v * stride + attribute.offset + i * sizeof(float), sizeof(float));
+                        m_AttributeValues[v * m_Components + component++] = value * attribute.weight;
+                    }
+                }
+            }
+            if (m_Components > 0) {
+                m_AttributeQuadrics.resize(vertexCount);
+                m_AttributeGradients.resize(vertexCount * m_Components * 4, 0.0f);
+            }
+        }
+
+        void ClassifyVertices(const std::vector<uint32_t> &indices, const std::vector<Edge> &edges) {
+            std::vector<bool> referenced(m_VertexCount, false);
+            for (uint32_t index : indices)
+                referenced[index] = true;
+
+            // Referenced vertices sharing a position with another one sit on an attribute seam
+            WeldTable<uint32_t, PositionHash, PositionEqual> positions(m_VertexCount, PositionHash{m_Vertices, m_Stride},
+                                                                       PositionEqual{m_Vertices, m_Stride});
+            std::vector<uint32_t> positionId(m_VertexCount);
+            std::vector<uint32_t> wedges;
+            for (uint32_t v = 0; v < m_VertexCount; v++) {
+                if (!referenced[v])
+                    continue;
+                positionId[v] = positions.Insert(v);
+                if (positionId[v] >= wedges.size())
+                    wedges.resize(positionId[v] + 1, 0);
+                wedges[positionId[v]]++;
+            }
+            for (uint32_t v = 0; v < m_VertexCount; v++) {
+                if (referenced[v] && wedges[positionId[v]] > 1)
+                    m_Kinds[v] = VertexKind::LOCKED;
+            }
+
+            for (const auto &edge : edges) {
+                if (edge.count > 2) {
+                    m_Kinds[edge.a] = VertexKind::LOCKED;
+                    m_Kinds[edge.b] = VertexKind::LOCKED;
+                } else if (edge.count == 1) {
+                    if (m_Kinds[edge.a] == VertexKind::MANIFOLD)
+                        m_Kinds[edge.a] = VertexKind::BORDER;
+                    if (m_Kinds[edge.b] == VertexKind::MANIFOLD)
+                        m_Kinds[edge.b] = VertexKind::BORDER;
+                }
+            }
+        }
+
+        void AccumulateQuadrics(const std::vector<uint32_t> &indices, const std::vector<Edge> &edges) {
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                uint32_t corners[3] = {indices[i], indices[i + 1], indices[i + 2]};
+                const Vec3 &p0 = m_Positions[corners[0]], &p1 = m_Positions[corners[1]], &p2 = m_Positions[corners[2]];
+                Vec3 e1 = p1 - p0, e2 = p2 - p0;
+                Vec3 normal = Cross(e1, e2);
+                float doubleArea = Length(normal);
+                if (doubleArea == 0.0f)
+                    continue;
+                float area = doubleArea * 0.5f;
+                Vec3 unitNormal = normal * (1.0f / doubleArea);
+
+                Quadric plane;
+                plane.AddPlane(unitNormal, -Dot(unitNormal, p0), area);
+                plane.weight = area;
+                for (uint32_t corner : corners)
+                    m_Geometric[corner].Add(plane);
+
+                for (int e = 0; e < 3; e++) {
+                    uint32_t a = corners[e], b = corners[(e + 1) % 3];
+                    const Edge *edge = FindEdge(edges, a, b);
+                    if (!edge || edge->count != 1)
+                        continue;
+                    Vec3 direction = m_Positions[b] - m_Positions[a];
+                    float length = Length(direction);
+                    Vec3 borderNormal = Cross(direction, unitNormal);
+                    float borderLength = Length(borderNormal);
+                    if (borderLength == 0.0f)
+                        continue;
+                    borderNormal = borderNormal * (1.0f / borderLength);
+
+                    Quadric border;
+                    border.AddPlane(borderNormal, -Dot(borderNormal, m_Positions[a]), length * length * BORDER_WEIGHT);
+                    border.weight = length * length * BORDER_WEIGHT;
+                    m_Geometric[a].Add(border);
+                    m_Geometric[b].Add(border);
+                }
+
+                if (m_Components == 0)
+                    continue;
+
+                // Linear function per component over the triangle: s(p) = g.p + d, g lies in the triangle plane
+                float inverseNormalLength2 = 1.0f / Dot(normal, normal);
+                Vec3 across2 = Cross(e2, normal) * inverseNormalLength2;
+                Vec3 across1 = Cross(normal, e1) * inverseNormalLength2;
+                Quadric attributeQuadric;
+                float gradients[MeshSimplifier::MAX_ATTRIBUTE_COMPONENTS][4];
+                for (uint32_t k = 0; k < m_Components; k++) {
+                    float s0 = Attribute(corners[0], k);
+                    Vec3 gradient = across2 * (Attribute(corners[1], k) - s0) + across1 * (Attribute(corners[2], k) - s0);
+                    float offset = s0 - Dot(gradient, p0);
+                    attributeQuadric.AddPlane(gradient, offset, area);
+                    gradients[k][0] = gradient.x * area;
+                    gradients[k][1] = gradient.y * area;
+                    gradients[k][2] = gradient.z * area;
+                    gradients[k][3] = offset * area;
+                }
+                attributeQuadric.weight = area;
+
+                for (uint32_t corner : corners) {
+                    m_AttributeQuadrics[corner].Add(attributeQuadric);
+                    for (uint32_t k = 0; k < m_Components; k++) {
+                        float *sum = Gradient(corner, k);
+                        for (int j = 0; j < 4; j++)
+                            sum[j] += gradients[k][j];
+                    }
+                }
+            }
+        }
+
+        /// Squared geometric distance and total cost of moving from onto to
+        auto Cost(uint32_t from, uint32_t to, float &geometricError) -> float {
+            const Vec3 &p = m_Positions[to];
+            const Quadric &geometric = m_Geometric[from];
+            geometricError = geometric.weight > 0.0f ? geometric.Evaluate(p) / geometric.weight : 0.0f;
+            if (m_Components == 0)
+                return geometricError;
+
+            // sum(area * (g.p + d - s)^2) expanded, so the gradients don't have to be kept per triangle
+            const Quadric &attribute = m_AttributeQuadrics[from];
+            if (attribute.weight == 0.0f)
+                return geometricError;
+            float error = attribute.Evaluate(p);
+            for (uint32_t k = 0; k < m_Components; k++) {
+                const float *g = Gradient(from, k);
+                float s = Attribute(to, k);
+                error += -2.0f * s * (g[0] * p.x + g[1] * p.y + g[2] * p.z + g[3]) + attribute.weight * s * s;
+            }
+            return geometricError + std::max(error, 0.0f) / attribute.weight;
+        }
+
+        auto CanCollapse(uint32_t from, uint32_t to, const Edge &edge) const -> bool {
+            switch (m_Kinds[from]) {
+                case VertexKind::MANIFOLD:
+                    return true;
+                case VertexKind::BORDER:
+                    return edge.count == 1 && m_Kinds[to] != VertexKind::MANIFOLD;
+                default:
+                    return false;
+            }
+        }
+
+        /// Whether moving from onto to turns any of its remaining triangles over
+        auto Flips(uint32_t from, uint32_t to, const std::vector<uint32_t> &indices,
+                   const TriangleAdjacency &adjacency) const -> bool {
+            for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++) {
+                const uint32_t *corners = &indices[adjacency.triangles[i] * 3];
+                if (corners[0] == to || corners[1] == to || corners[2] == to)
+                    continue;
+                Vec3 p[3], q[3];
+                for (int c = 0; c < 3; c++) {
+                    p[c] = m_Positions[corners[c]];
+                    q[c] = corners[c] == from ? m_Positions[to] : p[c];
+                }
+                Vec3 before = Cross(p[1] - p[0], p[2] - p[0]);
+                Vec3 after = Cross(q[1] - q[0], q[2] - q[0]);
+                if (Dot(before, after) < FLIP_THRESHOLD * Length(before) * Length(after))
+                    return true;
+            }
+            return false;
+        }
+
+        void Merge(uint32_t from, uint32_t to) {
+            m_Geometric[to].Add(m_Geometric[from]);
+            if (m_Components == 0)
+                return;
+            m_AttributeQuadrics[to].Add(m_AttributeQuadrics[from]);
+            for (uint32_t k = 0; k < m_Components; k++) {
+                float *target = Gradient(to, k);
+                const float *source = Gradient(from, k);
+                for (int j = 0; j < 4; j++)
+                    target[j] += source[j];
+            }
+        }
+    };
+}
+
+
+namespace MeshSimplifier {
+
+    auto Extent(ArrayView<const uint32_t> indices, const uint8_t *vertices, size_t vertexStride) -> float {
+        if (indices.empty())
+            return 0.0f;
+        Vec3 min = ReadPosition(vertices, vertexStride, indices[0]), max = min;
+        for (uint32_t index : indices) {
+            Vec3 p = ReadPosition(vertices, vertexStride, index);
+            min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+            max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+        }
+        return std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+    }
+
+
+    auto Simplify(ArrayView<const uint32_t> indices, const uint8_t *vertices, size_t vertexCount,
+                  size_t vertexStride, ArrayView<const SimplifyAttribute> attributes,
+                  size_t targetIndexCount, float targetError) -> SimplifyResult {
+        SimplifyResult result;
+        result.indices.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (a != b && b != c && a != c)
+                result.indices.insert(result.indices.end(), {a, b, c});
+        }
+        if (result.indices.size() <= targetIndexCount)
+            return result;
+
+        float extent = Extent(result.indices, vertices, vertexStride);
+        Vec3 origin = ReadPosition(vertices, vertexStride, result.indices[0]);
+        Simplifier simplifier(vertices, vertexCount, vertexStride, attributes, extent > 0.0f ? 1.0f / extent : 1.0f,
+                              origin);
+        auto edges = CollectEdges(result.indices);
+        simplifier.ClassifyVertices(result.indices, edges);
+        simplifier.AccumulateQuadrics(result.indices, edges);
+
+        float errorLimit = targetError * targetError;
+        float maxError = 0.0f;
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+            remap[v] = v;
+        std::vector<bool> touched(vertexCount, false);
+        std::vector<Collapse> collapses;
+        collapses.reserve(edges.size());
+
+        while (result.indices.size() > targetIndexCount) {
+            TriangleAdjacency adjacency(result.indices, vertexCount);
+
+            collapses.clear();
+            for (const auto &edge : edges) {
+                Collapse best{0, 0, std::numeric_limits<float>::max(), 0.0f, edge.count};
+                for (int direction = 0; direction < 2; direction++) {
+                    uint32_t from = direction ? edge.b : edge.a, to = direction ? edge.a : edge.b;
+                    if (!simplifier.CanCollapse(from, to, edge))
+                        continue;
+                    float error;
+                    float cost = simplifier.Cost(from, to, error);
+                    if (error <= errorLimit && cost < best.cost)
+                        best = {from, to, cost, error, edge.count};
+                }
+                if (best.cost != std::numeric_limits<float>::max())
+                    collapses.push_back(best);
+            }
+            if (collapses.empty())
+                break;
+
+            // Ties broken by the vertices, the result must not depend on the sort implementation
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                if (a.cost != b.cost)
+                    return a.cost < b.cost;
+                return a.from != b.from ? a.from < b.from : a.to < b.to;
+            });
+
+            // Roughly two triangles go per collapse, the pass stops short of much more expensive collapses
+            size_t trianglesToRemove = (result.indices.size() - targetIndexCount + 2) / 3;
+            size_t goal = std::min(collapses.size() - 1, trianglesToRemove / 2);
+            float passCostLimit = collapses[goal].cost * PASS_COST_BOUND;
+
+            size_t removed = 0;
+            size_t collapsed = 0;
+            for (const auto &collapse : collapses) {
+                if (removed >= trianglesToRemove || collapse.cost > passCostLimit)
+                    break;
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+                if (simplifier.Flips(collapse.from, collapse.to, result.indices, adjacency))
+                    continue;
+
+                remap[collapse.from] = collapse.to;
+                touched[collapse.from] = true;
+                touched[collapse.to] = true;
+                simplifier.Merge(collapse.from, collapse.to);
+                removed += collapse.removedTriangles;
+                maxError = std::max(maxError, collapse.error);
+                collapsed++;
+            }
+            if (collapsed == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t i = 0; i < result.indices.size(); i += 3) {
+                uint32_t a = remap[result.indices[i]], b = remap[result.indices[i + 1]], c = remap[result.indices[i + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                result.indices[write++] = a;
+                result.indices[write++] = b;
+                result.indices[write++] = c;
+            }
+            result.indices.resize(write);
+
+            for (const auto &collapse : collapses) {
+                remap[collapse.from] = collapse.from;
+                touched[collapse.from] = false;
+                touched[collapse.to] = false;
+            }
+            edges = CollectEdges(result.indices);
+        }
+
+        result.error = std::sqrt(maxError);
+        return result;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef GAME_ENGINE_MESH_SIMPLIFIER_H
+#define GAME_ENGINE_MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Engine/Core/ArrayView.h>
+
+
+/// Float vertex attribute taken into account by the collapse costs
+struct SimplifyAttribute {
+    /// Byte offset inside the vertex
+    uint32_t offset;
+    uint32_t components;
+    /// Attribute error relative to the geometric error, attribute values are compared as they are
+    float weight;
+};
+
+
+struct SimplifyResult {
+    /// References the same vertices as the input
+    std::vector<uint32_t> indices;
+    /// Largest geometric deviation introduced by the collapses, relative to the mesh extent
+    float error = 0.0f;
+};
+
+
+/**
+ * Quadric error metric simplification with half-edge collapses (Garland and Heckbert 1997). A
+ * vertex collapses onto one of its neighbours, so no vertices are created and every level of
+ * detail can share the vertex buffer of the full mesh.
+ *
+ * Every vertex accumulates the plane quadrics of its triangles, open borders add planes
+ * perpendicular to the border so they keep their shape. Attributes are handled like in Hoppe's
+ * "New quadric metric", every triangle fits a linear function per attribute component and the
+ * deviation of the collapse target's attributes from those functions is added to the cost. Only
+ * the geometric part counts towards the error limit.
+ *
+ * Vertices on attribute seams (same position, different attributes) and on non-manifold edges are
+ * locked, border vertices only collapse along the border.
+ */
+namespace MeshSimplifier {
+    constexpr uint32_t MAX_ATTRIBUTE_COMPONENTS = 8;
+
+    /**
+     * Collapses edges in order of increasing cost until the index count drops to targetIndexCount
+     * or the next collapse would exceed targetError (relative to the mesh extent). Positions are
+     * three floats at the start of every vertex.
+     */
+    auto Simplify(ArrayView<const uint32_t> indices, const uint8_t *vertices, size_t vertexCount,
+                  size_t vertexStride, ArrayView<const SimplifyAttribute> attributes,
+                  size_t targetIndexCount, float targetError) -> SimplifyResult;
+
+    /// Largest side of the bounding box of the referenced positions, scales relative errors to object space
+    auto Extent(ArrayView<const uint32_t> indices, const uint8_t *vertices, size_t vertexStride) -> float;
+}
+
+
+#endif //GAME_ENGINE_MESH_SIMPLIFIER_H
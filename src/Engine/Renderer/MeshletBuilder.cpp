@@ -0,0 +1,304 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+namespace {
+    constexpr uint8_t NO_SLOT = std::numeric_limits<uint8_t>::max();
+    constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+    /// Cones whose widest normal is closer than this to perpendicular wouldn't cull from any useful direction
+    constexpr float MIN_CONE_DOT = 0.1f;
+    /// Cutoff of a cone which can't cull, a dot product of unit vectors never reaches it
+    constexpr float NO_CONE_CUTOFF = 2.0f;
+    /// Cost of the farthest candidate from the meshlet's centroid, keeps meshlets round so they fit more triangles
+    constexpr float DISTANCE_WEIGHT = 0.5f;
+
+    static_assert(Meshlet::MAX_VERTICES < NO_SLOT, "Local vertex indices have to fit a byte");
+
+    struct Vec3 {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+
+        auto operator+(const Vec3 &o) const -> Vec3 { return {x + o.x, y + o.y, z + o.z}; }
+
+        auto operator-(const Vec3 &o) const -> Vec3 { return {x - o.x, y - o.y, z - o.z}; }
+
+        auto operator*(float s) const -> Vec3 { return {x * s, y * s, z * s}; }
+    };
+
+    auto Cross(const Vec3 &a, const Vec3 &b) -> Vec3 {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    auto Dot(const Vec3 &a, const Vec3 &b) -> float { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    auto Length(const Vec3 &v) -> float { return std::sqrt(Dot(v, v)); }
+
+    auto Normalized(const Vec3 &v) -> Vec3 {
+        float length = Length(v);
+        return length > 0.0f ? v * (1.0f / length) : Vec3{};
+    }
+
+    auto ReadPosition(const uint8_t *positions, size_t stride, uint32_t vertex) -> Vec3 {
+        Vec3 position;
+        std::memcpy(&position, positions + vertex * stride, sizeof(float) * 3);
+        return position;
+    }
+
+    /// Triangles around every vertex in one flat array, a triangle with a repeated vertex is listed twice
+    struct VertexAdjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        VertexAdjacency(ArrayView<const uint32_t> indices, size_t vertexCount)
+                : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+            for (uint32_t index : indices)
+                offsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++)
+                offsets[v + 1] += offsets[v];
+
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    };
+
+    /// Ritter's bounding sphere, within a few percent of the minimal one
+    void ComputeSphere(const std::vector<Vec3> &points, Meshlet &meshlet) {
+        auto farthestFrom = [&](const Vec3 &origin) {
+            size_t farthest = 0;
+            float farthestDistance = -1.0f;
+            for (size_t i = 0; i < points.size(); i++) {
+                float distance = Dot(points[i] - origin, points[i] - origin);
+                if (distance > farthestDistance) {
+                    farthest = i;
+                    farthestDistance = distance;
+                }
+            }
+            return points[farthest];
+        };
+
+        Vec3 a = farthestFrom(points[0]);
+        Vec3 b = farthestFrom(a);
+        Vec3 center = (a + b) * 0.5f;
+        float radius = Length(b - a) * 0.5f;
+        for (const auto &point : points) {
+            float distance = Length(point - center);
+            if (distance > radius) {
+                // Grow just enough to cover the point, keeping the opposite side of the sphere in place
+                float grownRadius = (radius + distance) * 0.5f;
+                center = center + (point - center) * ((grownRadius - radius) / distance);
+                radius = grownRadius;
+            }
+        }
+
+        std::memcpy(meshlet.center, &center, sizeof(meshlet.center));
+        meshlet.radius = radius;
+    }
+
+    /**
+     * The cone axis is the average triangle normal, the cutoff the sine of the angle between the
+     * axis and the widest normal. The apex is moved back along the axis until it lies behind every
+     * triangle's plane, a camera in front of the apex inside the cone sees only back faces.
+     */
+    void ComputeCone(const std::vector<Vec3> &corners, const std::vector<Vec3> &normals, const Vec3 &normalSum,
+                     Meshlet &meshlet) {
+        Vec3 center{meshlet.center[0], meshlet.center[1], meshlet.center[2]};
+        Vec3 axis = Normalized(normalSum);
+        std::memcpy(meshlet.coneAxis, &axis, sizeof(meshlet.coneAxis));
+        std::memcpy(meshlet.coneApex, &center, sizeof(meshlet.coneApex));
+        meshlet.coneCutoff = NO_CONE_CUTOFF;
+
+        float minDot = 1.0f;
+        for (const auto &normal : normals) {
+            // Degenerate triangles have no facing
+            if (Dot(normal, normal) > 0.0f)
+                minDot = std::min(minDot, Dot(axis, normal));
+        }
+        if (Length(axis) == 0.0f || minDot <= MIN_CONE_DOT)
+            return;
+
+        float maxT = 0.0f;
+        for (size_t t = 0; t < normals.size(); t++) {
+            if (Dot(normals[t], normals[t]) > 0.0f)
+                maxT = std::max(maxT, Dot(center - corners[t * 3], normals[t]) / Dot(axis, normals[t]));
+        }
+        Vec3 apex = center - axis * maxT;
+        std::memcpy(meshlet.coneApex, &apex, sizeof(meshlet.coneApex));
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+
+namespace MeshletBuilder {
+
+    auto Build(ArrayView<const uint32_t> indices, const uint8_t *positions, size_t vertexCount,
+               size_t positionStride, float coneWeight) -> MeshletBuffers {
+        MeshletBuffers result;
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return result;
+
+        std::vector<Vec3> normals(triangleCount), centroids(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            Vec3 a = ReadPosition(positions, positionStride, indices[t * 3]);
+            Vec3 b = ReadPosition(positions, positionStride, indices[t * 3 + 1]);
+            Vec3 c = ReadPosition(positions, positionStride, indices[t * 3 + 2]);
+            normals[t] = Normalized(Cross(b - a, c - a));
+            centroids[t] = (a + b + c) * (1.0f / 3.0f);
+        }
+        VertexAdjacency adjacency(indices, vertexCount);
+
+        std::vector<uint8_t> assigned(triangleCount, 0);
+        // Meshlet which last listed the triangle as a candidate, avoids duplicates in the candidate list
+        std::vector<uint32_t> listedBy(triangleCount, NO_TRIANGLE);
+        std::vector<uint8_t> slots(vertexCount, NO_SLOT);
+        std::vector<uint32_t> meshletVertices, meshletTriangles, candidates;
+        Vec3 normalSum, centroidSum;
+        size_t assignedCount = 0, scan = 0;
+        uint32_t meshletIdx = 0;
+
+        auto newVertices = [&](uint32_t triangle) {
+            const uint32_t *corners = &indices[triangle * 3];
+            uint32_t count = slots[corners[0]] == NO_SLOT;
+            count += slots[corners[1]] == NO_SLOT && corners[1] != corners[0];
+            count += slots[corners[2]] == NO_SLOT && corners[2] != corners[0] && corners[2] != corners[1];
+            return count;
+        };
+
+        std::vector<Vec3> corners, triangleNormals, points;
+        auto flush = [&] {
+            Meshlet meshlet{};
+            meshlet.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+            meshlet.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+            meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+            meshlet.triangleCount = static_cast<uint32_t>(meshletTriangles.size());
+
+            corners.clear();
+            triangleNormals.clear();
+            points.clear();
+            for (uint32_t triangle : meshletTriangles) {
+                for (size_t i = 0; i < 3; i++) {
+                    uint32_t vertex = indices[triangle * 3 + i];
+                    result.triangles.push_back(slots[vertex]);
+                    corners.push_back(ReadPosition(positions, positionStride, vertex));
+                }
+                triangleNormals.push_back(normals[triangle]);
+            }
+            // Every meshlet's triangles start on a 4 byte boundary so shaders can read them as words
+            result.triangles.resize((result.triangles.size() + 3) & ~size_t(3), 0);
+
+            for (uint32_t vertex : meshletVertices) {
+                result.vertices.push_back(vertex);
+                points.push_back(ReadPosition(positions, positionStride, vertex));
+                slots[vertex] = NO_SLOT;
+            }
+            ComputeSphere(points, meshlet);
+            ComputeCone(corners, triangleNormals, normalSum, meshlet);
+            result.meshlets.push_back(meshlet);
+
+            meshletVertices.clear();
+            meshletTriangles.clear();
+            candidates.clear();
+            normalSum = {};
+            centroidSum = {};
+            meshletIdx++;
+        };
+
+        auto add = [&](uint32_t triangle) {
+            assigned[triangle] = 1;
+            assignedCount++;
+            for (size_t i = 0; i < 3; i++) {
+                uint32_t vertex = indices[triangle * 3 + i];
+                if (slots[vertex] != NO_SLOT)
+                    continue;
+
+                slots[vertex] = static_cast<uint8_t>(meshletVertices.size());
+                meshletVertices.push_back(vertex);
+                for (uint32_t a = adjacency.offsets[vertex]; a < adjacency.offsets[vertex + 1]; a++) {
+                    uint32_t neighbour = adjacency.triangles[a];
+                    if (!assigned[neighbour] && listedBy[neighbour] != meshletIdx) {
+                        listedBy[neighbour] = meshletIdx;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+            meshletTriangles.push_back(triangle);
+            normalSum = normalSum + normals[triangle];
+            centroidSum = centroidSum + centroids[triangle];
+        };
+
+        while (assignedCount < triangleCount) {
+            Vec3 axis = Normalized(normalSum);
+            Vec3 centroid = centroidSum * (meshletTriangles.empty() ? 0.0f : 1.0f / meshletTriangles.size());
+            size_t kept = 0;
+            float maxDistance = 0.0f;
+            for (uint32_t candidate : candidates) {
+                if (assigned[candidate])
+                    continue;
+                candidates[kept++] = candidate;
+                maxDistance = std::max(maxDistance, Length(centroids[candidate] - centroid));
+            }
+            candidates.resize(kept);
+            float distanceScale = maxDistance > 0.0f ? DISTANCE_WEIGHT / maxDistance : 0.0f;
+
+            uint32_t best = NO_TRIANGLE;
+            float bestScore = std::numeric_limits<float>::max();
+            for (uint32_t candidate : candidates) {
+                uint32_t added = newVertices(candidate);
+                if (meshletVertices.size() + added > Meshlet::MAX_VERTICES)
+                    continue;
+                // Strictly smaller, ties go to the earlier listed triangle so the result doesn't depend on anything else
+                float score = static_cast<float>(added) + coneWeight * (1.0f - Dot(normals[candidate], axis)) +
+                              distanceScale * Length(centroids[candidate] - centroid);
+                if (score < bestScore) {
+                    best = candidate;
+                    bestScore = score;
+                }
+            }
+
+            if (best == NO_TRIANGLE) {
+                while (assigned[scan])
+                    scan++;
+                best = static_cast<uint32_t>(scan);
+            }
+            if (meshletTriangles.size() == Meshlet::MAX_TRIANGLES ||
+                meshletVertices.size() + newVertices(best) > Meshlet::MAX_VERTICES)
+                flush();
+            add(best);
+        }
+        flush();
+        return result;
+    }
+
+
+    auto IsBackfacing(const Meshlet &meshlet, const float cameraPosition[3]) -> bool {
+        Vec3 direction{meshlet.coneApex[0] - cameraPosition[0], meshlet.coneApex[1] - cameraPosition[1],
+                       meshlet.coneApex[2] - cameraPosition[2]};
+        Vec3 axis{meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]};
+        return Dot(direction, axis) >= meshlet.coneCutoff * Length(direction);
+    }
+
+
+    auto Analyze(const MeshletView &meshlets, size_t vertexCount) -> MeshletStats {
+        MeshletStats stats;
+        stats.meshletCount = meshlets.meshlets.size();
+        if (meshlets.meshlets.empty())
+            return stats;
+
+        uint64_t vertices = 0, triangles = 0, cullable = 0;
+        for (const auto &meshlet : meshlets.meshlets) {
+            vertices += meshlet.vertexCount;
+            triangles += meshlet.triangleCount;
+            cullable += meshlet.coneCutoff <= 1.0f;
+        }
+        auto count = static_cast<double>(stats.meshletCount);
+        stats.vertexFill = vertices / (count * Meshlet::MAX_VERTICES);
+        stats.triangleFill = triangles / (count * Meshlet::MAX_TRIANGLES);
+        stats.vertexDuplication = vertexCount ? double(vertices) / vertexCount : 0.0;
+        stats.cullableCones = cullable / count;
+        return stats;
+    }
+}
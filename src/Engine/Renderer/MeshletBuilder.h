@@ -0,0 +1,60 @@
+#ifndef GAME_ENGINE_MESHLET_BUILDER_H
+#define GAME_ENGINE_MESHLET_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Engine/Core/ArrayView.h>
+#include "MeshCache.h"
+
+
+/// Owned meshlet tables, the layout MeshletView describes
+struct MeshletBuffers {
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+
+    auto View() const -> MeshletView { return {meshlets, vertices, triangles}; }
+};
+
+
+struct MeshletStats {
+    size_t meshletCount = 0;
+    /// Fill of the vertex and triangle limits, 1 means every meshlet is full
+    double vertexFill = 0.0;
+    double triangleFill = 0.0;
+    /// Meshlet vertices per mesh vertex, 1 when no vertex is shared between meshlets
+    double vertexDuplication = 0.0;
+    /// Share of meshlets whose cone can cull them at all
+    double cullableCones = 0.0;
+};
+
+
+/**
+ * Partitions an index buffer into meshlets of at most Meshlet::MAX_VERTICES vertices and
+ * Meshlet::MAX_TRIANGLES triangles. The builder is greedy and single threaded, the same input
+ * always produces the same meshlets.
+ */
+namespace MeshletBuilder {
+    /// How much a triangle facing away from the meshlet's average normal costs, in shared vertices
+    constexpr float DEFAULT_CONE_WEIGHT = 0.5f;
+
+    /**
+     * Every meshlet is grown from a seed triangle by adding the connected triangle which brings in
+     * the fewest new vertices, deviates the least from the meshlet's average normal and lies
+     * closest to the meshlet's centroid. When no connected triangle fits, the next unassigned
+     * triangle in index buffer order continues the meshlet, a cache optimized buffer keeps that
+     * nearby. Positions are three floats at the start of every positionStride bytes, triangle
+     * normals use counter-clockwise winding.
+     */
+    auto Build(ArrayView<const uint32_t> indices, const uint8_t *positions, size_t vertexCount,
+               size_t positionStride, float coneWeight = DEFAULT_CONE_WEIGHT) -> MeshletBuffers;
+
+    /// Whether the whole meshlet faces away from the camera, never true for a cone that can't cull
+    auto IsBackfacing(const Meshlet &meshlet, const float cameraPosition[3]) -> bool;
+
+    auto Analyze(const MeshletView &meshlets, size_t vertexCount) -> MeshletStats;
+}
+
+
+#endif //GAME_ENGINE_MESHLET_BUILDER_H
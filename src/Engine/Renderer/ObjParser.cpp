@@ -0,0 +1,384 @@
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <Engine/Core/MappedFile.h>
+#include <Engine/Core/Parallel.h>
+
+
+namespace {
+    /// Significant digits which still fit into the 64-bit mantissa
+    constexpr int MAX_MANTISSA_DIGITS = 19;
+
+    constexpr double POW10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    struct ChunkCounts {
+        size_t positions = 0;
+        size_t texcoords = 0;
+        size_t normals = 0;
+        size_t corners = 0;
+    };
+
+    enum class LineType {
+        POSITION,
+        TEXCOORD,
+        NORMAL,
+        FACE,
+        OTHER
+    };
+
+    inline auto IsDigit(char c) -> bool { return static_cast<unsigned>(c - '0') < 10u; }
+
+    /// '\r' counts as whitespace, that takes care of CRLF line endings
+    inline auto IsSpace(char c) -> bool { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline auto SkipSpaces(const char *p, const char *end) -> const char * {
+        while (p < end && IsSpace(*p))
+            p++;
+        return p;
+    }
+
+    inline auto SkipToken(const char *p, const char *end) -> const char * {
+        while (p < end && !IsSpace(*p))
+            p++;
+        return p;
+    }
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    /// SWAR digit check, all eight bytes are in '0'..'9'
+    inline auto IsEightDigits(uint64_t chars) -> bool {
+        return (((chars & 0xF0F0F0F0F0F0F0F0ull) |
+                 (((chars + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4u)) == 0x3333333333333333ull);
+    }
+
+    /// Eight ASCII digits to their value with three multiplications instead of eight dependent ones
+    inline auto ParseEightDigits(uint64_t chars) -> uint32_t {
+        constexpr uint64_t MASK = 0x000000FF000000FFull;
+        constexpr uint64_t MUL_1 = 0x000F424000000064ull; // 100 + (1000000 << 32)
+        constexpr uint64_t MUL_2 = 0x0000271000000001ull; // 1 + (10000 << 32)
+        chars -= 0x3030303030303030ull;
+        chars = (chars * 10) + (chars >> 8u);
+        return static_cast<uint32_t>((((chars & MASK) * MUL_1) + (((chars >> 16u) & MASK) * MUL_2)) >> 32u);
+    }
+
+    inline auto TryEightDigits(const char *&p, const char *end, uint64_t &mantissa, int &digits) -> bool {
+        if (end - p < 8 || digits + 8 > MAX_MANTISSA_DIGITS)
+            return false;
+        uint64_t chars;
+        std::memcpy(&chars, p, sizeof(chars));
+        if (!IsEightDigits(chars))
+            return false;
+        mantissa = mantissa * 100000000u + ParseEightDigits(chars);
+        digits += 8;
+        p += 8;
+        return true;
+    }
+#else
+    inline auto TryEightDigits(const char *&, const char *, uint64_t &, int &) -> bool { return false; }
+#endif
+
+    /// Appends digits to the mantissa, returns how many didn't fit and were dropped
+    inline auto ParseDigits(const char *&p, const char *end, uint64_t &mantissa, int &digits) -> int {
+        int dropped = 0;
+        while (p < end && IsDigit(*p)) {
+            if (mantissa != 0 && TryEightDigits(p, end, mantissa, digits))
+                continue;
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                // Leading zeros don't use up precision
+                digits += mantissa != 0;
+            } else {
+                dropped++;
+            }
+            p++;
+        }
+        return dropped;
+    }
+
+    /// Literals the fast path doesn't handle (inf, nan, hex floats), rare enough to go through strtof
+    auto ParseFloatSlow(const char *&p, const char *end) -> float {
+        char buffer[64];
+        size_t length = std::min<size_t>(SkipToken(p, end) - p, sizeof(buffer) - 1);
+        std::memcpy(buffer, p, length);
+        buffer[length] = '\0';
+        char *parsedEnd = nullptr;
+        float value = std::strtof(buffer, &parsedEnd);
+        p += parsedEnd - buffer;
+        return value;
+    }
+
+    auto ParseInt(const char *&p, const char *end, int64_t &value) -> bool {
+        bool negative = p < end && *p == '-';
+        if (negative || (p < end && *p == '+'))
+            p++;
+        if (p >= end || !IsDigit(*p))
+            return false;
+
+        int64_t result = 0;
+        while (p < end && IsDigit(*p)) {
+            // Anything this large can't be a valid index anyway
+            if (result < (int64_t(1) << 40u))
+                result = result * 10 + (*p - '0');
+            p++;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    auto Classify(const char *&p, const char *end) -> LineType {
+        p = SkipSpaces(p, end);
+        if (end - p < 2)
+            return LineType::OTHER;
+        if (p[0] == 'f' && IsSpace(p[1])) {
+            p += 2;
+            return LineType::FACE;
+        }
+        if (p[0] != 'v')
+            return LineType::OTHER;
+        if (IsSpace(p[1])) {
+            p += 2;
+            return LineType::POSITION;
+        }
+        if (end - p < 3 || !IsSpace(p[2]))
+            return LineType::OTHER;
+        p += 3;
+        return p[-2] == 't' ? LineType::TEXCOORD : p[-2] == 'n' ? LineType::NORMAL : LineType::OTHER;
+    }
+
+    template<typename F>
+    void ForEachLine(const char *begin, const char *end, F &&visit) {
+        while (begin < end) {
+            const auto *lineEnd = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+            if (!lineEnd)
+                lineEnd = end;
+            visit(begin, lineEnd);
+            begin = lineEnd + 1;
+        }
+    }
+
+    auto CountFaceVertices(const char *p, const char *end) -> size_t {
+        size_t count = 0;
+        for (p = SkipSpaces(p, end); p < end; p = SkipSpaces(SkipToken(p, end), end))
+            count++;
+        return count;
+    }
+
+    auto CountChunk(const char *begin, const char *end) -> ChunkCounts {
+        ChunkCounts counts;
+        ForEachLine(begin, end, [&counts](const char *p, const char *lineEnd) {
+            switch (Classify(p, lineEnd)) {
+                case LineType::POSITION: counts.positions++; break;
+                case LineType::TEXCOORD: counts.texcoords++; break;
+                case LineType::NORMAL: counts.normals++; break;
+                case LineType::FACE: {
+                    size_t vertices = CountFaceVertices(p, lineEnd);
+                    counts.corners += vertices >= 3 ? (vertices - 2) * 3 : 0;
+                    break;
+                }
+                case LineType::OTHER: break;
+            }
+        });
+        return counts;
+    }
+
+    /**
+     * OBJ indices are one-based, negative ones count back from the latest element. seen is the
+     * number of elements declared before the current line, total the number in the whole file.
+     */
+    inline auto ResolveIndex(int64_t index, size_t seen, size_t total) -> int32_t {
+        int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(seen) + index;
+        if (index == 0 || resolved < 0 || resolved >= static_cast<int64_t>(total))
+            return -1;
+        return static_cast<int32_t>(resolved);
+    }
+
+    /// Parses "v", "v/t", "v//n" or "v/t/n", false on malformed or out of range references
+    auto ParseCorner(const char *&p, const char *end, const ChunkCounts &seen, const ChunkCounts &total,
+                     ObjIndex &corner) -> bool {
+        int64_t value = 0;
+        if (!ParseInt(p, end, value) || (corner.position = ResolveIndex(value, seen.positions, total.positions)) < 0)
+            return false;
+        corner.texcoord = -1;
+        corner.normal = -1;
+        if (p >= end || *p != '/')
+            return true;
+
+        p++;
+        if (p < end && *p != '/') {
+            if (!ParseInt(p, end, value) || (corner.texcoord = ResolveIndex(value, seen.texcoords, total.texcoords)) < 0)
+                return false;
+        }
+        if (p >= end || *p != '/')
+            return true;
+
+        p++;
+        return ParseInt(p, end, value) && (corner.normal = ResolveIndex(value, seen.normals, total.normals)) >= 0;
+    }
+
+    auto ParseFloats(const char *p, const char *end, float *out, size_t count) -> const char * {
+        for (size_t i = 0; i < count; i++) {
+            p = SkipSpaces(p, end);
+            out[i] = p < end ? ObjParser::ParseFloat(p, end) : 0.0f;
+        }
+        return p;
+    }
+
+    /// Writes the chunk's elements into the ranges starting at base
+    void ParseChunk(const char *fileBegin, const char *begin, const char *end, ChunkCounts base,
+                    const ChunkCounts &total, ObjMesh &mesh) {
+        ChunkCounts seen = base;
+        ForEachLine(begin, end, [&](const char *p, const char *lineEnd) {
+            switch (Classify(p, lineEnd)) {
+                case LineType::POSITION:
+                    ParseFloats(p, lineEnd, &mesh.positions[3 * seen.positions++], 3);
+                    break;
+                case LineType::TEXCOORD:
+                    ParseFloats(p, lineEnd, &mesh.texcoords[2 * seen.texcoords++], 2);
+                    break;
+                case LineType::NORMAL:
+                    ParseFloats(p, lineEnd, &mesh.normals[3 * seen.normals++], 3);
+                    break;
+                case LineType::FACE: {
+                    ObjIndex first, previous, current;
+                    size_t vertex = 0;
+                    for (p = SkipSpaces(p, lineEnd); p < lineEnd; p = SkipSpaces(p, lineEnd), vertex++) {
+                        if (!ParseCorner(p, lineEnd, seen, total, current) || (p < lineEnd && !IsSpace(*p))) {
+                            throw std::runtime_error("[ObjParser] Invalid face at byte offset " +
+                                                     std::to_string(p - fileBegin));
+                        }
+                        if (vertex == 0) {
+                            first = current;
+                        } else if (vertex >= 2) {
+                            mesh.indices[seen.corners++] = first;
+                            mesh.indices[seen.corners++] = previous;
+                            mesh.indices[seen.corners++] = current;
+                        }
+                        previous = current;
+                    }
+                    break;
+                }
+                case LineType::OTHER:
+                    break;
+            }
+        });
+    }
+
+    auto ParseMapped(TaskSystem &taskSystem, const char *data, size_t size, const MappedFile *file) -> ObjMesh {
+        // Chunk boundaries are moved forward to the next line start
+        std::vector<size_t> boundaries{0};
+        for (size_t offset = ObjParser::CHUNK_SIZE; offset < size; offset = boundaries.back() + ObjParser::CHUNK_SIZE) {
+            const auto *newline = static_cast<const char *>(std::memchr(data + offset, '\n', size - offset));
+            if (!newline)
+                break;
+            boundaries.push_back(newline - data + 1);
+        }
+        if (boundaries.back() != size)
+            boundaries.push_back(size);
+        size_t chunkCount = boundaries.size() - 1;
+
+        auto release = [file, &boundaries](size_t chunk) {
+            if (file)
+                file->Release(boundaries[chunk], boundaries[chunk + 1] - boundaries[chunk]);
+        };
+
+        std::vector<ChunkCounts> counts(chunkCount);
+        Parallel::For(taskSystem, 0, chunkCount, [&](size_t chunk) {
+            counts[chunk] = CountChunk(data + boundaries[chunk], data + boundaries[chunk + 1]);
+            release(chunk);
+        });
+
+        // Exclusive prefix sums give every chunk its output ranges
+        std::vector<ChunkCounts> bases(chunkCount);
+        ChunkCounts total;
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            bases[chunk] = total;
+            total.positions += counts[chunk].positions;
+            total.texcoords += counts[chunk].texcoords;
+            total.normals += counts[chunk].normals;
+            total.corners += counts[chunk].corners;
+        }
+        if (total.positions > static_cast<size_t>(INT32_MAX) || total.corners > static_cast<size_t>(UINT32_MAX))
+            throw std::runtime_error("[ObjParser] File has too many elements");
+
+        ObjMesh mesh;
+        mesh.positions.resize(total.positions * 3);
+        mesh.texcoords.resize(total.texcoords * 2);
+        mesh.normals.resize(total.normals * 3);
+        mesh.indices.resize(total.corners);
+
+        Parallel::For(taskSystem, 0, chunkCount, [&](size_t chunk) {
+            ParseChunk(data, data + boundaries[chunk], data + boundaries[chunk + 1], bases[chunk], total, mesh);
+            release(chunk);
+        });
+        return mesh;
+    }
+}
+
+
+namespace ObjParser {
+
+    auto ParseFloat(const char *&p, const char *end) -> float {
+        const char *start = p;
+        bool negative = p < end && *p == '-';
+        if (negative || (p < end && *p == '+'))
+            p++;
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        const char *integerStart = p;
+        int exponent = ParseDigits(p, end, mantissa, digits);
+        bool anyDigits = p != integerStart;
+        if (p < end && *p == '.') {
+            p++;
+            const char *fractionStart = p;
+            int dropped = ParseDigits(p, end, mantissa, digits);
+            // Every kept fraction digit shifts the exponent, dropped ones are simply lost precision
+            exponent -= static_cast<int>(p - fractionStart) - dropped;
+            anyDigits |= p != fractionStart;
+        }
+        if (!anyDigits) {
+            p = start;
+            return ParseFloatSlow(p, end);
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char *exponentStart = p++;
+            int64_t value = 0;
+            if (ParseInt(p, end, value))
+                exponent += static_cast<int>(std::max<int64_t>(std::min<int64_t>(value, 1000), -1000));
+            else
+                p = exponentStart;
+        }
+
+        auto value = static_cast<double>(mantissa);
+        if (exponent < 0 && exponent >= -22)
+            value /= POW10[-exponent];
+        else if (exponent > 0 && exponent <= 22)
+            value *= POW10[exponent];
+        else if (exponent != 0)
+            value *= std::pow(10.0, exponent);
+        return static_cast<float>(negative ? -value : value);
+    }
+
+
+    auto Parse(TaskSystem &taskSystem, const std::string &filepath) -> ObjMesh {
+        auto file = MappedFile::Open(filepath);
+        if (!file) {
+            if (auto stamp = FileStamp::Of(filepath); stamp && stamp->size == 0)
+                return {};
+            throw std::runtime_error("[ObjParser] Failed to open " + filepath);
+        }
+        return ParseMapped(taskSystem, reinterpret_cast<const char *>(file->Data()), file->Size(), file.get());
+    }
+
+
+    auto Parse(TaskSystem &taskSystem, const char *data, size_t size) -> ObjMesh {
+        return ParseMapped(taskSystem, data, size, nullptr);
+    }
+}
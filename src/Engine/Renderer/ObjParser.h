@@ -0,0 +1,59 @@
+#ifndef GAME_ENGINE_OBJ_PARSER_H
+#define GAME_ENGINE_OBJ_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Engine/Core/TaskSystem.h>
+
+
+/// Zero-based attribute indices of one face corner, -1 when the corner doesn't reference the attribute
+struct ObjIndex {
+    int32_t position = -1;
+    int32_t texcoord = -1;
+    int32_t normal = -1;
+
+    auto operator==(const ObjIndex &other) const -> bool {
+        return position == other.position && texcoord == other.texcoord && normal == other.normal;
+    }
+
+    auto operator!=(const ObjIndex &other) const -> bool { return !(*this == other); }
+};
+
+
+/// Geometry of a whole OBJ file, faces are triangulated as fans and every shape is merged
+struct ObjMesh {
+    /// xyz per position, extra components (w, vertex colors) are dropped
+    std::vector<float> positions;
+    /// xyz per normal
+    std::vector<float> normals;
+    /// uv per texture coordinate
+    std::vector<float> texcoords;
+    /// Three corners per triangle
+    std::vector<ObjIndex> indices;
+};
+
+
+/**
+ * Parses OBJ geometry in parallel. The file is mapped and split into line-aligned chunks. A first
+ * pass counts the elements of every chunk, so the final arrays can be allocated once and the
+ * second pass parses every chunk straight into its own range of them. Relative (negative)
+ * indices are resolved against the running element counts. Materials, groups and smoothing
+ * groups are ignored.
+ */
+namespace ObjParser {
+    /// Large enough to amortize the task overhead, small enough for load balancing on big files
+    constexpr size_t CHUNK_SIZE = 1u << 22u;
+
+    /// Throws std::runtime_error when the file can't be read or references missing elements
+    auto Parse(TaskSystem &taskSystem, const std::string &filepath) -> ObjMesh;
+
+    auto Parse(TaskSystem &taskSystem, const char *data, size_t size) -> ObjMesh;
+
+    /// Decimal float at p, p is advanced past it. Exposed for the benchmarks.
+    auto ParseFloat(const char *&p, const char *end) -> float;
+}
+
+
+#endif //GAME_ENGINE_OBJ_PARSER_H
@@ -61,9 +61,27 @@ struct DrawIndexedPayload {
     uint32_t firstInstance = 0;
 };
 
-class Mesh;
-class MeshRenderer;
-class Material;
+class ShaderPipeline;
+
+struct BindMaterialPayload {
+    ShaderPipeline *pipeline;
+    uint32_t materialID;
+};
+
+/// Everything needed to bind a mesh instance, copied while building so the render stage never reads the mesh
+struct BindMeshPayload {
+    /// Backend buffer holding the vertices followed by the indices
+    void *buffer;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    /// Bytes per index, zero for meshes drawn without indices
+    uint32_t indexSize;
+    uint32_t materialInstanceID;
+    /// VertexFormat, compact vertices push their dequantization box
+    uint32_t vertexFormat;
+    float positionOffset[3];
+    float positionScale[3];
+};
 
 struct RenderCommand {
     enum class Type : uint8_t {
@@ -130,12 +148,12 @@ struct RenderCommand {
 //        return RenderCommand(Type::BIND_INDEX_BUFFER, sizeof(BindIndexBufferPayload), &payload);
 //    }
 
-    static auto BindMaterial(const Material *material) -> RenderCommand {
-        return RenderCommand(Type::BIND_MATERIAL, sizeof(const void *), &material);
+    static auto BindMaterial(const BindMaterialPayload &payload) -> RenderCommand {
+        return RenderCommand(Type::BIND_MATERIAL, sizeof(BindMaterialPayload), &payload);
     }
 
-    static auto BindMeshInstance(const MeshRenderer *meshInstance) -> RenderCommand {
-        return RenderCommand(Type::BIND_MESH, sizeof(const void *), &meshInstance);
+    static auto BindMesh(const BindMeshPayload &payload) -> RenderCommand {
+        return RenderCommand(Type::BIND_MESH, sizeof(BindMeshPayload), &payload);
     }
 
     static auto SetDynamicOffset(uint32_t set, uint32_t binding, uint32_t objectIndex) -> RenderCommand {
@@ -159,6 +177,8 @@ struct RenderCommand {
     }
 };
 
+static_assert(sizeof(BindMeshPayload) <= sizeof(RenderCommand::m_Payload), "[RenderCommand] Mesh binding doesn't fit");
+
 
 class RenderCommandQueue {
 private:
@@ -191,6 +211,10 @@ public:
         m_NextFree = m_Buffer;
     }
 
+    RenderCommandQueue(const RenderCommandQueue &other) = delete;
+
+    auto operator=(const RenderCommandQueue &other) -> RenderCommandQueue & = delete;
+
     ~RenderCommandQueue() {
         std::free(m_Buffer);
     }
@@ -210,6 +234,20 @@ public:
         ++m_CommandCount;
     }
 
+    /// Copies all commands of the other queue to the end of this one
+    void Append(const RenderCommandQueue &other) {
+        size_t bytes = other.m_NextFree - other.m_Buffer;
+        while (m_FreeSpace < bytes)
+            Expand(m_Capacity * 2);
+
+        std::memcpy(m_NextFree, other.m_Buffer, bytes);
+        m_NextFree += bytes;
+        m_FreeSpace -= bytes;
+        m_CommandCount += other.m_CommandCount;
+    }
+
+    auto Empty() const -> bool { return m_CommandCount == 0; }
+
     void Clear() {
         m_NextFree = m_Buffer;
         m_FreeSpace = m_Capacity;
@@ -1,8 +1,108 @@
 #include <Platform/Vulkan/RendererVk.h>
 #include <Engine/Model.h>
 #include <Engine/ImGui/ImGuiLayer.h>
+#include <Engine/Application.h>
 #include "Renderer.h"
 #include "RenderCommand.h"
+#include "FramePipeline.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+
+/**
+ * Coarsest LOD whose object space error projects to at most the pixel threshold. The distance is
+ * measured to the closest point of the bounding sphere, so the estimate never undershoots. With
+ * hysteresis a coarser level has to be comfortably under the threshold before it replaces the
+ * current one, while a finer level is picked as soon as the current one gets too coarse.
+ */
+static auto SelectLod(const MeshRenderer &meshInstance, const PerspectiveCamera &camera, float pixelsPerRadian,
+                      float threshold, float hysteresis) -> uint32_t {
+    const Mesh *mesh = meshInstance.GetMesh();
+    auto lods = mesh->Lods();
+    const glm::mat4 &model = Entity::ModelMatrix(meshInstance.ParentEntityID());
+    float scale = std::sqrt(std::max({glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                      glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                                      glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))}));
+
+    const MeshBounds &bounds = mesh->Bounds();
+    glm::vec3 center = model * glm::vec4(bounds.center, 1.0f);
+    float distance = glm::length(center - camera.GetPosition()) - bounds.radius * scale;
+    if (distance <= 0.0f)
+        return 0;
+
+    // Worst case, the error is perpendicular to the view direction
+    float pixelsPerUnit = scale * pixelsPerRadian / distance;
+    auto coarsest = static_cast<uint32_t>(lods.size() - 1);
+    uint32_t current = std::min(meshInstance.SelectedLod(), coarsest);
+    uint32_t level = 0;
+    for (uint32_t i = coarsest; i > 0; i--) {
+        if (lods[i].error * pixelsPerUnit <= threshold) {
+            level = i;
+            break;
+        }
+    }
+    while (level > current && lods[level].error * pixelsPerUnit > threshold * (1.0f - hysteresis))
+        level--;
+    return level;
+}
+
+
+/// Copies what the render stage needs to bind the mesh, the MeshRenderer may change once the packet is published
+static auto MeshBinding(const MeshRenderer &meshInstance, const BufferAllocation &allocation) -> BindMeshPayload {
+    const Mesh *mesh = meshInstance.GetMesh();
+    const PositionQuantization &quantization = mesh->Quantization();
+    BindMeshPayload payload{};
+    payload.buffer = allocation.handle;
+    payload.vertexOffset = allocation.offset;
+    payload.indexOffset = allocation.offset + mesh->VertexData().size();
+    payload.indexSize = mesh->Indices().empty() ? 0 : mesh->IndexSize();
+    payload.materialInstanceID = meshInstance.GetMaterialInstance().InstanceID();
+    payload.vertexFormat = static_cast<uint32_t>(mesh->Format());
+    std::copy(std::begin(quantization.offset), std::end(quantization.offset), payload.positionOffset);
+    std::copy(std::begin(quantization.scale), std::end(quantization.scale), payload.positionScale);
+    return payload;
+}
+
+
+void Renderer::BeginFrame(FramePacket &packet) {
+    t_BuildPacket = &packet;
+
+    std::lock_guard<std::mutex> lock(s_Renderer->m_CmdQueueMutex);
+    if (!s_Renderer->m_CmdQueue.Empty()) {
+        packet.commands.Append(s_Renderer->m_CmdQueue);
+        s_Renderer->m_CmdQueue.Clear();
+    }
+}
+
+
+void Renderer::NewFrame() {
+    if (s_Renderer->m_ImGuiLayer)
+        s_Renderer->m_ImGuiLayer->NewFrame();
+}
+
+
+void Renderer::EndFrame() {
+    FramePacket &packet = *t_BuildPacket;
+    if (s_Renderer->m_ImGuiLayer) {
+        s_Renderer->m_ImGuiLayer->EndFrame();
+        packet.uiDrawData.Capture(ImGui::GetDrawData());
+    }
+
+    if (const auto &camera = s_Renderer->m_Scene.m_Camera) {
+        packet.camera.projection = camera->GetProjection();
+        packet.camera.view = camera->GetView();
+        packet.camera.position = camera->GetPosition();
+    }
+
+    packet.skybox = s_Skybox;
+    packet.skyboxTexIdx = s_SkyboxTexIdx;
+    packet.skyboxEnabled = s_SkyboxEnabled;
+    packet.skyboxLOD = s_SkyboxLOD;
+    packet.exposure = s_Exposure;
+    t_BuildPacket = nullptr;
+}
 
 
 void Renderer::BeginScene(const std::shared_ptr<PerspectiveCamera> &camera) {
@@ -18,10 +118,16 @@ void Renderer::BeginScene(const std::shared_ptr<PerspectiveCamera> &camera) {
 
 void Renderer::EndScene() {
     Scene &scene(s_Renderer->m_Scene);
-    Renderer::s_SceneCamera = scene.m_Camera;
     /// TODO: batching based on materials, etc...
     DrawPayload drawPayload{};
     DrawIndexedPayload drawIndexedPayload{};
+    LodStats lodStats;
+
+    // Pixels covered by one radian at the center of the viewport
+    float pixelsPerRadian = 0.0f;
+    if (scene.m_Camera)
+        pixelsPerRadian = 0.5f * static_cast<float>(s_ViewportHeight) * scene.m_Camera->GetProjection()[1][1];
+    bool selectLods = s_LodSelectionEnabled && pixelsPerRadian > 0.0f;
 
 
 //    if (scene.m_SkyboxMesh) {
@@ -38,15 +144,20 @@ void Renderer::EndScene() {
 //    }
 
     for (const auto&[material, batch] : scene.m_MaterialBatches) {
-        s_Renderer->m_CmdQueue.AddCommand(RenderCommand::BindMaterial(material));
+        SubmitCommand(RenderCommand::BindMaterial({&material->GetPipeline(), material->GetMaterialID()}));
 
         for (const MeshRenderer *meshInstance : batch) {
             const auto *mesh = meshInstance->GetMesh();
+            // Meshes whose staged data wasn't flushed yet have nothing to bind
+            BufferAllocation allocation = s_Renderer->impl_GetMeshAllocation(mesh);
+            if (!allocation.handle)
+                continue;
+
             uint32_t entityID = meshInstance->ParentEntityID();
             //            auto materialObjIdx = mesh->GetMaterialObjectIdx();
 //            auto meshID = meshInstance->GetMaterialInstance().InstanceID();
-            s_Renderer->m_CmdQueue.AddCommand(RenderCommand::BindMeshInstance(meshInstance));
-            s_Renderer->m_CmdQueue.AddCommand(RenderCommand::SetDynamicOffset(0, 0, entityID));
+            SubmitCommand(RenderCommand::BindMesh(MeshBinding(*meshInstance, allocation)));
+            SubmitCommand(RenderCommand::SetDynamicOffset(0, 0, entityID));
 //          for (const DynamicOffset &offset : model->GetDynamicOffsets()) {
 //              s_Renderer->m_CmdQueue.AddCommand(RenderCommand::SetDynamicOffset(offset.set, offset.offset));
 //          }
@@ -56,17 +167,31 @@ void Renderer::EndScene() {
                 drawPayload.firstVertex = 0;
                 drawPayload.firstInstance = 0;
                 drawPayload.instanceCount = 1;
-                s_Renderer->m_CmdQueue.AddCommand(RenderCommand::Draw(drawPayload));
+                SubmitCommand(RenderCommand::Draw(drawPayload));
             } else {
-                drawIndexedPayload.indexCount = mesh->Indices().size();
-                drawIndexedPayload.firstIndex = 0;
+                uint32_t level = 0;
+                if (selectLods && mesh->LodCount() > 1) {
+                    level = SelectLod(*meshInstance, *scene.m_Camera, pixelsPerRadian, s_LodPixelThreshold,
+                                      s_LodHysteresis);
+                }
+                meshInstance->SetSelectedLod(level);
+
+                MeshLod lod = mesh->Lod(level);
+                lodStats.draws++;
+                lodStats.drawsPerLod[level]++;
+                lodStats.triangles += lod.indexCount / 3;
+                lodStats.fullDetailTriangles += mesh->Lod(0).indexCount / 3;
+
+                drawIndexedPayload.indexCount = lod.indexCount;
+                drawIndexedPayload.firstIndex = lod.firstIndex;
                 drawIndexedPayload.vertexOffset = 0;
                 drawIndexedPayload.firstInstance = 0;
                 drawIndexedPayload.instanceCount = 1;
-                s_Renderer->m_CmdQueue.AddCommand(RenderCommand::DrawIndexed(drawIndexedPayload));
+                SubmitCommand(RenderCommand::DrawIndexed(drawIndexedPayload));
             }
         }
     }
+    s_LodStats = lodStats;
 }
 
 
@@ -87,9 +212,26 @@ void Renderer::SubmitSkybox(const MeshRenderer *meshInstance) {
 
 
 void Renderer::SubmitCommand(const RenderCommand &cmd) {
+    if (t_BuildPacket) {
+        t_BuildPacket->commands.AddCommand(cmd);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_Renderer->m_CmdQueueMutex);
     s_Renderer->m_CmdQueue.AddCommand(cmd);
 }
 
+
+void Renderer::OnWindowResize(WindowResizeEvent &e) {
+    s_ViewportHeight = e.Height();
+    // The swapchain belongs to the render stage, it is recreated before the packet's image is acquired
+    if (t_BuildPacket) {
+        t_BuildPacket->resize = std::make_pair(e.Width(), e.Height());
+        return;
+    }
+    s_Renderer->impl_OnWindowResize(e);
+}
+
 void Renderer::SetImGuiLayer(Layer *layer) {
     if (auto *imgui = dynamic_cast<ImGuiLayer *>(layer)) {
         s_Renderer->m_ImGuiLayer = imgui;
@@ -98,13 +240,20 @@ void Renderer::SetImGuiLayer(Layer *layer) {
 
 void Renderer::Init() {
     s_Renderer = std::make_unique<RendererVk>();
+    s_ViewportHeight = Application::GetWindow().Height();
 }
 
 
 std::unique_ptr<Renderer> Renderer::s_Renderer;
+thread_local FramePacket *Renderer::t_BuildPacket = nullptr;
 
 const TextureCubemap* Renderer::s_Skybox = nullptr;
-std::shared_ptr<PerspectiveCamera> Renderer::s_SceneCamera;
+uint32_t Renderer::s_SkyboxTexIdx = 0;
 float Renderer::s_Exposure = 1.0f;
 float Renderer::s_SkyboxLOD = 0.0f;
-bool Renderer::s_SkyboxEnabled = true;
\ No newline at end of file
+bool Renderer::s_SkyboxEnabled = true;
+float Renderer::s_LodPixelThreshold = 1.0f;
+float Renderer::s_LodHysteresis = 0.25f;
+bool Renderer::s_LodSelectionEnabled = true;
+uint32_t Renderer::s_ViewportHeight = 0;
+LodStats Renderer::s_LodStats;
\ No newline at end of file
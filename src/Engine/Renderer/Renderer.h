@@ -1,10 +1,13 @@
 #ifndef GAME_ENGINE_RENDERER_H
 #define GAME_ENGINE_RENDERER_H
 
+#include <array>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <Engine/Events/WindowEvents.h>
 #include <unordered_map>
+#include "MeshCache.h"
 #include "RendererAPI.h"
 #include "RenderCommand.h"
 #include "Texture.h"
@@ -22,6 +25,8 @@ class Material;
 
 class PerspectiveCamera;
 
+struct FramePacket;
+
 class Scene {
 public:
     std::vector<const Mesh *> m_Meshes;
@@ -36,6 +41,15 @@ class Layer;
 
 class ImGuiLayer;
 
+/// Result of the LOD selection in the last EndScene
+struct LodStats {
+    uint64_t draws = 0;
+    uint64_t triangles = 0;
+    /// What the same draws would have cost at LOD 0
+    uint64_t fullDetailTriangles = 0;
+    std::array<uint32_t, MeshCache::MAX_LODS> drawsPerLod{};
+};
+
 struct BufferAllocation {
     void *memory;
     void *handle;
@@ -48,21 +62,34 @@ class Renderer {
 protected:
     static std::unique_ptr<Renderer> s_Renderer;
 
-    static std::shared_ptr<PerspectiveCamera> s_SceneCamera;
+    /// Packet filled by the calling thread, commands and uniform writes end up in it
+    static thread_local FramePacket *t_BuildPacket;
+
     static const TextureCubemap* s_Skybox;
+    /// Slot of the skybox in the skybox pipeline's sampler binding
+    static uint32_t s_SkyboxTexIdx;
     static float s_SkyboxLOD;
     static bool s_SkyboxEnabled;
     static float s_Exposure;
 
+    /// Largest projected error of a selected LOD, in pixels of the viewport height
+    static float s_LodPixelThreshold;
+    /// A coarser LOD is only picked once its error drops this fraction below the threshold, stops popping at the boundary
+    static float s_LodHysteresis;
+    static bool s_LodSelectionEnabled;
+    static uint32_t s_ViewportHeight;
+    static LodStats s_LodStats;
+
     Scene m_Scene;
     RenderCommandQueue m_TransferQueue;
+    /// Commands submitted outside of a frame (setup, other threads), moved into the next packet
     RenderCommandQueue m_CmdQueue;
+    std::mutex m_CmdQueueMutex;
 
     ImGuiLayer *m_ImGuiLayer{};
 
-    virtual void impl_NextFrame() = 0;
-
-    virtual void impl_PresentFrame() = 0;
+    /// Acquires an image, records the packet and presents it
+    virtual void impl_RenderFrame(FramePacket &packet) = 0;
 
     virtual void impl_OnWindowResize(WindowResizeEvent &e) = 0;
 
@@ -72,12 +99,16 @@ protected:
 
     virtual auto impl_GetImageIndex() const -> size_t = 0;
 
-    virtual void impl_SetSkybox(const TextureCubemap* skybox) = 0;
+    /// Returns the skybox's texture slot, the descriptor write goes through the build packet when there is one
+    virtual auto impl_SetSkybox(const TextureCubemap* skybox) -> uint32_t = 0;
 
 //    virtual void impl_StageData(void* dstBufferHandle, uint64_t* dstOffsetHandle, const void *data, uint64_t bytes) = 0;
 
     virtual void impl_StageMesh(Mesh *mesh) = 0;
 
+    /// Where the mesh ended up on the device, a null handle until its staged data was flushed
+    virtual auto impl_GetMeshAllocation(const Mesh *mesh) const -> BufferAllocation = 0;
+
     virtual BufferAllocation impl_AllocateUniformBuffer(uint64_t size) = 0;
 
     virtual void impl_FlushStagedData() = 0;
@@ -91,14 +122,19 @@ public:
 
     static void Destroy() { s_Renderer.reset(); }
 
-    static void NewFrame() {
-        s_Renderer->impl_NextFrame();
-    }
+    /// Starts building a frame on the calling thread, everything submitted until EndFrame() goes into the packet
+    static void BeginFrame(FramePacket &packet);
 
-    static void PresentFrame() {
-        s_Renderer->impl_PresentFrame();
-        s_Renderer->m_CmdQueue.Clear();
-    }
+    /// Starts the UI frame, called after window events were processed
+    static void NewFrame();
+
+    /// Snapshots the camera, UI and render settings into the packet, it must not be modified afterwards
+    static void EndFrame();
+
+    /// Render stage, may run on a different thread than the one which built the packet
+    static void RenderFrame(FramePacket &packet) { s_Renderer->impl_RenderFrame(packet); }
+
+    static auto BuildPacket() -> FramePacket * { return t_BuildPacket; }
 
     static void BeginScene(const std::shared_ptr<PerspectiveCamera> &camera);
 
@@ -112,11 +148,26 @@ public:
 
     static void SetSkybox(const TextureCubemap* skybox) {
         s_Skybox = skybox;
-        s_Renderer->impl_SetSkybox(skybox);
+        s_SkyboxTexIdx = s_Renderer->impl_SetSkybox(skybox);
     }
 
     static void SetSkyboxLOD(float value) { s_SkyboxLOD = value; }
 
+    static void SetLodPixelThreshold(float pixels) { s_LodPixelThreshold = pixels; }
+
+    static auto GetLodPixelThreshold() -> float { return s_LodPixelThreshold; }
+
+    static void SetLodHysteresis(float fraction) { s_LodHysteresis = fraction; }
+
+    static auto GetLodHysteresis() -> float { return s_LodHysteresis; }
+
+    /// Disabled selection always draws LOD 0
+    static void SetLodSelectionEnabled(bool enabled) { s_LodSelectionEnabled = enabled; }
+
+    static auto IsLodSelectionEnabled() -> bool { return s_LodSelectionEnabled; }
+
+    static auto GetLodStats() -> const LodStats & { return s_LodStats; }
+
     static void EnableSkybox() { s_SkyboxEnabled = true; }
 
     static void DisableSkybox() { s_SkyboxEnabled = false; }
@@ -137,7 +188,7 @@ public:
 
     static void SubmitCommand(const RenderCommand &cmd);
 
-    static void OnWindowResize(WindowResizeEvent &e) { s_Renderer->impl_OnWindowResize(e); }
+    static void OnWindowResize(WindowResizeEvent &e);
 
     static auto GetRenderPass() -> const RenderPass & { return s_Renderer->impl_GetRenderPass(); }
 
@@ -0,0 +1,342 @@
+#include "SceneCache.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+
+namespace {
+    constexpr uint32_t MAX_LAYOUT_ATTRIBUTES = 8;
+
+    struct MaterialRecord {
+        uint32_t nameOffset;
+        uint32_t nameSize;
+        uint32_t firstTexture;
+        uint32_t textureCount;
+    };
+
+    struct TextureRecord {
+        uint32_t type;
+        uint32_t nameOffset;
+        uint32_t nameSize;
+        uint32_t reserved;
+    };
+
+    struct MeshRecord {
+        uint32_t materialIdx;
+        uint32_t vertexSize;
+        uint32_t layoutCount;
+        uint32_t meshletCount;
+        uint8_t layout[MAX_LAYOUT_ATTRIBUTES];
+        uint32_t firstLod;
+        uint32_t lodCount;
+        uint64_t vertexCount;
+        uint64_t vertexOffset;
+        uint64_t indexCount;
+        uint64_t indexOffset;
+        uint32_t meshletVertexCount;
+        uint32_t meshletTriangleSize;
+        uint64_t meshletOffset;
+        uint64_t meshletVertexOffset;
+        uint64_t meshletTriangleOffset;
+        uint32_t vertexFormat;
+        float positionOffset[3];
+        float positionScale[3];
+        uint16_t vertexEncoding;
+        uint16_t indexEncoding;
+        uint64_t vertexSectionSize;
+        uint64_t indexSectionSize;
+    };
+
+    static_assert(sizeof(MeshRecord) == 144, "Scene cache mesh record layout changed, bump the version");
+
+    auto AlignUp(uint64_t value, uint64_t alignment) -> uint64_t {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    /// Range of count elements at offset lies within the file, without overflowing on corrupted counts
+    auto InBounds(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) -> bool {
+        if (offset > fileSize)
+            return false;
+        return elementSize == 0 || count <= (fileSize - offset) / elementSize;
+    }
+
+    template<typename T>
+    auto ReadRecord(const uint8_t *base, uint64_t offset, size_t idx) -> T {
+        T record{};
+        std::memcpy(&record, base + offset + idx * sizeof(T), sizeof(T));
+        return record;
+    }
+
+    class StringTable {
+        std::string m_Data;
+
+    public:
+        auto Add(const std::string &string) -> uint32_t {
+            auto offset = static_cast<uint32_t>(m_Data.size());
+            m_Data += string;
+            return offset;
+        }
+
+        auto Data() const -> const std::string & { return m_Data; }
+    };
+}
+
+
+namespace SceneCache {
+
+    auto PathFor(const std::string &sourcePath) -> std::string {
+        return sourcePath + ".scenecache";
+    }
+
+
+    auto Open(const std::string &cachePath, const std::string &sourcePath, uint32_t postProcessFlags)
+    -> std::optional<SceneCacheContents> {
+        auto file = MappedFile::Open(cachePath);
+        if (!file || file->Size() < sizeof(SceneCacheHeader))
+            return std::nullopt;
+
+        const uint8_t *base = file->Data();
+        uint64_t fileSize = file->Size();
+        SceneCacheHeader header{};
+        std::memcpy(&header, base, sizeof(header));
+        if (header.magic != SceneCacheHeader::MAGIC || header.endianness != SceneCacheHeader::ENDIANNESS ||
+            header.version != SceneCacheHeader::VERSION || header.headerSize != sizeof(SceneCacheHeader) ||
+            header.postProcessFlags != postProcessFlags || header.fileSize != fileSize)
+            return std::nullopt;
+        if (!InBounds(header.materialOffset, header.materialCount, sizeof(MaterialRecord), fileSize) ||
+            !InBounds(header.textureOffset, header.textureCount, sizeof(TextureRecord), fileSize) ||
+            !InBounds(header.meshOffset, header.meshCount, sizeof(MeshRecord), fileSize) ||
+            !InBounds(header.lodOffset, header.lodCount, sizeof(MeshLod), fileSize) ||
+            !InBounds(header.stringOffset, header.stringSize, 1, fileSize))
+            return std::nullopt;
+        // The LOD table is used in place, unlike the records which are copied out
+        if (header.lodOffset % alignof(MeshLod))
+            return std::nullopt;
+
+        if (!MeshCache::IsSourceCurrent(sourcePath, header.sourceSize, header.sourceModified, header.sourceHash))
+            return std::nullopt;
+
+        const char *strings = reinterpret_cast<const char *>(base + header.stringOffset);
+        auto readString = [&](uint32_t offset, uint32_t size) -> std::optional<std::string> {
+            if (offset > header.stringSize || size > header.stringSize - offset)
+                return std::nullopt;
+            return std::string(strings + offset, size);
+        };
+
+        SceneCacheContents contents;
+        contents.materials.resize(header.materialCount);
+        for (uint32_t i = 0; i < header.materialCount; i++) {
+            auto record = ReadRecord<MaterialRecord>(base, header.materialOffset, i);
+            auto name = readString(record.nameOffset, record.nameSize);
+            if (!name || record.firstTexture > header.textureCount ||
+                record.textureCount > header.textureCount - record.firstTexture)
+                return std::nullopt;
+
+            SceneCacheMaterial &material = contents.materials[i];
+            material.name = std::move(*name);
+            for (uint32_t t = record.firstTexture; t < record.firstTexture + record.textureCount; t++) {
+                auto texture = ReadRecord<TextureRecord>(base, header.textureOffset, t);
+                auto textureName = readString(texture.nameOffset, texture.nameSize);
+                if (!textureName)
+                    return std::nullopt;
+                material.textures.push_back({texture.type, std::move(*textureName)});
+            }
+        }
+
+        contents.meshes.resize(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            auto record = ReadRecord<MeshRecord>(base, header.meshOffset, i);
+            if (record.materialIdx >= header.materialCount || record.layoutCount > MAX_LAYOUT_ATTRIBUTES ||
+                record.vertexOffset % MeshCache::SECTION_ALIGNMENT || record.indexOffset % MeshCache::SECTION_ALIGNMENT ||
+                !InBounds(record.vertexOffset, record.vertexSectionSize, 1, fileSize) ||
+                !InBounds(record.indexOffset, record.indexSectionSize, 1, fileSize) ||
+                record.firstLod > header.lodCount || record.lodCount > header.lodCount - record.firstLod ||
+                record.meshletOffset % MeshCache::SECTION_ALIGNMENT ||
+                record.meshletVertexOffset % MeshCache::SECTION_ALIGNMENT ||
+                !InBounds(record.meshletOffset, record.meshletCount, sizeof(Meshlet), fileSize) ||
+                !InBounds(record.meshletVertexOffset, record.meshletVertexCount, sizeof(uint32_t), fileSize) ||
+                !InBounds(record.meshletTriangleOffset, record.meshletTriangleSize, 1, fileSize) ||
+                record.vertexFormat > static_cast<uint32_t>(VertexFormat::COMPACT) ||
+                (record.vertexFormat == static_cast<uint32_t>(VertexFormat::COMPACT) &&
+                 record.vertexSize != sizeof(CompactVertex)))
+                return std::nullopt;
+
+            ArrayView<const MeshLod> lods(reinterpret_cast<const MeshLod *>(base + header.lodOffset) + record.firstLod,
+                                          record.lodCount);
+            MeshletView meshlets;
+            meshlets.meshlets = {reinterpret_cast<const Meshlet *>(base + record.meshletOffset), record.meshletCount};
+            meshlets.vertices = {reinterpret_cast<const uint32_t *>(base + record.meshletVertexOffset),
+                                 record.meshletVertexCount};
+            meshlets.triangles = {base + record.meshletTriangleOffset, record.meshletTriangleSize};
+            if (!MeshCache::AreLodsValid(lods, record.indexCount) || !MeshCache::AreMeshletsValid(meshlets))
+                return std::nullopt;
+
+            SceneCacheMeshView &mesh = contents.meshes[i];
+            mesh.materialIdx = record.materialIdx;
+            mesh.data.file = file;
+            mesh.data.layout = {base + header.meshOffset + i * sizeof(MeshRecord) + offsetof(MeshRecord, layout),
+                                record.layoutCount};
+            mesh.data.vertexSize = record.vertexSize;
+            mesh.data.vertexCount = record.vertexCount;
+            mesh.data.format = static_cast<VertexFormat>(record.vertexFormat);
+            std::memcpy(mesh.data.quantization.offset, record.positionOffset, sizeof(record.positionOffset));
+            std::memcpy(mesh.data.quantization.scale, record.positionScale, sizeof(record.positionScale));
+            mesh.data.lods = lods;
+            mesh.data.meshlets = meshlets;
+            if (!MeshCache::ReadSections(static_cast<SectionEncoding>(record.vertexEncoding),
+                                         {base + record.vertexOffset, record.vertexSectionSize},
+                                         static_cast<SectionEncoding>(record.indexEncoding),
+                                         {base + record.indexOffset, record.indexSectionSize}, record.indexCount,
+                                         mesh.data))
+                return std::nullopt;
+        }
+        return contents;
+    }
+
+
+    auto Write(const std::string &cachePath, const std::string &sourcePath, uint32_t postProcessFlags,
+               const std::vector<SceneCacheMaterial> &materials, const std::vector<SceneCacheMesh> &meshes) -> bool {
+        auto stamp = FileStamp::Of(sourcePath);
+        auto sourceHash = MeshCache::HashSource(sourcePath);
+        if (!stamp || !sourceHash)
+            return false;
+
+        StringTable strings;
+        std::vector<MaterialRecord> materialRecords;
+        std::vector<TextureRecord> textureRecords;
+        for (const auto &material : materials) {
+            MaterialRecord record{};
+            record.nameOffset = strings.Add(material.name);
+            record.nameSize = static_cast<uint32_t>(material.name.size());
+            record.firstTexture = static_cast<uint32_t>(textureRecords.size());
+            record.textureCount = static_cast<uint32_t>(material.textures.size());
+            for (const auto &texture : material.textures) {
+                TextureRecord textureRecord{};
+                textureRecord.type = texture.type;
+                textureRecord.nameOffset = strings.Add(texture.name);
+                textureRecord.nameSize = static_cast<uint32_t>(texture.name.size());
+                textureRecords.push_back(textureRecord);
+            }
+            materialRecords.push_back(record);
+        }
+
+        SceneCacheHeader header{};
+        header.magic = SceneCacheHeader::MAGIC;
+        header.version = SceneCacheHeader::VERSION;
+        header.endianness = SceneCacheHeader::ENDIANNESS;
+        header.headerSize = sizeof(SceneCacheHeader);
+        header.postProcessFlags = postProcessFlags;
+        header.sourceHash = *sourceHash;
+        header.sourceSize = stamp->size;
+        header.sourceModified = stamp->modified;
+        header.materialCount = static_cast<uint32_t>(materialRecords.size());
+        header.textureCount = static_cast<uint32_t>(textureRecords.size());
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+        size_t lodCount = 0;
+        for (const auto &mesh : meshes)
+            lodCount += mesh.data.lods.size();
+        header.lodCount = static_cast<uint32_t>(lodCount);
+        header.stringSize = static_cast<uint32_t>(strings.Data().size());
+        header.materialOffset = sizeof(SceneCacheHeader);
+        header.textureOffset = header.materialOffset + materialRecords.size() * sizeof(MaterialRecord);
+        header.meshOffset = header.textureOffset + textureRecords.size() * sizeof(TextureRecord);
+        header.lodOffset = header.meshOffset + meshes.size() * sizeof(MeshRecord);
+        header.stringOffset = header.lodOffset + lodCount * sizeof(MeshLod);
+
+        uint64_t offset = header.stringOffset + header.stringSize;
+        std::vector<MeshRecord> meshRecords;
+        std::vector<MeshLod> lods;
+        std::vector<std::vector<uint8_t>> encodedVertices(meshes.size()), encodedIndices(meshes.size());
+        std::vector<ArrayView<const uint8_t>> vertexSections, indexSections;
+        for (const auto &mesh : meshes) {
+            const MeshCacheData &data = mesh.data;
+            if (data.layout.size() > MAX_LAYOUT_ATTRIBUTES || data.vertexSize == 0 ||
+                data.vertexSize % sizeof(uint32_t) || data.vertices.size() != data.vertexCount * data.vertexSize ||
+                !MeshCache::AreLodsValid(data.lods, data.indices.size()) || !MeshCache::AreMeshletsValid(data.meshlets) ||
+                !MeshCache::AreIndicesInRange(data.indices, data.vertexCount) ||
+                !MeshCache::AreIndicesInRange(data.meshlets.vertices, data.vertexCount))
+                return false;
+
+            size_t meshIdx = meshRecords.size();
+            auto vertices = vertexSections.emplace_back(MeshCache::VertexSection(data, encodedVertices[meshIdx]));
+            auto indices = indexSections.emplace_back(MeshCache::IndexSection(data, encodedIndices[meshIdx]));
+
+            MeshRecord record{};
+            record.materialIdx = mesh.materialIdx;
+            record.vertexSize = data.vertexSize;
+            record.layoutCount = static_cast<uint32_t>(data.layout.size());
+            std::memcpy(record.layout, data.layout.data(), data.layout.size());
+            record.firstLod = static_cast<uint32_t>(lods.size());
+            record.lodCount = static_cast<uint32_t>(data.lods.size());
+            lods.insert(lods.end(), data.lods.begin(), data.lods.end());
+            record.vertexCount = data.vertexCount;
+            record.vertexFormat = static_cast<uint32_t>(data.format);
+            std::memcpy(record.positionOffset, data.quantization.offset, sizeof(record.positionOffset));
+            std::memcpy(record.positionScale, data.quantization.scale, sizeof(record.positionScale));
+            record.vertexOffset = AlignUp(offset, MeshCache::SECTION_ALIGNMENT);
+            record.vertexEncoding = static_cast<uint16_t>(data.vertexEncoding);
+            record.vertexSectionSize = vertices.size();
+            record.indexCount = data.indices.size();
+            record.indexOffset = AlignUp(record.vertexOffset + vertices.size(), MeshCache::SECTION_ALIGNMENT);
+            record.indexEncoding = static_cast<uint16_t>(data.indexEncoding);
+            record.indexSectionSize = indices.size();
+            record.meshletCount = static_cast<uint32_t>(data.meshlets.meshlets.size());
+            record.meshletOffset = AlignUp(record.indexOffset + indices.size(), MeshCache::SECTION_ALIGNMENT);
+            record.meshletVertexCount = static_cast<uint32_t>(data.meshlets.vertices.size());
+            record.meshletVertexOffset = AlignUp(record.meshletOffset + record.meshletCount * sizeof(Meshlet),
+                                                 MeshCache::SECTION_ALIGNMENT);
+            record.meshletTriangleSize = static_cast<uint32_t>(data.meshlets.triangles.size());
+            record.meshletTriangleOffset = record.meshletVertexOffset + record.meshletVertexCount * sizeof(uint32_t);
+            offset = record.meshletTriangleOffset + record.meshletTriangleSize;
+            meshRecords.push_back(record);
+        }
+        header.fileSize = offset;
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+
+            static const char s_Zeros[MeshCache::SECTION_ALIGNMENT]{};
+            uint64_t written = 0;
+            auto write = [&](const void *data, uint64_t size) {
+                file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+                written += size;
+            };
+            auto padTo = [&](uint64_t target) { write(s_Zeros, target - written); };
+
+            write(&header, sizeof(header));
+            write(materialRecords.data(), materialRecords.size() * sizeof(MaterialRecord));
+            write(textureRecords.data(), textureRecords.size() * sizeof(TextureRecord));
+            write(meshRecords.data(), meshRecords.size() * sizeof(MeshRecord));
+            write(lods.data(), lods.size() * sizeof(MeshLod));
+            write(strings.Data().data(), strings.Data().size());
+            for (size_t i = 0; i < meshes.size(); i++) {
+                padTo(meshRecords[i].vertexOffset);
+                write(vertexSections[i].data(), vertexSections[i].size());
+                padTo(meshRecords[i].indexOffset);
+                write(indexSections[i].data(), indexSections[i].size());
+                const MeshletView &meshlets = meshes[i].data.meshlets;
+                padTo(meshRecords[i].meshletOffset);
+                write(meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(Meshlet));
+                padTo(meshRecords[i].meshletVertexOffset);
+                write(meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+                write(meshlets.triangles.data(), meshlets.triangles.size());
+            }
+            if (!file) {
+                file.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        // Windows doesn't replace an existing file on rename
+        std::remove(cachePath.c_str());
+#endif
+        return std::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef GAME_ENGINE_SCENE_CACHE_H
+#define GAME_ENGINE_SCENE_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "MeshCache.h"
+
+
+struct SceneCacheTexture {
+    /// Texture2D::Type, the cache itself doesn't depend on the renderer
+    uint32_t type = 0;
+    /// As referenced by the source material, unresolved
+    std::string name;
+};
+
+
+struct SceneCacheMaterial {
+    std::string name;
+    std::vector<SceneCacheTexture> textures;
+};
+
+
+struct SceneCacheMesh {
+    uint32_t materialIdx = 0;
+    MeshCacheData data;
+};
+
+
+struct SceneCacheMeshView {
+    uint32_t materialIdx = 0;
+    MeshCacheView data;
+};
+
+
+/// Materials are parsed into owned strings, mesh data stays in the mapping shared by every mesh unless it was encoded
+struct SceneCacheContents {
+    std::vector<SceneCacheMaterial> materials;
+    std::vector<SceneCacheMeshView> meshes;
+};
+
+
+/**
+ * Imported scene as it comes out of the importer's post-processing, keyed by the source contents
+ * and the post-process flags. Layout: header, material / texture / mesh / LOD record tables, a
+ * string table and then every mesh's vertex, index and meshlet sections aligned like in the mesh cache.
+ */
+struct SceneCacheHeader {
+    static constexpr uint32_t MAGIC = 0x43535056u; // "VPSC"
+    /// 2: meshes are stored vertex cache optimized, 3: LOD table, 4: meshlet sections, 5: vertex formats,
+    /// 6: encoded vertex and index sections, 7: raw or encoded per section
+    static constexpr uint16_t VERSION = 7;
+    static constexpr uint16_t ENDIANNESS = MeshCacheHeader::ENDIANNESS;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t endianness;
+    uint32_t headerSize;
+    uint32_t postProcessFlags;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t sourceModified;
+    uint64_t fileSize;
+    uint32_t materialCount;
+    uint32_t textureCount;
+    uint32_t meshCount;
+    uint32_t stringSize;
+    uint64_t materialOffset;
+    uint64_t textureOffset;
+    uint64_t meshOffset;
+    uint64_t stringOffset;
+    uint64_t lodOffset;
+    uint32_t lodCount;
+    uint8_t reserved[20];
+};
+
+static_assert(sizeof(SceneCacheHeader) == 128, "Scene cache header layout changed, bump the version");
+
+
+namespace SceneCache {
+    auto PathFor(const std::string &sourcePath) -> std::string;
+
+    /// Nullopt when the cache is missing, malformed, stale or built with other post-process flags
+    auto Open(const std::string &cachePath, const std::string &sourcePath, uint32_t postProcessFlags)
+    -> std::optional<SceneCacheContents>;
+
+    auto Write(const std::string &cachePath, const std::string &sourcePath, uint32_t postProcessFlags,
+               const std::vector<SceneCacheMaterial> &materials, const std::vector<SceneCacheMesh> &meshes) -> bool;
+}
+
+
+#endif //GAME_ENGINE_SCENE_CACHE_H
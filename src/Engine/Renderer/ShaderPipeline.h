@@ -159,7 +159,11 @@ class TextureCubemap;
 
 class Material;
 
+struct FramePacket;
+
 class ShaderPipeline {
+    friend struct FramePacket;
+
 protected:
     std::string m_Name;
 
@@ -174,6 +178,9 @@ protected:
 
     explicit ShaderPipeline(std::string name) : m_Name(std::move(name)) {};
 
+    /// Writes the whole sampler array of the binding into the descriptor sets of every swapchain image
+    virtual void impl_WriteSamplers(BindingKey bindingKey, const std::vector<VkImageView> &views) const = 0;
+
 public:
     virtual ~ShaderPipeline() = default;
 
@@ -217,11 +224,14 @@ public:
 
 //    virtual void Bind(VkCommandBuffer cmdBuffer, uint32_t imageIndex) = 0;
 
+    /// With a packet the descriptor write is deferred until the render stage records that frame
     virtual auto BindTextures2D(const std::vector<const Texture2D *> &textures,
-                                BindingKey bindingKey) -> std::vector<uint32_t> = 0;
+                                BindingKey bindingKey,
+                                FramePacket *packet = nullptr) -> std::vector<uint32_t> = 0;
 
     virtual auto BindCubemaps(const std::vector<const TextureCubemap *> &cubemaps,
-                              BindingKey bindingKey) -> std::vector<uint32_t> = 0;
+                              BindingKey bindingKey,
+                              FramePacket *packet = nullptr) -> std::vector<uint32_t> = 0;
 
     virtual void BindUniformBuffer(const UniformBuffer *buffer, BindingKey bindingKey) = 0;
 
@@ -3,7 +3,23 @@
 
 #include <stb_image.h>
 #include <cstring>
+#include <future>
+#include <mutex>
 #include "RendererAPI.h"
+#include <Engine/Application.h>
+
+
+/// stbi_set_flip_vertically_on_load is global state, decoding jobs flip their own rows instead
+static void FlipRowsVertically(void *data, uint32_t width, uint32_t height, size_t pixelBytes) {
+    auto *bytes = static_cast<u_char *>(data);
+    size_t rowBytes = width * pixelBytes;
+    std::vector<u_char> row(rowBytes);
+    for (uint32_t top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+        std::memcpy(row.data(), &bytes[top * rowBytes], rowBytes);
+        std::memcpy(&bytes[top * rowBytes], &bytes[bottom * rowBytes], rowBytes);
+        std::memcpy(&bytes[bottom * rowBytes], row.data(), rowBytes);
+    }
+}
 
 
 Texture2D::Texture2D(const u_char *data, uint32_t width, uint32_t height, uint32_t channels, VkFormat format) :
@@ -15,25 +31,68 @@ Texture2D::Texture2D(const u_char *data, uint32_t width, uint32_t height, uint32
 }
 
 
+template<typename T>
+using TextureCache = std::unordered_map<std::string, std::shared_future<std::shared_ptr<T>>>;
+
+/**
+ * Runs the load once per key. The entry is registered before loading, concurrent requests for the key
+ * run other tasks until the first load finishes. The loader itself doesn't, a task it picked up could
+ * be waiting for the very texture it's loading. A failed load is forgotten and its error passed on.
+ */
+template<typename T, typename Load>
+static auto LoadOnce(TextureCache<T> &cache, std::mutex &cacheMutex, const std::string &key, const Load &load) -> T * {
+    std::promise<std::shared_ptr<T>> loaded;
+    std::shared_future<std::shared_ptr<T>> pending;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto [it, inserted] = cache.emplace(key, std::shared_future<std::shared_ptr<T>>());
+        if (inserted)
+            it->second = loaded.get_future().share();
+        else
+            pending = it->second;
+    }
+    if (pending.valid()) {
+        Application::Get().m_TaskSystem.WaitExternal([&pending](uint64_t timeoutNs) {
+            return pending.wait_for(std::chrono::nanoseconds(timeoutNs)) == std::future_status::ready;
+        });
+        return pending.get().get();
+    }
+
+    try {
+        TaskSystem::BlockingWaitScope blockingWaits;
+        std::shared_ptr<T> texture = load();
+        loaded.set_value(texture);
+        return texture.get();
+
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            cache.erase(key);
+        }
+        loaded.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+
 auto Texture2D::Create(const char *filepath, VkFormat format, bool flipOnLoad) -> Texture2D * {
-    static std::unordered_map<std::string, std::shared_ptr<Texture2D>> loadedTextures;
-    auto it = loadedTextures.find(filepath);
-    if (it != loadedTextures.end()) {
-        return it->second.get();
-    } else {
+    static TextureCache<Texture2D> loadedTextures;
+    static std::mutex loadedTexturesMutex;
+    // Decoding runs unlocked so that several textures can be loaded from different jobs at once
+    return LoadOnce(loadedTextures, loadedTexturesMutex, filepath, [&]() {
         int width = 0, height = 0, channels = 0;
-
-        stbi_set_flip_vertically_on_load(flipOnLoad);
         auto *tmp = stbi_load(filepath, &width, &height, &channels, STBI_rgb_alpha);
         if (!tmp)
             throw std::runtime_error("failed to load texture image!");
 
-        it = loadedTextures.emplace(filepath, Create(tmp, width, height, 4, format)).first;
-        stbi_image_free(tmp);
+        if (flipOnLoad)
+            FlipRowsVertically(tmp, width, height, STBI_rgb_alpha);
 
-        it->second->Upload();
-        return it->second.get();
-    }
+        auto texture = Create(tmp, width, height, 4, format);
+        stbi_image_free(tmp);
+        texture->Upload();
+        return texture;
+    });
 }
 
 
@@ -135,15 +194,12 @@ TextureCubemap::TextureCubemap(const u_char *data, uint32_t width, uint32_t heig
 
 
 auto TextureCubemap::Create(std::array<const char *, 6> filepaths) -> TextureCubemap * {
-    static std::unordered_map<std::string, std::shared_ptr<TextureCubemap>> loadedTextures;
-    auto it = loadedTextures.find(filepaths[0]);
-    if (it != loadedTextures.end()) {
-        return it->second.get();
-    } else {
+    static TextureCache<TextureCubemap> loadedTextures;
+    static std::mutex loadedTexturesMutex;
+    return LoadOnce(loadedTextures, loadedTexturesMutex, filepaths[0], [&]() {
         int width = 0, height = 0, channels = 0;
 
         std::array<u_char *, 6> faceData{};
-        stbi_set_flip_vertically_on_load(false);
         for (size_t i = 0; i < 6; i++) {
             faceData[i] = stbi_load(filepaths[i], &width, &height, &channels, STBI_rgb_alpha);
             if (!faceData[i]) {
@@ -155,31 +211,30 @@ auto TextureCubemap::Create(std::array<const char *, 6> filepaths) -> TextureCub
             }
         }
 
-        it = loadedTextures.emplace(filepaths[0], Create(faceData, width, height, STBI_rgb_alpha)).first;
+        auto texture = Create(faceData, width, height, STBI_rgb_alpha);
         for (u_char *dataPtr : faceData)
             stbi_image_free(dataPtr);
 
-        it->second->Upload();
-        return it->second.get();
-    }
+        texture->Upload();
+        return texture;
+    });
 }
 
 auto TextureCubemap::CreateFromHDR(const std::string &hdrPath, uint32_t faceResolution) -> TextureCubemap * {
-    static std::unordered_map<std::string, std::shared_ptr<TextureCubemap>> loadedTextures;
-    auto it = loadedTextures.find(hdrPath);
-    if (it != loadedTextures.end()) {
-        return it->second.get();
-    } else {
-        stbi_set_flip_vertically_on_load(true);
+    static TextureCache<TextureCubemap> loadedTextures;
+    static std::mutex loadedTexturesMutex;
+    return LoadOnce(loadedTextures, loadedTexturesMutex, hdrPath, [&]() {
         int width = 0, height = 0, channels = 0;
         float *tmp = stbi_loadf(hdrPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
         if (!tmp)
             throw std::runtime_error("failed to load texture image!");
 
-        it = loadedTextures.emplace(hdrPath, Create(tmp, width, height, STBI_rgb_alpha, faceResolution)).first;
+        FlipRowsVertically(tmp, width, height, STBI_rgb_alpha * sizeof(float));
+
+        auto texture = Create(tmp, width, height, STBI_rgb_alpha, faceResolution);
         stbi_image_free(tmp);
 
-        it->second->HDRtoCubemap();
-        return it->second.get();
-    }
+        texture->HDRtoCubemap();
+        return texture;
+    });
 }
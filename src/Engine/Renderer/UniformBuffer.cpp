@@ -1,6 +1,8 @@
 #include "UniformBuffer.h"
 #include <Platform/Vulkan/UniformBufferVk.h>
 #include "RendererAPI.h"
+#include "Renderer.h"
+#include "FramePipeline.h"
 
 auto UniformBuffer::Create(std::string name, size_t objectSize, size_t objectCount) -> std::unique_ptr<UniformBuffer> {
     switch (RendererAPI::GetSelectedAPI()) {
@@ -12,4 +14,22 @@ auto UniformBuffer::Create(std::string name, size_t objectSize, size_t objectCou
     }
 
     return nullptr;
-}
\ No newline at end of file
+}
+
+
+void UniformBuffer::SetData(const void *objectData, size_t objectCount, uint32_t offset) const {
+    if (FramePacket *packet = Renderer::BuildPacket()) {
+        packet->CaptureUniformData(this, objectData, m_ObjectSize * objectCount, objectCount, offset);
+        return;
+    }
+    impl_SetData(objectData, objectCount, offset);
+}
+
+
+void UniformBuffer::SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const {
+    if (FramePacket *packet = Renderer::BuildPacket()) {
+        packet->CaptureUniformData(this, memberData, memberBytes, 0, memberOffset);
+        return;
+    }
+    impl_SetMemberData(memberData, memberBytes, memberOffset);
+}
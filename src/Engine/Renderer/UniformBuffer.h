@@ -4,7 +4,11 @@
 #include <string>
 #include <memory>
 
+struct FramePacket;
+
 class UniformBuffer {
+    friend struct FramePacket;
+
 protected:
     std::string m_Name;
     uint64_t m_BufferSize = 0;
@@ -13,6 +17,10 @@ protected:
 
     explicit UniformBuffer(std::string name) : m_Name(std::move(name)) {}
 
+    virtual void impl_SetData(const void *objectData, size_t objectCount, uint32_t offset) const = 0;
+
+    virtual void impl_SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const = 0;
+
 public:
     static auto Create(std::string name, size_t objectSize, size_t objectCount) -> std::unique_ptr<UniformBuffer>;
 
@@ -26,9 +34,10 @@ public:
 
 //    virtual auto VkHandle() const -> const void* { return nullptr; }
 
-    virtual void SetData(const void *objectData, size_t objectCount, uint32_t offset) const = 0;
+    /// Writes made while a frame is being built are deferred until the render stage acquired its image
+    void SetData(const void *objectData, size_t objectCount, uint32_t offset) const;
 
-    virtual void SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const = 0;
+    void SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const;
 };
 
 
@@ -0,0 +1,543 @@
+#include "VertexCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define VERTEX_COMPRESSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+    constexpr float UNORM16_MAX = 65535.0f;
+    constexpr float SNORM16_MAX = 32767.0f;
+
+    auto FloatBits(float value) -> uint32_t {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    auto BitsFloat(uint32_t bits) -> float {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    auto ReadFloat(const uint8_t *vertex, size_t offset, size_t component) -> float {
+        float value;
+        std::memcpy(&value, vertex + offset + component * sizeof(float), sizeof(value));
+        return value;
+    }
+
+    void WriteFloats(uint8_t *vertex, size_t offset, const float *values, size_t count) {
+        std::memcpy(vertex + offset, values, count * sizeof(float));
+    }
+
+    /// Round to nearest even, overflow becomes infinity and NaN stays NaN
+    auto FloatToHalf(float value) -> uint16_t {
+        constexpr uint32_t F32_INFINITY = 255u << 23u;
+        constexpr uint32_t F16_MAX = (127u + 16u) << 23u;
+        constexpr uint32_t MIN_NORMAL = (127u - 14u) << 23u;
+        constexpr uint32_t SUBNORMAL_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23u;
+
+        uint32_t bits = FloatBits(value);
+        uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+        uint32_t half;
+        if (bits >= F16_MAX) {
+            half = bits > F32_INFINITY ? 0x7e00u : 0x7c00u;
+        } else if (bits < MIN_NORMAL) {
+            // The addition shifts the mantissa into place and rounds it
+            half = FloatBits(BitsFloat(bits) + BitsFloat(SUBNORMAL_MAGIC)) - SUBNORMAL_MAGIC;
+        } else {
+            uint32_t mantissaOdd = (bits >> 13u) & 1u;
+            bits += ((15u - 127u) << 23u) + 0xfffu + mantissaOdd;
+            half = bits >> 13u;
+        }
+        return static_cast<uint16_t>(half | (sign >> 16u));
+    }
+
+    auto HalfToFloat(uint16_t half) -> float {
+        constexpr uint32_t MAGIC = (254u - 15u) << 23u;
+        uint32_t exponentMantissa = half & 0x7fffu;
+        // Rebiasing by multiplication handles subnormal halves as well
+        uint32_t bits = FloatBits(BitsFloat(exponentMantissa << 13u) * BitsFloat(MAGIC));
+        if (exponentMantissa > 0x7bffu)
+            bits |= 255u << 23u;
+        return BitsFloat(bits | (static_cast<uint32_t>(half & 0x8000u) << 16u));
+    }
+
+    auto QuantizeUnorm(float value, float offset, float inverseScale) -> uint16_t {
+        float scaled = std::min(std::max((value - offset) * inverseScale, 0.0f), UNORM16_MAX);
+        return static_cast<uint16_t>(std::lrint(scaled));
+    }
+
+    auto QuantizeSnorm(float value) -> int16_t {
+        return static_cast<int16_t>(std::lrint(std::min(std::max(value, -1.0f), 1.0f) * SNORM16_MAX));
+    }
+
+    /// Projects the unit vector onto the octahedron and folds the lower half over the upper one
+    void OctahedronEncode(float x, float y, float z, int16_t output[2]) {
+        float sum = std::abs(x) + std::abs(y) + std::abs(z);
+        float inverse = sum > 0.0f ? 1.0f / sum : 0.0f;
+        float u = x * inverse, v = y * inverse;
+        if (z < 0.0f) {
+            float foldedU = 1.0f - std::abs(v), foldedV = 1.0f - std::abs(u);
+            u = u >= 0.0f ? foldedU : -foldedU;
+            v = v >= 0.0f ? foldedV : -foldedV;
+        }
+        output[0] = QuantizeSnorm(u);
+        output[1] = QuantizeSnorm(v);
+    }
+
+    /// Same steps as the shaders' OctahedronDecode
+    void OctahedronDecode(const int16_t input[2], float output[3]) {
+        float x = std::max(input[0] / SNORM16_MAX, -1.0f);
+        float y = std::max(input[1] / SNORM16_MAX, -1.0f);
+        float z = 1.0f - std::abs(x) - std::abs(y);
+        float t = std::max(-z, 0.0f);
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+        float inverseLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+        output[0] = x * inverseLength;
+        output[1] = y * inverseLength;
+        output[2] = z * inverseLength;
+    }
+
+    struct Quantizer {
+        float offset[3];
+        /// Steps per unit, 0 on flat axes
+        float inverseScale[3];
+        /// Units per step
+        float step[3];
+
+        explicit Quantizer(const PositionQuantization &quantization) {
+            for (size_t c = 0; c < 3; c++) {
+                offset[c] = quantization.offset[c];
+                inverseScale[c] = quantization.scale[c] > 0.0f ? UNORM16_MAX / quantization.scale[c] : 0.0f;
+                step[c] = quantization.scale[c] / UNORM16_MAX;
+            }
+        }
+    };
+
+    void EncodeScalar(const uint8_t *vertex, const Quantizer &quantizer, CompactVertex &output) {
+        using namespace VertexCompression;
+        float n[3], t[3], b[3];
+        for (size_t c = 0; c < 3; c++) {
+            output.position[c] = QuantizeUnorm(ReadFloat(vertex, POSITION_OFFSET, c), quantizer.offset[c],
+                                               quantizer.inverseScale[c]);
+            n[c] = ReadFloat(vertex, NORMAL_OFFSET, c);
+            t[c] = ReadFloat(vertex, TANGENT_OFFSET, c);
+            b[c] = ReadFloat(vertex, BITANGENT_OFFSET, c);
+        }
+        float crossX = n[1] * t[2] - n[2] * t[1];
+        float crossY = n[2] * t[0] - n[0] * t[2];
+        float crossZ = n[0] * t[1] - n[1] * t[0];
+        float handedness = crossX * b[0] + crossY * b[1] + crossZ * b[2];
+        output.position[3] = handedness < 0.0f ? 0 : 0xffff;
+        OctahedronEncode(n[0], n[1], n[2], output.normal);
+        OctahedronEncode(t[0], t[1], t[2], output.tangent);
+        output.texCoords[0] = FloatToHalf(ReadFloat(vertex, TEXCOORD_OFFSET, 0));
+        output.texCoords[1] = FloatToHalf(ReadFloat(vertex, TEXCOORD_OFFSET, 1));
+    }
+
+    void DecodeScalar(const CompactVertex &vertex, const Quantizer &quantizer, uint8_t *output) {
+        using namespace VertexCompression;
+        float position[3], normal[3], tangent[3], bitangent[3];
+        for (size_t c = 0; c < 3; c++)
+            position[c] = quantizer.offset[c] + static_cast<float>(vertex.position[c]) * quantizer.step[c];
+        OctahedronDecode(vertex.normal, normal);
+        OctahedronDecode(vertex.tangent, tangent);
+        float sign = vertex.position[3] > 0x7fff ? 1.0f : -1.0f;
+        bitangent[0] = sign * (normal[1] * tangent[2] - normal[2] * tangent[1]);
+        bitangent[1] = sign * (normal[2] * tangent[0] - normal[0] * tangent[2]);
+        bitangent[2] = sign * (normal[0] * tangent[1] - normal[1] * tangent[0]);
+        float texCoords[2] = {HalfToFloat(vertex.texCoords[0]), HalfToFloat(vertex.texCoords[1])};
+        WriteFloats(output, POSITION_OFFSET, position, 3);
+        WriteFloats(output, NORMAL_OFFSET, normal, 3);
+        WriteFloats(output, TANGENT_OFFSET, tangent, 3);
+        WriteFloats(output, BITANGENT_OFFSET, bitangent, 3);
+        WriteFloats(output, TEXCOORD_OFFSET, texCoords, 2);
+    }
+
+#if VERTEX_COMPRESSION_SSE2
+    // Four vertices per iteration, the attributes are transposed into one register per component.
+    // Every step mirrors the scalar code so both paths round the same way.
+
+    auto Abs(__m128 v) -> __m128 { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+    auto Select(__m128 mask, __m128 ifTrue, __m128 ifFalse) -> __m128 {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+
+    /// x >= 0 ? value : -value
+    auto CopyNonNegativeSign(__m128 value, __m128 x) -> __m128 {
+        __m128 negated = _mm_xor_ps(value, _mm_set1_ps(-0.0f));
+        return Select(_mm_cmpge_ps(x, _mm_setzero_ps()), value, negated);
+    }
+
+    auto QuantizeSnorm(__m128 v) -> __m128i {
+        __m128 clamped = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(SNORM16_MAX)));
+    }
+
+    void OctahedronEncode(__m128 x, __m128 y, __m128 z, __m128i &u16, __m128i &v16) {
+        __m128 sum = _mm_add_ps(_mm_add_ps(Abs(x), Abs(y)), Abs(z));
+        __m128 inverse = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), sum), _mm_cmpgt_ps(sum, _mm_setzero_ps()));
+        __m128 u = _mm_mul_ps(x, inverse), v = _mm_mul_ps(y, inverse);
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 foldedU = CopyNonNegativeSign(_mm_sub_ps(one, Abs(v)), u);
+        __m128 foldedV = CopyNonNegativeSign(_mm_sub_ps(one, Abs(u)), v);
+        __m128 lowerHalf = _mm_cmplt_ps(z, _mm_setzero_ps());
+        u16 = QuantizeSnorm(Select(lowerHalf, foldedU, u));
+        v16 = QuantizeSnorm(Select(lowerHalf, foldedV, v));
+    }
+
+    void OctahedronDecode(__m128i u16, __m128i v16, __m128 &x, __m128 &y, __m128 &z) {
+        __m128 minusOne = _mm_set1_ps(-1.0f), snormMax = _mm_set1_ps(SNORM16_MAX);
+        x = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(u16), snormMax), minusOne);
+        y = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(v16), snormMax), minusOne);
+        z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(x)), Abs(y));
+        __m128 t = _mm_max_ps(_mm_xor_ps(z, _mm_set1_ps(-0.0f)), _mm_setzero_ps());
+        __m128 negT = _mm_xor_ps(t, _mm_set1_ps(-0.0f));
+        x = _mm_add_ps(x, Select(_mm_cmpge_ps(x, _mm_setzero_ps()), negT, t));
+        y = _mm_add_ps(y, Select(_mm_cmpge_ps(y, _mm_setzero_ps()), negT, t));
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared));
+        x = _mm_mul_ps(x, inverseLength);
+        y = _mm_mul_ps(y, inverseLength);
+        z = _mm_mul_ps(z, inverseLength);
+    }
+
+    /// FloatToHalf on four lanes, the half ends up in the low 16 bits of every lane
+    auto FloatToHalf(__m128 value) -> __m128i {
+        __m128 sign = _mm_and_ps(value, _mm_set1_ps(-0.0f));
+        __m128 absolute = _mm_xor_ps(value, sign);
+        __m128i bits = _mm_castps_si128(absolute);
+        __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+        __m128i nanBit = _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absolute, absolute)), _mm_set1_epi32(0x200));
+        __m128i infinityOrNan = _mm_or_si128(nanBit, _mm_set1_epi32(0x7c00));
+
+        __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+        __m128i subnormal = _mm_sub_epi32(
+                _mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+        __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+        __m128i rounded = _mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32(static_cast<int>((15u - 127u) << 23u) + 0xfff)),
+                                        mantissaOdd);
+        __m128i normal = _mm_srli_epi32(rounded, 13);
+
+        __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+        __m128i half = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infinityOrNan));
+        return _mm_and_si128(_mm_or_si128(half, _mm_srli_epi32(_mm_castps_si128(sign), 16)), _mm_set1_epi32(0xffff));
+    }
+
+    /// HalfToFloat on four lanes, the upper 16 bits of every lane have to be zero
+    auto HalfToFloat(__m128i half) -> __m128 {
+        __m128i exponentMantissa = _mm_and_si128(half, _mm_set1_epi32(0x7fff));
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponentMantissa, 13)),
+                                   _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+        __m128i wasInfinityOrNan = _mm_cmpgt_epi32(exponentMantissa, _mm_set1_epi32(0x7bff));
+        __m128i exponent = _mm_and_si128(wasInfinityOrNan, _mm_set1_epi32(255 << 23));
+        __m128i sign = _mm_slli_epi32(_mm_xor_si128(half, exponentMantissa), 16);
+        return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, exponent)));
+    }
+
+    auto LoadFloat3(const uint8_t *vertex, size_t offset) -> __m128 {
+        // Reads one float past the attribute, every attribute is followed by another one
+        return _mm_loadu_ps(reinterpret_cast<const float *>(vertex + offset));
+    }
+
+    auto LoadFloat2(const uint8_t *vertex, size_t offset) -> __m128 {
+        return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(vertex + offset)));
+    }
+
+    /// Packs 0..65535 lanes without the signed saturation of packs
+    auto PackUnsigned16(__m128i low, __m128i high) -> __m128i {
+        __m128i bias = _mm_set1_epi32(0x8000);
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias));
+        return _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+    }
+
+    void EncodeSse2(const uint8_t *vertices, const Quantizer &quantizer, CompactVertex *output) {
+        using namespace VertexCompression;
+        const uint8_t *v[4];
+        for (size_t i = 0; i < 4; i++)
+            v[i] = vertices + i * FULL_VERTEX_SIZE;
+
+        __m128 px = LoadFloat3(v[0], POSITION_OFFSET), py = LoadFloat3(v[1], POSITION_OFFSET);
+        __m128 pz = LoadFloat3(v[2], POSITION_OFFSET), pw = LoadFloat3(v[3], POSITION_OFFSET);
+        _MM_TRANSPOSE4_PS(px, py, pz, pw);
+        __m128 nx = LoadFloat3(v[0], NORMAL_OFFSET), ny = LoadFloat3(v[1], NORMAL_OFFSET);
+        __m128 nz = LoadFloat3(v[2], NORMAL_OFFSET), nw = LoadFloat3(v[3], NORMAL_OFFSET);
+        _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+        __m128 tx = LoadFloat3(v[0], TANGENT_OFFSET), ty = LoadFloat3(v[1], TANGENT_OFFSET);
+        __m128 tz = LoadFloat3(v[2], TANGENT_OFFSET), tw = LoadFloat3(v[3], TANGENT_OFFSET);
+        _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+        __m128 bx = LoadFloat3(v[0], BITANGENT_OFFSET), by = LoadFloat3(v[1], BITANGENT_OFFSET);
+        __m128 bz = LoadFloat3(v[2], BITANGENT_OFFSET), bw = LoadFloat3(v[3], BITANGENT_OFFSET);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        __m128 zero = _mm_setzero_ps(), unormMax = _mm_set1_ps(UNORM16_MAX);
+        auto quantize = [&](__m128 value, size_t c) {
+            __m128 scaled = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(quantizer.offset[c])),
+                                       _mm_set1_ps(quantizer.inverseScale[c]));
+            return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(scaled, zero), unormMax));
+        };
+        __m128i qx = quantize(px, 0), qy = quantize(py, 1), qz = quantize(pz, 2);
+
+        __m128 crossX = _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty));
+        __m128 crossY = _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz));
+        __m128 crossZ = _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx));
+        __m128 handedness = _mm_add_ps(_mm_add_ps(_mm_mul_ps(crossX, bx), _mm_mul_ps(crossY, by)),
+                                       _mm_mul_ps(crossZ, bz));
+        __m128i qw = _mm_andnot_si128(_mm_castps_si128(_mm_cmplt_ps(handedness, zero)), _mm_set1_epi32(0xffff));
+
+        __m128i normalU, normalV, tangentU, tangentV;
+        OctahedronEncode(nx, ny, nz, normalU, normalV);
+        OctahedronEncode(tx, ty, tz, tangentU, tangentV);
+
+        // Component registers [x0 x1 x2 x3 y0 y1 y2 y3] interleaved back into per vertex pairs [x0 y0 x1 y1 ...]
+        __m128i positionXY = PackUnsigned16(qx, qy), positionZW = PackUnsigned16(qz, qw);
+        __m128i normals = _mm_packs_epi32(normalU, normalV), tangents = _mm_packs_epi32(tangentU, tangentV);
+        __m128i pairsXY = _mm_unpacklo_epi16(positionXY, _mm_unpackhi_epi64(positionXY, positionXY));
+        __m128i pairsZW = _mm_unpacklo_epi16(positionZW, _mm_unpackhi_epi64(positionZW, positionZW));
+        __m128i pairsN = _mm_unpacklo_epi16(normals, _mm_unpackhi_epi64(normals, normals));
+        __m128i pairsT = _mm_unpacklo_epi16(tangents, _mm_unpackhi_epi64(tangents, tangents));
+        __m128i positions01 = _mm_unpacklo_epi32(pairsXY, pairsZW), positions23 = _mm_unpackhi_epi32(pairsXY, pairsZW);
+        __m128i frames01 = _mm_unpacklo_epi32(pairsN, pairsT), frames23 = _mm_unpackhi_epi32(pairsN, pairsT);
+        __m128i rows[4] = {
+                _mm_unpacklo_epi64(positions01, frames01), _mm_unpackhi_epi64(positions01, frames01),
+                _mm_unpacklo_epi64(positions23, frames23), _mm_unpackhi_epi64(positions23, frames23),
+        };
+
+        // [u0 v0 u1 v1] halves merged into one 32 bit word per vertex
+        __m128i uv01 = FloatToHalf(_mm_movelh_ps(LoadFloat2(v[0], TEXCOORD_OFFSET), LoadFloat2(v[1], TEXCOORD_OFFSET)));
+        __m128i uv23 = FloatToHalf(_mm_movelh_ps(LoadFloat2(v[2], TEXCOORD_OFFSET), LoadFloat2(v[3], TEXCOORD_OFFSET)));
+        uv01 = _mm_shuffle_epi32(_mm_or_si128(uv01, _mm_srli_epi64(uv01, 16)), _MM_SHUFFLE(3, 1, 2, 0));
+        uv23 = _mm_shuffle_epi32(_mm_or_si128(uv23, _mm_srli_epi64(uv23, 16)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i texCoords = _mm_unpacklo_epi64(uv01, uv23);
+
+        for (size_t i = 0; i < 4; i++) {
+            auto *vertex = reinterpret_cast<uint8_t *>(output + i);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(vertex), rows[i]);
+            uint32_t word = static_cast<uint32_t>(_mm_cvtsi128_si32(texCoords));
+            std::memcpy(vertex + offsetof(CompactVertex, texCoords), &word, sizeof(word));
+            texCoords = _mm_srli_si128(texCoords, 4);
+        }
+    }
+
+    void DecodeSse2(const CompactVertex *vertices, const Quantizer &quantizer, uint8_t *output) {
+        using namespace VertexCompression;
+        // Rows [px py pz pw nu nv tu tv] as 16 bit lanes, transposed into one register per component
+        __m128i rows[4];
+        uint32_t texCoordWords[4];
+        for (size_t i = 0; i < 4; i++) {
+            const auto *vertex = reinterpret_cast<const uint8_t *>(vertices + i);
+            rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vertex));
+            std::memcpy(&texCoordWords[i], vertex + offsetof(CompactVertex, texCoords), sizeof(uint32_t));
+        }
+        __m128i positions01 = _mm_unpacklo_epi16(rows[0], rows[1]), positions23 = _mm_unpacklo_epi16(rows[2], rows[3]);
+        __m128i frames01 = _mm_unpackhi_epi16(rows[0], rows[1]), frames23 = _mm_unpackhi_epi16(rows[2], rows[3]);
+        __m128i positionXY = _mm_unpacklo_epi32(positions01, positions23);
+        __m128i positionZW = _mm_unpackhi_epi32(positions01, positions23);
+        __m128i normals = _mm_unpacklo_epi32(frames01, frames23);
+        __m128i tangents = _mm_unpackhi_epi32(frames01, frames23);
+
+        __m128i zero = _mm_setzero_si128();
+        auto position = [&](__m128i quantized, size_t c) {
+            return _mm_add_ps(_mm_set1_ps(quantizer.offset[c]),
+                              _mm_mul_ps(_mm_cvtepi32_ps(quantized), _mm_set1_ps(quantizer.step[c])));
+        };
+        __m128 px = position(_mm_unpacklo_epi16(positionXY, zero), 0);
+        __m128 py = position(_mm_unpackhi_epi16(positionXY, zero), 1);
+        __m128 pz = position(_mm_unpacklo_epi16(positionZW, zero), 2);
+        __m128i signs = _mm_unpackhi_epi16(positionZW, zero);
+
+        auto signExtendLow = [&](__m128i v) { return _mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 16); };
+        auto signExtendHigh = [&](__m128i v) { return _mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 16); };
+        __m128 nx, ny, nz, tx, ty, tz;
+        OctahedronDecode(signExtendLow(normals), signExtendHigh(normals), nx, ny, nz);
+        OctahedronDecode(signExtendLow(tangents), signExtendHigh(tangents), tx, ty, tz);
+
+        __m128 sign = Select(_mm_castsi128_ps(_mm_cmpgt_epi32(signs, _mm_set1_epi32(0x7fff))), _mm_set1_ps(1.0f),
+                             _mm_set1_ps(-1.0f));
+        __m128 bx = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty)));
+        __m128 by = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz)));
+        __m128 bz = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx)));
+
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(texCoordWords));
+        __m128 u = HalfToFloat(_mm_and_si128(words, _mm_set1_epi32(0xffff)));
+        __m128 v = HalfToFloat(_mm_srli_epi32(words, 16));
+
+        __m128 pw = _mm_setzero_ps(), nw = _mm_setzero_ps(), tw = _mm_setzero_ps(), bw = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(px, py, pz, pw);
+        _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+        _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+        __m128 uv01 = _mm_unpacklo_ps(u, v), uv23 = _mm_unpackhi_ps(u, v);
+        const __m128 positionRows[4] = {px, py, pz, pw}, normalRows[4] = {nx, ny, nz, nw};
+        const __m128 tangentRows[4] = {tx, ty, tz, tw}, bitangentRows[4] = {bx, by, bz, bw};
+        const __m128 texCoordRows[4] = {uv01, _mm_movehl_ps(uv01, uv01), uv23, _mm_movehl_ps(uv23, uv23)};
+
+        for (size_t i = 0; i < 4; i++) {
+            // Each 16 byte store spills into the next attribute, which is written right after
+            uint8_t *vertex = output + i * FULL_VERTEX_SIZE;
+            _mm_storeu_ps(reinterpret_cast<float *>(vertex + POSITION_OFFSET), positionRows[i]);
+            _mm_storeu_ps(reinterpret_cast<float *>(vertex + NORMAL_OFFSET), normalRows[i]);
+            _mm_storeu_ps(reinterpret_cast<float *>(vertex + TANGENT_OFFSET), tangentRows[i]);
+            _mm_storeu_ps(reinterpret_cast<float *>(vertex + BITANGENT_OFFSET), bitangentRows[i]);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(vertex + TEXCOORD_OFFSET), _mm_castps_si128(texCoordRows[i]));
+        }
+    }
+#endif
+
+    /// Angle between two vectors in degrees, in double precision so small angles don't drown in acos rounding
+    auto AngleDegrees(const float a[3], const float b[3]) -> double {
+        double cross[3] = {
+                double(a[1]) * b[2] - double(a[2]) * b[1],
+                double(a[2]) * b[0] - double(a[0]) * b[2],
+                double(a[0]) * b[1] - double(a[1]) * b[0],
+        };
+        double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        double cosine = double(a[0]) * b[0] + double(a[1]) * b[1] + double(a[2]) * b[2];
+        return std::atan2(sine, cosine) * 180.0 / 3.14159265358979323846;
+    }
+
+    auto IsZero(const float v[3]) -> bool { return v[0] == 0.0f && v[1] == 0.0f && v[2] == 0.0f; }
+}
+
+
+namespace VertexCompression {
+
+    auto Quantization(const uint8_t *vertices, size_t vertexCount) -> PositionQuantization {
+        PositionQuantization quantization;
+        if (vertexCount == 0)
+            return quantization;
+
+        float min[3], max[3];
+        for (size_t c = 0; c < 3; c++)
+            min[c] = max[c] = ReadFloat(vertices, POSITION_OFFSET, c);
+        for (size_t i = 1; i < vertexCount; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                float value = ReadFloat(vertices + i * FULL_VERTEX_SIZE, POSITION_OFFSET, c);
+                min[c] = std::min(min[c], value);
+                max[c] = std::max(max[c], value);
+            }
+        }
+        for (size_t c = 0; c < 3; c++) {
+            quantization.offset[c] = min[c];
+            quantization.scale[c] = max[c] - min[c];
+        }
+        return quantization;
+    }
+
+
+    void Encode(const uint8_t *vertices, size_t vertexCount, const PositionQuantization &quantization,
+                CompactVertex *output) {
+        Quantizer quantizer(quantization);
+        size_t i = 0;
+#if VERTEX_COMPRESSION_SSE2
+        for (; i + 4 <= vertexCount; i += 4)
+            EncodeSse2(vertices + i * FULL_VERTEX_SIZE, quantizer, output + i);
+#endif
+        for (; i < vertexCount; i++)
+            EncodeScalar(vertices + i * FULL_VERTEX_SIZE, quantizer, output[i]);
+    }
+
+
+    void Decode(const CompactVertex *vertices, size_t vertexCount, const PositionQuantization &quantization,
+                uint8_t *output) {
+        Quantizer quantizer(quantization);
+        size_t i = 0;
+#if VERTEX_COMPRESSION_SSE2
+        for (; i + 4 <= vertexCount; i += 4)
+            DecodeSse2(vertices + i, quantizer, output + i * FULL_VERTEX_SIZE);
+#endif
+        for (; i < vertexCount; i++)
+            DecodeScalar(vertices[i], quantizer, output + i * FULL_VERTEX_SIZE);
+    }
+
+
+    auto MeasureError(const uint8_t *original, const uint8_t *decoded, size_t vertexCount) -> CompressionError {
+        CompressionError error;
+        auto read3 = [](const uint8_t *vertex, size_t offset, float output[3]) {
+            for (size_t c = 0; c < 3; c++)
+                output[c] = ReadFloat(vertex, offset, c);
+        };
+
+        for (size_t i = 0; i < vertexCount; i++) {
+            const uint8_t *before = original + i * FULL_VERTEX_SIZE, *after = decoded + i * FULL_VERTEX_SIZE;
+            float a[3], b[3];
+            read3(before, POSITION_OFFSET, a);
+            read3(after, POSITION_OFFSET, b);
+            double distance = std::sqrt(double(a[0] - b[0]) * (a[0] - b[0]) + double(a[1] - b[1]) * (a[1] - b[1]) +
+                                        double(a[2] - b[2]) * (a[2] - b[2]));
+            error.position = std::max(error.position, static_cast<float>(distance));
+
+            const std::pair<size_t, float CompressionError::*> directions[] = {
+                    {NORMAL_OFFSET,    &CompressionError::normal},
+                    {TANGENT_OFFSET,   &CompressionError::tangent},
+                    {BITANGENT_OFFSET, &CompressionError::bitangent},
+            };
+            for (const auto &[offset, member] : directions) {
+                read3(before, offset, a);
+                read3(after, offset, b);
+                if (!IsZero(a))
+                    error.*member = std::max(error.*member, static_cast<float>(AngleDegrees(a, b)));
+            }
+
+            for (size_t c = 0; c < 2; c++) {
+                float difference = std::abs(ReadFloat(before, TEXCOORD_OFFSET, c) - ReadFloat(after, TEXCOORD_OFFSET, c));
+                error.texCoord = std::max(error.texCoord, difference);
+            }
+        }
+        return error;
+    }
+
+
+    auto ErrorBound(const uint8_t *vertices, size_t vertexCount, const PositionQuantization &quantization)
+    -> CompressionError {
+        constexpr double DEGREES = 180.0 / 3.14159265358979323846;
+        constexpr double EPSILON = std::numeric_limits<float>::epsilon();
+        CompressionError bound;
+
+        // Half a step per axis, plus a few ulps of float rounding in the quantization and dequantization
+        double squaredPosition = 0.0;
+        for (size_t c = 0; c < 3; c++) {
+            double axis = 0.5 * quantization.scale[c] / UNORM16_MAX +
+                          4.0 * EPSILON * (std::abs(quantization.offset[c]) + quantization.scale[c]);
+            squaredPosition += axis * axis;
+        }
+        bound.position = static_cast<float>(std::sqrt(squaredPosition));
+
+        // Rounding moves the octahedral coordinates by up to half a step on both axes. The map stretches
+        // such a move the most at face centers, where it turns the direction by sqrt(18) times the step.
+        double octahedral = std::sqrt(18.0) * 0.5 / SNORM16_MAX + 16.0 * EPSILON;
+        bound.normal = static_cast<float>(octahedral * DEGREES);
+        bound.tangent = bound.normal;
+        bound.bitangent = bound.normal + bound.tangent;
+
+        // Half a unit in the last place of an 11 bit significand, half the smallest subnormal near zero
+        float maxTexCoord = 0.0f;
+        for (size_t i = 0; i < vertexCount; i++) {
+            for (size_t c = 0; c < 2; c++)
+                maxTexCoord = std::max(maxTexCoord, std::abs(ReadFloat(vertices + i * FULL_VERTEX_SIZE, TEXCOORD_OFFSET, c)));
+        }
+        bound.texCoord = std::ldexp(maxTexCoord, -11) + std::ldexp(1.0f, -25);
+        return bound;
+    }
+
+
+    auto IsWithinBound(const CompressionError &error, const CompressionError &bound) -> bool {
+        return error.position <= bound.position && error.normal <= bound.normal && error.tangent <= bound.tangent &&
+               error.texCoord <= bound.texCoord;
+    }
+}
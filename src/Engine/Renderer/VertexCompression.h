@@ -0,0 +1,92 @@
+#ifndef GAME_ENGINE_VERTEX_COMPRESSION_H
+#define GAME_ENGINE_VERTEX_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// How a mesh stores its vertices, the material's vertex shader has to declare the matching inputs
+enum class VertexFormat : uint32_t {
+    /// The engine's Vertex, 56 bytes of floats
+    FULL = 0,
+    /// CompactVertex, decoded by the *Compact.vert shaders
+    COMPACT = 1,
+};
+
+
+/**
+ * 20 byte vertex, 2.8 times smaller than the full one. The bitangent isn't stored, the shader
+ * rebuilds it as bitangentSign * cross(normal, tangent).
+ */
+struct CompactVertex {
+    /// Unorm16 position inside the mesh's quantization box, w is the bitangent sign: 0 for -1, 65535 for +1
+    uint16_t position[4];
+    /// Octahedral encoded unit vectors as snorm16
+    int16_t normal[2];
+    int16_t tangent[2];
+    /// Half floats
+    uint16_t texCoords[2];
+};
+
+static_assert(sizeof(CompactVertex) == 20, "Compact vertex layout changed, update the shaders and bump the cache versions");
+
+
+/// Box the unorm16 positions are spread over: position = offset + scale * unorm
+struct PositionQuantization {
+    float offset[3] = {0.0f, 0.0f, 0.0f};
+    float scale[3] = {0.0f, 0.0f, 0.0f};
+};
+
+
+/// Largest round-trip error over all vertices
+struct CompressionError {
+    /// Object space distance
+    float position = 0.0f;
+    /// Angles in degrees, the bitangent one includes the error of dropping a non-orthogonal bitangent
+    float normal = 0.0f;
+    float tangent = 0.0f;
+    float bitangent = 0.0f;
+    float texCoord = 0.0f;
+};
+
+
+namespace VertexCompression {
+    /// Byte offsets of the float attributes in the uncompressed vertex, the layout of the engine's Vertex
+    constexpr size_t POSITION_OFFSET = 0;
+    constexpr size_t NORMAL_OFFSET = 12;
+    constexpr size_t TANGENT_OFFSET = 24;
+    constexpr size_t BITANGENT_OFFSET = 36;
+    constexpr size_t TEXCOORD_OFFSET = 48;
+    constexpr size_t FULL_VERTEX_SIZE = 56;
+
+    /// Bounding box of the positions, the smallest box keeps the quantization steps smallest
+    auto Quantization(const uint8_t *vertices, size_t vertexCount) -> PositionQuantization;
+
+    /**
+     * Encodes full vertices, four at a time with SSE2 where available. Zero length normals and
+     * tangents encode as +Z. The SIMD and scalar paths produce identical bits.
+     */
+    void Encode(const uint8_t *vertices, size_t vertexCount, const PositionQuantization &quantization,
+                CompactVertex *output);
+
+    /// Inverse of Encode into full vertices, with the bitangent reconstructed the way the shaders do it
+    void Decode(const CompactVertex *vertices, size_t vertexCount, const PositionQuantization &quantization,
+                uint8_t *output);
+
+    /// Compares full vertices before encoding and after decoding, vectors of zero length are skipped
+    auto MeasureError(const uint8_t *original, const uint8_t *decoded, size_t vertexCount) -> CompressionError;
+
+    /**
+     * Worst error the quantization of these vertices allows: half a position step per axis, the
+     * snorm16 rounding of the octahedral map and half-float rounding of the largest texture
+     * coordinate. The bitangent bound only holds for orthonormal frames, a skewed one isn't kept.
+     */
+    auto ErrorBound(const uint8_t *vertices, size_t vertexCount, const PositionQuantization &quantization)
+    -> CompressionError;
+
+    /// True when every attribute but the bitangent stays within the bound
+    auto IsWithinBound(const CompressionError &error, const CompressionError &bound) -> bool;
+}
+
+
+#endif //GAME_ENGINE_VERTEX_COMPRESSION_H
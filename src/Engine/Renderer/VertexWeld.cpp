@@ -0,0 +1,61 @@
+#include "VertexWeld.h"
+
+#include <Engine/Core/Parallel.h>
+
+
+namespace {
+    /// Keys are vertex numbers, hashing and comparison look at the vertex bytes they point to
+    struct VertexBytesHash {
+        const uint8_t *vertices;
+        uint32_t vertexSize;
+
+        auto operator()(uint32_t vertex) const -> uint64_t {
+            return Hash::Hash64(vertices + size_t(vertex) * vertexSize, vertexSize);
+        }
+    };
+
+    struct VertexBytesEqual {
+        const uint8_t *vertices;
+        uint32_t vertexSize;
+
+        auto operator()(uint32_t a, uint32_t b) const -> bool {
+            return std::memcmp(vertices + size_t(a) * vertexSize, vertices + size_t(b) * vertexSize, vertexSize) == 0;
+        }
+    };
+}
+
+
+namespace VertexWeld {
+
+    auto WeldByValue(const uint8_t *vertices, size_t vertexCount, uint32_t vertexSize) -> WeldResult {
+        WeldResult result;
+        result.remap.resize(vertexCount);
+
+        // Unindexed input has roughly one unique vertex per 4-6 corners, a quarter keeps the first rehash rare
+        WeldTable<uint32_t, VertexBytesHash, VertexBytesEqual> table(vertexCount / 4 + 1,
+                                                                     VertexBytesHash{vertices, vertexSize},
+                                                                     VertexBytesEqual{vertices, vertexSize});
+        for (size_t i = 0; i < vertexCount; i++)
+            result.remap[i] = table.Insert(static_cast<uint32_t>(i));
+
+        result.representatives = std::move(table.Keys());
+        return result;
+    }
+
+
+    auto EmitVertices(TaskSystem &taskSystem, const uint8_t *vertices, uint32_t vertexSize,
+                      const std::vector<uint32_t> &representatives) -> std::vector<uint8_t> {
+        std::vector<uint8_t> welded(representatives.size() * vertexSize);
+        Parallel::ForChunks(taskSystem, 0, representatives.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                std::memcpy(&welded[i * vertexSize], vertices + size_t(representatives[i]) * vertexSize, vertexSize);
+        }, 4096);
+        return welded;
+    }
+
+
+    void RemapIndices(std::vector<uint32_t> &indices, const std::vector<uint32_t> &remap) {
+        for (auto &index : indices)
+            index = remap[index];
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef GAME_ENGINE_VERTEX_WELD_H
+#define GAME_ENGINE_VERTEX_WELD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <Engine/Core/Hash.h>
+#include <Engine/Core/TaskSystem.h>
+
+
+/**
+ * Open-addressing table handing out dense vertex ids in order of first insertion. Slots are
+ * 8 bytes (upper half of the 64-bit hash and the id) in one flat power-of-two array probed
+ * linearly, so a lookup mostly touches a single cache line and nothing is allocated per key.
+ * The keys themselves are stored once per unique vertex and double as the list of
+ * representatives a caller emits the final vertices from.
+ *
+ * Hasher returns a well mixed uint64_t for a Key, Equal compares two Keys. Both may carry
+ * state, e.g. a pointer to the vertex buffer the keys index into.
+ */
+template<typename Key, typename Hasher, typename Equal>
+class WeldTable {
+    struct Slot {
+        uint32_t tag;
+        uint32_t id;
+    };
+
+    static constexpr uint32_t EMPTY = ~0u;
+
+    std::vector<Slot> m_Slots;
+    std::vector<Key> m_Keys;
+    size_t m_Mask = 0;
+    Hasher m_Hasher;
+    Equal m_Equal;
+
+    void Rehash(size_t capacity) {
+        m_Slots.assign(capacity, Slot{0, EMPTY});
+        m_Mask = capacity - 1;
+        for (uint32_t id = 0; id < m_Keys.size(); id++) {
+            uint64_t hash = m_Hasher(m_Keys[id]);
+            size_t pos = hash & m_Mask;
+            while (m_Slots[pos].id != EMPTY)
+                pos = (pos + 1) & m_Mask;
+            m_Slots[pos] = {static_cast<uint32_t>(hash >> 32u), id};
+        }
+    }
+
+public:
+    /// Pre-sized so expectedKeys unique keys stay below half load, the table still grows past that
+    explicit WeldTable(size_t expectedKeys, Hasher hasher = Hasher(), Equal equal = Equal())
+            : m_Hasher(hasher), m_Equal(equal) {
+        size_t capacity = 16;
+        while (capacity < expectedKeys * 2)
+            capacity *= 2;
+        m_Keys.reserve(expectedKeys);
+        Rehash(capacity);
+    }
+
+    /// Id of the key, a new one when it wasn't seen yet
+    auto Insert(const Key &key) -> uint32_t {
+        uint64_t hash = m_Hasher(key);
+        auto tag = static_cast<uint32_t>(hash >> 32u);
+        size_t pos = hash & m_Mask;
+        while (true) {
+            const Slot &slot = m_Slots[pos];
+            if (slot.id == EMPTY)
+                break;
+            if (slot.tag == tag && m_Equal(m_Keys[slot.id], key))
+                return slot.id;
+            pos = (pos + 1) & m_Mask;
+        }
+
+        auto id = static_cast<uint32_t>(m_Keys.size());
+        m_Slots[pos] = {tag, id};
+        m_Keys.push_back(key);
+        // Linear probing degrades quickly above 3/4 load
+        if (m_Keys.size() * 4 > m_Slots.size() * 3)
+            Rehash(m_Slots.size() * 2);
+        return id;
+    }
+
+    auto Size() const -> size_t { return m_Keys.size(); }
+
+    /// Key of every id, in id order
+    auto Keys() const -> const std::vector<Key> & { return m_Keys; }
+
+    auto Keys() -> std::vector<Key> & { return m_Keys; }
+};
+
+
+namespace VertexWeld {
+
+    /// Hashes a fixed-size POD key (e.g. a tuple of attribute indices) as raw bytes
+    template<typename Key>
+    struct PodHash {
+        auto operator()(const Key &key) const -> uint64_t { return Hash::Hash64(&key, sizeof(Key)); }
+    };
+
+    template<typename Key>
+    struct PodEqual {
+        auto operator()(const Key &a, const Key &b) const -> bool { return std::memcmp(&a, &b, sizeof(Key)) == 0; }
+    };
+
+    struct WeldResult {
+        /// One index per input vertex into the welded vertices
+        std::vector<uint32_t> remap;
+        /// First input vertex of every welded vertex
+        std::vector<uint32_t> representatives;
+    };
+
+    /**
+     * Welds vertices whose attributes are bitwise identical, for geometry which doesn't come with
+     * attribute indices (procedural meshes, unindexed triangle soups). Bitwise means -0.0 and 0.0
+     * or two NaNs with different payloads stay separate vertices.
+     */
+    auto WeldByValue(const uint8_t *vertices, size_t vertexCount, uint32_t vertexSize) -> WeldResult;
+
+    /// Copies the representatives into a tightly packed buffer in one allocation, in parallel for large meshes
+    auto EmitVertices(TaskSystem &taskSystem, const uint8_t *vertices, uint32_t vertexSize,
+                      const std::vector<uint32_t> &representatives) -> std::vector<uint8_t>;
+
+    /// Rewrites an index buffer referencing the input vertices to reference the welded ones
+    void RemapIndices(std::vector<uint32_t> &indices, const std::vector<uint32_t> &remap);
+}
+
+
+#endif //GAME_ENGINE_VERTEX_WELD_H
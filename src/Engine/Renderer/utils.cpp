@@ -1,7 +1,6 @@
 #include "utils.h"
 
 #include <vector>
-#include <iostream>
 #include <fstream>
 #include <array>
 #include <limits>
@@ -13,7 +12,7 @@ static bool s_GLFWInitialized = false;
 
 
 void GLFWErrorCallback(int error, const char *description) {
-   std::cerr << "[GLFW][Error " << error << "] " << description << std::endl;
+   LOG_ERROR("[GLFW][Error {}] {}", error, description);
 }
 
 
@@ -86,26 +85,24 @@ VKAPI_ATTR auto VKAPI_CALL debugCallback(
         void *pUserData) -> VkBool32 {
    (void) pUserData;
 
-   std::ostringstream ss;
-   ss << currentTime() << "[Vulkan]";
-
+   const char *type = "";
    if (messageType & VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT) {
-      ss << "[General]";
+      type = "[General]";
    } else if (messageType & VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT) {
-      ss << "[Validation]";
+      type = "[Validation]";
    } else if (messageType & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) {
-      ss << "[Performance]";
+      type = "[Performance]";
    }
 
    if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
-      ss << "[ERROR]";
+      LOG_ERROR("[Vulkan]{}[ERROR] {}", type, pCallbackData->pMessage);
    } else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
-      ss << "[WARNING]";
+      LOG_WARNING("[Vulkan]{}[WARNING] {}", type, pCallbackData->pMessage);
    } else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
-      ss << "[INFO]";
+      LOG_INFO("[Vulkan]{}[INFO] {}", type, pCallbackData->pMessage);
+   } else {
+      LOG_DEBUG("[Vulkan]{} {}", type, pCallbackData->pMessage);
    }
-   ss << " " << pCallbackData->pMessage;
-   std::cerr << ss.str() << std::endl;
 
    return VK_FALSE;
 }
@@ -8,7 +8,6 @@
 #include <GLFW/glfw3.h>
 #include <unordered_map>
 
-#include <iostream>
 #include <spirv_glsl.hpp>
 #include <Engine/Core.h>
 #include "Platform/Vulkan/CoreVk.h"
@@ -103,7 +102,7 @@ namespace vk {
        }
        if (!requiredExtensions.empty()) {
           for (const auto &missing: requiredExtensions) {
-             std::cerr << "[Vulkan] Missing extension: " << missing << std::endl;
+             LOG_ERROR("[Vulkan] Missing extension: {}", missing);
           }
           throw std::runtime_error("GPU does not support required extensions!");
        }
@@ -334,7 +333,7 @@ namespace vk {
           auto[vkFormat, size] = ParseSpirVType(base_type);
           VertexAttribute attribute{resource.name, vkFormat, size};
           vertexLayout[location] = attribute;
-          Log() << "[ShaderModule (" << m_Name << ")] Shader input: " << resource.name << std::endl;
+          LOG_TRACE("[ShaderModule ({})] Shader input: {}", m_Name, resource.name);
        }
 
        if (!vertexLayout.empty()) {
@@ -382,8 +381,7 @@ namespace vk {
                   std::move(members)
           });
 
-          Log() << "[ShaderModule (" << m_Name << ")] UBO: "
-                    << resource.name << ", Set: " << setIdx << ", Binding: " << bindingIdx << std::endl;
+          LOG_TRACE("[ShaderModule ({})] UBO: {}, Set: {}, Binding: {}", m_Name, resource.name, setIdx, bindingIdx);
        }
 
        /// Extract push constants
@@ -441,12 +439,11 @@ namespace vk {
           uint32_t bindingKey = (setIdx << 16u) + bindingIdx;
           m_SamplerBindings.emplace(bindingKey, binding);
 
-          Log() << "[ShaderModule (" << m_Name << ")] Sampler: "
-                    << resource.name << ", Set: " << setIdx << ", Binding: " << bindingIdx << std::endl;
+          LOG_TRACE("[ShaderModule ({})] Sampler: {}, Set: {}, Binding: {}", m_Name, resource.name, setIdx, bindingIdx);
        }
 
        m_CodeSize = shaderCode.size() * sizeof(uint32_t);
-       Log() << "[Vulkan] Loaded shader '" << m_Name << "' bytecode, bytes: " << m_CodeSize << std::endl;
+       LOG_DEBUG("[Vulkan] Loaded shader '{}' bytecode, bytes: {}", m_Name, m_CodeSize);
 
        VkShaderModuleCreateInfo createInfo = {};
        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -639,17 +636,17 @@ namespace vk {
 
 
     Instance::Instance(bool enableValidation) {
-       Log() << currentTime() << "[Vulkan][Instance] Constructing" << std::endl;
+       LOG_DEBUG("[Vulkan][Instance] Constructing");
        auto requiredLayers = ArrayToVector(s_RequiredLayers);
 
        if (enableValidation) {
-          Log() << currentTime() << "[Vulkan][Instance] Enabling validation layers" << std::endl;
+          LOG_INFO("[Vulkan][Instance] Enabling validation layers");
           requiredLayers.insert(requiredLayers.end(), s_ValidationLayers.begin(), s_ValidationLayers.end());
        }
 
        const auto layers = checkLayerSupport(requiredLayers, ArrayToVector(s_OptionalLayers));
        for (const auto& layer : layers) {
-          Log() << currentTime() << "[Vulkan][Instance] Enabled layer: " << layer << std::endl;
+          LOG_INFO("[Vulkan][Instance] Enabled layer: {}", layer);
        }
 
        VkApplicationInfo appInfo = {};
@@ -668,7 +665,7 @@ namespace vk {
        createInfo.enabledExtensionCount = extensions.size();
        createInfo.ppEnabledExtensionNames = extensions.data();
        for (const auto& ext : extensions) {
-          Log() << currentTime() << "[Vulkan][Instance] Enabled extension: " << ext << std::endl;
+          LOG_INFO("[Vulkan][Instance] Enabled extension: {}", ext);
        }
 
        VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
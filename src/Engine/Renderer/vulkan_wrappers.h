@@ -144,10 +144,10 @@ namespace vk {
               throw std::runtime_error("failed to end command buffer recording!");
         }
 
-        void Submit(VkQueue cmdQueue) const {
+        void Submit(VkQueue cmdQueue, VkFence fence = nullptr) const {
            VkSubmitInfo submitInfo = {};
            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-           Submit(submitInfo, cmdQueue);
+           Submit(submitInfo, cmdQueue, fence);
         }
 
         void Submit(VkSubmitInfo &submitInfo, VkQueue cmdQueue, VkFence fence = nullptr) const {
@@ -4,9 +4,7 @@
 
 #include <GLFW/glfw3.h>
 #include <Engine/Renderer/utils.h>
-#include <Engine/Events/WindowEvents.h>
-#include <Engine/Events/KeyEvents.h>
-#include <Engine/Events/MouseEvents.h>
+#include <Engine/Events/EventChannel.h>
 
 
 AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
@@ -24,27 +22,27 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       windowLinux->m_Width = newWidth;
       windowLinux->m_Height = newHeight;
-      windowLinux->m_EventCallback(std::make_unique<WindowResizeEvent>(newWidth, newHeight));
+      windowLinux->m_EventCallback(EventRecord::WindowResize(newWidth, newHeight));
    });
 
    glfwSetWindowCloseCallback(m_Window, [](GLFWwindow* window) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowLinux->m_EventCallback(std::make_unique<WindowCloseEvent>());
+      windowLinux->m_EventCallback(EventRecord::WindowClose());
    });
 
    glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int key, int, int action, int) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       switch (action) {
          case GLFW_PRESS:
-            windowLinux->m_EventCallback(std::make_unique<KeyPressEvent>(key, 0));
+            windowLinux->m_EventCallback(EventRecord::KeyPress(key, 0));
             break;
 
          case GLFW_RELEASE:
-            windowLinux->m_EventCallback(std::make_unique<KeyReleaseEvent>(key));
+            windowLinux->m_EventCallback(EventRecord::KeyRelease(key));
             break;
 
          case GLFW_REPEAT:
-            windowLinux->m_EventCallback(std::make_unique<KeyPressEvent>(key, 1));
+            windowLinux->m_EventCallback(EventRecord::KeyPress(key, 1));
             break;
 
          default:
@@ -56,11 +54,11 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       switch (action) {
          case GLFW_PRESS:
-            windowLinux->m_EventCallback(std::make_unique<MouseButtonPressEvent>(button));
+            windowLinux->m_EventCallback(EventRecord::MouseButtonPress(button));
             break;
 
          case GLFW_RELEASE:
-            windowLinux->m_EventCallback(std::make_unique<MouseButtonReleaseEvent>(button));
+            windowLinux->m_EventCallback(EventRecord::MouseButtonRelease(button));
             break;
 
          default:
@@ -71,17 +69,17 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
    glfwSetScrollCallback(m_Window, [](GLFWwindow* window, double offsetX, double offsetY) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       windowLinux->m_EventCallback(
-              std::make_unique<MouseScrollEvent>(static_cast<float>(offsetX), static_cast<float>(offsetY)));
+              EventRecord::MouseScroll(static_cast<float>(offsetX), static_cast<float>(offsetY)));
    });
 
    glfwSetCursorPosCallback(m_Window, [](GLFWwindow* window, double x, double y) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowLinux->m_EventCallback(std::make_unique<MouseMoveEvent>(static_cast<float>(x), static_cast<float>(y)));
+      windowLinux->m_EventCallback(EventRecord::MouseMove(static_cast<float>(x), static_cast<float>(y)));
    });
 
    glfwSetCharCallback(m_Window, [](GLFWwindow* window, unsigned int keycode) {
       auto* windowLinux = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowLinux->m_EventCallback(std::make_unique<CharacterPressEvent>(keycode));
+      windowLinux->m_EventCallback(EventRecord::CharacterPress(keycode));
    });
 }
 
@@ -90,8 +88,16 @@ AppWindow::~AppWindow() {
    glfwDestroyWindow(m_Window);
 }
 
-void AppWindow::OnUpdate() {
-   glfwWaitEvents();
+void AppWindow::PollEvents() {
+   glfwPollEvents();
+}
+
+void AppWindow::WaitEvents(double timeout) {
+   glfwWaitEventsTimeout(timeout);
+}
+
+void AppWindow::PostEmptyEvent() {
+   glfwPostEmptyEvent();
 }
 
 #endif
@@ -11,24 +11,18 @@
 void FileDialogs::OpenFile(const char *filterName,
                            const std::vector<std::string> &filters,
                            const std::function<void(const std::string&)>& callback) {
-   std::condition_variable cv;
-   std::mutex cv_m;
-   std::string path;
+   std::shared_ptr<std::string> path;
+   if (Application::IsMainThread()) {
+      path = GetFilePath(filters);
+   } else {
+      MainThreadFuture<std::shared_ptr<std::string>> result;
+      Application::ExecuteOnMainThread(result, [&filters]() { return GetFilePath(filters); });
+      result.Wait();
+      path = result.Get();
+   }
 
-   Application::ExecuteOnMainThread([filters]() -> std::shared_ptr<void> {
-      return GetFilePath(filters);
-   }, [callback, &cv, &path](const std::shared_ptr<void> &payload) {
-      if (payload) {
-         path = *std::static_pointer_cast<std::string>(payload);
-//         callback(*std::static_pointer_cast<std::string>(payload));
-      }
-      cv.notify_all();
-   });
-
-   std::unique_lock<std::mutex> lk(cv_m);
-   cv.wait(lk);
-   if (!path.empty())
-      callback(path);
+   if (path && !path->empty())
+      callback(*path);
 }
 
 auto FileDialogs::SaveFile(const char *filterName, const char *filter) -> std::string {
@@ -10,6 +10,7 @@
 #include <Engine/Application.h>
 #include <Engine/Renderer/Material.h>
 #include <Engine/Renderer/Camera.h>
+#include <Engine/Renderer/FramePipeline.h>
 #include <backends/imgui_impl_vulkan.h>
 #include <Engine/Core.h>
 
@@ -17,6 +18,7 @@
 #include "ShaderPipelineVk.h"
 #include "RenderPassVk.h"
 #include "TextureVk.h"
+#include "SyncVk.h"
 
 
 const std::map<ShaderType, const char *> RendererVk::POST_PROCESS_SHADERS{
@@ -35,7 +37,6 @@ const std::map<ShaderType, const char *> RendererVk::SKYBOX_SHADERS{
         {ShaderType::FRAGMENT_SHADER, BASE_DIR "/shaders/skybox.frag.spv"}
 };
 
-uint32_t RendererVk::s_SkyboxTexIdx = 0;
 
 
 void RendererVk::InitializeStaticResources() {
@@ -297,7 +298,9 @@ void RendererVk::AcquireNextImage() {
                                            m_AcquireSemaphores[m_FrameIndex].data(), nullptr,
                                            &m_ImageIndex);
 
-   vkWaitForFences(m_Device, 1, m_Fences[m_FrameIndex].ptr(), VK_TRUE, UINT64_MAX);
+   // Frame work only, asset imports and decodes in the normal lane can run for hundreds of milliseconds
+   vk::WaitForFence(Application::Get().m_TaskSystem, m_Device, m_Fences[m_FrameIndex].data(),
+                    TaskPriority::FRAME_CRITICAL);
    vkResetFences(m_Device, 1, m_Fences[m_FrameIndex].ptr());
 
    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -308,7 +311,19 @@ void RendererVk::AcquireNextImage() {
    }
 }
 
-void RendererVk::DrawFrame() {
+void RendererVk::impl_RenderFrame(FramePacket &packet) {
+   if (packet.resize) {
+      WindowResizeEvent resizeEvent(packet.resize->first, packet.resize->second);
+      impl_OnWindowResize(resizeEvent);
+   }
+
+   AcquireNextImage();
+   packet.ApplyUniformData();
+   packet.ApplySamplerWrites();
+   DrawFrame(packet);
+}
+
+void RendererVk::DrawFrame(FramePacket &packet) {
    static std::unordered_map<BindingKey, uint32_t> uniformObjectOffsets;
 
    vk::CommandBuffer primaryCmdBuffer(m_GfxCmdBuffers[m_ImageIndex]);
@@ -319,14 +334,14 @@ void RendererVk::DrawFrame() {
    vkCmdSetViewport(primaryCmdBuffer.data(), 0, 1, &m_Viewport);
    vkCmdSetScissor(primaryCmdBuffer.data(), 0, 1, &m_Scissor);
 
-   if (s_SkyboxEnabled && s_Skybox) {
-      glm::mat4 PV = s_SceneCamera->GetProjection() * glm::mat4(glm::mat3(s_SceneCamera->GetView()));
+   if (packet.skyboxEnabled && packet.skybox) {
+      glm::mat4 PV = packet.camera.projection * glm::mat4(glm::mat3(packet.camera.view));
 
       m_SkyboxPipeline->Bind(primaryCmdBuffer.data());
       m_SkyboxPipeline->BindDescriptorSets(m_ImageIndex, {});
       m_SkyboxPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_VERTEX_BIT, 0}, PV);
-      m_SkyboxPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 1}, s_SkyboxTexIdx);
-      m_SkyboxPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 2}, s_SkyboxLOD);
+      m_SkyboxPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 1}, packet.skyboxTexIdx);
+      m_SkyboxPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 2}, packet.skyboxLOD);
 
       VkDeviceSize offset = 0;
       vkCmdBindVertexBuffers(primaryCmdBuffer.data(), 0, 1, m_BasicCubeVBO->ptr(), &offset);
@@ -339,7 +354,7 @@ void RendererVk::DrawFrame() {
    std::optional<uint32_t> materialID{};
    std::optional<uint32_t> materialInstanceID{};
 //   vkCmdClearColorImage(primaryCmdBuffer.data(), )
-   while ((cmd = m_CmdQueue.GetNextCommand()) != nullptr) {
+   while ((cmd = packet.commands.GetNextCommand()) != nullptr) {
       switch (cmd->m_Type) {
          case RenderCommand::Type::SET_CLEAR_COLOR: {
             auto clearColor = cmd->UnpackData<math::vec4>();
@@ -372,35 +387,36 @@ void RendererVk::DrawFrame() {
 //                break;
 //            }
          case RenderCommand::Type::BIND_MATERIAL: {
-            auto *material = cmd->UnpackData<Material *>();
-            materialID = material->GetMaterialID();
-            boundPipeline = static_cast<ShaderPipelineVk *>(&material->GetPipeline());
+            auto payload = cmd->UnpackData<BindMaterialPayload>();
+            materialID = payload.materialID;
+            boundPipeline = static_cast<ShaderPipelineVk *>(payload.pipeline);
             boundPipeline->Bind(primaryCmdBuffer.data());
             boundPipeline->BindDescriptorSets(m_ImageIndex, materialID);
             break;
          }
          case RenderCommand::Type::BIND_MESH: {
-            const auto *meshInstance = cmd->UnpackData<const MeshRenderer *>();
-            const auto *mesh = meshInstance->GetMesh();
-            auto it = m_MeshAllocations.find(mesh->MeshID());
-            if (it == m_MeshAllocations.end())
-               assert(false);
-            const auto &meshInfo = it->second;
-            vkCmdBindVertexBuffers(primaryCmdBuffer.data(),
-                                   0,
-                                   1,
-                                   meshInfo.buffer->bufferPtr(),
-                                   &meshInfo.startOffset);
-
-            if (!mesh->Indices().empty()) {
+            auto payload = cmd->UnpackData<BindMeshPayload>();
+            auto buffer = static_cast<VkBuffer>(payload.buffer);
+            VkDeviceSize vertexOffset = payload.vertexOffset;
+            vkCmdBindVertexBuffers(primaryCmdBuffer.data(), 0, 1, &buffer, &vertexOffset);
+
+            if (payload.indexSize > 0) {
                vkCmdBindIndexBuffer(primaryCmdBuffer.data(),
-                                    meshInfo.buffer->buffer(),
-                                    meshInfo.startOffset + mesh->VertexData().size(),
-                                    VK_INDEX_TYPE_UINT32);
+                                    buffer,
+                                    payload.indexOffset,
+                                    payload.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16
+                                                                          : VK_INDEX_TYPE_UINT32);
+            }
+
+            if (static_cast<VertexFormat>(payload.vertexFormat) == VertexFormat::COMPACT) {
+               /// Compact vertex shaders take the position dequantization box as their first two push constants
+               glm::vec4 positionOffset(payload.positionOffset[0], payload.positionOffset[1], payload.positionOffset[2], 0.0f);
+               glm::vec4 positionScale(payload.positionScale[0], payload.positionScale[1], payload.positionScale[2], 0.0f);
+               boundPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_VERTEX_BIT, 0}, positionOffset);
+               boundPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_VERTEX_BIT, 1}, positionScale);
             }
 
-            materialInstanceID = meshInstance->GetMaterialInstance().InstanceID();
-//                auto materialID = meshInstance->GetMaterial();
+            materialInstanceID = payload.materialInstanceID;
 //                boundPipeline->SetDynamicOffsets(instanceID);
 //                boundPipeline->SetDynamicOffsets(mesh->GetMaterialObjectIdx());
             break;
@@ -461,11 +477,11 @@ void RendererVk::DrawFrame() {
 
    m_PostprocessPipeline->Bind(primaryCmdBuffer.data());
    m_PostprocessPipeline->BindDescriptorSets(m_ImageIndex, std::optional<uint32_t>());
-   m_PostprocessPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 0}, s_Exposure);
+   m_PostprocessPipeline->PushConstants(primaryCmdBuffer.data(), {VK_SHADER_STAGE_FRAGMENT_BIT, 0}, packet.exposure);
    vkCmdDraw(primaryCmdBuffer.data(), 3, 1, 0, 0);
 
-   if (m_ImGuiLayer) {
-      ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), primaryCmdBuffer.data());
+   if (ImDrawData *uiDrawData = packet.uiDrawData.DrawData()) {
+      ImGui_ImplVulkan_RenderDrawData(uiDrawData, primaryCmdBuffer.data());
    }
 //    /// ImGui fucks up viewport and scissor and doesn't restore it after the draw -_-
 //    /// TODO: write my own ImGuI renderer
@@ -487,6 +503,8 @@ void RendererVk::DrawFrame() {
    submitInfo.signalSemaphoreCount = 1;
    submitInfo.pSignalSemaphores = m_ReleaseSemaphores[m_FrameIndex].ptr();
 
+   // Asset jobs may use the queue at the same time
+   auto lock = m_Device.Lock();
    VkResult result = vkQueueSubmit(m_Device.GfxQueue(), 1, &submitInfo, m_Fences[m_FrameIndex].data());
    if (result != VK_SUCCESS) {
       std::ostringstream msg;
@@ -523,13 +541,13 @@ void RendererVk::impl_OnWindowResize(WindowResizeEvent &) {
 
 void RendererVk::impl_WaitIdle() const {
    vkDeviceWaitIdle(m_Device);
-   std::cout << currentTime() << "[Renderer] Idle state" << std::endl;
+   LOG_DEBUG("[Renderer] Idle state");
 }
 
 
-void RendererVk::impl_SetSkybox(const TextureCubemap *skybox) {
-   auto texIndices = m_SkyboxPipeline->BindCubemaps({skybox}, BindingKey(0, 0));
-   s_SkyboxTexIdx = texIndices.back();
+auto RendererVk::impl_SetSkybox(const TextureCubemap *skybox) -> uint32_t {
+   auto texIndices = m_SkyboxPipeline->BindCubemaps({skybox}, BindingKey(0, 0), t_BuildPacket);
+   return texIndices.back();
 }
 
 
@@ -538,6 +556,7 @@ void RendererVk::impl_FlushStagedData() {
 
    std::array<VkBufferMemoryBarrier, 1> bufferBarriers = {};
    vk::Semaphore transferSemaphore(m_Device);
+   vk::Fence acquisitionFence(m_Device, false);
    VkSubmitInfo submitInfo = {};
    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -619,9 +638,9 @@ void RendererVk::impl_FlushStagedData() {
       submitInfo.waitSemaphoreCount = 1;
       submitInfo.pWaitSemaphores = transferSemaphore.ptr();
       submitInfo.pWaitDstStageMask = &waitStage;
-      gfxCmdBuffer.Submit(submitInfo, m_Device.queue(QueueFamily::GRAPHICS));
+      gfxCmdBuffer.Submit(submitInfo, m_Device.queue(QueueFamily::GRAPHICS), acquisitionFence.data());
 
-      vkQueueWaitIdle(m_Device.queue(QueueFamily::GRAPHICS));
+      vk::WaitForFence(Application::Get().m_TaskSystem, m_Device, acquisitionFence.data());
    }
 }
 
@@ -45,7 +45,7 @@ public:
 
     void AcquireNextImage();
 
-    void DrawFrame();
+    void DrawFrame(FramePacket &packet);
 
     void RecreateSwapchain();
 
@@ -59,7 +59,7 @@ public:
 
     auto impl_GetImageIndex() const -> size_t override { return m_ImageIndex; }
 
-    void impl_SetSkybox(const TextureCubemap* skybox) override;
+    auto impl_SetSkybox(const TextureCubemap* skybox) -> uint32_t override;
 
 //    void impl_StageData(void* dstBuffer, uint64_t* dstOffset, const void *data, uint64_t bytes) override {
 //        m_StageBuffer.StageData(static_cast<vk::Buffer **>(dstBuffer), dstOffset, data, bytes);
@@ -71,6 +71,13 @@ public:
         m_StageBuffer.StageMesh(mesh);
     }
 
+    auto impl_GetMeshAllocation(const Mesh *mesh) const -> BufferAllocation override {
+        auto it = m_MeshAllocations.find(mesh->MeshID());
+        if (it == m_MeshAllocations.end() || !it->second.buffer)
+            return {};
+        return {nullptr, it->second.buffer->buffer(), it->second.startOffset};
+    }
+
     auto impl_AllocateUniformBuffer(uint64_t size) -> BufferAllocation override {
         return {m_UniformBuffer.memory(),
                 m_UniformBuffer.buffer(),
@@ -90,7 +97,6 @@ private:
     static const std::map<ShaderType, const char *> POST_PROCESS_SHADERS;
     static const std::map<ShaderType, const char *> NORMALDEBUG_SHADERS;
     static const std::map<ShaderType, const char *> SKYBOX_SHADERS;
-    static uint32_t s_SkyboxTexIdx;
 
     const size_t MAX_FRAMES_IN_FLIGHT = 2;
 
@@ -148,15 +154,7 @@ private:
 
     void CreateSynchronizationPrimitives();
 
-    void impl_NextFrame() override {
-        AcquireNextImage();
-        if (m_ImGuiLayer) m_ImGuiLayer->NewFrame();
-    }
-
-    void impl_PresentFrame() override {
-        if (m_ImGuiLayer) m_ImGuiLayer->EndFrame();
-        DrawFrame();
-    }
+    void impl_RenderFrame(FramePacket &packet) override;
 
     void CreateImageResources(const vk::Swapchain & swapchain);
 };
@@ -585,7 +585,8 @@ void ShaderPipelineVk::BindUniformBuffer(const UniformBuffer *buffer, BindingKey
 
 auto ShaderPipelineVk::BindImageViews(const std::vector<VkImageView> &textures,
                                       BindingKey bindingKey,
-                                      SamplerBinding::Type type) -> std::vector<uint32_t> {
+                                      SamplerBinding::Type type,
+                                      FramePacket *packet) -> std::vector<uint32_t> {
 
    auto bindingIt = m_ShaderSamplers.find(bindingKey);
    if (bindingIt == m_ShaderSamplers.end()) {
@@ -628,13 +629,24 @@ auto ShaderPipelineVk::BindImageViews(const std::vector<VkImageView> &textures,
 
    boundTextures.insert(boundTextures.end(), textures.begin(), textures.end());
 
+   /// Descriptor sets are recorded by the render stage, so the write has to wait for the packet's frame
+   if (packet)
+      packet->CaptureSamplerWrite(this, bindingKey, boundTextures);
+   else
+      impl_WriteSamplers(bindingKey, boundTextures);
+
+   return texIndices;
+}
+
+
+void ShaderPipelineVk::impl_WriteSamplers(BindingKey bindingKey, const std::vector<VkImageView> &views) const {
    auto imgCount = m_Context.Swapchain().ImageCount();
    auto layoutCount = m_DescriptorSetLayouts.size();
 
-   std::vector<VkDescriptorImageInfo> textureDescriptors(boundTextures.size());
-   for (size_t i = 0; i < boundTextures.size(); i++) {
+   std::vector<VkDescriptorImageInfo> textureDescriptors(views.size());
+   for (size_t i = 0; i < views.size(); i++) {
       textureDescriptors[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      textureDescriptors[i].imageView = boundTextures[i];
+      textureDescriptors[i].imageView = views[i];
       textureDescriptors[i].sampler = m_Sampler->data();
    }
 
@@ -647,34 +659,34 @@ auto ShaderPipelineVk::BindImageViews(const std::vector<VkImageView> &textures,
       writeDescriptorSets[i].dstBinding = bindingKey.Binding();
       writeDescriptorSets[i].dstArrayElement = 0;
       writeDescriptorSets[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      writeDescriptorSets[i].descriptorCount = boundTextures.size();
+      writeDescriptorSets[i].descriptorCount = views.size();
       writeDescriptorSets[i].pImageInfo = textureDescriptors.data();
    }
 
    vkUpdateDescriptorSets(m_Device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
-
-   return texIndices;
 }
 
 
 auto ShaderPipelineVk::BindTextures2D(const std::vector<const Texture2D *> &textures,
-                                      BindingKey bindingKey) -> std::vector<uint32_t> {
+                                      BindingKey bindingKey,
+                                      FramePacket *packet) -> std::vector<uint32_t> {
    std::vector<VkImageView> textureImageViews(textures.size());
    std::transform(textures.begin(), textures.end(), textureImageViews.begin(), [](const Texture2D *tex) {
       return static_cast<const Texture2DVk *>(tex)->View().data();
    });
-   return BindTextures2D(textureImageViews, bindingKey);
+   return BindImageViews(textureImageViews, bindingKey, SamplerBinding::Type::SAMPLER_2D, packet);
 }
 
 
 auto ShaderPipelineVk::BindCubemaps(const std::vector<const TextureCubemap *> &cubemaps,
-                                    BindingKey bindingKey) -> std::vector<uint32_t> {
+                                    BindingKey bindingKey,
+                                    FramePacket *packet) -> std::vector<uint32_t> {
 
    std::vector<VkImageView> textureImageViews(cubemaps.size());
    std::transform(cubemaps.begin(), cubemaps.end(), textureImageViews.begin(), [](const TextureCubemap *tex) {
       return static_cast<const TextureCubemapVk *>(tex)->View().data();
    });
-   return BindCubemaps(textureImageViews, bindingKey);
+   return BindImageViews(textureImageViews, bindingKey, SamplerBinding::Type::SAMPLER_CUBE, packet);
 
 //    /// Update binding metadata and return continuous indices of newly bound textures
 //    VkImageView textureView = static_cast<const TextureCubemapVk *>(cubemaps)->View().data();
@@ -93,7 +93,10 @@ class ShaderPipelineVk : public ShaderPipeline {
 
     auto BindImageViews(const std::vector<VkImageView> &textures,
                         BindingKey bindingKey,
-                        SamplerBinding::Type type) -> std::vector<uint32_t>;
+                        SamplerBinding::Type type,
+                        FramePacket *packet) -> std::vector<uint32_t>;
+
+    void impl_WriteSamplers(BindingKey bindingKey, const std::vector<VkImageView> &views) const override;
 
 public:
     ShaderPipelineVk(std::string name,
@@ -127,17 +130,19 @@ public:
     void BindDescriptorSets(uint32_t imageIndex, std::optional<uint32_t> materialID);
 
     auto BindTextures2D(const std::vector<const Texture2D *> &textures,
-                        BindingKey bindingKey) -> std::vector<uint32_t> override;
+                        BindingKey bindingKey,
+                        FramePacket *packet = nullptr) -> std::vector<uint32_t> override;
 
     auto BindCubemaps(const std::vector<const TextureCubemap *> &cubemaps,
-                      BindingKey bindingKey) -> std::vector<uint32_t> override;
+                      BindingKey bindingKey,
+                      FramePacket *packet = nullptr) -> std::vector<uint32_t> override;
 
     auto BindTextures2D(const std::vector<VkImageView> &textures, BindingKey bindingKey) -> std::vector<uint32_t> {
-        return BindImageViews(textures, bindingKey, SamplerBinding::Type::SAMPLER_2D);
+        return BindImageViews(textures, bindingKey, SamplerBinding::Type::SAMPLER_2D, nullptr);
     }
 
     auto BindCubemaps(const std::vector<VkImageView> &cubemaps, BindingKey bindingKey) -> std::vector<uint32_t> {
-        return BindImageViews(cubemaps, bindingKey, SamplerBinding::Type::SAMPLER_CUBE);
+        return BindImageViews(cubemaps, bindingKey, SamplerBinding::Type::SAMPLER_CUBE, nullptr);
     }
 
     void BindUniformBuffer(const UniformBuffer *buffer, BindingKey bindingKey) override;
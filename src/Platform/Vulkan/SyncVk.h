@@ -0,0 +1,45 @@
+#ifndef VULKAN_SYNC_VK_H
+#define VULKAN_SYNC_VK_H
+
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include <Engine/Core/TaskSystem.h>
+#include <Engine/Renderer/vulkan_wrappers.h>
+#include "CoreVk.h"
+
+
+namespace vk {
+    /**
+     * Waits for the fence like vkWaitForFences without a timeout, but the calling thread keeps running
+     * pending tasks of the given lanes until the fence signals, see TaskSystem::WaitExternal().
+     */
+    inline void WaitForFence(TaskSystem &taskSystem, VkDevice device, VkFence fence,
+                             TaskPriority lowest = TaskPriority::BACKGROUND) {
+       VkResult result = VK_SUCCESS;
+       taskSystem.WaitExternal([&](uint64_t timeoutNs) {
+          result = vkWaitForFences(device, 1, &fence, VK_TRUE, timeoutNs);
+          return result != VK_TIMEOUT;
+       }, lowest);
+
+       if (result != VK_SUCCESS)
+          throw std::runtime_error("[vkWaitForFences] Failed to wait for fence: " + errorString(result));
+    }
+
+
+    /**
+     * Replacement of Submit() followed by vkQueueWaitIdle, only this command buffer is waited for.
+     * The caller keeps holding the device lock and no tasks are run during the wait: the operation may
+     * still be using shared pipelines and descriptor sets, and a task could need the device itself.
+     */
+    inline void SubmitAndWait(VkDevice device, const CommandBuffer &cmdBuffer, VkQueue queue) {
+       Fence fence(device, false);
+       cmdBuffer.Submit(queue, fence.data());
+
+       VkResult result = vkWaitForFences(device, 1, fence.ptr(), VK_TRUE, UINT64_MAX);
+       if (result != VK_SUCCESS)
+          throw std::runtime_error("[vkWaitForFences] Failed to wait for fence: " + errorString(result));
+    }
+}
+
+
+#endif //VULKAN_SYNC_VK_H
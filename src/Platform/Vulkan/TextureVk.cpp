@@ -5,6 +5,7 @@
 #include "GraphicsContextVk.h"
 #include "RenderPassVk.h"
 #include "ShaderPipelineVk.h"
+#include "SyncVk.h"
 
 using namespace vk;
 
@@ -46,6 +47,8 @@ auto PrepareTextureImage(uint32_t width,
    imageInfo.usage = usage;
    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+   auto lock = device.Lock();
    return device.createImage(imageInfo);
 }
 
@@ -116,6 +119,7 @@ void Texture2DVk::Upload() {
    auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
 
    Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
 
    m_TextureMemory = device.allocateImageMemory({m_TextureImage}, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
    m_TextureImage->BindMemory(m_TextureMemory->data(), 0);
@@ -153,14 +157,14 @@ void Texture2DVk::Upload() {
    m_TextureImage->GenerateMipmaps(device, setupCmdBuffer);
 
    setupCmdBuffer.End();
-   setupCmdBuffer.Submit(device.GfxQueue());
-   vkQueueWaitIdle(device.GfxQueue());
+   SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
 }
 
 
 std::unique_ptr<Texture2DVk> Texture2DVk::GenerateBrdfLut(uint32_t resolution) {
    auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
    Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
 
    auto lut = std::make_unique<Texture2DVk>(resolution, 2, VK_FORMAT_R16G16_SFLOAT);
 
@@ -200,8 +204,7 @@ std::unique_ptr<Texture2DVk> Texture2DVk::GenerateBrdfLut(uint32_t resolution) {
    s_Renderpass->End(setupCmdBuffer);
 
    setupCmdBuffer.End();
-   setupCmdBuffer.Submit(device.GfxQueue());
-   vkQueueWaitIdle(device.GfxQueue());
+   SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
 
    return lut;
 }
@@ -395,6 +398,7 @@ TextureCubemapVk::TextureCubemapVk(uint32_t width, uint32_t height, uint32_t max
 void TextureCubemapVk::Upload() {
    auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
    Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
    m_TextureMemory = device.allocateImageMemory({m_TextureImage}, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
    m_TextureImage->BindMemory(m_TextureMemory->data(), 0);
 //    vkBindImageMemory(device, m_TextureImage->data(), m_TextureMemory->data(), 0);
@@ -431,14 +435,14 @@ void TextureCubemapVk::Upload() {
 
 
    setupCmdBuffer.End();
-   setupCmdBuffer.Submit(device.GfxQueue());
-   vkQueueWaitIdle(device.GfxQueue());
+   SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
 }
 
 
 void TextureCubemapVk::HDRtoCubemap() {
    auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
    Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
 
    if (!s_CubemapRenderpass) {
       TextureCubemapVk::InitResources();
@@ -602,12 +606,15 @@ void TextureCubemapVk::HDRtoCubemap() {
 
    m_TextureImage->GenerateMipmaps(device, setupCmdBuffer);
    setupCmdBuffer.End();
-   setupCmdBuffer.Submit(device.GfxQueue());
-   vkQueueWaitIdle(device.GfxQueue());
+   SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
 }
 
 
 auto TextureCubemapVk::CreateIrradianceCubemap(uint32_t resolution) -> TextureCubemap * {
+   auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
+   Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
+
    if (!s_CubemapRenderpass) {
       TextureCubemapVk::InitResources();
    }
@@ -618,9 +625,6 @@ auto TextureCubemapVk::CreateIrradianceCubemap(uint32_t resolution) -> TextureCu
       return it->second.get();
    }
 
-   auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
-   Device &device = gfxContext.GetDevice();
-
    auto irradianceMap = std::make_unique<TextureCubemapVk>(resolution, resolution, 1);
 
    const size_t cubeFaceCount = 6;
@@ -705,8 +709,7 @@ auto TextureCubemapVk::CreateIrradianceCubemap(uint32_t resolution) -> TextureCu
       s_CubemapRenderpass->End(setupCmdBuffer);
 
       setupCmdBuffer.End();
-      setupCmdBuffer.Submit(device.GfxQueue());
-      vkQueueWaitIdle(device.GfxQueue());
+      SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
       vkResetCommandBuffer(setupCmdBuffer.data(), 0);
    }
 
@@ -719,15 +722,16 @@ auto TextureCubemapVk::CreateIrradianceCubemap(uint32_t resolution) -> TextureCu
 }
 
 auto TextureCubemapVk::CreatePrefilteredCubemap(uint32_t baseResolution, uint32_t maxMipLevels) -> TextureCubemap * {
+   auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
+   Device &device = gfxContext.GetDevice();
+   auto lock = device.Lock();
+
    static std::unordered_map<TextureCubemapVk *, std::shared_ptr<TextureCubemap>> loadedTextures;
    auto it = loadedTextures.find(this);
    if (it != loadedTextures.end()) {
       return it->second.get();
    }
 
-   auto &gfxContext = static_cast<GfxContextVk &>(Application::GetGraphicsContext());
-   Device &device = gfxContext.GetDevice();
-
    auto prefilteredMap = std::make_unique<TextureCubemapVk>(baseResolution, baseResolution, maxMipLevels);
    uint32_t faceMipLevels = std::min(prefilteredMap->m_TextureImage->Info().mipLevels, maxMipLevels);
 
@@ -848,8 +852,7 @@ auto TextureCubemapVk::CreatePrefilteredCubemap(uint32_t baseResolution, uint32_
    }
 
    setupCmdBuffer.End();
-   setupCmdBuffer.Submit(device.GfxQueue());
-   vkQueueWaitIdle(device.GfxQueue());
+   SubmitAndWait(device, setupCmdBuffer, device.GfxQueue());
 
    it = loadedTextures.emplace(this, std::move(prefilteredMap)).first;
    return it->second.get();
@@ -31,7 +31,7 @@ void UniformBufferVk::Allocate(size_t objectCount) {
 }
 
 
-void UniformBufferVk::SetData(const void *objectData, size_t objectCount, uint32_t offset) const {
+void UniformBufferVk::impl_SetData(const void *objectData, size_t objectCount, uint32_t offset) const {
     auto frameOffset = m_BaseOffset + m_BufferSubSize * Renderer::GetImageIndex();
 
     void *memoryPtr = nullptr;
@@ -53,7 +53,7 @@ void UniformBufferVk::SetData(const void *objectData, size_t objectCount, uint32
     vkUnmapMemory(*m_Device, m_Memory);
 }
 
-void UniformBufferVk::SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const {
+void UniformBufferVk::impl_SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const {
     void *mappedPtr = nullptr;
     vkMapMemory(*m_Device, m_Memory, m_BaseOffset, m_BufferSize - m_BaseOffset, 0, &mappedPtr);
 
@@ -15,6 +15,11 @@ class UniformBufferVk : public UniformBuffer {
     uint32_t m_ImageCount = 0;
     bool m_PerObject = false;
 
+protected:
+    void impl_SetData(const void *objectData, size_t objectCount, uint32_t offset) const override;
+
+    void impl_SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const override;
+
 public:
     explicit UniformBufferVk(std::string name, size_t objectSize, bool perObject);
 
@@ -27,10 +32,6 @@ public:
     auto BaseOffset() const -> auto { return m_BaseOffset; }
 
     auto IsDynamic() const -> bool { return m_PerObject; }
-
-    void SetData(const void *objectData, size_t objectCount, uint32_t offset) const override;
-
-    void SetMemberData(const void *memberData, uint32_t memberBytes, uint32_t memberOffset) const override;
 };
 
 
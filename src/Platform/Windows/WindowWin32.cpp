@@ -4,9 +4,7 @@
 
 #include <GLFW/glfw3.h>
 #include <Engine/Renderer/utils.h>
-#include <Engine/Events/WindowEvents.h>
-#include <Engine/Events/KeyEvents.h>
-#include <Engine/Events/MouseEvents.h>
+#include <Engine/Events/EventChannel.h>
 
 
 AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
@@ -24,27 +22,27 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       windowWin32->m_Width = newWidth;
       windowWin32->m_Height = newHeight;
-      windowWin32->m_EventCallback(std::make_unique<WindowResizeEvent>(newWidth, newHeight));
+      windowWin32->m_EventCallback(EventRecord::WindowResize(newWidth, newHeight));
    });
 
    glfwSetWindowCloseCallback(m_Window, [](GLFWwindow* window) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowWin32->m_EventCallback(std::make_unique<WindowCloseEvent>());
+      windowWin32->m_EventCallback(EventRecord::WindowClose());
    });
 
    glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int key, int, int action, int) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       switch (action) {
          case GLFW_PRESS:
-            windowWin32->m_EventCallback(std::make_unique<KeyPressEvent>(key, 0));
+            windowWin32->m_EventCallback(EventRecord::KeyPress(key, 0));
             break;
 
          case GLFW_RELEASE:
-            windowWin32->m_EventCallback(std::make_unique<KeyReleaseEvent>(key));
+            windowWin32->m_EventCallback(EventRecord::KeyRelease(key));
             break;
 
          case GLFW_REPEAT:
-            windowWin32->m_EventCallback(std::make_unique<KeyPressEvent>(key, 1));
+            windowWin32->m_EventCallback(EventRecord::KeyPress(key, 1));
             break;
 
          default:
@@ -56,11 +54,11 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       switch (action) {
          case GLFW_PRESS:
-            windowWin32->m_EventCallback(std::make_unique<MouseButtonPressEvent>(button));
+            windowWin32->m_EventCallback(EventRecord::MouseButtonPress(button));
             break;
 
          case GLFW_RELEASE:
-            windowWin32->m_EventCallback(std::make_unique<MouseButtonReleaseEvent>(button));
+            windowWin32->m_EventCallback(EventRecord::MouseButtonRelease(button));
             break;
 
          default:
@@ -71,23 +69,27 @@ AppWindow::AppWindow(uint32_t width, uint32_t height, const char* title) {
    glfwSetScrollCallback(m_Window, [](GLFWwindow* window, double offsetX, double offsetY) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
       windowWin32->m_EventCallback(
-              std::make_unique<MouseScrollEvent>(static_cast<float>(offsetX), static_cast<float>(offsetY)));
+              EventRecord::MouseScroll(static_cast<float>(offsetX), static_cast<float>(offsetY)));
    });
 
    glfwSetCursorPosCallback(m_Window, [](GLFWwindow* window, double x, double y) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowWin32->m_EventCallback(std::make_unique<MouseMoveEvent>(static_cast<float>(x), static_cast<float>(y)));
+      windowWin32->m_EventCallback(EventRecord::MouseMove(static_cast<float>(x), static_cast<float>(y)));
    });
 
    glfwSetCharCallback(m_Window, [](GLFWwindow* window, unsigned int keycode) {
       auto* windowWin32 = static_cast<AppWindow*>(glfwGetWindowUserPointer(window));
-      windowWin32->m_EventCallback(std::make_unique<CharacterPressEvent>(keycode));
+      windowWin32->m_EventCallback(EventRecord::CharacterPress(keycode));
    });
 }
 
 
 AppWindow::~AppWindow() { glfwDestroyWindow(m_Window); }
 
-void AppWindow::OnUpdate() { glfwWaitEvents(); }
+void AppWindow::PollEvents() { glfwPollEvents(); }
+
+void AppWindow::WaitEvents(double timeout) { glfwWaitEventsTimeout(timeout); }
+
+void AppWindow::PostEmptyEvent() { glfwPostEmptyEvent(); }
 
 #endif
\ No newline at end of file
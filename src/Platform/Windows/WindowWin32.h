@@ -11,10 +11,10 @@
 
 struct GLFWwindow;
 
-class Event;
+struct EventRecord;
 
 class AppWindow {
-    using EventCallbackFn = std::function<void(std::unique_ptr<Event>)>;
+    using EventCallbackFn = std::function<void(const EventRecord &)>;
 
     uint32_t m_Width = 1280;
     uint32_t m_Height = 720;
@@ -33,7 +33,13 @@ public:
 
     ~AppWindow();
 
-    void OnUpdate();
+    void PollEvents();
+
+    /// Blocks until an event arrives, PostEmptyEvent() is called or the timeout in seconds expires
+    void WaitEvents(double timeout);
+
+    /// Wakes WaitEvents() up, can be called from any thread
+    static void PostEmptyEvent();
 
     auto Width() const -> uint32_t { return m_Width; };
 
@@ -1,5 +1,6 @@
 #include <vector>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <Engine/Include/Engine.h>
@@ -45,6 +46,8 @@ class TestLayer : public Layer {
     const char *BACKPACK_MODEL_ASSET_PATH = BASE_DIR "/models/backpack.obj";
     const char *CAR_MODEL_ASSET_PATH = BASE_DIR "/models/car.obj";
     const char *CERBERUS_MODEL_ASSET_PATH = BASE_DIR "/models/Cerberus_LP.FBX";
+    /// Imported models are drawn by the PBR shader variant matching this format
+    const VertexFormat MODEL_VERTEX_FORMAT = VertexFormat::COMPACT;
     const char *MODEL_PATH = BASE_DIR "/models/chalet.obj";
     const char *CHALET_TEXTURE_PATH = BASE_DIR "/textures/chalet.jpg";
 
@@ -116,6 +119,7 @@ class TestLayer : public Layer {
 
     const char *phongVertShaderPath = BASE_DIR "/shaders/cube.vert.spv";
     const char *phongFragShaderPath = BASE_DIR "/shaders/cube.frag.spv";
+    const char *compactVertShaderPath = BASE_DIR "/shaders/cubeCompact.vert.spv";
 
     const char *vertLightShader = BASE_DIR "/shaders/lightCube.vert.spv";
     const char *fragLightShader = BASE_DIR "/shaders/lightCube.frag.spv";
@@ -185,6 +189,8 @@ class TestLayer : public Layer {
     float m_MouseSensitivity = 0.2f;
     float m_MoveSpeed = 3.0f;
 
+    TaskProfilerPanel m_TaskProfilerPanel;
+
     std::shared_ptr<Material> m_PbrMaterial;
     std::shared_ptr<Material> m_PbrMaterialStrips;
 
@@ -273,8 +279,13 @@ public:
        msState.sampleShadingEnable = VK_TRUE;
        msState.minSampleShading = 0.2f;
 
+       std::map<ShaderType, const char *> modelShaderStages{
+               {ShaderType::VERTEX_SHADER,   MODEL_VERTEX_FORMAT == VertexFormat::COMPACT ? compactVertShaderPath
+                                                                                         : phongVertShaderPath},
+               {ShaderType::FRAGMENT_SHADER, phongFragShaderPath}
+       };
        m_Shaders.emplace_back(ShaderPipeline::Create("PBR Shader",
-                                                     shaderStages,
+                                                     modelShaderStages,
                                                      {{0, 0},
                                                       m_PbrUboKey},
                                                      Renderer::GetRenderPass(),
@@ -300,27 +311,66 @@ public:
 
        m_SelectedSkybox = SKYBOX_HDR_TEXTURE;
        m_SelectedSkyboxName = m_SelectedSkybox.substr(m_SelectedSkybox.rfind('/') + 1);
-       std::future<void> asyncResult = Application::Get().m_TaskSystem.Async([&]() {
+       // Startup assets form one dependency graph, independent branches are loaded concurrently
+       TaskGraph assetGraph;
+       auto hdrToCubemap = assetGraph.Add("HDR to cubemap", [&]() {
           m_SkyboxHdrTexture = TextureCubemap::CreateFromHDR(m_SelectedSkybox, 256);
+       });
+       assetGraph.Then(hdrToCubemap, "Irradiance cubemap", [&]() {
           m_SkyboxIrradianceTexture = m_SkyboxHdrTexture->CreateIrradianceCubemap(256);
+       });
+       assetGraph.Then(hdrToCubemap, "Prefiltered environment map", [&]() {
           m_PrefilteredEnvMap = m_SkyboxHdrTexture->CreatePrefilteredCubemap(256, 5);
+       });
+       assetGraph.Add("BRDF LUT", [&]() {
           m_BrdfLut = Texture2D::GenerateBrdfLut(256);
        });
-       asyncResult.wait();
+
+       struct TextureJob {
+          std::unordered_map<Texture2D::Type, const Texture2D *> *target;
+          Texture2D::Type type;
+          const char *path;
+          VkFormat format;
+          bool flipOnLoad;
+          const Texture2D *result = nullptr;
+       };
+       std::vector<TextureJob> textureJobs;
+       auto addTextureJobs = [&textureJobs](auto &target, const auto &textures, bool flipOnLoad) {
+          for (const auto&[type, tex]: textures) {
+             textureJobs.push_back({&target, type, tex.first, tex.second, flipOnLoad});
+          }
+       };
+       addTextureJobs(m_CerberusTextures, CERBERUS_PBR_TEXTURES, false);
+       addTextureJobs(m_CarTextures, CAR_PBR_TEXTURES, false);
+       addTextureJobs(m_BrickwallTextures, BRICKWALL_TEXTURES, true);
+       addTextureJobs(m_SphereTextures, RUSTED_IRON_PBR_TEXTURES, true);
+       // Jobs reference vector elements, it must not reallocate from here on
+       for (auto &job : textureJobs) {
+          assetGraph.Add(std::string("Texture ") + job.path, [&job]() {
+             job.result = Texture2D::Create(job.path, job.format, job.flipOnLoad);
+          });
+       }
+
+       std::shared_ptr<ModelAsset> cerberusImport, carImport;
+       assetGraph.Add("Import Cerberus", [&]() {
+          cerberusImport = ModelAsset::LoadModel(CERBERUS_MODEL_ASSET_PATH, MODEL_VERTEX_FORMAT);
+       });
+       assetGraph.Add("Import Car", [&]() {
+          carImport = ModelAsset::LoadModel(CAR_MODEL_ASSET_PATH, MODEL_VERTEX_FORMAT);
+       });
+
+       assetGraph.Run(Application::Get().m_TaskSystem);
+       assetGraph.Wait();
+       LOG_INFO("[TestLayer] Startup assets loaded in {} ms (critical path {} ms, serial {} ms)",
+                std::chrono::duration<double, std::milli>(assetGraph.WallTime()).count(),
+                std::chrono::duration<double, std::milli>(assetGraph.CriticalPathTime()).count(),
+                std::chrono::duration<double, std::milli>(assetGraph.TotalTaskTime()).count());
+
 //        m_SkyboxTexture = TextureCubemap::Create(SKYBOX_TEXTURE_PATHS);
        Renderer::SetSkybox(m_SkyboxHdrTexture);
 
-       for (const auto&[type, tex]: CERBERUS_PBR_TEXTURES) {
-          m_CerberusTextures.emplace(type, Texture2D::Create(tex.first, tex.second, false));
-       }
-       for (const auto&[type, tex]: CAR_PBR_TEXTURES) {
-          m_CarTextures.emplace(type, Texture2D::Create(tex.first, tex.second, false));
-       }
-       for (const auto&[type, tex]: BRICKWALL_TEXTURES) {
-          m_BrickwallTextures.emplace(type, Texture2D::Create(tex.first, tex.second, true));
-       }
-       for (const auto&[type, tex]: RUSTED_IRON_PBR_TEXTURES) {
-          m_SphereTextures.emplace(type, Texture2D::Create(tex.first, tex.second, true));
+       for (const auto &job : textureJobs) {
+          job.target->emplace(job.type, job.result);
        }
        m_SphereTextures[Texture2D::Type::BRDF_LUT] = m_BrdfLut.get();
        m_CerberusTextures[Texture2D::Type::BRDF_LUT] = m_BrdfLut.get();
@@ -429,7 +479,7 @@ public:
 
 
        m_Entities.emplace_back("Cerberus");
-       m_ModelAssets.emplace_back(ModelAsset::LoadModel(CERBERUS_MODEL_ASSET_PATH));
+       m_ModelAssets.emplace_back(std::move(cerberusImport));
        auto cerberusAsset = m_ModelAssets.back();
        cerberusAsset->StageMeshes();
        auto &cerberusEntity = m_Entities.back();
@@ -442,7 +492,7 @@ public:
 
 
        m_Entities.emplace_back("Car");
-       m_ModelAssets.emplace_back(ModelAsset::LoadModel(CAR_MODEL_ASSET_PATH));
+       m_ModelAssets.emplace_back(std::move(carImport));
        auto carAsset = m_ModelAssets.back();
        carAsset->StageMeshes();
        auto &carEntity = m_Entities.back();
@@ -822,7 +872,7 @@ public:
 
        if (ImGui::Button("Select skybox")) {
           FileDialogs::OpenFile("High Dynamic Range (.hdr)", {"hdr"}, [&](const std::string &path) {
-             Log() << "Opening file: " << path << std::endl;
+             LOG_INFO("Opening file: {}", path);
              m_SelectedSkybox = path;
              m_SelectedSkyboxName = m_SelectedSkybox.substr(m_SelectedSkybox.rfind('/') + 1);
 
@@ -870,6 +920,53 @@ public:
 
        ImGui::End();
 
+       auto frameStats = Application::Get().GetFrameStats();
+       bool pipelined = Application::Get().GetFrameMode() == Application::FrameMode::PIPELINED;
+       ImGui::Begin("Frame statistics");
+       ImGui::Text("Mode:       %s", pipelined ? "Pipelined" : "Serial");
+       ImGui::Text("FPS:        %.1f", frameStats.Fps());
+       ImGui::Text("Frame time: %.2f ms (max %.2f ms)", frameStats.frameMs, frameStats.maxFrameMs);
+       ImGui::Text("Update:     %.2f ms", frameStats.updateMs);
+       ImGui::Text("Render:     %.2f ms", frameStats.renderMs);
+       ImGui::Text("Latency:    %.2f ms (max %.2f ms)", frameStats.latencyMs, frameStats.maxLatencyMs);
+
+       auto eventStats = Application::Get().GetWindowEventStats();
+       ImGui::Separator();
+       ImGui::Text("Window events: %llu (queued %llu, max %llu)", (unsigned long long) eventStats.posted,
+                   (unsigned long long) eventStats.depth, (unsigned long long) eventStats.maxDepth);
+       ImGui::Text("Dropped: %llu, coalesced moves: %llu", (unsigned long long) eventStats.dropped,
+                   (unsigned long long) eventStats.coalescedMoves);
+
+       auto mainLoopStats = Application::Get().GetMainLoopStats();
+       bool waiting = Application::Get().GetMainLoopMode() == Application::MainLoopMode::WAIT;
+       ImGui::Separator();
+       ImGui::Text("Main loop:  %s, CPU %.1f%%", waiting ? "waiting" : "polling", mainLoopStats.cpuUsage * 100.0f);
+       ImGui::Text("Iterations: %llu (woken %llu)", (unsigned long long) mainLoopStats.iterations,
+                   (unsigned long long) mainLoopStats.wakeups);
+
+       const LodStats &lodStats = Renderer::GetLodStats();
+       bool lodSelection = Renderer::IsLodSelectionEnabled();
+       float lodThreshold = Renderer::GetLodPixelThreshold();
+       float lodHysteresis = Renderer::GetLodHysteresis();
+       ImGui::Separator();
+       if (ImGui::Checkbox("LOD selection", &lodSelection))
+          Renderer::SetLodSelectionEnabled(lodSelection);
+       if (ImGui::DragFloat("LOD error [px]", &lodThreshold, 0.05f, 0.1f, 16.0f))
+          Renderer::SetLodPixelThreshold(lodThreshold);
+       if (ImGui::DragFloat("LOD hysteresis", &lodHysteresis, 0.01f, 0.0f, 0.9f))
+          Renderer::SetLodHysteresis(lodHysteresis);
+       double triangleRatio = lodStats.fullDetailTriangles ?
+                              double(lodStats.triangles) / double(lodStats.fullDetailTriangles) : 1.0;
+       ImGui::Text("Triangles:  %llu of %llu (%.1f%%)", (unsigned long long) lodStats.triangles,
+                   (unsigned long long) lodStats.fullDetailTriangles, triangleRatio * 100.0);
+       for (size_t level = 0; level < lodStats.drawsPerLod.size(); level++) {
+          if (lodStats.drawsPerLod[level])
+             ImGui::Text("LOD %zu:      %u draws", level, lodStats.drawsPerLod[level]);
+       }
+       ImGui::End();
+
+       m_TaskProfilerPanel.Draw(Application::Get().m_TaskSystem);
+
        ImGui::Begin("Properties");
        if (selectedEntity) {
           auto &instance = selectedEntity->MeshRenderers()[0].GetMaterialInstance();
@@ -924,7 +1021,7 @@ public:
 
              if (ImGui::Button("Select Normal Texture")) {
                 FileDialogs::OpenFile("", {"tga", "png", "jpg"}, [&](const std::string &path) {
-                   Log() << "Loading normal texture: " << path << std::endl;
+                   LOG_INFO("Loading normal texture: {}", path);
                    m_UserTextures.emplace(Texture2D::Type::NORMAL,
                                           Texture2D::Create(path.c_str(), VK_FORMAT_R8G8B8A8_UNORM, true));
                    auto texIndices = material->BindTextures(m_UserTextures, {1, 0});
@@ -934,7 +1031,7 @@ public:
 
              if (ImGui::Button("Select Albedo Texture")) {
                 FileDialogs::OpenFile("", {"tga", "png", "jpg"}, [&](const std::string &path) {
-                   Log() << "Loading albedo texture: " << path << std::endl;
+                   LOG_INFO("Loading albedo texture: {}", path);
                    m_UserTextures.emplace(Texture2D::Type::ALBEDO,
                                           Texture2D::Create(path.c_str(), VK_FORMAT_R8G8B8A8_UNORM, true));
                    auto texIndices = material->BindTextures(m_UserTextures, {1, 0});
@@ -944,7 +1041,7 @@ public:
 
              if (ImGui::Button("Select Metallic Texture")) {
                 FileDialogs::OpenFile("", {"tga", "png", "jpg"}, [&](const std::string &path) {
-                   Log() << "Loading metallic texture: " << path << std::endl;
+                   LOG_INFO("Loading metallic texture: {}", path);
                    m_UserTextures.emplace(Texture2D::Type::METALLIC,
                                           Texture2D::Create(path.c_str(), VK_FORMAT_R8G8B8A8_UNORM, true));
                    auto texIndices = material->BindTextures(m_UserTextures, {1, 0});
@@ -954,7 +1051,7 @@ public:
 
              if (ImGui::Button("Select Roughness Texture")) {
                 FileDialogs::OpenFile("", {"tga", "png", "jpg"}, [&](const std::string &path) {
-                   Log() << "Loading roughness texture: " << path << std::endl;
+                   LOG_INFO("Loading roughness texture: {}", path);
                    m_UserTextures.emplace(Texture2D::Type::ROUGHNESS,
                                           Texture2D::Create(path.c_str(), VK_FORMAT_R8G8B8A8_UNORM, true));
                    auto texIndices = material->BindTextures(m_UserTextures, m_TexSamplerKey);
@@ -1116,11 +1213,43 @@ public:
 };
 
 
+/**
+ * SANDBOX_WORKERS=<count>, SANDBOX_AFFINITY=none|restricted|pinned and SANDBOX_RENDER_PRIORITY=high
+ * select the thread layout without rebuilding, defaults leave placement to the OS scheduler.
+ */
+static auto ThreadConfigFromEnvironment() -> ThreadConfig {
+   ThreadConfig config;
+   if (const char *workers = std::getenv("SANDBOX_WORKERS"))
+      config.workerCount = static_cast<unsigned>(std::strtoul(workers, nullptr, 10));
+
+   if (const char *affinity = std::getenv("SANDBOX_AFFINITY")) {
+      if (std::strcmp(affinity, "restricted") == 0)
+         config.affinity = ThreadConfig::Affinity::RESTRICTED;
+      else if (std::strcmp(affinity, "pinned") == 0)
+         config.affinity = ThreadConfig::Affinity::PINNED;
+   }
+
+   const char *renderPriority = std::getenv("SANDBOX_RENDER_PRIORITY");
+   config.elevateRenderThread = renderPriority && std::strcmp(renderPriority, "high") == 0;
+   return config;
+}
+
+
 class SandboxApp : public Application {
 public:
-    SandboxApp() : Application("Sandbox") {
+    SandboxApp() : Application("Sandbox", ThreadConfigFromEnvironment()) {
        RendererAPI::SelectAPI(RendererAPI::API::VULKAN);
 
+       // SANDBOX_FRAME_MODE=serial disables frame pipelining, useful for comparing both modes
+       const char *frameMode = std::getenv("SANDBOX_FRAME_MODE");
+       bool serial = frameMode && std::strcmp(frameMode, "serial") == 0;
+       SetFrameMode(serial ? FrameMode::SERIAL : FrameMode::PIPELINED);
+
+       // SANDBOX_MAIN_LOOP=poll brings back a polling main thread for comparison
+       const char *mainLoop = std::getenv("SANDBOX_MAIN_LOOP");
+       bool poll = mainLoop && std::strcmp(mainLoop, "poll") == 0;
+       SetMainLoopMode(poll ? MainLoopMode::POLL : MainLoopMode::WAIT);
+
        PushLayer(std::make_unique<TestLayer>("TestLayer"));
        Renderer::SetImGuiLayer(PushOverlay(ImGuiLayer::Create()));
     }